@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2018 Istituto Italiano di Tecnologia (IIT)
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ */
+
+#include <cstdio>
+#include <vector>
+
+#include <yarp/os/all.h>
+#include <yarp/dev/ControlBoardInterfaces.h>
+#include <yarp/dev/PolyDriver.h>
+#include <yarp/dev/PolyDriverList.h>
+#include <yarp/dev/Wrapper.h>
+
+#if defined(__linux__)
+#include <sys/resource.h>
+#endif
+
+using namespace yarp::os;
+using namespace yarp::dev;
+
+// Control board streaming benchmark.
+// Sends, at each cycle, position direct, velocity and current references
+// for three groups of joints of a fakeMotionControl, through a
+// controlboardwrapper2 and a remote_controlboard, first with one message
+// for each command, then with a single streaming frame. Reports the
+// latency until the last reference reaches the device and the CPU time
+// used by the process (both sides run in this process, and the CPU time
+// includes the busy wait for the last reference).
+//
+// Parameters:
+// --joints: number of joints, split in three groups (default 24)
+// --cycles: number of control cycles (default 2000)
+// --carrier: carrier of the command connection (default tcp)
+
+static double cpuTime()
+{
+#if defined(__linux__)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6;
+#else
+    return -1;
+#endif
+}
+
+struct Groups
+{
+    std::vector<int> pos, vel, curr;
+    std::vector<double> posRefs, velRefs, currRefs;
+};
+
+static void runTest(const char* name, PolyDriver& remote, ICurrentControl* local, Groups& g, int cycles, bool useFrame)
+{
+    IPositionDirect* posdir = nullptr;
+    IVelocityControl2* vel = nullptr;
+    ICurrentControl* curr = nullptr;
+    IStreamingFrame* stream = nullptr;
+    remote.view(posdir);
+    remote.view(vel);
+    remote.view(curr);
+    remote.view(stream);
+
+    StreamingFrame frame;
+    int last = g.curr.back();
+    double latency = 0;
+    double maxLatency = 0;
+    int lost = 0;
+
+    double cpu = cpuTime();
+    for (int k = 1; k <= cycles; k++) {
+        for (size_t i = 0; i < g.posRefs.size(); i++) { g.posRefs[i] = k; }
+        for (size_t i = 0; i < g.velRefs.size(); i++) { g.velRefs[i] = k; }
+        for (size_t i = 0; i < g.currRefs.size(); i++) { g.currRefs[i] = k; }
+
+        double t0 = SystemClock::nowSystem();
+        if (useFrame) {
+            frame.clear();
+            frame.addCommand(VOCAB_POSITION_DIRECT_GROUP, (int)g.pos.size(), g.pos.data(), g.posRefs.data());
+            frame.addCommand(VOCAB_VELOCITY_MOVE_GROUP, (int)g.vel.size(), g.vel.data(), g.velRefs.data());
+            frame.addCommand(VOCAB_CURRENT_REF_GROUP, (int)g.curr.size(), g.curr.data(), g.currRefs.data());
+            stream->sendStreamingFrame(frame);
+        } else {
+            posdir->setPositions((int)g.pos.size(), g.pos.data(), g.posRefs.data());
+            vel->velocityMove((int)g.vel.size(), g.vel.data(), g.velRefs.data());
+            curr->setRefCurrents((int)g.curr.size(), g.curr.data(), g.currRefs.data());
+        }
+
+        // wait for the last reference of the cycle
+        double ref = 0;
+        double t1 = t0;
+        while (ref != k && t1 - t0 < 0.1) {
+            local->getRefCurrent(last, &ref);
+            t1 = SystemClock::nowSystem();
+        }
+        if (ref != k) {
+            lost++;
+        }
+        latency += t1 - t0;
+        if (t1 - t0 > maxLatency) {
+            maxLatency = t1 - t0;
+        }
+    }
+    cpu = cpuTime() - cpu;
+
+    printf("%-18s latency avg %.3f max %.3f [ms], cpu %.1f [us/cycle], lost %d\n",
+           name, latency / cycles * 1000, maxLatency * 1000, cpu / cycles * 1e6, lost);
+}
+
+int main(int argc, char *argv[])
+{
+    Property p;
+    p.fromCommand(argc, argv);
+
+    int joints = p.check("joints", Value(24)).asInt();
+    int cycles = p.check("cycles", Value(2000)).asInt();
+    ConstString carrier = p.check("carrier", Value("tcp")).asString();
+
+    Network yarp;
+    Network::setLocalMode(true);
+
+    Property fakeConf;
+    fakeConf.fromConfig(("device fakeMotionControl\n[GENERAL]\nJoints " + std::to_string(joints) + "\n").c_str());
+    PolyDriver fake;
+    if (!fake.open(fakeConf)) {
+        printf("Cannot open fakeMotionControl\n");
+        return 1;
+    }
+    ICurrentControl* local = nullptr;
+    IControlMode2* mode = nullptr;
+    fake.view(local);
+    fake.view(mode);
+
+    Property wrapperConf;
+    wrapperConf.fromConfig(("device controlboardwrapper2\nname /bench/robot\nperiod 10\nnetworks (net)\njoints " +
+                            std::to_string(joints) + "\nnet 0 " + std::to_string(joints - 1) + " 0 " + std::to_string(joints - 1) + "\n").c_str());
+    PolyDriver wrapper;
+    if (!wrapper.open(wrapperConf)) {
+        printf("Cannot open controlboardwrapper2\n");
+        return 1;
+    }
+    IMultipleWrapper* iwrap = nullptr;
+    wrapper.view(iwrap);
+    PolyDriverList list;
+    list.push(&fake, "net");
+    iwrap->attachAll(list);
+
+    Property remoteConf;
+    remoteConf.put("device", "remote_controlboard");
+    remoteConf.put("remote", "/bench/robot");
+    remoteConf.put("local", "/bench/client");
+    remoteConf.put("carrier", carrier);
+    remoteConf.put("writeStrict", "on");
+    PolyDriver remote;
+    if (!remote.open(remoteConf)) {
+        printf("Cannot open remote_controlboard\n");
+        return 1;
+    }
+
+    Groups g;
+    for (int j = 0; j < joints; j++) {
+        if (j < joints / 3) {
+            g.pos.push_back(j);
+            mode->setControlMode(j, VOCAB_CM_POSITION_DIRECT);
+        } else if (j < 2 * joints / 3) {
+            g.vel.push_back(j);
+            mode->setControlMode(j, VOCAB_CM_VELOCITY);
+        } else {
+            g.curr.push_back(j);
+        }
+    }
+    g.posRefs.resize(g.pos.size());
+    g.velRefs.resize(g.vel.size());
+    g.currRefs.resize(g.curr.size());
+
+    printf("%d joints, %d cycles, 3 commands per cycle\n", joints, cycles);
+    runTest("one per command:", remote, local, g, cycles, false);
+    runTest("streaming frame:", remote, local, g, cycles, true);
+
+    remote.close();
+    iwrap->detachAll();
+    wrapper.close();
+    fake.close();
+    return 0;
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2018 Istituto Italiano di Tecnologia (IIT)
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <yarp/os/all.h>
+#include <yarp/sig/IplImage.h>
+
+using namespace yarp::os;
+
+// Ipl convolution benchmark.
+// Convolves mono 8 bits images (VGA and HD) with square kernels of size
+// 3 to 15, with iplConvolve2D and with iplConvolveSep2D, in the calling
+// thread only (YARP_IPL_THREADS=1) and with all the threads, and with the
+// per-pixel loops iplConvolve2D was implemented with before.
+// Reports the time of a convolution in ms, and checks that the results of
+// iplConvolve2D are the same as those of the per-pixel loops.
+//
+// Parameters:
+// --rounds: number of convolutions of each test (default 10)
+// --max: largest kernel size (default 15)
+
+// The per-pixel loops of the old iplConvolve2D, on 8 bits unsigned images
+static void convolveScalar(const char* src, char* dst, int w, int h,
+                           const int* values, int size, int shift)
+{
+    const int ksize = size * size;
+    const int border = size / 2;
+    for (int i = border; i < h - border; i++) {
+        for (int j = border; j < w - border; j++) {
+            int tmp = 0;
+            for (int k = 0; k < size; k++) {
+                for (int l = 0; l < size; l++) {
+                    tmp += src[(i + k - border) * w + j + l - border] * values[ksize - k * size - l - 1];
+                }
+            }
+            tmp >>= shift;
+            dst[i * w + j] = char((tmp > 255) ? 255 : ((tmp < 0) ? 0 : tmp));
+        }
+    }
+}
+
+static IplImage* createImage(int w, int h)
+{
+    IplImage* img = iplCreateImageHeader(1, 0, IPL_DEPTH_8U, const_cast<char*>("GRAY"), const_cast<char*>("GRAY"),
+                                         IPL_DATA_ORDER_PIXEL, IPL_ORIGIN_TL, IPL_ALIGN_QWORD,
+                                         w, h, nullptr, nullptr, nullptr, nullptr);
+    iplAllocateImage(img, 0, 0);
+    for (int i = 0; i < img->imageSize; i++) {
+        img->imageData[i] = (char)((i * 7 + i / w * 13) & 0x7f);
+    }
+    return img;
+}
+
+template <class F>
+static double timeIt(int rounds, F f)
+{
+    f();
+    double t = SystemClock::nowSystem();
+    for (int i = 0; i < rounds; i++) {
+        f();
+    }
+    return (SystemClock::nowSystem() - t) / rounds * 1000;
+}
+
+static void runTest(const char* name, int w, int h, int size, int rounds)
+{
+    IplImage* src = createImage(w, h);
+    IplImage* dst = createImage(w, h);
+    std::vector<char> ref(src->imageSize, 0);
+
+    std::vector<int> values(size * size, 1);
+    std::vector<int> line(size, 1);
+    // the sum of the kernel, rounded to a power of 2
+    int shift = 0;
+    while ((1 << shift) < size) {
+        shift++;
+    }
+    shift *= 2;
+    IplConvKernel* kernel = iplCreateConvKernel(size, size, size / 2, size / 2, values.data(), shift);
+    IplConvKernel* xKernel = iplCreateConvKernel(size, 1, size / 2, 0, line.data(), shift / 2);
+    IplConvKernel* yKernel = iplCreateConvKernel(1, size, 0, size / 2, line.data(), shift / 2);
+
+    double scalar = timeIt(rounds, [&]() {
+        convolveScalar(src->imageData, ref.data(), w, h, values.data(), size, shift);
+    });
+    NetworkBase::setEnvironment("YARP_IPL_THREADS", "1");
+    double single = timeIt(rounds, [&]() { iplConvolve2D(src, dst, &kernel, 1, 0); });
+    double singleSep = timeIt(rounds, [&]() { iplConvolveSep2D(src, dst, xKernel, yKernel); });
+    NetworkBase::setEnvironment("YARP_IPL_THREADS", "");
+    double multi = timeIt(rounds, [&]() { iplConvolve2D(src, dst, &kernel, 1, 0); });
+
+    bool same = true;
+    const int border = size / 2;
+    for (int i = border; i < h - border; i++) {
+        same = same && memcmp(dst->imageData + i * w + border, ref.data() + i * w + border, w - 2 * border) == 0;
+    }
+    double multiSep = timeIt(rounds, [&]() { iplConvolveSep2D(src, dst, xKernel, yKernel); });
+
+    char label[64];
+    snprintf(label, sizeof(label), "%s, %dx%d:", name, size, size);
+    printf("%-24s %8.2f ms scalar  %8.2f ms simd  %8.2f ms threads (x%5.1f)  %8.2f ms sep  %8.2f ms sep threads  %s\n",
+           label, scalar, single, multi, multi > 0 ? scalar / multi : 0.0, singleSep, multiSep,
+           same ? "same" : "DIFFERENT");
+
+    iplDeleteConvKernel(kernel);
+    iplDeleteConvKernel(xKernel);
+    iplDeleteConvKernel(yKernel);
+    iplDeallocate(src, IPL_IMAGE_ALL);
+    iplDeallocate(dst, IPL_IMAGE_ALL);
+}
+
+int main(int argc, char *argv[])
+{
+    Network yarp;
+
+    Property p;
+    p.fromCommand(argc, argv);
+    int rounds = p.check("rounds", Value(10)).asInt();
+    int max = p.check("max", Value(15)).asInt();
+
+    for (int size = 3; size <= max; size += 2) {
+        runTest("vga", 640, 480, size, rounds);
+    }
+    for (int size = 3; size <= max; size += 2) {
+        runTest("hd", 1280, 720, size, rounds);
+    }
+    return 0;
+}
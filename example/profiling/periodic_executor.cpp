@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2018 Istituto Italiano di Tecnologia (IIT)
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <yarp/os/all.h>
+
+#if defined(__linux__)
+#include <sys/resource.h>
+#endif
+
+using namespace yarp::os;
+
+// Periodic executor benchmark.
+// Runs the same set of periodic tasks first with one thread each, then on
+// a shared PeriodicExecutor, and reports the number of threads of the
+// process, the context switches and the jitter of the period.
+//
+// Parameters:
+// --tasks: number of periodic tasks (default 100)
+// --period: period of the tasks [ms] (default 10)
+// --workers: number of threads of the executor (default 2)
+// --duration: duration of each test [s] (default 5)
+
+class Task : public RateThread
+{
+public:
+    volatile double sink;
+
+    Task(double period) : RateThread(period), sink(0) {}
+
+    void run() override
+    {
+        // a few microseconds of work
+        for (int i=0; i<2000; i++) {
+            sink += i * 0.5;
+        }
+    }
+};
+
+static int countThreads()
+{
+#if defined(__linux__)
+    FILE* f = fopen("/proc/self/status", "r");
+    if (!f) {
+        return -1;
+    }
+    char line[256];
+    int threads = -1;
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, "Threads:", 8) == 0) {
+            threads = atoi(line + 8);
+        }
+    }
+    fclose(f);
+    return threads;
+#else
+    return -1;
+#endif
+}
+
+static long contextSwitches()
+{
+#if defined(__linux__)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_nvcsw + usage.ru_nivcsw;
+#else
+    return -1;
+#endif
+}
+
+static void runTest(const char* name, int tasks, double period, double duration, PeriodicExecutor* executor)
+{
+    std::vector<Task*> threads;
+    for (int i=0; i<tasks; i++) {
+        Task* t = new Task(period);
+        t->setExecutor(executor);
+        threads.push_back(t);
+    }
+
+    for (int i=0; i<tasks; i++) {
+        threads[i]->start();
+    }
+    Time::delay(0.5);
+    for (int i=0; i<tasks; i++) {
+        threads[i]->resetStat();
+    }
+
+    long switches = contextSwitches();
+    int nThreads = countThreads();
+    Time::delay(duration);
+    switches = contextSwitches() - switches;
+
+    double avgPeriod = 0, avgStd = 0, maxStd = 0;
+    for (int i=0; i<tasks; i++) {
+        double av, std;
+        threads[i]->getEstPeriod(av, std);
+        avgPeriod += av;
+        avgStd += std;
+        if (std > maxStd) {
+            maxStd = std;
+        }
+    }
+
+    for (int i=0; i<tasks; i++) {
+        threads[i]->stop();
+        delete threads[i];
+    }
+
+    printf("%-22s threads %4d, context switches %8.0f/s, period %.3f [ms], jitter avg %.3f max %.3f [ms]\n",
+           name, nThreads, switches / duration,
+           avgPeriod / tasks, avgStd / tasks, maxStd);
+}
+
+int main(int argc, char *argv[])
+{
+    Property p;
+    p.fromCommand(argc, argv);
+
+    int tasks = p.check("tasks", Value(100)).asInt();
+    double period = p.check("period", Value(10.0)).asDouble();
+    int workers = p.check("workers", Value(2)).asInt();
+    double duration = p.check("duration", Value(5.0)).asDouble();
+
+    Network::init();
+
+    printf("%d tasks, period %.3f [ms]\n", tasks, period);
+
+    runTest("dedicated threads:", tasks, period, duration, nullptr);
+
+    PeriodicExecutor executor(workers);
+    executor.start();
+    char name[64];
+    sprintf(name, "executor (%d workers):", workers);
+    runTest(name, tasks, period, duration, &executor);
+    executor.stop();
+
+    Network::fini();
+    return 0;
+}
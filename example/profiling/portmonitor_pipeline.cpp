@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2018 Istituto Italiano di Tecnologia (IIT)
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ */
+
+#include <cstdio>
+
+#include <yarp/os/all.h>
+#include <yarp/os/DummyConnector.h>
+#include <yarp/sig/Image.h>
+
+using namespace yarp::os;
+using namespace yarp::sig;
+
+// Portmonitor pipeline benchmark.
+// Sends depth images through a monitored connection and reports the
+// average time per frame, together with the cost of the serialize/read
+// back step the portmonitor carrier does on each modified message.
+//
+// Parameters:
+// --carrier: connection carrier
+//            (default tcp+recv.portmonitor+type.dll+file.depthimage)
+//            e.g. tcp, tcp+recv.portmonitor+type.dll+file.depthimage:zfp
+//                 tcp+recv.portmonitor+type.dll+file.depthimage+async.1
+// --width, --height: image size (default 1280x720)
+// --frames: number of frames to send (default 300)
+
+int main(int argc, char *argv[])
+{
+    Property p;
+    p.fromCommand(argc, argv);
+
+    ConstString carrier = p.check("carrier",
+                                  Value("tcp+recv.portmonitor+type.dll+file.depthimage")).asString();
+    int width = p.check("width", Value(1280)).asInt();
+    int height = p.check("height", Value(720)).asInt();
+    int frames = p.check("frames", Value(300)).asInt();
+
+    Network yarp;
+    Network::setLocalMode(true);
+
+    ImageOf<PixelFloat> depth;
+    depth.resize(width, height);
+    for (int r=0; r<height; r++) {
+        for (int c=0; c<width; c++) {
+            depth(c, r) = 0.2f + 10.0f * (float)(c+r) / (float)(width+height);
+        }
+    }
+
+    // serialize + read back, as done by the carrier on modified data
+    DummyConnector con;
+    ImageOf<PixelFloat> copy;
+    double start = Time::now();
+    for (int i=0; i<frames; i++) {
+        con.reset();
+        depth.write(con.getWriter());
+        copy.read(con.getReader());
+    }
+    double roundTrip = (Time::now() - start) / frames;
+    printf("serialize/read back of a %dx%d float image: %.3f [ms]\n",
+           width, height, roundTrip * 1000);
+
+    Port out;
+    BufferedPort<FlexImage> in;
+    in.setStrict();
+    out.open("/portmonitor_pipeline/out");
+    in.open("/portmonitor_pipeline/in");
+    if (!Network::connect(out.getName(), in.getName(), carrier)) {
+        printf("cannot connect with carrier %s\n", carrier.c_str());
+        return 1;
+    }
+
+    // with asynchronous monitors the result of a frame is delivered
+    // when the next one arrives, so do not wait in lockstep.
+    int count = 0;
+    start = Time::now();
+    for (int i=0; i<frames; i++) {
+        out.write(depth);
+        while (in.read(false) != nullptr) {
+            count++;
+        }
+    }
+    double timeout = Time::now() + 1.0;
+    while (count < frames - 1 && Time::now() < timeout) {
+        if (in.read(false) != nullptr) {
+            count++;
+        } else {
+            Time::delay(0.001);
+        }
+    }
+    double perFrame = (Time::now() - start) / frames;
+    printf("%s: %d/%d frames, %.3f [ms] per frame (%.1f fps)\n",
+           carrier.c_str(), count, frames, perFrame * 1000, 1.0 / perFrame);
+
+    out.close();
+    in.close();
+    return 0;
+}
@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2018 Istituto Italiano di Tecnologia (IIT)
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ */
+
+#include <cstdio>
+#include <vector>
+
+#include <yarp/os/all.h>
+#include <yarp/sig/Image.h>
+#include <yarp/sig/Sound.h>
+
+using namespace yarp::os;
+using namespace yarp::sig;
+
+// Sound throughput benchmark.
+// Streams multichannel sounds at 48 kHz in blocks (10 ms by default), and
+// measures for each step of the stream how many seconds of audio are
+// handled in a second (and the MB/s of the same audio as 16 bit samples):
+// - filling a sound with set(), sample by sample, and with setBlock() from
+//   interleaved 16 bit integers and floats, in each sample format;
+// - reading a channel with get() and with getChannel();
+// - serializing and deserializing a sound, with the format of the sounds
+//   and with the format of the older versions (an image and a bottle);
+// - sending the sounds between two ports of this process over tcp.
+//
+// Parameters:
+// --channels: number of channels (default 8)
+// --rate: sampling frequency in Hz (default 48000)
+// --block: samples in a block (default 480)
+// --seconds: seconds of audio for each test (default 60)
+
+static int channels;
+static int rate;
+static int block;
+static int blocks;
+
+static void report(const char* name, double t)
+{
+    double audio = (double)blocks * block / rate;
+    printf("%-24s %10.1f x real time  %8.1f MB/s\n",
+           name,
+           (t > 0) ? audio / t : 0.0,
+           (t > 0) ? audio * rate * channels * 2 / t / 1e6 : 0.0);
+}
+
+static const char* formatName(Sound::SampleFormat format)
+{
+    switch (format) {
+    case Sound::FORMAT_INT16: return "int16";
+    case Sound::FORMAT_INT24: return "int24";
+    case Sound::FORMAT_INT32: return "int32";
+    default: return "float32";
+    }
+}
+
+static void runFill(Sound::SampleFormat format)
+{
+    std::vector<short> in(block * channels);
+    std::vector<float> inf(block * channels);
+    for (size_t i = 0; i < in.size(); i++) {
+        in[i] = (short)(i * 31);
+        inf[i] = in[i] / 32768.0f;
+    }
+    Sound snd;
+    snd.setSampleFormat(format);
+    snd.resize(block, channels);
+    char name[64];
+
+    double t = SystemClock::nowSystem();
+    for (int b = 0; b < blocks; b++) {
+        int idx = 0;
+        for (int i = 0; i < block; i++) {
+            for (int c = 0; c < channels; c++) {
+                snd.set(in[idx++], i, c);
+            }
+        }
+    }
+    sprintf(name, "set(), %s:", formatName(format));
+    report(name, SystemClock::nowSystem() - t);
+
+    t = SystemClock::nowSystem();
+    for (int b = 0; b < blocks; b++) {
+        snd.setBlock(in.data(), 0, block);
+    }
+    sprintf(name, "setBlock(short), %s:", formatName(format));
+    report(name, SystemClock::nowSystem() - t);
+
+    t = SystemClock::nowSystem();
+    for (int b = 0; b < blocks; b++) {
+        snd.setBlock(inf.data(), 0, block);
+    }
+    sprintf(name, "setBlock(float), %s:", formatName(format));
+    report(name, SystemClock::nowSystem() - t);
+}
+
+static void runChannels()
+{
+    Sound snd;
+    snd.resize(block, channels);
+    std::vector<short> out(block);
+    // the results are stored, so that the loops are not optimized away
+    volatile int x = 0;
+
+    double t = SystemClock::nowSystem();
+    for (int b = 0; b < blocks; b++) {
+        for (int c = 0; c < channels; c++) {
+            for (int i = 0; i < block; i++) {
+                out[i] = (short)snd.get(i, c);
+            }
+            x = out[0];
+        }
+    }
+    report("get():", SystemClock::nowSystem() - t);
+
+    t = SystemClock::nowSystem();
+    for (int b = 0; b < blocks; b++) {
+        for (int c = 0; c < channels; c++) {
+            snd.getChannel(c, out.data(), 0, block);
+            x = out[0];
+        }
+    }
+    report("getChannel():", SystemClock::nowSystem() - t);
+}
+
+static void runSerialization()
+{
+    Sound snd;
+    snd.resize(block, channels);
+    snd.setFrequency(rate);
+    Sound result;
+
+    double t = SystemClock::nowSystem();
+    for (int b = 0; b < blocks; b++) {
+        Portable::copyPortable(snd, result);
+    }
+    report("serialization:", SystemClock::nowSystem() - t);
+
+    // the older versions sent an image, with a channel for each row
+    PortablePair<FlexImage,Bottle> old;
+    old.head.setPixelCode(VOCAB_PIXEL_MONO16);
+    old.head.setQuantum(2);
+    old.head.resize(block, channels);
+    old.body.addInt(rate);
+    PortablePair<FlexImage,Bottle> oldResult;
+    oldResult.head.setPixelCode(VOCAB_PIXEL_MONO16);
+    oldResult.head.setQuantum(2);
+
+    t = SystemClock::nowSystem();
+    for (int b = 0; b < blocks; b++) {
+        Portable::copyPortable(old, oldResult);
+    }
+    report("old serialization:", SystemClock::nowSystem() - t);
+
+    t = SystemClock::nowSystem();
+    for (int b = 0; b < blocks; b++) {
+        Portable::copyPortable(old, result);
+    }
+    report("old format, read:", SystemClock::nowSystem() - t);
+}
+
+static void runPorts()
+{
+    BufferedPort<Sound> in;
+    BufferedPort<Sound> out;
+    in.setStrict();
+    in.open("/sound_throughput/in");
+    out.open("/sound_throughput/out");
+    if (!NetworkBase::connect(out.getName(), in.getName(), "tcp")) {
+        printf("%-24s cannot connect\n", "tcp:");
+        return;
+    }
+
+    double t = SystemClock::nowSystem();
+    for (int b = 0; b < blocks; b++) {
+        Sound& snd = out.prepare();
+        snd.resize(block, channels);
+        snd.setFrequency(rate);
+        out.writeStrict();
+        in.read();
+    }
+    report("tcp:", SystemClock::nowSystem() - t);
+
+    out.close();
+    in.close();
+}
+
+int main(int argc, char *argv[])
+{
+    Network yarp;
+
+    Property p;
+    p.fromCommand(argc, argv);
+    channels = p.check("channels", Value(8)).asInt();
+    rate = p.check("rate", Value(48000)).asInt();
+    block = p.check("block", Value(480)).asInt();
+    double seconds = p.check("seconds", Value(60.0)).asDouble();
+    blocks = (int)(seconds * rate / block);
+
+    printf("%d channels, %d Hz, blocks of %d samples, %g s of audio\n",
+           channels, rate, block, seconds);
+    runFill(Sound::FORMAT_INT16);
+    runFill(Sound::FORMAT_INT24);
+    runFill(Sound::FORMAT_FLOAT32);
+    runChannels();
+    runSerialization();
+    runPorts();
+    return 0;
+}
@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2018 Istituto Italiano di Tecnologia (IIT)
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <yarp/os/all.h>
+#include <yarp/os/NetType.h>
+
+#if defined(__linux__)
+#include <sys/resource.h>
+#endif
+
+using namespace yarp::os;
+
+// Udp throughput benchmark.
+// Sends large messages between two ports of this process over an udp
+// connection on the loopback interface, with the old checksum of the
+// datagrams, with the CRC-32C, with the CRC-32C and the batches of
+// datagrams (sendmmsg/recvmmsg, Linux only), and with the forward error
+// correction of the messages as well (a parity fragment every 4).
+// Reports the throughput of the received messages, the messages lost,
+// and the CPU time used by the process for each MB received (both sides
+// run in this process, and the CPU time includes the busy wait between
+// long datagrams).
+// The speed of the two checksums on a datagram is reported as well.
+//
+// Parameters:
+// --size: size of a message in bytes (default 1000000)
+// --messages: number of messages (default 500)
+// --period: pause between the messages in seconds (default 0)
+
+static double cpuTime()
+{
+#if defined(__linux__)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6;
+#else
+    return -1;
+#endif
+}
+
+// A block of bytes, sent without copies
+class Payload : public Portable
+{
+public:
+    std::vector<char> data;
+
+    virtual bool read(ConnectionReader& connection) override
+    {
+        int len = connection.expectInt();
+        if (len < 0) {
+            return false;
+        }
+        data.resize(len);
+        return connection.expectBlock(data.data(), len);
+    }
+
+    virtual bool write(ConnectionWriter& connection) override
+    {
+        connection.appendInt((int)data.size());
+        connection.appendExternalBlock(data.data(), data.size());
+        return true;
+    }
+};
+
+class Counter : public PortReader
+{
+public:
+    Mutex mutex;
+    int messages;
+    double bytes;
+    double last;
+    Payload payload;
+
+    Counter() : messages(0), bytes(0), last(0) {}
+
+    virtual bool read(ConnectionReader& connection) override
+    {
+        if (!payload.read(connection)) {
+            return false;
+        }
+        LockGuard guard(mutex);
+        messages++;
+        bytes += payload.data.size();
+        last = SystemClock::nowSystem();
+        return true;
+    }
+};
+
+static void runTest(const char* name, const char* crc32c, const char* batch,
+                    const char* fec, int size, int messages, double period)
+{
+    NetworkBase::setEnvironment("YARP_UDP_CRC32C", crc32c);
+    NetworkBase::setEnvironment("YARP_DGRAM_BATCH_SIZE", batch);
+    NetworkBase::setEnvironment("YARP_DGRAM_FEC", fec);
+
+    Counter counter;
+    Port in;
+    Port out;
+    in.setReader(counter);
+    in.open("/udp_throughput/in");
+    out.open("/udp_throughput/out");
+    if (!NetworkBase::connect(out.getName(), in.getName(), "udp")) {
+        printf("%-24s cannot connect\n", name);
+        return;
+    }
+    SystemClock::delaySystem(0.2);
+
+    Payload payload;
+    payload.data.resize(size);
+    for (int i = 0; i < size; i++) {
+        payload.data[i] = (char)(i * 7);
+    }
+
+    double cpu = cpuTime();
+    double start = SystemClock::nowSystem();
+    for (int i = 0; i < messages; i++) {
+        out.write(payload);
+        if (period > 0) {
+            SystemClock::delaySystem(period);
+        }
+    }
+
+    // wait for the last datagrams
+    int received = -1;
+    while (true) {
+        SystemClock::delaySystem(0.2);
+        LockGuard guard(counter.mutex);
+        if (counter.messages == received) {
+            break;
+        }
+        received = counter.messages;
+    }
+    cpu = cpuTime() - cpu;
+
+    double mb = counter.bytes / 1e6;
+    double time = counter.last - start;
+    printf("%-24s %8.1f MB/s  %6.1f%% lost  %8.2f ms cpu/MB\n",
+           name,
+           (time > 0) ? mb / time : 0.0,
+           100.0 * (messages - counter.messages) / messages,
+           (mb > 0) ? cpu / mb * 1000 : 0.0);
+
+    NetworkBase::disconnect(out.getName(), in.getName());
+    out.close();
+    in.close();
+}
+
+static void runChecksum(int size)
+{
+    std::vector<char> buf(size);
+    for (int i = 0; i < size; i++) {
+        buf[i] = (char)(i * 13);
+    }
+    int rounds = (int)(2e9 / size);
+    // the results are stored, so that the loops are not optimized away
+    volatile unsigned long x = 0;
+    double t = SystemClock::nowSystem();
+    for (int i = 0; i < rounds; i++) {
+        x = NetType::getCrc(buf.data(), buf.size());
+    }
+    double crc = SystemClock::nowSystem() - t;
+    t = SystemClock::nowSystem();
+    for (int i = 0; i < rounds; i++) {
+        x = NetType::getCrc32c(buf.data(), buf.size());
+    }
+    double crc32c = SystemClock::nowSystem() - t;
+    printf("%-24s %8.1f MB/s\n", "checksum crc32:", rounds * (size / 1e6) / crc);
+    printf("%-24s %8.1f MB/s\n", "checksum crc32c:", rounds * (size / 1e6) / crc32c);
+}
+
+int main(int argc, char *argv[])
+{
+    Network yarp;
+
+    Property p;
+    p.fromCommand(argc, argv);
+    int size = p.check("size", Value(1000000)).asInt();
+    int messages = p.check("messages", Value(500)).asInt();
+    double period = p.check("period", Value(0.0)).asDouble();
+
+    runChecksum(65499);
+    runTest("udp, crc32:", "0", "0", "0", size, messages, period);
+    runTest("udp, crc32c:", "1", "0", "0", size, messages, period);
+    runTest("udp, crc32c, batches:", "1", "131072", "0", size, messages, period);
+    runTest("udp, fec:", "1", "131072", "4", size, messages, period);
+    return 0;
+}
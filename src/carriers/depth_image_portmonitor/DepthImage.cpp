@@ -10,18 +10,23 @@
 #include <cstdio>
 #include <cmath>
 
+#include <yarp/os/LogStream.h>
 #include <yarp/sig/Image.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 using namespace yarp::os;
 using namespace yarp::sig;
 
 
 bool DepthImageConverter::create(const yarp::os::Property& options)
 {
-    min = 0.2;
-    max = 10.0;
-    inMatrix = nullptr;
-    outMatrix = nullptr;
+    min = options.check("min", Value(0.2)).asDouble();
+    max = options.check("max", Value(10.0)).asDouble();
+    colormap = options.check("colormap", Value("none")).asString();
+    updateColormap();
     outImg.setPixelCode(VOCAB_PIXEL_MONO);
     return true;
 }
@@ -32,12 +37,62 @@ void DepthImageConverter::destroy()
 
 bool DepthImageConverter::setparam(const yarp::os::Property& params)
 {
-    return false;
+    bool ok = false;
+    if (params.check("min")) {
+        min = params.find("min").asDouble();
+        ok = true;
+    }
+    if (params.check("max")) {
+        max = params.find("max").asDouble();
+        ok = true;
+    }
+    if (params.check("colormap")) {
+        colormap = params.find("colormap").asString();
+        updateColormap();
+        ok = true;
+    }
+    return ok;
 }
 
 bool DepthImageConverter::getparam(yarp::os::Property& params)
 {
-    return false;
+    params.put("min", min);
+    params.put("max", max);
+    params.put("colormap", colormap);
+    return true;
+}
+
+void DepthImageConverter::updateColormap()
+{
+    // Entry 0 is reserved for invalid depth values, which are shown black.
+    lut[0].r = lut[0].g = lut[0].b = 0;
+    for (int i=1; i<256; i++)
+    {
+        double x = (i - 1) / 254.0;
+        double r, g, b;
+        if (colormap == "turbo")
+        {
+            // polynomial approximation of the Turbo colormap
+            r = 0.13572138 + x*(4.61539260 + x*(-42.66032258 + x*(132.13108234 + x*(-152.94239396 + x*59.28637943))));
+            g = 0.09140261 + x*(2.19418839 + x*(4.84296658 + x*(-14.18503333 + x*(4.27729857 + x*2.82956604))));
+            b = 0.10667330 + x*(12.64194608 + x*(-60.58204836 + x*(110.36276771 + x*(-89.90310912 + x*27.34824973))));
+        }
+        else
+        {
+            // jet
+            r = 1.5 - std::fabs(4.0*x - 3.0);
+            g = 1.5 - std::fabs(4.0*x - 2.0);
+            b = 1.5 - std::fabs(4.0*x - 1.0);
+        }
+        lut[i].r = (unsigned char) (255.0 * std::min(std::max(r, 0.0), 1.0) + 0.5);
+        lut[i].g = (unsigned char) (255.0 * std::min(std::max(g, 0.0), 1.0) + 0.5);
+        lut[i].b = (unsigned char) (255.0 * std::min(std::max(b, 0.0), 1.0) + 0.5);
+    }
+    if (colormap != "none" && colormap != "jet" && colormap != "turbo")
+    {
+        yWarning() << "DepthImageConverter: unknown colormap" << colormap << ", using jet";
+        colormap = "jet";
+    }
 }
 
 bool DepthImageConverter::accept(yarp::os::Things& thing)
@@ -57,36 +112,76 @@ bool DepthImageConverter::accept(yarp::os::Things& thing)
     return false;
 }
 
+void DepthImageConverter::convertRow(const float* in, unsigned char* out, size_t len,
+                                     float min, float max, float scale, int lowest)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128 vmin = _mm_set1_ps(min);
+    const __m128 vmax = _mm_set1_ps(max);
+    const __m128 vscale = _mm_set1_ps(scale);
+    const __m128 vtop = _mm_set1_ps(255.0f);
+    const __m128 vlow = _mm_set1_ps((float) lowest);
+    for (; i + 16 <= len; i += 16)
+    {
+        __m128i q[4];
+        for (int k=0; k<4; k++)
+        {
+            __m128 v = _mm_loadu_ps(in + i + 4*k);
+            // comparisons with NaN are false, so NaN is masked out as well
+            __m128 valid = _mm_and_ps(_mm_cmpge_ps(v, vmin), _mm_cmple_ps(v, vmax));
+            __m128 r = _mm_sub_ps(vtop, _mm_mul_ps(v, vscale));
+            r = _mm_min_ps(_mm_max_ps(r, vlow), vtop);
+            q[k] = _mm_and_si128(_mm_cvttps_epi32(r), _mm_castps_si128(valid));
+        }
+        __m128i lo = _mm_packs_epi32(q[0], q[1]);
+        __m128i hi = _mm_packs_epi32(q[2], q[3]);
+        _mm_storeu_si128((__m128i*) (out + i), _mm_packus_epi16(lo, hi));
+    }
+#endif
+    for (; i < len; i++)
+    {
+        float v = in[i];
+        float r = 255.0f - v * scale;
+        r = (r < lowest) ? (float) lowest : ((r > 255.0f) ? 255.0f : r);
+        out[i] = (v >= min && v <= max) ? (unsigned char) r : 0;
+    }
+}
+
 yarp::os::Things& DepthImageConverter::update(yarp::os::Things& thing)
 {
     Image* img = thing.cast_as< Image >();
-    inMatrix = (float **) img->getRawImage();
-
-    outImg.setPixelCode(VOCAB_PIXEL_MONO);
-    outImg.setPixelSize(1);
-    outImg.resize(img->width(), img->height());
-
-    outImg.zero();
-    float *inPixels = (float *)img->getRawImage();
-    unsigned char *pixels = outImg.getRawImage();
-    for(int h=0; h<img->height(); h++)
+    int width = img->width();
+    int height = img->height();
+    bool colored = (colormap != "none");
+
+    // The output buffer is reused across frames, it is reallocated only
+    // when size or format change. No need to zero it, every pixel is set.
+    outImg.setPixelCode(colored ? VOCAB_PIXEL_RGB : VOCAB_PIXEL_MONO);
+    outImg.resize(width, height);
+
+    float fmin = (float) min;
+    float fmax = (float) max;
+    float scale = (float) (255.0 / (max - min));
+    if (colored) {
+        levels.resize(width);
+    }
+    for(int h=0; h<height; h++)
     {
-        for(int w=0; w<img->width(); w++)
+        const float* inRow = (const float*) img->getRow(h);
+        if (!colored)
+        {
+            convertRow(inRow, outImg.getRow(h), width, fmin, fmax, scale, 0);
+            continue;
+        }
+        // valid values are mapped to [1, 255], 0 marks invalid ones
+        convertRow(inRow, levels.data(), width, fmin, fmax, scale, 1);
+        PixelRgb* outRow = (PixelRgb*) outImg.getRow(h);
+        for(int w=0; w<width; w++)
         {
-            float inVal = inPixels[w + (h * img->width())];
-            if (inVal != inVal /* NaN */ || inVal < min || inVal > max) {
-                pixels[w + (h * (img->width() ))] = 0;
-            } else {
-                int val = (int) (255.0 - (inVal * 255.0 / (max - min)));
-                if(val >= 255)
-                    val = 255;
-                if(val <= 0)
-                    val = 0;
-                pixels[w + (h * (img->width() ))] = (char) val;
-            }
+            outRow[w] = lut[levels[w]];
         }
     }
     th.setPortWriter(&outImg);
     return th;
 }
-
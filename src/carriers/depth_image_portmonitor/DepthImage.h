@@ -25,7 +25,16 @@
 #include <yarp/os/MonitorObject.h>
 #include <yarp/sig/Image.h>
 
+#include <vector>
 
+
+/**
+ * Port monitor converting float depth images into mono images, or into
+ * RGB images through a colormap ("jet" or "turbo").
+ *
+ * Parameters (at creation, e.g. tcp+recv.portmonitor+type.dll+file.depthimage+colormap.jet,
+ * or through setparam): min, max (range in meters) and colormap ("none", "jet", "turbo").
+ */
 class DepthImageConverter : public yarp::os::MonitorObject
 {
 public:
@@ -38,13 +47,23 @@ public:
     bool accept(yarp::os::Things& thing) override;
     yarp::os::Things& update(yarp::os::Things& thing) override;
 
+    /**
+     * Convert a row of depth values into 8 bit levels: values outside
+     * [min, max] (and NaN) become 0, valid ones 255 - depth*scale clamped
+     * to [lowest, 255].
+     */
+    static void convertRow(const float* in, unsigned char* out, size_t len,
+                           float min, float max, float scale, int lowest);
+
 private:
+    void updateColormap();
 
     double min, max;
+    yarp::os::ConstString colormap;
+    yarp::sig::PixelRgb lut[256];
+    std::vector<unsigned char> levels;
     yarp::os::Bottle bt;
     yarp::os::Things th;
-    float **inMatrix;
-    unsigned char **outMatrix;
     yarp::sig::FlexImage outImg;
 };
 
@@ -7,6 +7,10 @@
 
 
 #include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <vector>
 
 
 /*
@@ -47,25 +51,19 @@ extern "C" {
 #include <yarp/sig/ImageNetworkHeader.h>
 #include <yarp/os/Name.h>
 #include <yarp/os/Bytes.h>
+#include <yarp/os/LockGuard.h>
+#include <yarp/os/ManagedBytes.h>
+#include <yarp/os/Mutex.h>
 
 #include "WireImage.h"
 
 using namespace yarp::os;
 using namespace yarp::sig;
+using namespace yarp::mjpeg;
 
 #define dbg_printf if (0) printf
 
-typedef struct {
-    struct jpeg_destination_mgr pub;
-
-    JOCTET *buffer;
-    int bufsize;
-    JOCTET cache[1000000];  // need to make this variable...
-} net_destination_mgr;
-
-typedef net_destination_mgr *net_destination_ptr;
-
-void send_net_data(JOCTET *data, int len, void *client) {
+static void send_net_data(const unsigned char *data, int len, void *client) {
     dbg_printf("Send %d bytes\n", len);
     ConnectionState *p = (ConnectionState *)client;
     char hdr[1000];
@@ -97,50 +95,104 @@ Content-Length: %d%s%s", brk, len, brk, brk);
 
 }
 
-static void init_net_destination(j_compress_ptr cinfo) {
-    //printf("Initializing destination\n");
-    net_destination_ptr dest = (net_destination_ptr)cinfo->dest;
-    dest->buffer = &(dest->cache[0]);
-    dest->bufsize = sizeof(dest->cache);
-    dest->pub.next_output_byte = dest->buffer;
-    dest->pub.free_in_buffer = dest->bufsize;
-}
+/**
+ * The last image compressed by the mjpeg connections of a port with the
+ * same compression parameters.
+ */
+class MjpegSharedFrame {
+public:
+    Mutex mutex;
+    // copy of the image and of its envelope, to recognize it
+    bool valid;
+    ManagedBytes raw;
+    int width;
+    int height;
+    int code;
+    ConstString envelope;
+    std::shared_ptr<std::vector<unsigned char> > jpeg;
+
+    MjpegSharedFrame() :
+        valid(false),
+        width(0),
+        height(0),
+        code(0)
+    {}
+
+    bool matches(const FlexImage& img, const ConstString& envelope) const {
+        return valid && width==img.width() && height==img.height() &&
+            code==img.getPixelCode() && envelope==this->envelope &&
+            raw.length()==(size_t)img.getRawImageSize() &&
+            memcmp(raw.get(),img.getRawImage(),raw.length())==0;
+    }
 
-static boolean empty_net_output_buffer(j_compress_ptr cinfo) {
-    net_destination_ptr dest = (net_destination_ptr)cinfo->dest;
-    printf("Empty buffer - PROBLEM\n");
-    send_net_data(dest->buffer,dest->bufsize-dest->pub.free_in_buffer,
-                  cinfo->client_data);
-    dest->pub.next_output_byte = dest->buffer;
-    dest->pub.free_in_buffer = dest->bufsize;
-    return TRUE;
+    void store(const FlexImage& img, const ConstString& envelope) {
+        raw.allocateOnNeed(img.getRawImageSize(),img.getRawImageSize());
+        raw.setUsed(img.getRawImageSize());
+        memcpy(raw.get(),img.getRawImage(),img.getRawImageSize());
+        width = img.width();
+        height = img.height();
+        code = img.getPixelCode();
+        this->envelope = envelope;
+        valid = true;
+    }
+};
+
+namespace {
+Mutex sharedFramesMutex;
+std::map<std::string, std::weak_ptr<MjpegSharedFrame> > sharedFrames;
 }
 
-static void term_net_destination(j_compress_ptr cinfo) {
-    net_destination_ptr dest = (net_destination_ptr)cinfo->dest;
-    //printf("Terminating net %d %d\n", dest->bufsize,dest->pub.free_in_buffer);
-    send_net_data(dest->buffer,dest->bufsize-dest->pub.free_in_buffer,
-                  cinfo->client_data);
+static std::shared_ptr<MjpegSharedFrame> getSharedFrame(const ConstString& key) {
+    LockGuard guard(sharedFramesMutex);
+    std::map<std::string, std::weak_ptr<MjpegSharedFrame> >::iterator it = sharedFrames.begin();
+    while (it!=sharedFrames.end()) {
+        if (it->second.expired()) {
+            it = sharedFrames.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    std::shared_ptr<MjpegSharedFrame> frame = sharedFrames[key].lock();
+    if (!frame) {
+        frame = std::make_shared<MjpegSharedFrame>();
+        sharedFrames[key] = frame;
+    }
+    return frame;
 }
 
-void jpeg_net_dest(j_compress_ptr cinfo) {
-    net_destination_ptr dest;
+MjpegCarrier::~MjpegCarrier() {
+    shared.reset();
+    if (compression!=nullptr) {
+        delete compression;
+        compression = nullptr;
+    }
+}
 
-      //ERREXIT(cinfo, JERR_BUFFER_SIZE);
+void MjpegCarrier::configureCompression(ConnectionState& proto) {
+    // parameters of the request first, then the ones of the carrier
+    Name n(proto.getRoute().getCarrierName() + "://test");
+    if (quality=="") quality = n.getCarrierModifier("quality");
+    if (subsampling=="") subsampling = n.getCarrierModifier("subsampling");
+    if (bands=="") bands = n.getCarrierModifier("bands");
 
-    /* The destination object is made permanent so that multiple JPEG images
-     * can be written to the same buffer without re-executing jpeg_net_dest.
-     */
-    if (cinfo->dest == nullptr) {    /* first time for this JPEG object? */
-        cinfo->dest = (struct jpeg_destination_mgr *)
-            (*cinfo->mem->alloc_large) ((j_common_ptr) cinfo, JPOOL_PERMANENT,
-                                        sizeof(net_destination_mgr));
+    compression = new MjpegCompression;
+    if (quality!="") {
+        compression->setQuality(atoi(quality.c_str()));
     }
-
-    dest = (net_destination_ptr) cinfo->dest;
-    dest->pub.init_destination = init_net_destination;
-    dest->pub.empty_output_buffer = empty_net_output_buffer;
-    dest->pub.term_destination = term_net_destination;
+    if (subsampling!="") {
+        MjpegCompression::Subsampling mode;
+        if (MjpegCompression::parseSubsampling(subsampling,mode)) {
+            compression->setSubsampling(mode);
+        } else {
+            fprintf(stderr,"mjpeg: unknown subsampling %s, using 420\n", subsampling.c_str());
+            subsampling = "";
+        }
+    }
+    if (bands!="") {
+        compression->setBands(atoi(bands.c_str()));
+    }
+    shared = getSharedFrame(proto.getRoute().getFromName() + " " + quality +
+                            " " + subsampling + " " + bands);
 }
 
 bool MjpegCarrier::write(ConnectionState& proto, SizedWriter& writer) {
@@ -148,40 +200,36 @@ bool MjpegCarrier::write(ConnectionState& proto, SizedWriter& writer) {
     FlexImage *img = rep.checkForImage(writer);
 
     if (img==nullptr) return false;
-    int w = img->width();
-    int h = img->height();
-    int row_stride = img->getRowSize();
-    JOCTET *data = (JOCTET*)img->getRawImage();
-
-    JSAMPROW row_pointer[1];
-
-    struct jpeg_compress_struct cinfo;
-    struct jpeg_error_mgr jerr;
-    cinfo.err = jpeg_std_error(&jerr);
-    cinfo.client_data = &proto;
-    jpeg_create_compress(&cinfo);
-    jpeg_net_dest(&cinfo);
-    cinfo.image_width = w;
-    cinfo.image_height = h;
-    cinfo.input_components = 3;
-    cinfo.in_color_space = JCS_RGB;
-    jpeg_set_defaults(&cinfo);
-    //jpeg_set_quality(&cinfo, 85, TRUE);
-    dbg_printf("Starting to compress...\n");
-    jpeg_start_compress(&cinfo, TRUE);
-    if(!envelope.empty()) {
-        jpeg_write_marker(&cinfo, JPEG_COM, reinterpret_cast<const JOCTET*>(envelope.c_str()), envelope.length() + 1);
-        envelope.clear();
-    }
-    dbg_printf("Done compressing (height %d)\n", cinfo.image_height);
-    while (cinfo.next_scanline < cinfo.image_height) {
-        dbg_printf("Writing row %d...\n", cinfo.next_scanline);
-        row_pointer[0] = data + cinfo.next_scanline * row_stride;
-        jpeg_write_scanlines(&cinfo, row_pointer, 1);
-    }
-    jpeg_finish_compress(&cinfo);
-    jpeg_destroy_compress(&cinfo);
+    if (compression==nullptr) {
+        configureCompression(proto);
+    }
+
+    // Compress the image unless another connection of the port already did
+    std::shared_ptr<std::vector<unsigned char> > jpeg;
+    {
+        LockGuard guard(shared->mutex);
+        if (!shared->matches(*img,envelope)) {
+            // keep the buffer unless a connection is still sending it
+            if (!shared->jpeg || shared->jpeg.use_count()>1) {
+                shared->jpeg = std::make_shared<std::vector<unsigned char> >();
+            }
+            dbg_printf("Starting to compress...\n");
+            if (!compression->compress(*img,envelope,*shared->jpeg)) {
+                shared->valid = false;
+                return false;
+            }
+            if (shared.use_count()>1) {
+                shared->store(*img,envelope);
+            } else {
+                // no other connection, no need to keep the image
+                shared->valid = false;
+            }
+        }
+        jpeg = shared->jpeg;
+    }
+    envelope.clear();
 
+    send_net_data(jpeg->data(),jpeg->size(),&proto);
     return true;
 }
 
@@ -190,10 +238,51 @@ bool MjpegCarrier::reply(ConnectionState& proto, SizedWriter& writer) {
 }
 
 
+bool MjpegCarrier::expectExtraHeader(ConnectionState& proto) {
+    // The rest of the request line, as in "tion=stream&quality=90 HTTP/1.1"
+    ConstString txt = proto.is().readLine();
+    size_t end = txt.find(' ');
+    ConstString query = txt.substr(0,end);
+    size_t at = 0;
+    while (at<query.length()) {
+        size_t next = query.find('&',at);
+        if (next==ConstString::npos) {
+            next = query.length();
+        }
+        ConstString param = query.substr(at,next-at);
+        size_t eq = param.find('=');
+        if (eq!=ConstString::npos) {
+            ConstString key = param.substr(0,eq);
+            ConstString value = param.substr(eq+1);
+            if (key=="quality") {
+                quality = value;
+            } else if (key=="subsampling") {
+                subsampling = value;
+            } else if (key=="bands") {
+                bands = value;
+            }
+        }
+        at = next+1;
+    }
+    while (txt!="") {
+        txt = proto.is().readLine();
+    }
+    return true;
+}
+
 bool MjpegCarrier::sendHeader(ConnectionState& proto) {
     Name n(proto.getRoute().getCarrierName() + "://test");
     ConstString pathValue = n.getCarrierModifier("path");
-    ConstString target = "GET /?action=stream\n\n";
+    ConstString target = "GET /?action=stream";
+    // pass on the compression parameters to the sender
+    const char *params[] = { "quality", "subsampling", "bands" };
+    for (size_t i=0; i<sizeof(params)/sizeof(params[0]); i++) {
+        ConstString value = n.getCarrierModifier(params[i]);
+        if (value!="") {
+            target += ConstString("&") + params[i] + "=" + value;
+        }
+    }
+    target += "\n\n";
     if (pathValue!="") {
         target = "GET /";
         target += pathValue;
@@ -11,8 +11,10 @@
 #include <yarp/os/Carrier.h>
 #include <yarp/os/NetType.h>
 #include "MjpegStream.h"
+#include "MjpegCompression.h"
 
 #include <cstring>
+#include <memory>
 
 namespace yarp {
     namespace os {
@@ -21,6 +23,8 @@ namespace yarp {
     }
 }
 
+class MjpegSharedFrame;
+
 /**
  *
  * A carrier for sending/receiving images via mjpeg over http.
@@ -38,18 +42,38 @@ namespace yarp {
  * You can also view yarp image ports from a browser.  Do a "yarp name query /portname" to find their port number NNN, then go to:
  *   http://localhost:NNN/?output=stream
  *
+ * The compression can be tuned with carrier parameters, as in
+ * mjpeg+quality.90+subsampling.444+bands.4, or in the query of the url,
+ * as in http://localhost:NNN/?action=stream&quality=90&bands=4 :
+ *  - quality: jpeg quality, from 1 to 100 (default 75)
+ *  - subsampling: chroma subsampling, 444, 422 or 420 (default 420)
+ *  - bands: number of horizontal bands compressed in parallel (default 1)
+ * The mjpeg connections of a port with the same parameters compress each
+ * image once, and share the result.
+ *
  */
 class yarp::os::MjpegCarrier : public Carrier {
 private:
     bool firstRound;
     bool sender;
     yarp::os::ConstString envelope;
+    // compression parameters, as given in the request
+    yarp::os::ConstString quality;
+    yarp::os::ConstString subsampling;
+    yarp::os::ConstString bands;
+    yarp::mjpeg::MjpegCompression *compression;
+    std::shared_ptr<MjpegSharedFrame> shared;
+
+    void configureCompression(ConnectionState& proto);
 public:
     MjpegCarrier() {
         firstRound = true;
         sender = false;
+        compression = nullptr;
     }
 
+    virtual ~MjpegCarrier();
+
     virtual Carrier *create() override {
         return new MjpegCarrier();
     }
@@ -143,13 +167,7 @@ public:
         return true;
     }
 
-    virtual bool expectExtraHeader(ConnectionState& proto) override {
-        ConstString txt;
-        do {
-            txt = proto.is().readLine();
-        } while (txt!="");
-        return true;
-    }
+    virtual bool expectExtraHeader(ConnectionState& proto) override;
 
     bool respondToHeader(ConnectionState& proto) override {
         ConstString target = "HTTP/1.0 200 OK\r\n\
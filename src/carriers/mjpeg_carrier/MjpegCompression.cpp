@@ -0,0 +1,442 @@
+/*
+ * Copyright (C) 2018 Istituto Italiano di Tecnologia (IIT)
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ *
+ */
+
+#include "MjpegCompression.h"
+
+#include <yarp/os/Log.h>
+#include <yarp/os/Semaphore.h>
+#include <yarp/os/Thread.h>
+#include <yarp/sig/Image.h>
+
+#include <csetjmp>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_WIN32)
+#define INT32 long  // jpeg's definition
+#define QGLOBAL_H 1
+#endif
+
+#ifdef _MSC_VER
+#pragma warning (push)
+#pragma warning (disable : 4091)
+#endif
+
+extern "C" {
+#include <jpeglib.h>
+}
+
+#ifdef _MSC_VER
+#pragma warning (pop)
+#endif
+
+#if defined(_WIN32)
+#undef INT32
+#undef QGLOBAL_H
+#endif
+
+
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace yarp::mjpeg;
+
+namespace {
+
+// Initial size of the output buffer, it grows as needed and is kept
+// for the next frames
+const size_t MIN_JPEG_BUFFER = 65536;
+
+struct compress_error_mgr {
+    struct jpeg_error_mgr pub;
+    jmp_buf setjmp_buffer;
+};
+
+void compress_error_exit(j_common_ptr cinfo) {
+    compress_error_mgr *err = (compress_error_mgr *) cinfo->err;
+    (*cinfo->err->output_message) (cinfo);
+    longjmp(err->setjmp_buffer, 1);
+}
+
+// Destination writing the jpeg in a growing memory buffer
+struct mem_destination_mgr {
+    struct jpeg_destination_mgr pub;
+    std::vector<unsigned char> *data;
+};
+
+void init_mem_destination(j_compress_ptr cinfo) {
+    mem_destination_mgr *dest = (mem_destination_mgr *) cinfo->dest;
+    std::vector<unsigned char>& data = *dest->data;
+    size_t len = data.capacity();
+    if (len < MIN_JPEG_BUFFER) {
+        len = MIN_JPEG_BUFFER;
+    }
+    data.resize(len);
+    dest->pub.next_output_byte = (JOCTET *) data.data();
+    dest->pub.free_in_buffer = data.size();
+}
+
+boolean empty_mem_output_buffer(j_compress_ptr cinfo) {
+    // called when the whole buffer is full
+    mem_destination_mgr *dest = (mem_destination_mgr *) cinfo->dest;
+    std::vector<unsigned char>& data = *dest->data;
+    size_t used = data.size();
+    data.resize(used * 2);
+    dest->pub.next_output_byte = (JOCTET *) data.data() + used;
+    dest->pub.free_in_buffer = data.size() - used;
+    return TRUE;
+}
+
+void term_mem_destination(j_compress_ptr cinfo) {
+    mem_destination_mgr *dest = (mem_destination_mgr *) cinfo->dest;
+    dest->data->resize(dest->data->size() - dest->pub.free_in_buffer);
+}
+
+struct CompressionSettings {
+    int components;
+    J_COLOR_SPACE color_space;
+    int quality;
+    MjpegCompression::Subsampling subsampling;
+};
+
+// A libjpeg compressor, created once and reused for each frame
+class MjpegEncoder {
+public:
+    struct jpeg_compress_struct cinfo;
+    struct compress_error_mgr jerr;
+    struct mem_destination_mgr dest;
+    std::vector<JSAMPROW> rows;
+
+    MjpegEncoder() {
+        memset(&cinfo, 0, sizeof(cinfo));
+        memset(&jerr, 0, sizeof(jerr));
+        cinfo.err = jpeg_std_error(&jerr.pub);
+        jerr.pub.error_exit = compress_error_exit;
+        jpeg_create_compress(&cinfo);
+        dest.pub.init_destination = init_mem_destination;
+        dest.pub.empty_output_buffer = empty_mem_output_buffer;
+        dest.pub.term_destination = term_mem_destination;
+        dest.data = nullptr;
+        cinfo.dest = &dest.pub;
+    }
+
+    ~MjpegEncoder() {
+        jpeg_destroy_compress(&cinfo);
+    }
+
+    bool encode(const CompressionSettings& settings,
+                const unsigned char *pixels, size_t row_stride,
+                int width, int height,
+                const ConstString& comment,
+                std::vector<unsigned char>& data) {
+        rows.resize(height);
+        for (int i=0; i<height; i++) {
+            rows[i] = (JSAMPROW) (pixels + i*row_stride);
+        }
+        dest.data = &data;
+
+        if (setjmp(jerr.setjmp_buffer)) {
+            jpeg_abort_compress(&cinfo);
+            return false;
+        }
+        cinfo.image_width = width;
+        cinfo.image_height = height;
+        cinfo.input_components = settings.components;
+        cinfo.in_color_space = settings.color_space;
+        jpeg_set_defaults(&cinfo);
+        jpeg_set_quality(&cinfo, settings.quality, TRUE);
+        if (settings.components == 3) {
+            // the chroma components stay at 1x1
+            cinfo.comp_info[0].h_samp_factor =
+                (settings.subsampling == MjpegCompression::SUBSAMPLING_444) ? 1 : 2;
+            cinfo.comp_info[0].v_samp_factor =
+                (settings.subsampling == MjpegCompression::SUBSAMPLING_420) ? 2 : 1;
+        }
+        jpeg_start_compress(&cinfo, TRUE);
+        if (!comment.empty()) {
+            jpeg_write_marker(&cinfo, JPEG_COM, reinterpret_cast<const JOCTET*>(comment.c_str()), comment.length() + 1);
+        }
+        while (cinfo.next_scanline < cinfo.image_height) {
+            jpeg_write_scanlines(&cinfo, &rows[cinfo.next_scanline],
+                                 cinfo.image_height - cinfo.next_scanline);
+        }
+        jpeg_finish_compress(&cinfo);
+        return true;
+    }
+};
+
+// Compresses a band of the image in its own thread
+class MjpegBandWorker : public Thread {
+public:
+    MjpegEncoder encoder;
+    std::vector<unsigned char> data;
+    Semaphore startSema;
+    Semaphore doneSema;
+    const CompressionSettings *settings;
+    const unsigned char *pixels;
+    size_t row_stride;
+    int width;
+    int height;
+    bool ok;
+
+    MjpegBandWorker() :
+        startSema(0),
+        doneSema(0),
+        settings(nullptr),
+        pixels(nullptr),
+        row_stride(0),
+        width(0),
+        height(0),
+        ok(false)
+    {}
+
+    void post(const CompressionSettings& settings,
+              const unsigned char *pixels, size_t row_stride,
+              int width, int height) {
+        this->settings = &settings;
+        this->pixels = pixels;
+        this->row_stride = row_stride;
+        this->width = width;
+        this->height = height;
+        startSema.post();
+    }
+
+    bool wait() {
+        doneSema.wait();
+        return ok;
+    }
+
+    virtual void run() override {
+        while (true) {
+            startSema.wait();
+            if (isStopping()) {
+                break;
+            }
+            ok = encoder.encode(*settings, pixels, row_stride, width, height,
+                                "", data);
+            doneSema.post();
+        }
+    }
+
+    virtual void onStop() override {
+        startSema.post();
+    }
+};
+
+// Finds the SOF segment and the start of the scan data of a jpeg
+// produced by MjpegEncoder
+bool findScan(const std::vector<unsigned char>& jpeg,
+              size_t& sof, size_t& sos, size_t& scan) {
+    size_t at = 2;
+    sof = 0;
+    while (at+4 <= jpeg.size() && jpeg[at] == 0xFF) {
+        int marker = jpeg[at+1];
+        size_t len = (jpeg[at+2] << 8) | jpeg[at+3];
+        if (marker >= 0xC0 && marker <= 0xC2) {
+            sof = at;
+        }
+        if (marker == 0xDA) {
+            sos = at;
+            scan = at + 2 + len;
+            return sof != 0 && scan+2 <= jpeg.size() &&
+                jpeg[jpeg.size()-2] == 0xFF && jpeg[jpeg.size()-1] == 0xD9;
+        }
+        at += 2 + len;
+    }
+    return false;
+}
+
+void appendMarker(std::vector<unsigned char>& data, int marker) {
+    data.push_back(0xFF);
+    data.push_back((unsigned char) marker);
+}
+
+void appendShort(std::vector<unsigned char>& data, size_t x) {
+    data.push_back((unsigned char) ((x >> 8) & 0xFF));
+    data.push_back((unsigned char) (x & 0xFF));
+}
+
+} // namespace
+
+
+class MjpegCompressionHelper {
+public:
+    CompressionSettings settings;
+    int bands;
+    MjpegEncoder encoder;
+    std::vector<unsigned char> first;
+    std::vector<MjpegBandWorker*> workers;
+
+    MjpegCompressionHelper() : bands(1) {
+        settings.components = 3;
+        settings.color_space = JCS_RGB;
+        settings.quality = 75;
+        settings.subsampling = MjpegCompression::SUBSAMPLING_420;
+    }
+
+    ~MjpegCompressionHelper() {
+        for (size_t i=0; i<workers.size(); i++) {
+            workers[i]->stop();
+            delete workers[i];
+        }
+        workers.clear();
+    }
+
+    bool compress(const Image& img, const ConstString& comment,
+                  std::vector<unsigned char>& data) {
+        switch (img.getPixelCode()) {
+        case VOCAB_PIXEL_MONO:
+            settings.components = 1;
+            settings.color_space = JCS_GRAYSCALE;
+            break;
+#ifdef JCS_EXTENSIONS
+        case VOCAB_PIXEL_BGR:
+            settings.components = 3;
+            settings.color_space = JCS_EXT_BGR;
+            break;
+#endif
+        default:
+            // as rgb, as done so far
+            if (img.getPixelSize() != 3) {
+                return false;
+            }
+            settings.components = 3;
+            settings.color_space = JCS_RGB;
+            break;
+        }
+        int w = img.width();
+        int h = img.height();
+        size_t row_stride = img.getRowSize();
+        const unsigned char *pixels = img.getRawImage();
+
+        // Size of the blocks of pixels (MCU) encoded together
+        int mcu_w = 8;
+        int mcu_h = 8;
+        if (settings.components == 3) {
+            if (settings.subsampling != MjpegCompression::SUBSAMPLING_444) {
+                mcu_w = 16;
+            }
+            if (settings.subsampling == MjpegCompression::SUBSAMPLING_420) {
+                mcu_h = 16;
+            }
+        }
+        int band_rows = (h + bands - 1) / bands;
+        band_rows = ((band_rows + mcu_h - 1) / mcu_h) * mcu_h;
+        int n = (band_rows > 0) ? (h + band_rows - 1) / band_rows : 0;
+        size_t interval = (size_t) ((w + mcu_w - 1) / mcu_w) * (band_rows / mcu_h);
+        if (n <= 1 || interval > 65535 || comment.length() + 3 > 65535) {
+            return encoder.encode(settings, pixels, row_stride, w, h, comment, data);
+        }
+
+        while ((int) workers.size() < n-1) {
+            MjpegBandWorker *worker = new MjpegBandWorker;
+            yAssert(worker != nullptr);
+            worker->start();
+            workers.push_back(worker);
+        }
+        for (int i=1; i<n; i++) {
+            int rows = h - i*band_rows;
+            if (rows > band_rows) {
+                rows = band_rows;
+            }
+            workers[i-1]->post(settings, pixels + i*band_rows*row_stride,
+                               row_stride, w, rows);
+        }
+        bool ok = encoder.encode(settings, pixels, row_stride, w, band_rows, "", first);
+        for (int i=1; i<n; i++) {
+            ok = workers[i-1]->wait() && ok;
+        }
+        if (!ok) {
+            return false;
+        }
+
+        // The bands share the tables, and the DC prediction of the
+        // encoder starts from zero as after a restart marker: the headers
+        // of the first band, with the full height and a restart interval
+        // of one band, are followed by the scan data of all the bands,
+        // separated by restart markers
+        size_t sof, sos, scan;
+        if (!findScan(first, sof, sos, scan)) {
+            return false;
+        }
+        data.clear();
+        data.insert(data.end(), first.begin(), first.begin() + sos);
+        data[sof+5] = (unsigned char) ((h >> 8) & 0xFF);
+        data[sof+6] = (unsigned char) (h & 0xFF);
+        if (!comment.empty()) {
+            appendMarker(data, JPEG_COM);
+            appendShort(data, comment.length() + 3);
+            data.insert(data.end(), comment.c_str(), comment.c_str() + comment.length() + 1);
+        }
+        appendMarker(data, 0xDD);   // DRI
+        appendShort(data, 4);
+        appendShort(data, interval);
+        data.insert(data.end(), first.begin() + sos, first.end() - 2);
+        for (int i=1; i<n; i++) {
+            const std::vector<unsigned char>& band = workers[i-1]->data;
+            size_t band_sof, band_sos, band_scan;
+            if (!findScan(band, band_sof, band_sos, band_scan)) {
+                return false;
+            }
+            appendMarker(data, JPEG_RST0 + ((i-1) & 7));
+            data.insert(data.end(), band.begin() + band_scan, band.end() - 2);
+        }
+        appendMarker(data, JPEG_EOI);
+        return true;
+    }
+};
+
+#define HELPER(x) (*((MjpegCompressionHelper*)(x)))
+
+MjpegCompression::MjpegCompression() {
+    system_resource = new MjpegCompressionHelper;
+    yAssert(system_resource!=nullptr);
+}
+
+MjpegCompression::~MjpegCompression() {
+    if (system_resource!=nullptr) {
+        delete &HELPER(system_resource);
+        system_resource = nullptr;
+    }
+}
+
+void MjpegCompression::setQuality(int quality) {
+    if (quality < 1) {
+        quality = 1;
+    }
+    if (quality > 100) {
+        quality = 100;
+    }
+    HELPER(system_resource).settings.quality = quality;
+}
+
+void MjpegCompression::setSubsampling(Subsampling subsampling) {
+    HELPER(system_resource).settings.subsampling = subsampling;
+}
+
+void MjpegCompression::setBands(int bands) {
+    HELPER(system_resource).bands = (bands > 1) ? bands : 1;
+}
+
+bool MjpegCompression::compress(const Image& image,
+                                const ConstString& comment,
+                                std::vector<unsigned char>& data) {
+    MjpegCompressionHelper& helper = HELPER(system_resource);
+    return helper.compress(image, comment, data);
+}
+
+bool MjpegCompression::parseSubsampling(const ConstString& txt,
+                                        Subsampling& subsampling) {
+    if (txt == "444") {
+        subsampling = SUBSAMPLING_444;
+    } else if (txt == "422") {
+        subsampling = SUBSAMPLING_422;
+    } else if (txt == "420") {
+        subsampling = SUBSAMPLING_420;
+    } else {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2018 Istituto Italiano di Tecnologia (IIT)
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ *
+ */
+
+#ifndef YARP2_MJPEGCOMPRESSION_INC
+#define YARP2_MJPEGCOMPRESSION_INC
+
+#include <yarp/os/ConstString.h>
+#include <yarp/sig/Image.h>
+
+#include <vector>
+
+namespace yarp {
+    namespace mjpeg {
+        class MjpegCompression;
+    }
+}
+
+/**
+ * A jpeg compressor kept across frames, so that the libjpeg state and the
+ * output buffer are set up once per connection.
+ *
+ * Large images can be split in horizontal bands compressed in parallel.
+ * The bands are joined in a single jpeg, with a restart marker at the
+ * start of each band, that any decoder reads as usual.
+ */
+class yarp::mjpeg::MjpegCompression {
+private:
+    void *system_resource;
+public:
+    enum Subsampling {
+        SUBSAMPLING_444,
+        SUBSAMPLING_422,
+        SUBSAMPLING_420
+    };
+
+    MjpegCompression();
+
+    virtual ~MjpegCompression();
+
+    /**
+     * @param quality jpeg quality, from 1 to 100 (libjpeg default is 75)
+     */
+    void setQuality(int quality);
+
+    /**
+     * @param subsampling chroma subsampling of color images (default 4:2:0)
+     */
+    void setSubsampling(Subsampling subsampling);
+
+    /**
+     * @param bands maximum number of bands compressed in parallel
+     * (default 1, no parallel compression)
+     */
+    void setBands(int bands);
+
+    /**
+     * Compress an rgb, bgr or mono image.
+     * @param image the image
+     * @param comment if not empty, added to the jpeg as a COM marker
+     * @param data filled with the jpeg
+     * @return false if the image cannot be compressed
+     */
+    bool compress(const yarp::sig::Image& image,
+                  const yarp::os::ConstString& comment,
+                  std::vector<unsigned char>& data);
+
+    /**
+     * Parse a subsampling mode: "444", "422" or "420".
+     * @return false if the mode is not known
+     */
+    static bool parseSubsampling(const yarp::os::ConstString& txt,
+                                 Subsampling& subsampling);
+};
+
+#endif
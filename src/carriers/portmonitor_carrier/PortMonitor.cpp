@@ -11,6 +11,8 @@
 
 #include "PortMonitor.h"
 
+#include <algorithm>
+
 
 
 using namespace yarp::os;
@@ -41,60 +43,121 @@ bool PortMonitor::configure(yarp::os::ConnectionState& proto)
 }
 
 bool PortMonitor::configureFromProperty(yarp::os::Property& options) {
-    if(binder) delete binder;
-    binder = nullptr;
+    clearBinders();
 
     ConstString script = options.check("type", Value("lua")).asString();
-    ConstString filename = options.check("file", Value("modifier")).asString();
     ConstString constraint = options.check("constraint", Value("")).asString();
     // context is used to find the script files
     ConstString context = options.check("context", Value("")).asString();
+    bool async = options.check("async", Value(0)).asInt() != 0;
+
+    // several monitors can be chained by listing their files separated
+    // by colons (e.g. "file.first:second"); each one is loaded into its
+    // own binder.
+    std::vector<ConstString> files;
+    ConstString filenames = options.check("file", Value("modifier")).asString();
+    size_t start = 0;
+    while (start <= filenames.length()) {
+        size_t end = filenames.find(':', start);
+        if (end == ConstString::npos) {
+            end = filenames.length();
+        }
+        if (end > start) {
+            files.push_back(filenames.substr(start, end - start));
+        }
+        start = end + 1;
+    }
+    if (files.empty()) {
+        yError("No monitor file was given to portmonitor");
+        return false;
+    }
 
-    // check which monitor should be used
-    if((binder = MonitorBinding::create(script.c_str())) == nullptr)
+    PortMonitor::lock();
+    bReady = true;
+    for (size_t i=0; i<files.size() && bReady; i++)
     {
-         yError("Currently only \'lua\' script and \'dll\' object is supported by portmonitor");
-         return false;
-    }
+        MonitorBinding* stage;
+        // check which monitor should be used
+        if((stage = MonitorBinding::create(script.c_str())) == nullptr)
+        {
+             yError("Currently only \'lua\' script and \'dll\' object is supported by portmonitor");
+             bReady = false;
+             break;
+        }
+        chain.push_back(stage);
 
-    // set the acceptance constraint
-    binder->setAcceptConstraint(constraint.c_str());
+        // set the acceptance constraint
+        if (i == 0) {
+            stage->setAcceptConstraint(constraint.c_str());
+        }
 
-    ConstString strFile = filename;
+        ConstString filename = files[i];
+        ConstString strFile = filename;
 
-    if(script != "dll")
-    {
-        yarp::os::ResourceFinder rf;
-        rf.setDefaultContext(context.c_str());
-        rf.configure(0, nullptr);
-        strFile = rf.findFile(filename.c_str());
-        if(strFile == "")
-            strFile = rf.findFile(filename+".lua");
-    }
-
-    // provide some useful information for the monitor object
-    // which can be accessed in the create() callback.
-    Property info;
-    info.clear();
-    info.put("filename", strFile);
-    info.put("type", script);
-    info.put("source", options.find("source").asString());
-    info.put("destination", options.find("destination").asString());
-    info.put("sender_side",  options.find("sender_side").asInt());
-    info.put("receiver_side",options.find("receiver_side").asInt());
-    info.put("carrier", options.find("carrier").asString());
+        if(script != "dll")
+        {
+            yarp::os::ResourceFinder rf;
+            rf.setDefaultContext(context.c_str());
+            rf.configure(0, nullptr);
+            strFile = rf.findFile(filename.c_str());
+            if(strFile == "")
+                strFile = rf.findFile(filename+".lua");
+        }
 
-    PortMonitor::lock();
-    bReady =  binder->load(info);
+        // provide some useful information for the monitor object
+        // which can be accessed in the create() callback.
+        // Other connection options (e.g., +colormap.jet) are passed
+        // through, so that monitors can be configured at creation.
+        Property info;
+        info.fromString(options.toString());
+        info.put("filename", strFile);
+        info.put("type", script);
+        info.put("source", options.find("source").asString());
+        info.put("destination", options.find("destination").asString());
+        info.put("sender_side",  options.find("sender_side").asInt());
+        info.put("receiver_side",options.find("receiver_side").asInt());
+        info.put("carrier", options.find("carrier").asString());
+
+        bReady = stage->load(info);
+    }
+    binder = chain.empty() ? nullptr : chain[0];
     PortMonitor::unlock();
+
+    if (bReady && async) {
+        worker = new PortMonitorWorker(*this);
+        if (!worker->start()) {
+            delete worker;
+            worker = nullptr;
+            bReady = false;
+        }
+    }
     return bReady;
 }
 
+void PortMonitor::clearBinders()
+{
+    // the worker uses the binders, so it must go first
+    if (worker) {
+        worker->stop();
+        delete worker;
+        worker = nullptr;
+    }
+    bReady = false;
+    for (size_t i=0; i<chain.size(); i++) {
+        delete chain[i];
+    }
+    chain.clear();
+    binder = nullptr;
+    pending = nullptr;
+}
+
 void PortMonitor::setCarrierParams(const yarp::os::Property& params)
 {
     if(!bReady) return;
     PortMonitor::lock();
-    binder->setParams(params);
+    for (size_t i=0; i<chain.size(); i++) {
+        chain[i]->setParams(params);
+    }
     PortMonitor::unlock();
 }
 
@@ -102,31 +165,66 @@ void PortMonitor::getCarrierParams(yarp::os::Property& params)
 {
     if(!bReady) return;
     PortMonitor::lock();
-    binder->getParams(params);
+    for (size_t i=0; i<chain.size(); i++) {
+        chain[i]->getParams(params);
+    }
     PortMonitor::unlock();
 }
 
+yarp::os::Things* PortMonitor::processChain(yarp::os::Things& thing)
+{
+    // Each stage gets the Things returned by the previous one, so
+    // typed objects travel along the chain without being serialized.
+    yarp::os::Things* current = &thing;
+    for (size_t i=0; i<chain.size(); i++) {
+        if (chain[i]->hasAccept() && !chain[i]->acceptData(*current)) {
+            return nullptr;
+        }
+        if (chain[i]->hasUpdate()) {
+            current = &chain[i]->updateData(*current);
+        }
+    }
+    return current;
+}
+
 
 yarp::os::ConnectionReader& PortMonitor::modifyIncomingData(yarp::os::ConnectionReader& reader)
 {
     if(!bReady) return reader;
 
+    if (worker) {
+        // acceptIncomingData() has already collected a result in localReader
+        localReader->setParentConnectionReader(&reader);
+        return *localReader;
+    }
+
     // When we are here,
-    // the incoming data should be accessed using localReader.
+    // the incoming data should be accessed using localReader
+    // or, if it has already been deserialized, through pending.
     // The reader passed to this function is infact empty.
-    // first check if we need to call the update callback
-    if(!binder->hasUpdate()) {
+    yarp::os::Things* result = pending;
+    pending = nullptr;
+    if (result == nullptr) {
+        // a single monitor: accept has run, update is still to be done
+        if(!binder->hasUpdate()) {
+            localReader->setParentConnectionReader(&reader);
+            return *localReader;
+        }
+        PortMonitor::lock();
+        result = &binder->updateData(inThing);
+        PortMonitor::unlock();
+    }
+
+    // Untouched data can be delivered straight from the original reader
+    if (result == &inThing && !inThing.hasBeenRead()) {
         localReader->setParentConnectionReader(&reader);
         return *localReader;
     }
 
-    PortMonitor::lock();
-    yarp::os::Things thing;
-    thing.setConnectionReader(*localReader);
-    yarp::os::Things& result = binder->updateData(thing);
-    PortMonitor::unlock();
+    // The result is serialized once; the reader of the dummy connection
+    // reads directly from the written blocks.
     con.reset();
-    if(result.write(con.getWriter())) {
+    if(result->write(con.getWriter())) {
         con.getReader().setParentConnectionReader(&reader);
         return con.getReader();
     }
@@ -139,29 +237,45 @@ bool PortMonitor::acceptIncomingData(yarp::os::ConnectionReader& reader)
 
     bool result = false;
     localReader = &reader;
-    // If no accept callback avoid calling the binder
-    if(binder->hasAccept())
-    {
+    pending = nullptr;
+
+    if (worker) {
+        // hand over the data to the worker and deliver the latest
+        // result it has produced, if any.
+        if (!worker->submit(reader)) {
+            return false;
+        }
+        localReader = worker->collect();
+        if (localReader == nullptr) {
+            return false;
+        }
+    } else if (chain.size() > 1) {
+        // With a chain of monitors the acceptance of later stages
+        // depends on the output of the former ones, so the whole chain
+        // is run here and modifyIncomingData() only delivers the result.
+        PortMonitor::lock();
+        inThing.setConnectionReader(reader);
+        pending = processChain(inThing);
+        PortMonitor::unlock();
+        if (pending == nullptr) {
+            return false;
+        }
+    } else if(binder->hasAccept()) {
+        // If no accept callback avoid calling the binder
         PortMonitor::lock();
-        Things thing;
         // set the reference connection reader
-        thing.setConnectionReader(reader);
-        result = binder->acceptData(thing);
+        inThing.setConnectionReader(reader);
+        result = binder->acceptData(inThing);
         PortMonitor::unlock();
         if(!result)
             return false;
 
         // When data is read here using the reader passed to this functions,
-        // then it wont be available for modifyIncomingData(). Thus, we write
-        // it to a dumy connection and pass it to the modifyOutgoingData() using
-        // localReader.
-        // localReader points to a connection reader which contains
-        // either the original or modified data.
-        if(thing.hasBeenRead()) {
-            con.reset();
-            if(thing.write(con.getWriter()))
-                localReader = &con.getReader();
-        }
+        // then it wont be available from the reader any more. The already
+        // deserialized thing is kept and given to the update callback in
+        // modifyIncomingData(), with no need of serializing it again.
+    } else {
+        inThing.setConnectionReader(reader);
     }
 
     if(group!=nullptr) {
@@ -221,6 +335,121 @@ yarp::os::PortReader& PortMonitor::modifyReply(yarp::os::PortReader& reader) {
     return *result.getPortReader();
 }
 
+/**
+ * Class PortMonitorWorker
+ */
+
+PortMonitorWorker::PortMonitorWorker(PortMonitor& owner) :
+        owner(owner),
+        mutex(1),
+        wake(0),
+        staging(&messages[0]),
+        pending(&messages[1]),
+        work(&messages[2]),
+        hasPending(false),
+        hasResult(false),
+        front(&results[0]),
+        ready(&results[1]),
+        back(&results[2])
+{
+}
+
+bool PortMonitorWorker::submit(yarp::os::ConnectionReader& reader)
+{
+    if (reader.isTextMode()) {
+        yError("portmonitor: asynchronous mode supports only binary connections");
+        return false;
+    }
+    // the reader is only valid during this call, thus the raw message
+    // is copied once to be processed later by the worker.
+    size_t len = reader.getSize();
+    if (staging->length() < len) {
+        staging->allocate(len);
+    }
+    if (len > 0 && !reader.expectBlock(staging->get(), len)) {
+        return false;
+    }
+    staging->setUsed(len);
+    mutex.wait();
+    std::swap(staging, pending);
+    bool wasPending = hasPending;
+    hasPending = true;
+    mutex.post();
+    if (!wasPending) {
+        wake.post();
+    }
+    return true;
+}
+
+yarp::os::ConnectionReader* PortMonitorWorker::collect()
+{
+    mutex.wait();
+    bool got = hasResult;
+    if (got) {
+        std::swap(front, ready);
+        hasResult = false;
+    }
+    mutex.post();
+    if (!got) {
+        return nullptr;
+    }
+    delivered.reset();
+    delivered.getWriter().appendExternalBlock(front->get(), front->used());
+    return &delivered.getReader();
+}
+
+void PortMonitorWorker::run()
+{
+    while (!isStopping()) {
+        wake.wait();
+        if (isStopping()) {
+            break;
+        }
+        mutex.wait();
+        if (!hasPending) {
+            mutex.post();
+            continue;
+        }
+        std::swap(pending, work);
+        hasPending = false;
+        mutex.post();
+
+        input.reset();
+        input.getWriter().appendExternalBlock(work->get(), work->used());
+        thing.setConnectionReader(input.getReader());
+
+        owner.lock();
+        yarp::os::Things* result = owner.processChain(thing);
+        bool ok = false;
+        if (result != nullptr) {
+            output.reset();
+            ok = result->write(output.getWriter());
+            if (ok) {
+                yarp::os::ConnectionReader& reader = output.getReader();
+                size_t len = reader.getSize();
+                if (back->length() < len) {
+                    back->allocate(len);
+                }
+                ok = len == 0 || reader.expectBlock(back->get(), len);
+                back->setUsed(len);
+            }
+        }
+        owner.unlock();
+
+        if (ok) {
+            mutex.wait();
+            std::swap(back, ready);
+            hasResult = true;
+            mutex.post();
+        }
+    }
+}
+
+void PortMonitorWorker::onStop()
+{
+    wake.post();
+}
+
 /**
  * Class PortMonitorGroup
  */
@@ -12,9 +12,13 @@
 #include <yarp/os/DummyConnector.h>
 #include <yarp/os/Election.h>
 #include <yarp/os/NullConnectionReader.h>
+#include <yarp/os/ManagedBytes.h>
 #include <yarp/os/Semaphore.h>
+#include <yarp/os/Thread.h>
 #include <yarp/os/Things.h>
 
+#include <vector>
+
 #include "MonitorBinding.h"
 #include "MonitorEvent.h"
 
@@ -22,6 +26,7 @@ namespace yarp {
     namespace os {
         class PortMonitor;
         class PortMonitorGroup;
+        class PortMonitorWorker;
     }
 }
 
@@ -39,6 +44,59 @@ public:
 
 
 
+/**
+ *
+ * Worker thread used by an asynchronous PortMonitor: it runs the monitor
+ * chain on the most recent input and publishes the serialized result
+ * through a triple buffer, so that a slow monitor never stalls the input
+ * unit of the port.  Inputs arriving while the worker is busy replace
+ * the pending one (latest wins).
+ *
+ */
+class yarp::os::PortMonitorWorker : public yarp::os::Thread {
+public:
+    PortMonitorWorker(PortMonitor& owner);
+
+    /**
+     * Copy the incoming message and hand it over to the worker.
+     * Called from the input thread.
+     */
+    bool submit(yarp::os::ConnectionReader& reader);
+
+    /**
+     * Take the latest completed result, if any.  The returned reader
+     * stays valid until the next call to collect().
+     * Called from the input thread.
+     */
+    yarp::os::ConnectionReader* collect();
+
+    virtual void run() override;
+    virtual void onStop() override;
+
+private:
+    PortMonitor& owner;
+    yarp::os::Semaphore mutex;
+    yarp::os::Semaphore wake;
+    yarp::os::ManagedBytes messages[3];
+    yarp::os::ManagedBytes* staging;
+    yarp::os::ManagedBytes* pending;
+    yarp::os::ManagedBytes* work;
+    bool hasPending;
+    bool hasResult;
+    yarp::os::DummyConnector input;
+    // the result is serialized here, and then copied in a slot: images
+    // and blobs are written as references to the objects of the monitor,
+    // which are overwritten by the next message
+    yarp::os::DummyConnector output;
+    yarp::os::ManagedBytes results[3];
+    yarp::os::ManagedBytes* front;
+    yarp::os::ManagedBytes* ready;
+    yarp::os::ManagedBytes* back;
+    yarp::os::DummyConnector delivered;
+    yarp::os::Things thing;
+};
+
+
 /**
  *
  * Allow to monitor and modify port data from Lua script  Under development.
@@ -46,6 +104,16 @@ public:
  *
  * Examples: tcp+recv.portmonitor+type.lua+file.my_lua_script_file
  *
+ * Several monitors of the same type can be chained on one connection by
+ * giving a colon separated list of files, e.g.
+ * tcp+recv.portmonitor+type.dll+file.depthimage:zfp
+ * The output of each monitor is handed to the next one as a typed object,
+ * without being serialized in between.
+ *
+ * Adding "+async.1" runs the monitor chain on a worker thread: the port
+ * receives the result of the previous message while the current one is
+ * being processed.
+ *
  */
 
 /**
@@ -64,13 +132,15 @@ public:
         binder = NULL;
         group = NULL;
         localReader = NULL;
+        pending = NULL;
+        worker = NULL;
     }
 
     virtual ~PortMonitor() {
         if (portName!="") {
             getPeers().remove(portName,this);
         }
-        if (binder) delete binder;
+        clearBinders();
     }
 
     virtual Carrier *create() override {
@@ -113,6 +183,15 @@ public:
         return binder;
     }
 
+    /**
+     * Run the accept and update callbacks of the whole monitor chain on
+     * the given thing.  The caller must hold the monitor lock.
+     *
+     * @param thing the incoming data
+     * @return the modified data, or NULL if one of the monitors rejected it
+     */
+    yarp::os::Things* processChain(yarp::os::Things& thing);
+
 public:
     ConstString portName;
     ConstString sourceName;
@@ -123,11 +202,17 @@ private:
 
 
 private:
+    void clearBinders();
+
     bool bReady;
     yarp::os::DummyConnector con;
     yarp::os::ConnectionReader* localReader;
     yarp::os::Things thing;
+    yarp::os::Things inThing;
+    yarp::os::Things* pending;
     MonitorBinding* binder;
+    std::vector<MonitorBinding*> chain;
+    PortMonitorWorker* worker;
     PortMonitorGroup *group;
     yarp::os::Semaphore mutex;
 };
@@ -14,6 +14,8 @@
 #include <yarp/os/NetInt32.h>
 #include <yarp/os/Bottle.h>
 #include <yarp/os/Port.h>
+#include <yarp/os/Mutex.h>
+#include <yarp/os/LockGuard.h>
 
 #include "WireBottle.h"
 
@@ -175,10 +177,17 @@ std::map<std::string, std::string> TcpRosStream::rosToKind() {
 
 std::string TcpRosStream::rosToKind(const char *rosname) {
     if (ConstString(rosname)=="") return "";
-    std::map<std::string, std::string> kinds = rosToKind();
 
-    if (kinds.find(rosname)!=kinds.end()) {
-        return kinds[rosname];
+    // Descriptions already known, including the ones given by the type
+    // server, shared by the connections of the process
+    static std::map<std::string, std::string> kinds = rosToKind();
+    static Mutex kindsMutex;
+    {
+        LockGuard guard(kindsMutex);
+        std::map<std::string, std::string>::const_iterator it = kinds.find(rosname);
+        if (it!=kinds.end()) {
+            return it->second;
+        }
     }
     Port port;
     port.openFake("yarpidl_rosmsg");
@@ -189,7 +198,11 @@ std::string TcpRosStream::rosToKind(const char *rosname) {
         port.write(cmd,resp);
         dbg_printf("GOT yarpidl_rosmsg %s\n", resp.toString().c_str());
         ConstString txt = resp.get(0).asString();
-        if (txt!="?") return txt;
+        if (txt!="?") {
+            LockGuard guard(kindsMutex);
+            kinds[rosname] = txt;
+            return txt;
+        }
     }
     port.close();
     if (ConstString(rosname)!="") {
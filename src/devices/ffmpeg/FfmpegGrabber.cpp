@@ -13,6 +13,7 @@
 #include "ffmpeg_api.h"
 
 #include <cstdio>
+#include <vector>
 
 #define ERROR_PROBLEM
 
@@ -73,9 +74,8 @@ public:
 
     // video buffers
     AVFrame         *pFrame;
-    AVFrame         *pFrameRGB;
     AVFrame         *pAudio;
-    uint8_t         *buffer;
+    struct SwsContext *img_convert_ctx;
     int16_t         *audioBuffer;
     int16_t         *audioBufferAt;
     int audioBufferLen;
@@ -88,9 +88,8 @@ public:
         pCodecCtx(nullptr),
         pCodec(nullptr),
         pFrame(nullptr),
-        pFrameRGB(nullptr),
         pAudio(nullptr),
-        buffer(nullptr),
+        img_convert_ctx(nullptr),
         audioBuffer(nullptr),
         audioBufferAt(nullptr),
         audioBufferLen(0)
@@ -111,11 +110,8 @@ public:
         if (audioBuffer!=nullptr) {
             delete [] audioBuffer;
         }
-        if (buffer!=nullptr) {
-            delete [] buffer;
-        }
-        if (pFrameRGB!=nullptr) {
-            av_free(pFrameRGB);
+        if (img_convert_ctx!=nullptr) {
+            sws_freeContext(img_convert_ctx);
         }
         if (pFrame!=nullptr) {
             av_free(pFrame);
@@ -144,10 +140,21 @@ public:
         return index;
     }
 
-    bool getCodec(AVFormatContext *pFormatCtx) {
+    bool getCodec(AVFormatContext *pFormatCtx, int threads = 1,
+                  bool frameThreads = false) {
         // Get a pointer to the codec context for the video stream
         pCodecCtx=pFormatCtx->streams[index]->codec;
 
+        // Decoding threads, 0 for as many as the cores. Frame threading
+        // delays the output of a few frames, it is used for media files.
+        pCodecCtx->thread_count = threads;
+#ifdef FF_THREAD_FRAME
+        pCodecCtx->thread_type = FF_THREAD_SLICE;
+        if (frameThreads) {
+            pCodecCtx->thread_type |= FF_THREAD_FRAME;
+        }
+#endif
+
         // Find the decoder for the video stream
         pCodec=avcodec_find_decoder(pCodecCtx->codec_id);
         if(pCodec==nullptr) {
@@ -166,24 +173,13 @@ public:
 
 
     bool allocateImage() {
-        // Allocate video frame
+        // Allocate video frame, the rgb image is converted straight
+        // into the image given to getVideo()
         pFrame=YARP_avcodec_alloc_frame();
-
-        // Allocate an AVFrame structure
-        pFrameRGB=YARP_avcodec_alloc_frame();
-        if(pFrameRGB==nullptr) {
+        if(pFrame==nullptr) {
             printf("Could not allocate a frame\n");
             return false;
         }
-
-        // Determine required buffer size and allocate buffer
-        int numBytes=avpicture_get_size(AV_PIX_FMT_RGB24, pCodecCtx->width,
-                                        pCodecCtx->height);
-        buffer=new uint8_t[numBytes];
-
-        // Assign appropriate parts of buffer to image planes in pFrameRGB
-        avpicture_fill((AVPicture *)pFrameRGB, buffer, AV_PIX_FMT_RGB24,
-                       pCodecCtx->width, pCodecCtx->height);
         return true;
     }
 
@@ -275,19 +271,14 @@ public:
                 sound.resize(num_samples,num_channels);
                 sound.setFrequency(num_rate);
 
-                int idx = 0;
-                for (int i=0; i<num_samples; i++) {
-                    for (int j=0; j<num_channels; j++) {
-                        sound.set(audioBuffer[idx],i,j);
-                        idx++;
-                    }
-                }
+                // the decoded samples are interleaved 16 bit integers
+                sound.setBlock(audioBuffer,0,num_samples);
             }
         }
         return true;
     }
 
-    bool getVideo(AVPacket& packet) {
+    bool getVideo(AVPacket& packet, ImageOf<PixelRgb>& image) {
         // Decode video frame
 #ifdef FFEPOCH3
         avcodec_decode_video2(pCodecCtx, pFrame, &frameFinished,
@@ -299,46 +290,33 @@ public:
 
         // Did we get a video frame?
         if(frameFinished) {
-            // Convert the image from its native format to RGB
-            int w = pCodecCtx->width;
-            int h = pCodecCtx->height;
-            static struct SwsContext *img_convert_ctx = nullptr;
-            if (img_convert_ctx==nullptr) {
-                img_convert_ctx = sws_getContext(w,h,
-                                                 pCodecCtx->pix_fmt,
-                                                 w, h, AV_PIX_FMT_RGB24,
-                                                 //0,
-                                                 //SWS_BILINEAR,
-                                                 SWS_BICUBIC,
-                                                 nullptr, nullptr, nullptr);
-            }
-            if (img_convert_ctx!=nullptr) {
-                sws_scale(img_convert_ctx, ((AVPicture*)pFrame)->data,
-                          ((AVPicture*)pFrame)->linesize, 0,
-                          pCodecCtx->height,
-                          ((AVPicture*)pFrameRGB)->data,
-                          ((AVPicture*)pFrameRGB)->linesize);
-            } else {
-                printf("Software scaling not working\n");
-                ::exit(1);
-            }
+            getLastVideo(image);
         }
         return frameFinished;
     }
 
-
-    bool getVideo(ImageOf<PixelRgb>& image) {
-        if (frameFinished) {
-            FlexImage flex;
-            flex.setPixelCode(VOCAB_PIXEL_RGB);
-            flex.setQuantum((pFrameRGB->linesize[0]));
-            flex.setExternal(pFrameRGB->data[0],
-                             pCodecCtx->width,
-                             pCodecCtx->height);
-            image.copy(flex);
+    // Convert the last decoded frame from its native format to RGB,
+    // straight into the image. The context of this decoder is set up
+    // again if the size or format of the video change.
+    void getLastVideo(ImageOf<PixelRgb>& image) {
+        int w = pCodecCtx->width;
+        int h = pCodecCtx->height;
+        img_convert_ctx = sws_getCachedContext(img_convert_ctx,
+                                               w, h,
+                                               pCodecCtx->pix_fmt,
+                                               w, h, AV_PIX_FMT_RGB24,
+                                               SWS_BICUBIC,
+                                               nullptr, nullptr, nullptr);
+        if (img_convert_ctx!=nullptr) {
+            image.resize(w,h);
+            uint8_t *dst[4] = { image.getRawImage(), nullptr, nullptr, nullptr };
+            int dstStride[4] = { image.getRowSize(), 0, 0, 0 };
+            sws_scale(img_convert_ctx, pFrame->data, pFrame->linesize,
+                      0, h, dst, dstStride);
+        } else {
+            printf("Software scaling not working\n");
+            ::exit(1);
         }
-
-        return frameFinished;
     }
 
     bool haveFrame() {
@@ -346,10 +324,114 @@ public:
     }
 };
 
+/**
+ * A decoded frame: the image and the sound up to it.
+ */
+class FfmpegFrame {
+public:
+    ImageOf<PixelRgb> image;
+    Sound sound;
+    double time_target;     // time of the frame in the media
+    bool looped;            // the media restarted from the beginning
+    bool ok;                // false at the end of the media
+
+    FfmpegFrame() :
+        time_target(0),
+        looped(false),
+        ok(true)
+    {}
+};
+
+
+/**
+ * Reads and decodes the media ahead of the caller, in a bounded queue of
+ * frames allocated once.
+ */
+class FfmpegDecodeThread : public Thread {
+public:
+    FfmpegDecodeThread(FfmpegGrabber& grabber, int length) :
+        grabber(grabber),
+        frames(length),
+        freeSlots(length),
+        filledSlots(0),
+        readAt(0),
+        writeAt(0),
+        finished(false)
+    {}
+
+    virtual void run() override {
+        while (!isStopping()) {
+            freeSlots.wait();
+            if (isStopping()) {
+                break;
+            }
+            FfmpegFrame& frame = frames[writeAt];
+            frame.ok = grabber.decodeFrame(frame);
+            writeAt = (writeAt+1)%frames.size();
+            filledSlots.post();
+            if (!frame.ok) {
+                break;
+            }
+        }
+    }
+
+    virtual void onStop() override {
+        freeSlots.post();
+    }
+
+    /**
+     * Wait for the next frame, to be given back with release().
+     * @return nullptr at the end of the media
+     */
+    FfmpegFrame *next() {
+        if (finished) {
+            return nullptr;
+        }
+        filledSlots.wait();
+        FfmpegFrame& frame = frames[readAt];
+        if (!frame.ok) {
+            finished = true;
+            return nullptr;
+        }
+        return &frame;
+    }
+
+    void release() {
+        readAt = (readAt+1)%frames.size();
+        freeSlots.post();
+    }
+
+private:
+    FfmpegGrabber& grabber;
+    std::vector<FfmpegFrame> frames;
+    Semaphore freeSlots;
+    Semaphore filledSlots;
+    size_t readAt;
+    size_t writeAt;
+    bool finished;
+};
+
+
 class FfmpegHelper {
 public:
     DecoderState videoDecoder;
     DecoderState audioDecoder;
+    FfmpegDecodeThread *decodeThread;
+    FfmpegFrame frame;      // without a decode thread
+
+    FfmpegHelper() : decodeThread(nullptr) {}
+
+    ~FfmpegHelper() {
+        stopDecoding();
+    }
+
+    void stopDecoding() {
+        if (decodeThread!=nullptr) {
+            decodeThread->stop();
+            delete decodeThread;
+            decodeThread = nullptr;
+        }
+    }
 };
 
 
@@ -520,6 +602,14 @@ bool FfmpegGrabber::open(yarp::os::Searchable & config) {
     pace = config.check("pace",Value(1.0),
                         "simulated realtime multiplier factor (must be <1 right now)").asDouble();
 
+    bool live = (config.check("v4l") || config.check("v4l1") ||
+                 config.check("v4l2") || config.check("ieee1394"));
+    // a queue would make live images late
+    queueLength = config.check("queue",Value(live?0:3),
+                               "number of frames decoded ahead by a thread, 0 to decode in the caller thread").asInt();
+    decoderThreads = config.check("threads",Value(0),
+                                  "number of video decoding threads, 0 for automatic").asInt();
+
     // Register all formats and codecs
     av_register_all();
     avdevice_register_all();
@@ -598,7 +688,7 @@ bool FfmpegGrabber::open(yarp::os::Searchable & config) {
 
     bool ok = true;
     if (_hasVideo) {
-        ok = ok && videoDecoder.getCodec(pFormatCtx);
+        ok = ok && videoDecoder.getCodec(pFormatCtx, decoderThreads, !live);
     }
     if (_hasAudio) {
         ok = ok && audioDecoder.getCodec(pAudioFormatCtx);
@@ -629,6 +719,14 @@ bool FfmpegGrabber::open(yarp::os::Searchable & config) {
     if (!(_hasVideo||_hasAudio)) {
         return false;
     }
+    if (queueLength>0) {
+        helper.decodeThread = new FfmpegDecodeThread(*this, queueLength);
+        if (!helper.decodeThread->start()) {
+            printf("Could not start the decoding thread\n");
+            helper.stopDecoding();
+            return false;
+        }
+    }
     active = true;
     return true;
 }
@@ -647,6 +745,11 @@ bool FfmpegGrabber::close() {
         return false;
     }
 
+    // The decoding thread uses the media
+    if (system_resource!=nullptr) {
+        HELPER(system_resource).stopDecoding();
+    }
+
     // Close the video file
     if (pFormatCtx!=nullptr) {
         YARP_av_close_input_file(pFormatCtx);
@@ -684,36 +787,80 @@ bool FfmpegGrabber::getSound(yarp::sig::Sound& sound) {
 bool FfmpegGrabber::getAudioVisual(yarp::sig::ImageOf<yarp::sig::PixelRgb>& image,
                                    yarp::sig::Sound& sound) {
 
+    FfmpegHelper& helper = HELPER(system_resource);
+    FfmpegFrame *frame = nullptr;
+    if (helper.decodeThread!=nullptr) {
+        frame = helper.decodeThread->next();
+        if (frame==nullptr) {
+            return false;
+        }
+    } else {
+        frame = &helper.frame;
+        if (!decodeFrame(*frame)) {
+            return false;
+        }
+    }
+
+    if (startTime<0.5 || frame->looped) {
+        startTime = SystemClock::nowSystem();
+    }
+    if (needRateControl) {
+        double now = (SystemClock::nowSystem()-startTime)*pace;
+        double delay = frame->time_target-now;
+        if (delay>0) {
+            DBG printf("DELAY %g ", delay);
+            SystemClock::delaySystem(delay);
+        } else {
+            DBG printf("NODELAY %g ", delay);
+        }
+    }
+    if (_hasVideo) {
+        // the image of the frame is filled again by the next decoding;
+        // an external buffer of the caller is filled by copy, not handed over
+        image.swap(frame->image);
+    } else {
+        image.resize(0,0);
+    }
+    sound = frame->sound;
+    DBG printf("IMAGE size %dx%d  ", image.width(), image.height());
+    DBG printf("SOUND size %d\n", sound.getSamples());
+
+    if (helper.decodeThread!=nullptr) {
+        helper.decodeThread->release();
+    }
+    return true;
+}
+
+
+bool FfmpegGrabber::decodeFrame(FfmpegFrame& frame) {
+
     FfmpegHelper& helper = HELPER(system_resource);
     DecoderState& videoDecoder = helper.videoDecoder;
     DecoderState& audioDecoder = helper.audioDecoder;
 
     bool tryAgain = false;
     bool triedAgain = false;
+    frame.looped = false;
 
     do {
 
         bool gotAudio = false;
         bool gotVideo = false;
-        if (startTime<0.5) {
-            startTime = SystemClock::nowSystem();
-        }
-        double time_target = 0;
+        frame.time_target = 0;
         while(av_read_frame(pFormatCtx, &packet)>=0) {
             // Is this a packet from the video stream?
             DBG printf("frame ");
             bool done = false;
             if (packet.stream_index==videoDecoder.getIndex()) {
                 DBG printf("video ");
-                done = videoDecoder.getVideo(packet);
-                image.resize(1,1);
+                done = videoDecoder.getVideo(packet,frame.image);
                 if (done) {
                     //printf("got a video frame\n");
                     gotVideo = true;
                 }
-            } if (packet.stream_index==audioDecoder.getIndex()) {
+            } else if (packet.stream_index==audioDecoder.getIndex()) {
                 DBG printf("audio ");
-                done = audioDecoder.getAudio(packet,sound);
+                done = audioDecoder.getAudio(packet,frame.sound);
                 if (done) {
                     //printf("got an audio frame\n");
                     gotAudio = true;
@@ -725,31 +872,24 @@ bool FfmpegGrabber::getAudioVisual(yarp::sig::ImageOf<yarp::sig::PixelRgb>& imag
             double rbase = av_q2d(time_base);
 
             DBG printf(" time=%g ", packet.pts*rbase);
-            time_target = packet.pts*rbase;
+            frame.time_target = packet.pts*rbase;
 
             av_free_packet(&packet);
             DBG printf(" %d\n", done);
             if (((imageSync?gotVideo:videoDecoder.haveFrame())||!_hasVideo)&&
                 ((imageSync?1:gotAudio)||!_hasAudio)) {
                 if (_hasVideo) {
-                    videoDecoder.getVideo(image);
-                } else {
-                    image.resize(0,0);
-                }
-                if (needRateControl) {
-                    double now = (SystemClock::nowSystem()-startTime)*pace;
-                    double delay = time_target-now;
-                    if (delay>0) {
-                        DBG printf("DELAY %g ", delay);
-                        SystemClock::delaySystem(delay);
-                    } else {
-                        DBG printf("NODELAY %g ", delay);
+                    if (!gotVideo) {
+                        // completed by audio, same image as last time: the
+                        // image of the previous frame may have been given
+                        // away, the last decoded frame is converted again
+                        videoDecoder.getLastVideo(frame.image);
                     }
+                } else {
+                    frame.image.resize(0,0);
                 }
-                DBG printf("IMAGE size %dx%d  ", image.width(), image.height());
-                DBG printf("SOUND size %d\n", sound.getSamples());
                 if (!_hasAudio) {
-                    sound.resize(0,0);
+                    frame.sound.resize(0,0);
                 }
                 return true;
             }
@@ -762,7 +902,8 @@ bool FfmpegGrabber::getAudioVisual(yarp::sig::ImageOf<yarp::sig::PixelRgb>& imag
                 return false;
             }
             av_seek_frame(pFormatCtx,-1,0,AVSEEK_FLAG_BACKWARD);
-            startTime = SystemClock::nowSystem();
+            frame.looped = true;
+            triedAgain = true;
         }
     } while (tryAgain);
 
@@ -28,6 +28,9 @@ namespace yarp {
     }
 }
 
+class FfmpegFrame;
+class FfmpegDecodeThread;
+
 #include <yarp/dev/AudioVisualInterfaces.h>
 #include <yarp/dev/DeviceDriver.h>
 
@@ -38,6 +41,10 @@ namespace yarp {
  *
  * An image frame grabber device using ffmpeg to capture images from
  * AVI files.
+ *
+ * Media files are read and decoded by a thread of the device, a few frames
+ * ahead of the caller (see the "queue" option), and the video decoder
+ * can use several threads (see the "threads" option).
  */
 class yarp::dev::FfmpegGrabber : public IFrameGrabberImage,
             public IAudioGrabberSound,
@@ -62,6 +69,8 @@ public:
         shouldLoop(true),
         pace(1),
         imageSync(false),
+        queueLength(0),
+        decoderThreads(1),
         m_w(0),
         m_h(0),
         m_channels(0),
@@ -119,6 +128,8 @@ protected:
     bool shouldLoop;
     double pace;
     bool imageSync;
+    int queueLength;
+    int decoderThreads;
 
     /** Uri of the images a grabber produces. */
     yarp::os::ConstString m_uri;
@@ -143,6 +154,15 @@ protected:
 
     bool openFile(AVFormatContext **ppFormatCtx,
                   const char *fname);
+
+    /**
+     * Read and decode the media up to the next frame.
+     * @param frame the frame to fill
+     * @return false at the end of the media, if not looping
+     */
+    bool decodeFrame(FfmpegFrame& frame);
+
+    friend class ::FfmpegDecodeThread;
 };
 
 
@@ -517,7 +517,8 @@ void FfmpegWriter::write_video_frame(AVFormatContext *oc, AVStream *st,
         DBG printf("Converting to AV_PIX_FMT_RGB24\n");
         fill_rgb_image(tmp_picture, frame_count, c->width, c->height, img);
         DBG printf("Converting to AV_PIX_FMT_RGB24 (stable_img_convert)\n");
-        stable_img_convert((AVPicture *)picture, c->pix_fmt,
+        stable_img_convert(&img_convert_ctx,
+                           (AVPicture *)picture, c->pix_fmt,
                            (AVPicture *)tmp_picture, AV_PIX_FMT_RGB24,
                            c->width, c->height);
         DBG printf("Converted to AV_PIX_FMT_RGB24\n");
@@ -604,6 +605,10 @@ void FfmpegWriter::close_video(AVFormatContext *oc, AVStream *st)
         av_free(tmp_picture);
     }
     av_free(video_outbuf);
+    if (img_convert_ctx) {
+        sws_freeContext(img_convert_ctx);
+        img_convert_ctx = nullptr;
+    }
 }
 
 
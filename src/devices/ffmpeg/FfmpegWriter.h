@@ -16,6 +16,8 @@ extern "C" {
 #include <avformat.h>
 }
 
+struct SwsContext;
+
 /*
  * Uses ffmpeg to write images to movie files.
  *
@@ -52,6 +54,7 @@ public:
         video_pts(0.0),
         picture(nullptr),
         tmp_picture(nullptr),
+        img_convert_ctx(nullptr),
         video_outbuf(nullptr),
         frame_count(0),
         video_outbuf_size(0),
@@ -85,6 +88,7 @@ private:
     yarp::os::ConstString filename;
     yarp::os::Property savedConfig;
     AVFrame *picture, *tmp_picture;
+    struct SwsContext *img_convert_ctx;
     uint8_t *video_outbuf;
     int frame_count, video_outbuf_size;
     bool ready;
@@ -8,40 +8,26 @@
 #include "ffmpeg_api.h"
 
 
-int stable_img_convert (AVPicture *dst, int dst_pix_fmt,
+int stable_img_convert (struct SwsContext **ctx,
+                        AVPicture *dst, int dst_pix_fmt,
                         const AVPicture *src, int src_pix_fmt,
                         int src_width, int src_height) {
-  static struct SwsContext *img_convert_ctx = nullptr;
-  if (img_convert_ctx==nullptr) {
-      //printf("Looking for a context\n");
-      img_convert_ctx = sws_getContext(src_width, src_height,
-                                       (AVPixelFormat)src_pix_fmt,
-                                       src_width, src_height,
-                                       (AVPixelFormat)dst_pix_fmt,
+  // returns the same context unless the parameters changed
+  *ctx = sws_getCachedContext(*ctx,
+                              src_width, src_height,
+                              (AVPixelFormat)src_pix_fmt,
+                              src_width, src_height,
+                              (AVPixelFormat)dst_pix_fmt,
 #ifdef SWS_BILINEAR
-                                       SWS_BILINEAR,
+                              SWS_BILINEAR,
 #else
-                                       0,
+                              0,
 #endif
-                                       nullptr, nullptr, nullptr);
-
-      //printf("Done looking for a context\n");
-  }
-  if (img_convert_ctx!=nullptr) {
-      /*
-      printf("software scale: %ld %ld/%ld %d/%d %d\n",
-             (long int)img_convert_ctx,
-             (long int)(((AVPicture*)src)->data),
-             (long int)(((AVPicture*)dst)->data),
-             ((AVPicture*)src)->linesize[0],
-             ((AVPicture*)dst)->linesize[0],
-             src_height);
-      */
-
-      sws_scale(img_convert_ctx, ((AVPicture*)src)->data,
+                              nullptr, nullptr, nullptr);
+  if (*ctx!=nullptr) {
+      sws_scale(*ctx, ((AVPicture*)src)->data,
                 ((AVPicture*)src)->linesize, 0, src_height,
                 ((AVPicture*)dst)->data, ((AVPicture*)dst)->linesize);
-      //printf("software scale done\n");
   } else {
     fprintf(stderr,"image conversion failed\n");
     return -1;
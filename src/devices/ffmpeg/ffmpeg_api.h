@@ -50,7 +50,13 @@ extern "C" {
 
 
 
-int stable_img_convert (AVPicture *dst, int dst_pix_fmt,
+/**
+ * Convert a picture. The conversion context is kept in *ctx by the
+ * caller, it is created on the first call and set up again if the
+ * formats or the size change. Free it with sws_freeContext().
+ */
+int stable_img_convert (struct SwsContext **ctx,
+                        AVPicture *dst, int dst_pix_fmt,
                         const AVPicture *src, int src_pix_fmt,
                         int src_width, int src_height);
 
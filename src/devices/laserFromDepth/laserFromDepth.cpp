@@ -17,6 +17,7 @@
 #include <cstring>
 #include <cstdlib>
 #include <limits>
+#include <algorithm>
 
 #include <cmath>
 
@@ -50,6 +51,15 @@ bool LaserFromDepth::open(yarp::os::Searchable& config)
         if (m_clip_max_enable) { m_max_distance = general_config.find("clip_max").asDouble(); }
         if (m_clip_min_enable) { m_min_distance = general_config.find("clip_min").asDouble(); }
         m_do_not_clip_infinity_enable = (general_config.find("allow_infinity").asInt()!=0);
+        // number of image rows, centered on the middle one, whose minimum
+        // distance is used for each beam.
+        m_band_height = general_config.check("band_height", Value(1)).asInt();
+        m_use_intrinsics = (general_config.check("use_intrinsics", Value(0)).asInt()!=0);
+        if (m_band_height < 1)
+        {
+            yError() << "band_height must be at least 1";
+            return false;
+        }
     }
     else
     {
@@ -121,12 +131,74 @@ bool LaserFromDepth::open(yarp::os::Searchable& config)
     m_laser_data.resize(m_sensorsNum, 0.0);
     m_max_angle = +hfov / 2;
     m_min_angle = -hfov / 2;
+    if (m_band_height > m_depth_height)
+    {
+        m_band_height = m_depth_height;
+    }
+
+    Property intrinsic;
+    if (m_use_intrinsics && !iRGBD->getDepthIntrinsicParam(intrinsic))
+    {
+        yWarning() << "Unable to get the depth intrinsic parameters, assuming linear angles";
+        m_use_intrinsics = false;
+    }
+    computeBeamTables(intrinsic);
     RateThread::start();
 
     yInfo("Sensor ready");
     return true;
 }
 
+void LaserFromDepth::computeBeamTables(const yarp::os::Property& intrinsic)
+{
+    double angleShift = m_sensorsNum * m_resolution / 2;
+    double fx = intrinsic.check("focalLengthX", Value(0.0)).asDouble();
+    double cx = intrinsic.check("principalPointX", Value(m_depth_width / 2.0)).asDouble();
+    if (m_use_intrinsics && fx <= 0)
+    {
+        yWarning() << "Invalid focalLengthX in the depth intrinsic parameters, assuming linear angles";
+        m_use_intrinsics = false;
+    }
+
+    m_beam_column.resize(m_sensorsNum);
+    m_beam_factor.resize(m_sensorsNum);
+    m_beam_skip.resize(m_sensorsNum);
+    m_column_min.resize(m_depth_width);
+
+    for (int elem = 0; elem < m_sensorsNum; elem++)
+    {
+        double angle = elem * m_resolution;    //deg
+        double theta = (angle - angleShift) * DEG2RAD;
+
+        if (m_use_intrinsics)
+        {
+            // pick the column whose ray has the beam angle: the distance
+            // on the horizontal plane of a point with depth z on that
+            // column is z * sqrt(1 + x^2), for every row.
+            int column = (int) std::floor(cx + fx * tan(theta) + 0.5);
+            column = std::max(0, std::min(m_depth_width - 1, column));
+            double x = (column - cx) / fx;
+            m_beam_column[elem] = column;
+            m_beam_factor[elem] = sqrt(1.0 + x * x);
+        }
+        else
+        {
+            //the 1 / cos(blabla) distortion simulate the way RGBD devices calculate the distance..
+            m_beam_column[elem] = elem;
+            m_beam_factor[elem] = 1.0 / cos(theta);
+        }
+
+        m_beam_skip[elem] = 0;
+        for (size_t i = 0; i < m_range_skip_vector.size(); i++)
+        {
+            if (angle > m_range_skip_vector[i].min && angle < m_range_skip_vector[i].max)
+            {
+                m_beam_skip[elem] = 1;
+            }
+        }
+    }
+}
+
 bool LaserFromDepth::close()
 {
     RateThread::stop();
@@ -263,21 +335,36 @@ void LaserFromDepth::run()
     }
 
 
-    float* pointer = (float*)m_depth_image.getPixelAddress(0, m_depth_height / 2);
-    double angle, distance, infinity, angleShift;
-    size_t i;
+    // minimum over the band of rows of each column. Invalid values (NaN,
+    // zero) of the rows other than the middle one are ignored.
+    int firstRow = m_depth_height / 2 - m_band_height / 2;
+    float* minimum = m_column_min.data();
+    const float* center = (const float*)m_depth_image.getRow(m_depth_height / 2);
+    std::copy(center, center + m_depth_width, minimum);
+    for (int row = firstRow; row < firstRow + m_band_height; row++)
+    {
+        if (row == m_depth_height / 2)
+        {
+            continue;
+        }
+        const float* pointer = (const float*)m_depth_image.getRow(row);
+        for (int col = 0; col < m_depth_width; col++)
+        {
+            float value = pointer[col];
+            float current = minimum[col];
+            minimum[col] = (value > 0 && !(value >= current)) ? value : current;
+        }
+    }
 
-    infinity   = std::numeric_limits<double>::infinity();
-    angleShift = m_sensorsNum * m_resolution / 2;
+    double distance;
+    double infinity = std::numeric_limits<double>::infinity();
+    const int* column = m_beam_column.data();
+    const double* factor = m_beam_factor.data();
+    const unsigned char* skip = m_beam_skip.data();
 
     for (int elem = 0; elem < m_sensorsNum; elem++)
     {
-
-        angle    = elem * m_resolution;    //deg
-
-        //the 1 / cos(blabla) distortion simulate the way RGBD devices calculate the distance..
-        distance = *(pointer + elem);
-        distance /= cos((angle - angleShift) * DEG2RAD); //m
+        distance = minimum[column[elem]] * factor[elem]; //m
 
         if (m_clip_min_enable && distance < m_min_distance)
         {
@@ -292,12 +379,9 @@ void LaserFromDepth::run()
             distance = m_max_distance;
         }
 
-        for (i = 0; i < m_range_skip_vector.size(); i++)
+        if (skip[elem])
         {
-            if (angle > m_range_skip_vector[i].min && angle < m_range_skip_vector[i].max)
-            {
-                distance = infinity;
-            }
+            distance = infinity;
         }
 
         m_laser_data[m_sensorsNum - 1 - elem] = distance;
@@ -54,6 +54,14 @@ protected:
     bool m_clip_min_enable;
     bool m_do_not_clip_infinity_enable;
     std::vector <Range_t> m_range_skip_vector;
+    int m_band_height;
+    bool m_use_intrinsics;
+
+    //per-beam tables, computed at open()
+    std::vector <int> m_beam_column;
+    std::vector <double> m_beam_factor;
+    std::vector <unsigned char> m_beam_skip;
+    std::vector <float> m_column_min;
 
     std::string m_info;
     Device_status m_device_status;
@@ -74,6 +82,8 @@ public:
         m_clip_max_enable(false),
         m_clip_min_enable(false),
         m_do_not_clip_infinity_enable(false),
+        m_band_height(1),
+        m_use_intrinsics(false),
         m_device_status(Device_status::DEVICE_OK_STANBY)
     {}
 
@@ -81,6 +91,15 @@ public:
     {
     }
 
+    /**
+     * Compute the depth image column, the distance correction factor and
+     * the skip flag of each beam.
+     * @param intrinsic the depth camera intrinsic parameters, used if
+     *        m_use_intrinsics is set, otherwise angles are assumed to be
+     *        linear in the column index.
+     */
+    void computeBeamTables(const yarp::os::Property& intrinsic);
+
     virtual bool open(yarp::os::Searchable& config) override;
     virtual bool close() override;
     virtual bool threadInit() override;
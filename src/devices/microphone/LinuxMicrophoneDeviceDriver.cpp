@@ -7,6 +7,11 @@
 
 #include <MicrophoneDeviceDriver.h>
 
+#include <yarp/os/Thread.h>
+#include <yarp/os/Value.h>
+#include <yarp/dev/CircularAudioBuffer.h>
+
+#include <cerrno>
 #include <cstdio>
 #include <fcntl.h>
 #include <cstdlib>
@@ -14,17 +19,79 @@
 #include <cstring>
 #include <sys/ioctl.h>
 #include <sys/soundcard.h>
+#include <vector>
 
 #define SAMPLE_RATE 48000
 #define NUM_SECONDS 0.1
 #define NUM_SAMPLES ((int)(SAMPLE_RATE*NUM_SECONDS))
+// frames read from the device at a time, 5 ms at 48 kHz
+#define CAPTURE_FRAMES 240
 
 char devname[] = "/dev/dsp";
-unsigned char pulsecode[ NUM_SAMPLES ];
 
 using namespace yarp::os;
 using namespace yarp::dev;
 
+namespace {
+
+/*
+ * The device is read in small blocks by a thread, and the blocks go in a
+ * circular buffer: getSound() is woken up as soon as the buffer has its
+ * samples, and the capture goes on while the sound is sent.
+ */
+class CaptureThread : public yarp::os::Thread
+{
+public:
+    int dsp;
+    int rate;
+    int samples;
+    CircularAudioBuffer buffer;
+    std::vector<short> block;
+    std::vector<unsigned char> raw;
+    std::vector<short> chunk;
+
+    CaptureThread(int dsp, int rate, int samples) :
+            dsp(dsp),
+            rate(rate),
+            samples(samples),
+            buffer(2*samples + 4*CAPTURE_FRAMES, 1),
+            block(samples),
+            raw(CAPTURE_FRAMES),
+            chunk(CAPTURE_FRAMES)
+    {
+    }
+
+    virtual void run() override
+    {
+        while (!isStopping()) {
+            int nbytes = ::read(dsp, raw.data(), raw.size());
+            if (nbytes < 0 && errno == EINTR) {
+                continue;
+            }
+            if (nbytes <= 0) {
+                perror(devname);
+                break;
+            }
+            // the unsigned 8 bit samples of the device are stored as they
+            // are, as the sounds have always had them
+            for (int i = 0; i < nbytes; i++) {
+                chunk[i] = raw[i];
+            }
+            // the frames that do not fit are counted as an overrun
+            buffer.write(chunk.data(), nbytes);
+        }
+    }
+
+    virtual void onStop() override
+    {
+        buffer.interrupt();
+    }
+};
+
+} // namespace
+
+#define RES(x) (*((CaptureThread*)(x)))
+
 
 MicrophoneDeviceDriver::MicrophoneDeviceDriver() :
     system_resources(nullptr),
@@ -41,8 +108,13 @@ bool MicrophoneDeviceDriver::open(yarp::os::Searchable& config) {
     printf("WARNING: it hasn't really been written yet\n");
 
     short nChannels = 1;
-    int samplesPerSec = SAMPLE_RATE;
+    int samplesPerSec = config.check("rate",Value(SAMPLE_RATE),"audio sample rate").asInt();
+    int samples = config.check("samples",Value(NUM_SAMPLES),"number of samples per network packet").asInt();
     short bitsPerSample = 8;
+    if (samplesPerSec <= 0 || samples <= 0) {
+        printf("ERROR: the rate and the number of samples must be positive\n");
+        return false;
+    }
 
     // open the audio device-file and set its capture parameters
     int bits = ( bitsPerSample == 8 ) ? AFMT_U8 : AFMT_S16_BE;
@@ -54,15 +126,24 @@ bool MicrophoneDeviceDriver::open(yarp::os::Searchable& config) {
         { perror( "ioctl" ); std::exit(1); }
     if (      ( ioctl( dsp, SNDCTL_DSP_SETFMT,   &bits ) < 0 )
               ||( ioctl( dsp, SNDCTL_DSP_CHANNELS, &chns ) < 0 )
-              ||( ioctl( dsp, SNDCTL_DSP_SPEED,    &rate ) < 0 )    )
+              ||( ioctl( dsp, SNDCTL_DSP_SPEED,    &rate ) < 0 )
+              ||( bits != AFMT_U8 ) )
         { perror( "audio format not not supported\n" ); std::exit(1); }
 
     printf("Ok, opened microphone...\n");
 
-    return true;
+    // the device may have chosen a close rate
+    CaptureThread* capture = new CaptureThread(dsp, rate, samples);
+    system_resources = capture;
+    return capture->start();
 }
 
 bool MicrophoneDeviceDriver::close() {
+    if (system_resources!=nullptr) {
+        RES(system_resources).stop();
+        delete &RES(system_resources);
+        system_resources = nullptr;
+    }
     if (dsp!=-1) {
         ::close( dsp );
         dsp = -1;
@@ -71,33 +152,28 @@ bool MicrophoneDeviceDriver::close() {
 }
 
 bool MicrophoneDeviceDriver::getSound(yarp::sig::Sound& sound) {
-    // main loop to capture the waveform audio data
-    unsigned char *data = pulsecode;
-    int begun = 1;
-    int bytes_to_grab = NUM_SAMPLES / 16;
-    int bytes_to_save = NUM_SAMPLES;
-    while ( bytes_to_save > 0 )
-        {
-            int nbytes = read( dsp, data, bytes_to_grab );
-            if ( !begun )
-                {
-                    int max = 0;
-                    for (int i = 0; i < nbytes; i++)
-                        if ( data[i] > max ) max = data[i];
-                    if ( max > 0x99 ) begun = 1;
-                    else continue;
-                }
-            bytes_to_save -= nbytes;
-            data += nbytes;
-        }
-    sound.resize(NUM_SAMPLES);
-    double total = 0;
-    for (int i=0; i<NUM_SAMPLES; i++) {
-        sound.set(pulsecode[i],i);
-        total += abs(pulsecode[i]-128);
+    if (system_resources==nullptr) {
+        return false;
+    }
+    CaptureThread& capture = RES(system_resources);
+    CircularAudioBuffer& buffer = capture.buffer;
+
+    // woken up by the capture thread as soon as the samples are there; if
+    // they do not come the missing ones are silence
+    if (!buffer.waitFrames(capture.samples, 2.0*capture.samples/capture.rate + 0.5)) {
+        printf("WARNING: no audio from the microphone\n");
+    }
+    buffer.readOrSilence(capture.block.data(), capture.samples);
+
+    sound.resize(capture.samples);
+    sound.setFrequency(capture.rate);
+    sound.setBlock(capture.block.data(), 0, capture.samples);
+
+    if (buffer.getOverruns() != 0 || buffer.getUnderruns() != 0) {
+        printf("WARNING: %zu samples lost (buffer full), %zu samples of silence (buffer empty)\n",
+               buffer.getOverruns(), buffer.getUnderruns());
+        buffer.resetCounters();
     }
-    printf( "grabbing a chunk of %d samples... magnitude: %g\n",
-            NUM_SAMPLES, total);
     return true;
 }
 
@@ -24,6 +24,11 @@ namespace yarp {
  * The implementation is very simple right now - if you want to
  * use this for real you should fix it up.
  *
+ * On Linux the device is read by a thread, in blocks of 5 ms, into a
+ * yarp::dev::CircularAudioBuffer; getSound() returns as soon as the
+ * buffer has the samples of a sound (the "samples" parameter, 4800 by
+ * default, at the "rate" parameter, 48000 by default).
+ *
  */
 class yarp::dev::MicrophoneDeviceDriver :
     public IAudioGrabberSound, public DeprecatedDeviceDriver
@@ -7,6 +7,7 @@
 
 #include <PortAudioDeviceDriver.h>
 
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -31,92 +32,40 @@ static int bufferIOCallback( const void *inputBuffer, void *outputBuffer,
                          void *userData )
 {
     circularDataBuffers* dataBuffers = static_cast<circularDataBuffers*>(userData);
-    circularBuffer *playdata = dataBuffers->playData;
-    circularBuffer *recdata  = dataBuffers->recData;
-    int num_channels         = dataBuffers->numChannels;
-    int finished = paComplete;
+    CircularAudioBuffer *playdata = dataBuffers->playData;
+    CircularAudioBuffer *recdata  = dataBuffers->recData;
+
+    (void) timeInfo; // just to prevent unused variable warnings
+    (void) statusFlags;
 
     if (dataBuffers->canRec)
     {
-        const SAMPLE *rptr = (const SAMPLE*)inputBuffer;
-        unsigned int framesToCalc;
-        unsigned int i;
-        unsigned long framesLeft = recdata->getMaxSize()-recdata->size();
-
-        (void) outputBuffer; // just to prevent unused variable warnings
-        (void) timeInfo;
-        (void) statusFlags;
-        (void) userData;
-
-        if( framesLeft/num_channels < framesPerBuffer )
-        {
-            framesToCalc = framesLeft/num_channels;
-            finished = paComplete;
-        }
-        else
-        {
-            framesToCalc = framesPerBuffer;
-            finished = paContinue;
-        }
-
-        if( inputBuffer == NULL )
-        {
-            for( i=0; i<framesToCalc; i++ )
-            {
-                recdata->write(0); // left
-                if( num_channels == 2 ) recdata->write(0);  // right
-            }
-        }
-        else
-        {
-            for( i=0; i<framesToCalc; i++ )
-            {
-                recdata->write(*rptr++);  // left
-                if( num_channels == 2 ) recdata->write(*rptr++);  // right
-            }
-        }
+        // whole blocks are copied, and the reader is woken up as soon as
+        // it has its frames; when the buffer is full the frames are
+        // dropped and counted as an overrun, the recording goes on
+        (void) outputBuffer;
+        recdata->write((const SAMPLE*)inputBuffer, framesPerBuffer);
         //note: you can record or play but not simultaneously (for now)
-        return finished;
+        return paContinue;
     }
 
     if (dataBuffers->canPlay)
     {
         SAMPLE *wptr = (SAMPLE*)outputBuffer;
-        unsigned int i;
-
-        unsigned int framesLeft = playdata->size();
+        int num_channels = dataBuffers->numChannels;
 
-        (void) inputBuffer; // just to prevent unused variable warnings
-        (void) timeInfo;
-        (void) statusFlags;
-        (void) userData;
+        (void) inputBuffer;
 
-        if( framesLeft/num_channels < framesPerBuffer )
+        size_t frames = playdata->read(wptr, framesPerBuffer);
+        if (frames < framesPerBuffer)
         {
             // final buffer
-            for( i=0; i<framesLeft/num_channels; i++ )
-            {
-                *wptr++ = playdata->read();  // left
-                if( num_channels == 2 ) *wptr++ = playdata->read();  // right
-            }
-            for( ; i<framesPerBuffer; i++ )
-            {
-                *wptr++ = 0;  // left
-                if( num_channels == 2 ) *wptr++ = 0;  // right
-            }
-            finished = paComplete;
-        }
-        else
-        {
-            for( i=0; i<framesPerBuffer; i++ )
-            {
-                *wptr++ = playdata->read();  // left
-                if( num_channels == 2 ) *wptr++ = playdata->read();  // right
-            }
-            finished = paContinue;
+            memset(wptr + frames*num_channels, SAMPLE_SILENCE,
+                   (framesPerBuffer - frames)*num_channels*sizeof(SAMPLE));
+            return paComplete;
         }
         //note: you can record or play but not simultaneously (for now)
-        return finished;
+        return paContinue;
     }
 
     printf("No read/write operations requested, aborting\n");
@@ -129,6 +78,7 @@ PortAudioDeviceDriver::PortAudioDeviceDriver() :
     i(0),
     numSamples(0),
     numBytes(0),
+    framesPerBuffer(0),
     system_resource(NULL),
     numChannels(0),
     frequency(0),
@@ -155,6 +105,7 @@ bool PortAudioDeviceDriver::open(yarp::os::Searchable& config)
     driverConfig.wantRead = (bool)config.check("read","if present, just deal with reading audio (microphone)");
     driverConfig.wantWrite = (bool)config.check("write","if present, just deal with writing audio (speaker)");
     driverConfig.deviceNumber = config.check("id",Value(-1),"which portaudio index to use (-1=automatic)").asInt();
+    driverConfig.framesPerBuffer = config.check("frames_per_buffer",Value(0),"frames passed to each call of the audio callback (0=automatic). With samples, it bounds the latency of the recording.").asInt();
 
     if (!(driverConfig.wantRead||driverConfig.wantWrite))
     {
@@ -188,6 +139,12 @@ bool PortAudioDeviceDriver::open(PortAudioDeviceDriverSettings& config)
     bool wantWrite = config.wantWrite;
     int deviceNumber = config.deviceNumber;
 
+    if (rate<0 || samples<0 || channels<0)
+    {
+        printf("the rate, the samples and the channels cannot be negative\n");
+        return false;
+    }
+
     if (channels==0) channels = DEFAULT_NUM_CHANNELS;
     numChannels = channels;
     if (rate==0) rate = DEFAULT_SAMPLE_RATE;
@@ -198,14 +155,17 @@ bool PortAudioDeviceDriver::open(PortAudioDeviceDriverSettings& config)
     else
         numSamples = samples;
 
-    //buffer.allocate(num_samples*num_channels*sizeof(SAMPLE));
+    framesPerBuffer = config.framesPerBuffer;
+    if (framesPerBuffer<=0) framesPerBuffer = DEFAULT_FRAMES_PER_BUFFER;
+
+    // room for two network packets, and for a few calls of the callback
     numBytes = numSamples * sizeof(SAMPLE) * numChannels;
-    int twiceTheBuffer = numBytes * 2;
+    size_t bufferFrames = std::max(2*numSamples, 4*framesPerBuffer);
     dataBuffers.numChannels=numChannels;
     if (dataBuffers.playData==0)
-        dataBuffers.playData = new circularBuffer(twiceTheBuffer);
+        dataBuffers.playData = new CircularAudioBuffer(bufferFrames, numChannels);
     if (dataBuffers.recData==0)
-        dataBuffers.recData = new circularBuffer(twiceTheBuffer);
+        dataBuffers.recData = new CircularAudioBuffer(bufferFrames, numChannels);
     if (wantRead) dataBuffers.canRec = true;
     if (wantWrite) dataBuffers.canPlay = true;
 
@@ -235,7 +195,7 @@ bool PortAudioDeviceDriver::open(PortAudioDeviceDriverSettings& config)
               wantRead?(&inputParameters):NULL,
               wantWrite?(&outputParameters):NULL,
               frequency,
-              DEFAULT_FRAMES_PER_BUFFER,
+              framesPerBuffer,
               paClipOff,
               bufferIOCallback,
               &dataBuffers );
@@ -329,28 +289,33 @@ bool PortAudioDeviceDriver::getSound(yarp::sig::Sound& sound)
         this->startRecording();
     }
 
-    int buff_size = 0;
-    static int buff_size_wdt = 0;
-    while (buff_size<this->numSamples*this->numChannels)
+    // woken up by the callback as soon as the frames are there; if they do
+    // not come the missing ones are silence
+    CircularAudioBuffer* recData = dataBuffers.recData;
+    double timeout = 2.0*numSamples/frequency + 0.5;
+    if (!recData->waitFrames(numSamples, timeout))
     {
-         buff_size = dataBuffers.recData->size();
-         if (buff_size == 0 && buff_size_wdt++ == 100) break;
-         yarp::os::SystemClock::delaySystem(SLEEP_TIME);
+        printf("WARN: no audio from the device\n");
     }
-    buff_size_wdt = 0;
 
-    if (sound.getChannels()!=this->numChannels && sound.getSamples() != this->numSamples)
+    if (sound.getChannels()!=this->numChannels || sound.getSamples() != this->numSamples)
     {
         sound.resize(this->numSamples,this->numChannels);
     }
-    sound.setFrequency(this->driverConfig.rate);
-
-    for (int i=0; i<this->numSamples; i++)
-        for (int j=0; j<this->numChannels; j++)
-            {
-                SAMPLE s = dataBuffers.recData->read();
-                sound.set(s,i,j);
-            }
+    sound.setFrequency(this->frequency);
+
+    recordBuffer.resize(numSamples*numChannels);
+    recData->readOrSilence(recordBuffer.data(), numSamples);
+    sound.setBlock(recordBuffer.data(), 0, numSamples);
+
+    size_t overruns = recData->getOverruns();
+    size_t underruns = recData->getUnderruns();
+    if (overruns != 0 || underruns != 0)
+    {
+        printf("WARN: recording, %zu frames lost (buffer full), %zu frames of silence (buffer empty)\n",
+               overruns, underruns);
+        recData->resetCounters();
+    }
     return true;
 }
 
@@ -416,20 +381,14 @@ void streamThread::run()
 
 bool PortAudioDeviceDriver::immediateSound(yarp::sig::Sound& sound)
 {
+    // the callback reads the buffer, it is stopped before the buffer is
+    // cleared
+    if (Pa_IsStreamActive(stream) == 1)
+    {
+        Pa_AbortStream(stream);
+    }
     dataBuffers.playData->clear();
-
-    //unsigned char* dataP= sound.getRawData();
-    int num_bytes = sound.getBytesPerSample();
-    int num_channels = sound.getChannels();
-    int num_samples = sound.getRawDataSize()/num_channels/num_bytes;
-    // memcpy(data.samplesBuffer,dataP,num_samples/**num_bytes*num_channels*/);
-
-    for (int i=0; i<num_samples; i++)
-        for (int j=0; j<num_channels; j++)
-            dataBuffers.playData->write (sound.get(i,j));
-
-    pThread.something_to_play = true;
-    return true;
+    return appendSound(sound);
 }
 
 bool PortAudioDeviceDriver::renderSound(yarp::sig::Sound& sound)
@@ -468,18 +427,33 @@ bool PortAudioDeviceDriver::renderSound(yarp::sig::Sound& sound)
 
 bool PortAudioDeviceDriver::appendSound(yarp::sig::Sound& sound)
 {
-    //unsigned char* dataP= sound.getRawData();
-    int num_bytes = sound.getBytesPerSample();
+    CircularAudioBuffer* playData = dataBuffers.playData;
     int num_channels = sound.getChannels();
-    int num_samples = sound.getRawDataSize()/num_channels/num_bytes;
-    // memcpy(data.samplesBuffer,dataP,num_samples/**num_bytes*num_channels*/);
+    int num_samples = sound.getSamples();
+    if (num_channels != playData->getChannels())
+    {
+        printf("ERROR: the sound has %d channels, the device %d\n", num_channels, playData->getChannels());
+        return false;
+    }
 
-    for (int i=0; i<num_samples; i++)
-        for (int j=0; j<num_channels; j++)
-            dataBuffers.playData->write (sound.get(i,j));
+    playBuffer.resize(num_samples*num_channels);
+    sound.getBlock(playBuffer.data(), 0, num_samples);
 
-    pThread.something_to_play = true;
+    // sounds longer than the free space are written as the callback plays
+    // them: each time it frees about a buffer, all the free space is filled
+    size_t done = 0;
+    while (done < (size_t)num_samples)
+    {
+        size_t remaining = (size_t)num_samples - done;
+        size_t wanted = std::min(remaining, std::min((size_t)framesPerBuffer, playData->getMaxFrames()));
+        if (!playData->waitFreeFrames(wanted, (double)wanted/frequency + 1.0))
+        {
+            printf("ERROR: the sound is not being played\n");
+            return false;
+        }
+        size_t chunk = std::min(playData->getFreeFrames(), remaining);
+        done += playData->write(playBuffer.data() + done*num_channels, chunk);
+        pThread.something_to_play = true;
+    }
     return true;
 }
-
-
@@ -16,6 +16,8 @@
 #include <portaudio.h>
 #include "PortAudioBuffer.h"
 
+#include <vector>
+
 #define DEFAULT_SAMPLE_RATE  (44100)
 #define DEFAULT_NUM_CHANNELS    (2)
 #define DEFAULT_DITHER_FLAG     (0)
@@ -37,6 +39,7 @@ public:
     bool wantRead;
     bool wantWrite;
     int deviceNumber;
+    int framesPerBuffer;
 };
 
 class streamThread : public yarp::os::Thread
@@ -66,7 +69,10 @@ private:
     int                 i;
     int                 numSamples;
     int                 numBytes;
+    int                 framesPerBuffer;
     streamThread        pThread;
+    std::vector<SAMPLE> recordBuffer;
+    std::vector<SAMPLE> playBuffer;
 
     PortAudioDeviceDriver(const PortAudioDeviceDriver&);
     void operator=(const PortAudioDeviceDriver&);
@@ -89,6 +95,12 @@ public:
      * channels: Number of channels of input.  Specify
      * 0 to use a default.
      *
+     * framesPerBuffer: Number of frames passed to each call of the
+     * audio callback.  Specify 0 to use a default.  The recorded
+     * sounds are available as soon as the callback has written
+     * their last frame, so the latency of the recording is
+     * bounded by samples plus framesPerBuffer.
+     *
      * read: Should allow reading
      *
      * write: Should allow writing
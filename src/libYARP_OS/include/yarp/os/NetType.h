@@ -36,6 +36,12 @@ public:
     static ConstString toString(unsigned int x);
     static int toInt(const ConstString& x);
     static unsigned long int getCrc(char *buf, size_t len);
+
+    /**
+     * The CRC-32C (Castagnoli) of a block of bytes, computed with the
+     * crc32 instruction of the processor when available.
+     */
+    static unsigned long int getCrc32c(const char *buf, size_t len);
 };
 
 #endif // YARP_OS_NETTYPE_H
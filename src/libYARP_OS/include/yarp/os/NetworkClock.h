@@ -21,6 +21,20 @@ namespace yarp {
 }
 
 
+/**
+ * A clock driven by the time published on a port, for example by a
+ * simulator or by `yarp clock`.
+ *
+ * Threads sleeping in delay() are kept ordered by deadline, and each tick
+ * only wakes up the expired ones. now() does not lock.
+ *
+ * If the YARP_CLOCK_SHMEM environment variable is set, and the source of
+ * the time runs on the same host and publishes it in shared memory (see
+ * `yarp clock --shmem`), now() reads the time from there. The port is
+ * still used to wake up the sleeping threads, delay() counts in its time,
+ * and now() falls back to it when the shared memory is not updated for a
+ * second, e.g. because its producer stopped.
+ */
 class YARP_OS_API yarp::os::NetworkClock : public Clock, PortReader {
 public:
     NetworkClock();
@@ -36,17 +50,12 @@ public:
 private:
 
     ConstString clockName;
-    void *pwaiters;
     Port port;
 
-    Mutex listMutex;
-    Mutex timeMutex;
-
-    YARP_INT32 sec;
-    YARP_INT32 nsec;
-    double _time;
-    bool closing;
-    bool initted;
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+    class Private;
+    Private* mPriv;
+#endif // DOXYGEN_SHOULD_SKIP_THIS
 };
 
 #endif // YARP_OS_NETWORKCLOCK_H
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2018 Istituto Italiano di Tecnologia (IIT)
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ */
+
+#ifndef YARP_OS_PERIODICEXECUTOR_H
+#define YARP_OS_PERIODICEXECUTOR_H
+
+#include <yarp/os/api.h>
+
+namespace yarp {
+    namespace os {
+        class PeriodicExecutor;
+        class RateThread;
+        namespace impl {
+            class PeriodicTask;
+        }
+    }
+}
+
+/**
+ * \ingroup key_class
+ *
+ * A pool of threads running many periodic tasks.
+ *
+ * Each RateThread normally owns an OS thread that sleeps most of the time.
+ * A RateThread can instead be assigned to an executor, see
+ * RateThread::setExecutor(), before it is started: its iterations are then
+ * scheduled on absolute deadlines by the executor and run by one of its
+ * worker threads. The RateThread interface does not change: threadInit(),
+ * run() and threadRelease() are still called in this order, and
+ * getEstPeriod(), getEstUsed() and the other statistics are still updated.
+ *
+ * Tasks sharing an executor should not block in run(), since this delays
+ * the other tasks assigned to the same worker.
+ *
+ * \code{.cpp}
+ * yarp::os::PeriodicExecutor executor(2);
+ * executor.start();
+ * MyRateThread t1(10), t2(20);
+ * t1.setExecutor(&executor);
+ * t2.setExecutor(&executor);
+ * t1.start();
+ * t2.start();
+ * ...
+ * t1.stop();
+ * t2.stop();
+ * executor.stop();
+ * \endcode
+ */
+class YARP_OS_API yarp::os::PeriodicExecutor
+{
+public:
+    /**
+     * Constructor. The executor begins in a dormant state, call start() to
+     * create the worker threads.
+     * @param workers number of threads running the tasks.
+     */
+    PeriodicExecutor(int workers = 1);
+
+    /**
+     * Destructor. Stops the workers. The tasks must be stopped before.
+     */
+    virtual ~PeriodicExecutor();
+
+    /**
+     * Create the worker threads.
+     * @return true on success.
+     */
+    bool start();
+
+    /**
+     * Stop the worker threads. Tasks still assigned to the executor are
+     * stopped first.
+     */
+    void stop();
+
+    /**
+     * @return true if the workers are running.
+     */
+    bool isRunning();
+
+    /**
+     * @return the number of worker threads.
+     */
+    int getWorkers();
+
+    /**
+     * @return the number of tasks currently scheduled.
+     */
+    int getTasks();
+
+    /**
+     * Set the priority and scheduling policy of the worker threads, see
+     * RateThread::setPriority(). It can be called before or after start().
+     * @return -1 if the priority cannot be set.
+     */
+    int setPriority(int priority, int policy = -1);
+
+    /**
+     * Bind the worker threads to a set of CPUs (supported on Linux only).
+     * It must be called before start(), which fails if the workers cannot
+     * be bound, e.g. to CPUs not available to the process.
+     * @param cpus array with the indexes of the CPUs
+     * @param count number of elements of cpus, 0 to remove the binding
+     * @return false if an index is out of range, or on other platforms.
+     */
+    bool setAffinity(const int* cpus, int count);
+
+private:
+    friend class yarp::os::RateThread;
+
+    bool add(yarp::os::impl::PeriodicTask* task);
+    bool remove(yarp::os::impl::PeriodicTask* task, bool wait, double seconds = -1);
+    bool isScheduled(yarp::os::impl::PeriodicTask* task);
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+    class Private;
+    Private* mPriv;
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+};
+
+#endif // YARP_OS_PERIODICEXECUTOR_H
@@ -14,6 +14,7 @@ namespace yarp {
         class RateThread;
         class RateThreadWrapper;
         class SystemRateThread;
+        class PeriodicExecutor;
     }
 }
 
@@ -26,15 +27,20 @@ class YARP_OS_API yarp::os::RateThread
 {
 public:
 
+    /**
+     * Number of bins of the histogram returned by getOverrunHistogram().
+     */
+    static const int OverrunHistogramSize = 5;
+
     /**
      * Constructor.  Thread begins in a dormant state.  Call RateThread::start
      * to get things going.
      * @param period The period in milliseconds [ms] between
      * successive calls to the RateThread::run method
      * (remember you need to call RateThread::start first
-     * before anything happens)
+     * before anything happens). Fractions of milliseconds are allowed.
      */
-    RateThread(int period);
+    RateThread(double period);
 
     virtual ~RateThread();
 
@@ -77,10 +83,48 @@ public:
 
     /**
      * Set the (new) rate of the thread.
-     * @param period the rate [ms]
+     * @param period the rate [ms], fractions of milliseconds are allowed.
      * @return true.
      */
-    bool setRate(int period);
+    bool setRate(double period);
+
+    /**
+     * Enable or disable scheduling by absolute deadlines.
+     * When enabled, the n-th iteration is started at start + n * period
+     * instead of sleeping for the period minus the time spent in run(),
+     * therefore the jitter does not accumulate as drift. Iterations that
+     * end after their deadline are counted as deadline misses: the next
+     * one is started immediately, and if the thread is late by more than
+     * a period the deadlines are computed again from the current time.
+     * On the system clock the thread sleeps on a monotonic clock
+     * (clock_nanosleep with TIMER_ABSTIME on Linux).
+     * @param enable true to use absolute deadlines.
+     */
+    void setAbsoluteDeadlines(bool enable);
+
+    /**
+     * @return true if the thread is scheduled by absolute deadlines.
+     */
+    bool hasAbsoluteDeadlines();
+
+    /**
+     * Run the thread on a shared PeriodicExecutor instead of a dedicated
+     * OS thread. Must be called before start(); the executor must be
+     * running when start() is called. While on an executor the iterations
+     * are always scheduled on absolute deadlines, and setPriority(),
+     * getPriority() and getPolicy() return -1: use the ones of the
+     * executor instead. On an executor stop() can be called from run(),
+     * where it behaves like askToStop(). The executor must outlive the
+     * thread.
+     * @param executor the executor, or nullptr to use a dedicated thread.
+     * @return false if the thread is running.
+     */
+    bool setExecutor(yarp::os::PeriodicExecutor* executor);
+
+    /**
+     * @return the executor running the thread, or nullptr.
+     */
+    yarp::os::PeriodicExecutor* getExecutor();
 
     /**
      * Return the current rate of the thread.
@@ -134,6 +178,31 @@ public:
      */
     void getEstUsed(double &av, double &std);
 
+    /**
+     * Return the number of iterations that ended after their deadline
+     * since last reset. Only updated when using absolute deadlines.
+     */
+    unsigned int getDeadlineMisses();
+
+    /**
+     * Return the histogram of the deadline misses since last reset, by
+     * how late the iteration ended: less than 1/4 of the period, 1/4 to
+     * 1/2, 1/2 to 1, 1 to 2, more than 2 periods.
+     * Only updated when using absolute deadlines.
+     * @param bins array filled with the counts
+     * @param size number of elements of bins (OverrunHistogramSize)
+     */
+    void getOverrunHistogram(unsigned int* bins, int size);
+
+    /**
+     * Return the delay between the deadlines and the actual wake up of
+     * the thread since last reset. Only updated when using absolute
+     * deadlines.
+     * @param av average value [ms]
+     * @param max maximum value [ms]
+     */
+    void getWakeupLatency(double &av, double &max);
+
     /**
      * Set the priority and scheduling policy of the thread, if the OS supports that.
      * @param priority the new priority of the thread.
@@ -192,7 +261,9 @@ protected:
      * be executed, the thread will sleep for 7ms.
      *
      * Note: after each run is completed, the thread will call a yield()
-     * in order to facilitate other threads to run.
+     * in order to facilitate other threads to run. When using absolute
+     * deadlines, see setAbsoluteDeadlines(), the yield() is done only
+     * if the thread does not sleep.
      */
     virtual void run() = 0;
 
@@ -228,7 +299,7 @@ private:
     using RateThread::step;
 
 public:
-    SystemRateThread(int period);
+    SystemRateThread(double period);
 
     virtual ~SystemRateThread();
 
@@ -172,6 +172,18 @@ public:
      */
     yarp::os::ConstString findFileByName(const ConstString& name);
 
+    /**
+     *
+     * Find the full path of many files at once, given their names.
+     * The result is a list with a string for each name, in the same
+     * order, which is the path returned by findFileByName, or an empty
+     * string if the file was not found.
+     *
+     * The files are looked for together in each directory of the search
+     * path, so each directory is checked only once for all of them.
+     */
+    yarp::os::Bottle findFilesByName(const Bottle& names);
+
     /**
      *
      * Expand a partial path to a full path.  The path is specified by the
@@ -391,6 +403,9 @@ public:
     yarp::os::ConstString findFileByName(const ConstString& name,
                                    const ResourceFinderOptions& options);
 
+    yarp::os::Bottle findFilesByName(const Bottle& names,
+                                     const ResourceFinderOptions& options);
+
     bool readConfig(Property& config,
                     const ConstString& key,
                     const ResourceFinderOptions& options);
@@ -54,12 +54,14 @@ public:
 
     /**
      *  set a reference to a ConnectionReader
+     *
+     *  An object previously created by cast_as() is kept and, if the
+     *  requested type matches, reused for reading the new data, so that
+     *  its buffers are not reallocated for every message.
      */
     bool setConnectionReader(yarp::os::ConnectionReader& reader) {
         conReader = &reader;
-        if (portable)
-            delete portable;
-        portable = nullptr;
+        beenRead = false;
         return true;
     }
 
@@ -69,7 +71,7 @@ public:
     bool write(yarp::os::ConnectionWriter& connection) {
         if (writer)
             return writer->write(connection);
-        if (portable)
+        if (portable && beenRead)
             return portable->write(connection);
         return false;
     }
@@ -93,11 +95,17 @@ public:
         if (this->reader)
             return dynamic_cast<T*>(this->reader);
 
-        if (!this->portable)
+        if (!this->portable || !beenRead)
         {
             if (!this->conReader)
                 return nullptr;
-            this->portable = new T();
+            if (this->portable && !dynamic_cast<T*>(this->portable))
+            {
+                delete this->portable;
+                this->portable = nullptr;
+            }
+            if (!this->portable)
+                this->portable = new T();
             if (!this->portable->read(*this->conReader))
             {
                 delete this->portable;
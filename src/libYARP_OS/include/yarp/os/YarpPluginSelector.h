@@ -30,6 +30,7 @@ class YARP_OS_API yarp::os::YarpPluginSelector {
 private:
     Bottle plugins;
     Bottle search_path;
+    Property names;
     Property config;
     mutable yarp::os::Mutex mutex;
 public:
@@ -55,6 +56,10 @@ public:
      * Find plugin configuration files, and run [plugin] sections
      * through the select method.
      *
+     * The sections are kept in an index shared by all the selectors,
+     * and saved on disk. The configuration files are read again only
+     * when they, or the plugin directories, are modified.
+     *
      */
     void scan();
 
@@ -69,6 +74,15 @@ public:
         return plugins;
     }
 
+    /**
+     *
+     * @return the section of the plugin called name, among those that
+     * passed the select method during the last call to scan, or an
+     * empty list if there is none.
+     *
+     */
+    Bottle findPlugin(const ConstString& name) const;
+
     /**
      *
      * @return possible locations for plugin libraries found in [search]
@@ -299,7 +299,7 @@ public:
             yarp::os::ManagedBytes& b = *(header[index]);
             return b.used();
         }
-        yarp::os::ManagedBytes& b = *(lst[index-header.size()]);
+        yarp::os::ManagedBytes& b = *(lst[index-header_used]);
         return b.used();
     }
 
@@ -309,7 +309,7 @@ public:
             yarp::os::ManagedBytes& b = *(header[index]);
             return (const char *)b.get();
         }
-        yarp::os::ManagedBytes& b = *(lst[index-header.size()]);
+        yarp::os::ManagedBytes& b = *(lst[index-header_used]);
         return (const char *)b.get();
     }
 
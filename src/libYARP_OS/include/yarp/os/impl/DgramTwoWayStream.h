@@ -12,6 +12,7 @@
 #include <yarp/os/Semaphore.h>
 
 #include <cstdlib>
+#include <vector>
 
 #ifdef YARP_HAS_ACE
 #include <ace/SOCK_Dgram.h>
@@ -22,6 +23,8 @@ namespace yarp {
     namespace os {
         namespace impl {
             class DgramTwoWayStream;
+            class DgramFecState;
+            struct DgramFecStats;
         }
     }
 }
@@ -29,6 +32,23 @@ namespace yarp {
 /**
  * A stream abstraction for datagram communication.  It supports UDP and
  * MCAST.  This class is not concerned with making the stream reliable.
+ *
+ * Each datagram starts with a checksum of its content and a packet code.
+ * The checksum is the CRC-32 of PNG, or the CRC-32C when enabled with
+ * setFastCrc(), in which case the packet code is flagged so that the
+ * receiver knows which one to check.  Receivers accept both.
+ *
+ * On Linux the datagrams are sent and received in batches, with
+ * sendmmsg() and recvmmsg().  The bytes moved in a batch are limited by
+ * YARP_DGRAM_BATCH_SIZE (default 131072, 0 disables the batches).
+ *
+ * With setFec(), each message (the bytes written between two flushes) is
+ * sent as numbered fragments, and every group of fragments is followed
+ * by a parity fragment, the XOR of the group, from which a fragment lost
+ * in the group is rebuilt.  The receivers recognize the fragments, and
+ * reassemble a few messages at a time, in any order; a message that
+ * cannot be rebuilt is dropped as a whole, without disturbing the next
+ * ones.  See getFecStats().
  */
 class YARP_OS_impl_API yarp::os::impl::DgramTwoWayStream : public TwoWayStream, public InputStream, public OutputStream
 {
@@ -43,7 +63,10 @@ public:
                           mutex(1), readAt(0), readAvail(0),
                           writeAvail(0), pct(0), happy(true),
                           bufferAlertNeeded(false), bufferAlerted(false),
-                          multiMode(false), errCount(0), lastReportTime(0)
+                          multiMode(false), errCount(0), lastReportTime(0),
+                          fastCrc(false), fec(nullptr), writeHeader(0),
+                          readSlots(1), readSlotSize(0), readNext(0), readCount(0),
+                          writeSlots(1), writeSlotSize(0), writeSlot(0)
     {
     }
 
@@ -140,6 +163,38 @@ public:
 
     virtual void onMonitorOutput() {}
 
+    /**
+     * Check the datagrams that are sent with the CRC-32C, which is much
+     * faster than the default checksum.  Only enable it when the receiver
+     * is known to accept it.
+     */
+    void setFastCrc(bool fast)
+    {
+        fastCrc = fast;
+    }
+
+    bool getFastCrc() const
+    {
+        return fastCrc;
+    }
+
+    /**
+     * Send the messages as fragments with forward error correction.
+     * Only enable it when the receivers are known to accept it, and
+     * before writing.
+     * @param group the number of fragments protected by a parity
+     * fragment, 0 to disable the correction
+     */
+    void setFec(int group);
+
+    int getFec() const;
+
+    /**
+     * @return the statistics of the messages received with forward
+     * error correction
+     */
+    DgramFecStats getFecStats() const;
+
 private:
     yarp::os::ManagedBytes monitor;
     bool closed, interrupting, reader;
@@ -164,10 +219,58 @@ private:
     bool multiMode;
     int errCount;
     double lastReportTime;
+    bool fastCrc;
+    DgramFecState *fec;
+    YARP_SSIZE_T writeHeader;
+
+    // the buffers are split in slots of one datagram each, sent or
+    // received in a single system call
+    int readSlots;
+    YARP_SSIZE_T readSlotSize;
+    int readNext, readCount;
+    std::vector<YARP_SSIZE_T> readLengths;
+    int writeSlots;
+    YARP_SSIZE_T writeSlotSize;
+    int writeSlot;
+    std::vector<YARP_SSIZE_T> writeLengths;
 
     void allocate(int readSize=0, int writeSize=0);
 
+    YARP_SSIZE_T receiveDatagrams();
+
+    YARP_SSIZE_T sendDatagram(char *buf, YARP_SSIZE_T length);
+
+    void sealSlot(bool last = false);
+
+    void sealParity(bool last);
+
+    bool receiveFragment(char *buf, YARP_SSIZE_T length);
+
+    void sendSlots();
+
     void configureSystemBuffers();
 };
 
+
+/**
+ * Statistics of the messages received with forward error correction.
+ */
+struct YARP_OS_impl_API yarp::os::impl::DgramFecStats
+{
+    long messages;              ///< messages received
+    long lostMessages;          ///< messages dropped, not rebuilt in time
+    long fragments;             ///< fragments received, data and parity
+    long recoveredFragments;    ///< fragments rebuilt from the parity
+    long badFragments;          ///< fragments with a wrong checksum or header
+
+    DgramFecStats() :
+            messages(0),
+            lostMessages(0),
+            fragments(0),
+            recoveredFragments(0),
+            badFragments(0)
+    {
+    }
+};
+
 #endif // YARP_OS_IMPL_DGRAMTWOWAYSTREAM_H
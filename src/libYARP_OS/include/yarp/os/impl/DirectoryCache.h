@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2018 Istituto Italiano di Tecnologia (IIT)
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ */
+
+#ifndef YARP_OS_IMPL_DIRECTORYCACHE_H
+#define YARP_OS_IMPL_DIRECTORYCACHE_H
+
+#include <yarp/os/api.h>
+#include <yarp/os/ConstString.h>
+#include <yarp/os/Mutex.h>
+
+#include <memory>
+#include <unordered_map>
+
+namespace yarp {
+    namespace os {
+        namespace impl {
+            class DirectoryCache;
+        }
+    }
+}
+
+/**
+ * The listings of the directories searched by the ResourceFinder, shared
+ * by the whole process.
+ *
+ * Checking if a file exists looks for its name in the listing of its
+ * directory, which is read once and then revalidated with a stat of the
+ * directory: it is read again only when the mtime of the directory
+ * changed. So a search of many files in the same directories costs a
+ * stat for each directory, instead of a stat for each file and directory.
+ */
+class YARP_OS_impl_API yarp::os::impl::DirectoryCache
+{
+public:
+    static DirectoryCache& getInstance();
+
+    /**
+     * @return the directory of a path, or an empty string if the path
+     * has no name to look for in a listing (e.g. it ends with a
+     * separator, or it is relative to the current directory).
+     */
+    static ConstString getDirectory(const ConstString& path);
+
+    /**
+     * Check if a path exists, with the same results as a stat.
+     * @param validate if false, the listing of the directory of the path
+     * is used without checking the directory, when it is already cached.
+     */
+    bool exists(const ConstString& path, bool validate = true);
+
+    /**
+     * Forget all the listings.
+     */
+    void clear();
+
+    /**
+     * With the cache disabled, each check is a stat of the path.
+     */
+    void setEnabled(bool enabled);
+
+    bool isEnabled() const;
+
+    /**
+     * @return the number of stat made since the last resetCounters.
+     */
+    int getStatCount() const;
+
+    /**
+     * @return the number of directory listings read since the last
+     * resetCounters.
+     */
+    int getListCount() const;
+
+    void resetCounters();
+
+private:
+    DirectoryCache();
+
+    class Listing;
+
+    std::shared_ptr<const Listing> getListing(const ConstString& dir, bool validate);
+
+    bool stat(const ConstString& path);
+
+    mutable yarp::os::Mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<const Listing>> listings;
+    bool enabled;
+    int stats;
+    int lists;
+};
+
+#endif // YARP_OS_IMPL_DIRECTORYCACHE_H
@@ -28,6 +28,10 @@ namespace yarp {
 
 /**
  * Communicating between two ports via MCAST.
+ *
+ * When YARP_DGRAM_FEC is set on the sender, the messages are sent with
+ * forward error correction (see DgramTwoWayStream::setFec()), and all the
+ * receivers of the group must accept it.
  */
 class yarp::os::impl::McastCarrier : public UdpCarrier {
 protected:
@@ -51,6 +55,7 @@ public:
     virtual ConstString getName() override;
 
     virtual int getSpecifierCode() override;
+    virtual void getHeader(const Bytes& header) override;
     virtual bool sendHeader(ConnectionState& proto) override;
     virtual bool expectExtraHeader(ConnectionState& proto) override;
     virtual bool becomeMcast(ConnectionState& proto, bool sender);
@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2018 Istituto Italiano di Tecnologia (IIT)
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ */
+
+#ifndef YARP_OS_IMPL_PERIODICTASK_H
+#define YARP_OS_IMPL_PERIODICTASK_H
+
+#include <yarp/os/PeriodicExecutor.h>
+
+/**
+ * A task run periodically by a yarp::os::PeriodicExecutor.
+ * All the methods are called by one of the workers of the executor.
+ */
+class yarp::os::impl::PeriodicTask
+{
+public:
+    virtual ~PeriodicTask() {}
+
+    /**
+     * Called once, before the first step.
+     * @return false to reject the task.
+     */
+    virtual bool taskInit() = 0;
+
+    /**
+     * Called once, after the last step.
+     */
+    virtual void taskRelease() = 0;
+
+    /**
+     * Run a single iteration.
+     */
+    virtual void taskStep() = 0;
+
+    /**
+     * @return the period of the task in seconds.
+     */
+    virtual double taskPeriod() = 0;
+};
+
+#endif // YARP_OS_IMPL_PERIODICTASK_H
@@ -22,6 +22,7 @@ namespace impl {
     typedef ACE_DIRENT dirent;
     typedef ACE_DIR DIR;
     using ACE_OS::opendir;
+    using ACE_OS::readdir;
     using ACE_OS::closedir;
     using ACE_OS::scandir;
     inline int alphasort(const ACE_DIRENT **f1, const ACE_DIRENT **f2) { return ACE_OS::alphasort(f1, f2); }
@@ -29,6 +30,7 @@ namespace impl {
     using ::dirent;
     using ::DIR;
     using ::opendir;
+    using ::readdir;
     using ::closedir;
     using ::scandir;
     using ::alphasort;
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2018 Istituto Italiano di Tecnologia (IIT)
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ */
+
+#ifndef YARP_OS_IMPL_SHAREDMEMORYCLOCK_H
+#define YARP_OS_IMPL_SHAREDMEMORYCLOCK_H
+
+#include <yarp/os/api.h>
+#include <yarp/os/ConstString.h>
+
+namespace yarp {
+    namespace os {
+        namespace impl {
+            class SharedMemoryClock;
+        }
+    }
+}
+
+/**
+ * The time published by a clock port, shared with the processes running
+ * on the same host through a POSIX shared memory segment.
+ *
+ * The producer (`yarp clock --shmem`) writes each tick in the segment,
+ * protected by a sequence lock, and the NetworkClock of the processes on
+ * the same host reads the current time from there instead of waiting for
+ * the port message (see the YARP_CLOCK_SHMEM environment variable).
+ * The segment name is derived from the name of the clock port.
+ * Not available on Windows.
+ */
+class YARP_OS_impl_API yarp::os::impl::SharedMemoryClock
+{
+public:
+    SharedMemoryClock();
+    virtual ~SharedMemoryClock();
+
+    /**
+     * Create the segment, used by the producer of the time.
+     */
+    bool create(const ConstString& clockPortName);
+
+    /**
+     * Open an existing segment, used by the readers of the time.
+     */
+    bool open(const ConstString& clockPortName);
+
+    void close();
+
+    bool isOpen() const;
+
+    /**
+     * Publish a new time.
+     */
+    void write(int sec, int nsec);
+
+    /**
+     * Read the last published time.
+     * @param maxAge if not negative, the time is not read when it was
+     * published more than maxAge seconds ago (of system time), e.g.
+     * because the producer stopped.
+     * @return false if nothing was published yet, or if it is too old.
+     */
+    bool read(int& sec, int& nsec, double maxAge = -1) const;
+
+    /**
+     * @return the name of the segment used for the given clock port.
+     */
+    static ConstString getSegmentName(const ConstString& clockPortName);
+
+private:
+    void* segment;
+    bool owner;
+    ConstString name;
+};
+
+#endif // YARP_OS_IMPL_SHAREDMEMORYCLOCK_H
@@ -21,6 +21,15 @@ namespace yarp {
 
 /**
  * Communicating between two ports via UDP.
+ *
+ * The sender offers to check the datagrams with the CRC-32C by a flag in
+ * the header, the receiver accepts by a flag in the port number of its
+ * reply.  A peer that does not know the flags ignores them, and the
+ * datagrams keep the old checksum.
+ *
+ * In the same way, when YARP_DGRAM_FEC is set to the size of the groups
+ * of fragments, the sender offers to send the messages with forward
+ * error correction (see DgramTwoWayStream::setFec()).
  */
 class yarp::os::impl::UdpCarrier : public AbstractCarrier
 {
@@ -40,6 +49,10 @@ public:
     virtual bool isConnectionless() override;
     virtual bool respondToHeader(ConnectionState& proto) override;
     virtual bool expectReplyToHeader(ConnectionState& proto) override;
+
+protected:
+    bool fastCrc;
+    int fecGroup;
 };
 
 #endif // YARP_OS_IMPL_UDPCARRIER_H
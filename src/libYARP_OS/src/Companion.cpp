@@ -37,6 +37,7 @@
 #include <yarp/os/impl/PlatformUnistd.h>
 #include <yarp/os/impl/PortCommand.h>
 #include <yarp/os/impl/PortCore.h>
+#include <yarp/os/impl/SharedMemoryClock.h>
 #include <yarp/os/impl/StreamConnectionReader.h>
 
 #include <algorithm>
@@ -2738,6 +2739,7 @@ int Companion::cmdClock(int argc, char *argv[])
     double period = config.check("period", Value(30), "update period, default 30ms").asDouble() /1000.0;
     double timeFactor = config.check("rtf", Value(1), "real time factor. Upscale or downscale the clock frequency by a multiplier factor. Default 1").asDouble();
     bool system = config.check("systemTime", "Publish system clock. If false time starts from zero. Default false");
+    bool shmem = config.check("shmem", "Publish the time in shared memory as well, for the processes running on this host. Default false");
     bool help = config.check("help");
 
     if(help)
@@ -2748,6 +2750,7 @@ int Companion::cmdClock(int argc, char *argv[])
         printf("name:       name of yarp port to be opened. Default: check YARP_CLOCK environment variable; if missing use '/clock'\n");
         printf("rtf:        realt time factor. Elapsed time will be multiplied by this factor to simulate faster or slower then real time clock frequency. Default 1 (real time)\n");
         printf("systemTime: If present the published time will start at the same value as system clock. If if not present (default) the published time will start from 0. \n");
+        printf("shmem:      If present the time is published in shared memory as well. The processes running on this host read it from there when YARP_CLOCK_SHMEM is set.\n");
         printf("help:       print this help\n");
         printf("\n");
         return 1;
@@ -2769,6 +2772,7 @@ int Companion::cmdClock(int argc, char *argv[])
     printf("name   %s\n", portName.c_str());                    std::fflush(stdout);
     printf("rtf    %.3f\n", timeFactor);                        std::fflush(stdout);
     printf("system %s\n", system?"true":"false");               std::fflush(stdout);
+    printf("shmem  %s\n", shmem?"true":"false");                std::fflush(stdout);
 
     if(!streamPort.open(portName) )
     {
@@ -2776,6 +2780,13 @@ int Companion::cmdClock(int argc, char *argv[])
         return 1;
     }
 
+    SharedMemoryClock shmemClock;
+    if (shmem && !shmemClock.create(portName))
+    {
+        printf("yarp clock error: Cannot create the shared memory segment %s\n", SharedMemoryClock::getSegmentName(portName).c_str());
+        return 1;
+    }
+
     printf("\n\n");                                             std::fflush(stdout);
     double sec, nsec, elapsed;
     double time = clock.now();
@@ -2804,6 +2815,9 @@ int Companion::cmdClock(int argc, char *argv[])
         tick.addInt((int)sec);
         tick.addInt((int)nsec);
         streamPort.write();
+        if (shmem) {
+            shmemClock.write((int)sec, (int)nsec);
+        }
 
         if( (((int) elapsed %5) == 0))
         {
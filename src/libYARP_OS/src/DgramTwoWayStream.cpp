@@ -40,15 +40,48 @@ using namespace yarp::os;
 #define CRC_SIZE 8
 #define UDP_MAX_DATAGRAM_SIZE 65507 - CRC_SIZE
 
+// packet code flag of the datagrams checked with the CRC-32C
+#define CRC32C_FLAG 0x40000000
+// packet code flag of the fragments with forward error correction
+#define FEC_FLAG 0x20000000
+
+// After the checksum, a fragment has the id of its message, its index
+// (the index of the group for a parity fragment), the flags, the size of
+// the groups and of the fragments, and, in the last fragments of the
+// message, the number of data fragments and the size of the message.
+#define FEC_HEADER_SIZE 28
+#define FEC_PARITY 1
+#define FEC_LAST 2
+// messages reassembled at the same time
+#define FEC_MAX_PENDING 4
+#define FEC_MAX_GROUP 255
+#define FEC_MAX_MESSAGE_SIZE (64*1024*1024)
+// ids of the messages older than the last one received, that are late
+// fragments and not a new sender
+#define FEC_WINDOW 64
+
+#if !defined(YARP_HAS_ACE) && defined(__linux__)
+// sendmmsg() and recvmmsg() move several datagrams with a single call
+#  define YARP_DGRAM_HAS_MMSG
+#endif
+
+#define DGRAM_BATCH_SIZE 131072
+#define DGRAM_MAX_SLOTS 64
+#define DGRAM_READ_SLOT_SIZE 65536
+
 
 static bool checkCrc(char *buf, YARP_SSIZE_T length, YARP_SSIZE_T crcLength, int pct,
                      int *store_altPct = nullptr) {
-    NetInt32 alt =
-        (NetInt32)NetType::getCrc(buf+crcLength, (length>crcLength)?(length-crcLength):0);
     Bytes b(buf, 4);
     Bytes b2(buf+4, 4);
     NetInt32 curr = NetType::netInt(b);
     int altPct = NetType::netInt(b2);
+    bool crc32c = (altPct>=0 && (altPct&CRC32C_FLAG)!=0);
+    altPct &= ~(crc32c?CRC32C_FLAG:0);
+    size_t dataLength = (length>crcLength)?(length-crcLength):0;
+    NetInt32 alt = crc32c ?
+        (NetInt32)NetType::getCrc32c(buf+crcLength, dataLength) :
+        (NetInt32)NetType::getCrc(buf+crcLength, dataLength);
     bool ok = (alt == curr && pct==altPct);
     if (!ok) {
         if (alt!=curr) {
@@ -66,17 +99,188 @@ static bool checkCrc(char *buf, YARP_SSIZE_T length, YARP_SSIZE_T crcLength, int
 }
 
 
-static void addCrc(char *buf, YARP_SSIZE_T length, YARP_SSIZE_T crcLength, int pct) {
-    NetInt32 alt =
-        (NetInt32)NetType::getCrc(buf+crcLength,
-                                           (length>crcLength)?(length-crcLength):0);
+static void addCrc(char *buf, YARP_SSIZE_T length, YARP_SSIZE_T crcLength, int pct,
+                   bool crc32c) {
+    size_t dataLength = (length>crcLength)?(length-crcLength):0;
+    // the interrupt datagrams (pct -1) are never flagged
+    crc32c = crc32c && pct>=0;
+    NetInt32 alt = crc32c ?
+        (NetInt32)NetType::getCrc32c(buf+crcLength, dataLength) :
+        (NetInt32)NetType::getCrc(buf+crcLength, dataLength);
     Bytes b(buf, 4);
     Bytes b2(buf+4, 4);
     NetType::netInt((NetInt32)alt, b);
-    NetType::netInt((NetInt32)pct, b2);
+    NetType::netInt((NetInt32)(crc32c?(pct|CRC32C_FLAG):pct), b2);
 }
 
 
+// difference of two message ids, that wrap around
+static int fecAge(int id, int ref) {
+    return (int)((unsigned int)ref-(unsigned int)id);
+}
+
+namespace yarp {
+namespace os {
+namespace impl {
+
+/**
+ * A message being reassembled from its fragments.
+ */
+class DgramFecMessage
+{
+public:
+    int id;
+    int group;
+    int fragSize;
+    int count;                  // data fragments, -1 until known
+    int length;                 // bytes, -1 until known
+    std::vector<char> data;
+    std::vector<bool> have;
+    std::vector<std::vector<char> > parity;
+
+    DgramFecMessage(int id, int group, int fragSize) :
+            id(id),
+            group(group),
+            fragSize(fragSize),
+            count(-1),
+            length(-1)
+    {
+    }
+
+    YARP_SSIZE_T fragmentLength(int index) const
+    {
+        return (index==count-1) ? length-(YARP_SSIZE_T)index*fragSize : fragSize;
+    }
+
+    // Rebuild the fragments that can be rebuilt, and check that nothing
+    // is missing
+    bool complete(DgramFecStats& stats)
+    {
+        if (count<0) {
+            return false;
+        }
+        have.resize(count, false);
+        data.resize(length);
+        for (int first=0; first<count; first+=group) {
+            int last = (first+group<count) ? first+group : count;
+            int lost = -1;
+            int lostCount = 0;
+            for (int i=first; i<last; i++) {
+                if (!have[i]) {
+                    lost = i;
+                    lostCount++;
+                }
+            }
+            if (lostCount==0) {
+                continue;
+            }
+            int g = first/group;
+            if (lostCount>1 || g>=(int)parity.size() || parity[g].empty()) {
+                return false;
+            }
+            YARP_SSIZE_T len = fragmentLength(lost);
+            if ((YARP_SSIZE_T)parity[g].size()<len) {
+                return false;
+            }
+            char *dest = &data[(size_t)lost*fragSize];
+            memcpy(dest, parity[g].data(), len);
+            for (int i=first; i<last; i++) {
+                if (i==lost) {
+                    continue;
+                }
+                const char *src = &data[(size_t)i*fragSize];
+                YARP_SSIZE_T n = fragmentLength(i);
+                if (n>len) {
+                    n = len;
+                }
+                for (YARP_SSIZE_T k=0; k<n; k++) {
+                    dest[k] ^= src[k];
+                }
+            }
+            have[lost] = true;
+            stats.recoveredFragments++;
+        }
+        return true;
+    }
+};
+
+/**
+ * The state of the forward error correction of a stream: the message
+ * being sent, and the messages being received.
+ */
+class DgramFecState
+{
+public:
+    // sender
+    int group;
+    int fragSize;
+    int sendId;
+    int sendIndex;
+    YARP_SSIZE_T sendLength;
+    std::vector<char> parity;
+    YARP_SSIZE_T parityLength;
+
+    // receiver
+    std::vector<DgramFecMessage> pending;
+    bool started;
+    int lastId;
+    std::vector<char> output;
+    size_t outputAt;
+    DgramFecStats stats;
+    long reportedLost;
+    long reportedRecovered;
+    double lastReportTime;
+
+    DgramFecState() :
+            group(0),
+            fragSize(0),
+            sendId(0),
+            sendIndex(0),
+            sendLength(0),
+            parityLength(0),
+            started(false),
+            lastId(0),
+            outputAt(0),
+            reportedLost(0),
+            reportedRecovered(0),
+            lastReportTime(0)
+    {
+    }
+
+    // Drop a message, and ignore its late fragments
+    void drop(size_t i)
+    {
+        if (!started || fecAge(pending[i].id, lastId)<0) {
+            lastId = pending[i].id;
+            started = true;
+        }
+        stats.lostMessages++;
+        pending.erase(pending.begin()+i);
+    }
+
+    void report()
+    {
+        if (stats.lostMessages==reportedLost && stats.recoveredFragments==reportedRecovered) {
+            return;
+        }
+        double now = SystemClock::nowSystem();
+        if (now-lastReportTime>1) {
+            YARP_INFO(Logger::get(),
+                      ConstString("*** datagram fragments: ") +
+                      NetType::toString((int)(stats.recoveredFragments-reportedRecovered)) + " recovered, " +
+                      NetType::toString((int)(stats.lostMessages-reportedLost)) + " message(s) dropped ***");
+            reportedLost = stats.lostMessages;
+            reportedRecovered = stats.recoveredFragments;
+            lastReportTime = now;
+        }
+    }
+};
+
+} // namespace impl
+} // namespace os
+} // namespace yarp
+
+
 bool DgramTwoWayStream::open(const Contact& remote) {
 #if defined(YARP_HAS_ACE)
     ACE_INET_Addr anywhere((u_short)0, (ACE_UINT32)INADDR_ANY);
@@ -240,11 +444,62 @@ void DgramTwoWayStream::allocate(int readSize, int writeSize) {
         #endif
     }
 
-    readBuffer.allocate(_read_size);
-    writeBuffer.allocate(_write_size);
+    int _batch_size = 0;
+#if defined(YARP_DGRAM_HAS_MMSG)
+    if (dgram != nullptr) {
+        _batch_size = DGRAM_BATCH_SIZE;
+        ConstString _env_batch = NetworkBase::getEnvironment("YARP_DGRAM_BATCH_SIZE");
+        if (_env_batch!="") {
+            _batch_size = NetType::toInt(_env_batch);
+        }
+    }
+#endif
+
+    // A datagram is never larger than 64kB, a larger read buffer is
+    // split in slots that a single recvmmsg() fills
+    readSlots = 1;
+    readSlotSize = _read_size;
+    if (_batch_size>0) {
+        int batch = (_batch_size<_read_size) ? _batch_size : _read_size;
+        if (readSlotSize>DGRAM_READ_SLOT_SIZE) {
+            readSlotSize = DGRAM_READ_SLOT_SIZE;
+        }
+        readSlots = batch/readSlotSize;
+        if (readSlots<1) {
+            readSlots = 1;
+            readSlotSize = _read_size;
+        }
+        if (readSlots>DGRAM_MAX_SLOTS) {
+            readSlots = DGRAM_MAX_SLOTS;
+        }
+    }
+    writeSlots = 1;
+    writeSlotSize = _write_size;
+    if (_batch_size>0) {
+        writeSlots = _batch_size/_write_size;
+        if (writeSlots<1) {
+            writeSlots = 1;
+        }
+        if (writeSlots>DGRAM_MAX_SLOTS) {
+            writeSlots = DGRAM_MAX_SLOTS;
+        }
+    }
+
+    readBuffer.allocate(readSlots*readSlotSize);
+    writeBuffer.allocate(writeSlots*writeSlotSize);
+    readLengths.assign(readSlots, 0);
+    writeLengths.assign(writeSlots, 0);
     readAt = 0;
     readAvail = 0;
-    writeAvail = CRC_SIZE;
+    readNext = 0;
+    readCount = 0;
+    writeHeader = CRC_SIZE;
+    if (fec != nullptr && fec->group>0) {
+        writeHeader += FEC_HEADER_SIZE;
+        fec->fragSize = (int)(writeSlotSize-writeHeader);
+    }
+    writeAvail = writeHeader;
+    writeSlot = 0;
     //happy = true;
     pct = 0;
 }
@@ -625,6 +880,39 @@ bool DgramTwoWayStream::join(const Contact& group, bool sender,
 
 DgramTwoWayStream::~DgramTwoWayStream() {
     closeMain();
+    delete fec;
+}
+
+void DgramTwoWayStream::setFec(int group) {
+    if (group>FEC_MAX_GROUP) {
+        group = FEC_MAX_GROUP;
+    }
+    if (group<0) {
+        group = 0;
+    }
+    if (fec == nullptr) {
+        if (group==0) {
+            return;
+        }
+        fec = new DgramFecState;
+        yAssert(fec!=nullptr);
+        // a sender that restarts does not reuse the ids of the messages
+        // it sent before
+        fec->sendId = (int)((long long)(SystemClock::nowSystem()*1000)&0x3fffffff);
+    }
+    fec->group = group;
+    writeHeader = CRC_SIZE+((group>0)?FEC_HEADER_SIZE:0);
+    fec->fragSize = (int)(writeSlotSize-writeHeader);
+    writeAvail = writeHeader;
+    writeSlot = 0;
+}
+
+int DgramTwoWayStream::getFec() const {
+    return (fec != nullptr) ? fec->group : 0;
+}
+
+DgramFecStats DgramTwoWayStream::getFecStats() const {
+    return (fec != nullptr) ? fec->stats : DgramFecStats();
 }
 
 void DgramTwoWayStream::interrupt() {
@@ -737,6 +1025,17 @@ YARP_SSIZE_T DgramTwoWayStream::read(const Bytes& b) {
             return -1;
         }
 
+        // a message reassembled from its fragments
+        if (fec != nullptr && fec->outputAt<fec->output.size()) {
+            size_t take = fec->output.size()-fec->outputAt;
+            if (take>b.length()) {
+                take = b.length();
+            }
+            memcpy(b.get(), &fec->output[fec->outputAt], take);
+            fec->outputAt += take;
+            return take;
+        }
+
         // if nothing is available, try to grab stuff
         if (readAvail==0) {
             readAt = 0;
@@ -745,6 +1044,12 @@ YARP_SSIZE_T DgramTwoWayStream::read(const Bytes& b) {
             //yAssert(dgram != nullptr);
             //YARP_DEBUG(Logger::get(), "DGRAM Waiting for something!");
             YARP_SSIZE_T result = -1;
+            if (readNext<readCount) {
+                // a datagram left by the last batch
+                readAt = readNext*readSlotSize;
+                result = readLengths[readNext];
+                readNext++;
+            } else
 #if defined(YARP_HAS_ACE)
             if (dgram && restrictInterfaceIp.isValid()) {
                 /*
@@ -767,14 +1072,7 @@ YARP_SSIZE_T DgramTwoWayStream::read(const Bytes& b) {
 #endif
             if (dgram != nullptr) {
                 yAssert(dgram != nullptr);
-#if defined(YARP_HAS_ACE)
-                ACE_INET_Addr dummy((u_short)0, (ACE_UINT32)INADDR_ANY);
-                //YARP_DEBUG(Logger::get(), "DGRAM Waiting for something!");
-                result =
-                    dgram->recv(readBuffer.get(), readBuffer.length(), dummy);
-#else
-                result = recv(dgram_sockfd, readBuffer.get(), readBuffer.length(), 0);
-#endif
+                result = receiveDatagrams();
                 YARP_DEBUG(Logger::get(),
                            ConstString("DGRAM Got ") + NetType::toString((int)result) +
                            " bytes");
@@ -804,9 +1102,24 @@ YARP_SSIZE_T DgramTwoWayStream::read(const Bytes& b) {
             }
             readAvail = result;
 
+            if (readAvail>=CRC_SIZE+FEC_HEADER_SIZE) {
+                Bytes code(readBuffer.get()+readAt+4, 4);
+                int flags = NetType::netInt(code);
+                if (flags>=0 && (flags&FEC_FLAG)!=0) {
+                    receiveFragment(readBuffer.get()+readAt, readAvail);
+                    readAvail = 0;
+                    continue;
+                }
+            }
+            if (readAvail==0 && dgram == nullptr) {
+                // nothing more to monitor
+                reset();
+                return -1;
+            }
+
             // deal with CRC
             int altPct = 0;
-            bool crcOk = checkCrc(readBuffer.get(), readAvail, CRC_SIZE, pct,
+            bool crcOk = checkCrc(readBuffer.get()+readAt, readAvail, CRC_SIZE, pct,
                                   &altPct);
             if (altPct!=-1) {
                 pct++;
@@ -866,6 +1179,181 @@ YARP_SSIZE_T DgramTwoWayStream::read(const Bytes& b) {
     return 0;
 }
 
+bool DgramTwoWayStream::receiveFragment(char *buf, YARP_SSIZE_T length) {
+    if (fec == nullptr) {
+        fec = new DgramFecState;
+        yAssert(fec!=nullptr);
+    }
+    DgramFecStats& stats = fec->stats;
+    if (!checkCrc(buf, length, CRC_SIZE, FEC_FLAG)) {
+        stats.badFragments++;
+        return false;
+    }
+    stats.fragments++;
+
+    int header[FEC_HEADER_SIZE/4];
+    for (int i=0; i<FEC_HEADER_SIZE/4; i++) {
+        Bytes b(buf+CRC_SIZE+4*i, 4);
+        header[i] = NetType::netInt(b);
+    }
+    int id = header[0];
+    int index = header[1];
+    int flags = header[2];
+    int group = header[3];
+    int fragSize = header[4];
+    int count = header[5];
+    int total = header[6];
+    char *payload = buf+CRC_SIZE+FEC_HEADER_SIZE;
+    YARP_SSIZE_T len = length-CRC_SIZE-FEC_HEADER_SIZE;
+    bool parity = (flags&FEC_PARITY)!=0;
+    bool last = (flags&FEC_LAST)!=0;
+    if (group<1 || group>FEC_MAX_GROUP || fragSize<1 || len>fragSize || index<0) {
+        stats.badFragments++;
+        return false;
+    }
+    // bound the index before the size of the message is known: a parity
+    // fragment covers a group of data fragments
+    int maxFragments = (FEC_MAX_MESSAGE_SIZE+fragSize-1)/fragSize;
+    int maxIndex = parity ? (maxFragments+group-1)/group : maxFragments;
+    if (index>=maxIndex ||
+            (last && (count<1 || total<=(YARP_SSIZE_T)(count-1)*fragSize ||
+                      total>(YARP_SSIZE_T)count*fragSize ||
+                      (size_t)count*fragSize>FEC_MAX_MESSAGE_SIZE))) {
+        stats.badFragments++;
+        return false;
+    }
+
+    if (fec->started) {
+        int age = fecAge(id, fec->lastId);
+        if (age>=0 && age<FEC_WINDOW) {
+            // a late fragment of a message received or dropped
+            return false;
+        }
+    }
+
+    std::vector<DgramFecMessage>& pending = fec->pending;
+    size_t at = 0;
+    while (at<pending.size() && pending[at].id!=id) {
+        at++;
+    }
+    if (at==pending.size()) {
+        if (pending.size()>=FEC_MAX_PENDING) {
+            // the oldest message will not be completed in time
+            size_t oldest = 0;
+            for (size_t i=1; i<pending.size(); i++) {
+                if (fecAge(pending[i].id, pending[oldest].id)>0) {
+                    oldest = i;
+                }
+            }
+            fec->drop(oldest);
+            at = pending.size();
+        }
+        pending.push_back(DgramFecMessage(id, group, fragSize));
+    }
+    DgramFecMessage& msg = pending[at];
+    if (msg.group!=group || msg.fragSize!=fragSize) {
+        stats.badFragments++;
+        return false;
+    }
+    if (last && msg.count>=0 && (msg.count!=count || msg.length!=total)) {
+        stats.badFragments++;
+        return false;
+    }
+    // once the size of the message is known, the fragments must fit in it
+    int msgCount = last ? count : msg.count;
+    YARP_SSIZE_T msgLength = last ? total : msg.length;
+    if (msgCount>=0) {
+        bool fits;
+        if (parity) {
+            fits = (YARP_SSIZE_T)index*group<msgCount;
+        } else {
+            YARP_SSIZE_T fragLength = (index==msgCount-1) ?
+                msgLength-(YARP_SSIZE_T)index*fragSize : fragSize;
+            fits = index<msgCount && len<=fragLength;
+        }
+        if (!fits) {
+            stats.badFragments++;
+            return false;
+        }
+    }
+    if (last) {
+        msg.count = count;
+        msg.length = total;
+    }
+    if (parity) {
+        if ((int)msg.parity.size()<=index) {
+            msg.parity.resize(index+1);
+        }
+        msg.parity[index].assign(payload, payload+len);
+    } else {
+        size_t offset = (size_t)index*fragSize;
+        if (msg.data.size()<offset+len) {
+            msg.data.resize(offset+len);
+        }
+        if ((int)msg.have.size()<=index) {
+            msg.have.resize(index+1, false);
+        }
+        memcpy(&msg.data[offset], payload, len);
+        msg.have[index] = true;
+    }
+
+    if (!msg.complete(stats)) {
+        fec->report();
+        return false;
+    }
+
+    // deliver the message, the older ones are not waited for anymore
+    fec->output.swap(msg.data);
+    fec->outputAt = 0;
+    fec->started = true;
+    fec->lastId = id;
+    stats.messages++;
+    pending.erase(pending.begin()+at);
+    for (size_t i=0; i<pending.size(); ) {
+        if (fecAge(pending[i].id, id)>0) {
+            fec->drop(i);
+        } else {
+            i++;
+        }
+    }
+    fec->report();
+    return true;
+}
+
+YARP_SSIZE_T DgramTwoWayStream::receiveDatagrams() {
+#if defined(YARP_HAS_ACE)
+    ACE_INET_Addr dummy((u_short)0, (ACE_UINT32)INADDR_ANY);
+    //YARP_DEBUG(Logger::get(), "DGRAM Waiting for something!");
+    return dgram->recv(readBuffer.get(), readBuffer.length(), dummy);
+#else
+#  if defined(YARP_DGRAM_HAS_MMSG)
+    if (readSlots>1) {
+        struct mmsghdr msgs[DGRAM_MAX_SLOTS];
+        struct iovec iovecs[DGRAM_MAX_SLOTS];
+        memset(msgs, 0, sizeof(msgs));
+        for (int i=0; i<readSlots; i++) {
+            iovecs[i].iov_base = readBuffer.get()+i*readSlotSize;
+            iovecs[i].iov_len = readSlotSize;
+            msgs[i].msg_hdr.msg_iov = &iovecs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        // wait for a datagram, then take the ones already queued
+        int n = recvmmsg(dgram_sockfd, msgs, readSlots, MSG_WAITFORONE, nullptr);
+        if (n<=0) {
+            return -1;
+        }
+        for (int i=0; i<n; i++) {
+            readLengths[i] = msgs[i].msg_len;
+        }
+        readCount = n;
+        readNext = 1;
+        return readLengths[0];
+    }
+#  endif
+    return recv(dgram_sockfd, readBuffer.get(), readBuffer.length(), 0);
+#endif
+}
+
 void DgramTwoWayStream::write(const Bytes& b) {
     //YARP_DEBUG(Logger::get(), "DGRAM prep writing");
     //printf("DGRAM write %d bytes\n", b.length());
@@ -880,19 +1368,22 @@ void DgramTwoWayStream::write(const Bytes& b) {
     Bytes local = b;
     while (local.length()>0) {
         //YARP_DEBUG(Logger::get(), "DGRAM prep writing");
+        if (writeAvail==writeSlotSize) {
+            // the datagram is sealed when more data follows, so that the
+            // last one of a message is known
+            sealSlot();
+            if (writeSlot==writeSlots) {
+                sendSlots();
+            }
+        }
         YARP_SSIZE_T rem = local.length();
-        YARP_SSIZE_T space = writeBuffer.length()-writeAvail;
-        bool shouldFlush = false;
-        if (rem>=space) {
+        YARP_SSIZE_T space = writeSlotSize-writeAvail;
+        if (rem>space) {
             rem = space;
-            shouldFlush = true;
         }
-        memcpy(writeBuffer.get()+writeAvail, local.get(), rem);
+        memcpy(writeBuffer.get()+writeSlot*writeSlotSize+writeAvail, local.get(), rem);
         writeAvail+=rem;
         local = Bytes(local.get()+rem, local.length()-rem);
-        if (shouldFlush) {
-            flush();
-        }
     }
 }
 
@@ -901,88 +1392,215 @@ void DgramTwoWayStream::flush() {
     if (writeBuffer.get() == nullptr) {
         return;
     }
+    sealSlot(true);
+    sendSlots();
+}
+
+
+static void setFecHeader(char *buf, int id, int index, int flags, int group,
+                         int fragSize, int count, YARP_SSIZE_T total) {
+    int header[FEC_HEADER_SIZE/4] = { id, index, flags, group, fragSize,
+                                      (flags&FEC_LAST)?count:0,
+                                      (flags&FEC_LAST)?(int)total:0 };
+    for (int i=0; i<FEC_HEADER_SIZE/4; i++) {
+        Bytes b(buf+CRC_SIZE+4*i, 4);
+        NetType::netInt(header[i], b);
+    }
+}
+
 
+void DgramTwoWayStream::sealSlot(bool last) {
     // should set CRC
-    if (writeAvail<=CRC_SIZE) {
+    if (writeAvail<=writeHeader) {
         return;
     }
-    addCrc(writeBuffer.get(), writeAvail, CRC_SIZE, pct);
-    pct++;
+    char *buf = writeBuffer.get()+writeSlot*writeSlotSize;
+    if (writeHeader==CRC_SIZE) {
+        addCrc(buf, writeAvail, CRC_SIZE, pct, fastCrc);
+        pct++;
+        writeLengths[writeSlot] = writeAvail;
+        writeSlot++;
+    } else {
+        DgramFecState& f = *fec;
+        YARP_SSIZE_T len = writeAvail-writeHeader;
+        if (f.sendIndex%f.group==0) {
+            f.parity.assign(f.fragSize, 0);
+            f.parityLength = 0;
+        }
+        const char *payload = buf+writeHeader;
+        for (YARP_SSIZE_T k=0; k<len; k++) {
+            f.parity[k] ^= payload[k];
+        }
+        if (len>f.parityLength) {
+            f.parityLength = len;
+        }
+        f.sendLength += len;
+        setFecHeader(buf, f.sendId, f.sendIndex, last?FEC_LAST:0, f.group,
+                     f.fragSize, f.sendIndex+1, f.sendLength);
+        addCrc(buf, writeAvail, CRC_SIZE, FEC_FLAG, fastCrc);
+        writeLengths[writeSlot] = writeAvail;
+        writeSlot++;
+        f.sendIndex++;
+        if (last || f.sendIndex%f.group==0) {
+            sealParity(last);
+        }
+        if (last) {
+            f.sendId++;
+            f.sendIndex = 0;
+            f.sendLength = 0;
+        }
+    }
 
-    if (writeAvail>0) {
-        //yAssert(dgram != nullptr);
-        YARP_SSIZE_T len = 0;
+    // make space for CRC
+    writeAvail = writeHeader;
+}
 
-#if defined(YARP_HAS_ACE)
-        if (mgram != nullptr) {
-            len = mgram->send(writeBuffer.get(), writeAvail);
-            YARP_DEBUG(Logger::get(),
-                       ConstString("MCAST - wrote ") +
-                       NetType::toString((int)len) + " bytes"
-                       );
-        } else
-#endif
-            if (dgram != nullptr) {
-#if defined(YARP_HAS_ACE)
-            len = dgram->send(writeBuffer.get(), writeAvail,
-                              remoteHandle);
-#else
-            len = send(dgram_sockfd, writeBuffer.get(),
-                       writeAvail, 0);
-#endif
-            YARP_DEBUG(Logger::get(),
-                       ConstString("DGRAM - wrote ") +
-                       NetType::toString((int)len) + " bytes to " +
-                       remoteAddress.toString()
-                       );
-        } else {
-            Bytes b(writeBuffer.get(), writeAvail);
-            monitor = ManagedBytes(b, false);
-            monitor.copy();
-            //printf("Monitored output of %d bytes\n", monitor.length());
-            len = monitor.length();
-            onMonitorOutput();
+
+void DgramTwoWayStream::sealParity(bool last) {
+    if (writeSlot==writeSlots) {
+        sendSlots();
+    }
+    DgramFecState& f = *fec;
+    char *buf = writeBuffer.get()+writeSlot*writeSlotSize;
+    memcpy(buf+writeHeader, f.parity.data(), f.parityLength);
+    setFecHeader(buf, f.sendId, (f.sendIndex-1)/f.group,
+                 FEC_PARITY|(last?FEC_LAST:0), f.group, f.fragSize,
+                 f.sendIndex, f.sendLength);
+    addCrc(buf, writeHeader+f.parityLength, CRC_SIZE, FEC_FLAG, fastCrc);
+    writeLengths[writeSlot] = writeHeader+f.parityLength;
+    writeSlot++;
+}
+
+
+void DgramTwoWayStream::sendSlots() {
+    if (writeSlot==0) {
+        return;
+    }
+
+    int longDatagrams = 0;
+    bool ok = true;
+#if defined(YARP_DGRAM_HAS_MMSG)
+    if (writeSlots>1 && dgram != nullptr) {
+        struct mmsghdr msgs[DGRAM_MAX_SLOTS];
+        struct iovec iovecs[DGRAM_MAX_SLOTS];
+        memset(msgs, 0, sizeof(msgs));
+        for (int i=0; i<writeSlot; i++) {
+            iovecs[i].iov_base = writeBuffer.get()+i*writeSlotSize;
+            iovecs[i].iov_len = writeLengths[i];
+            msgs[i].msg_hdr.msg_iov = &iovecs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
         }
-        //if (len>WRITE_SIZE*0.75) {
-        if (len>writeBuffer.length()*0.75) {
-            YARP_DEBUG(Logger::get(),
-                       "long dgrams might need a little time");
-
-            // Under heavy loads, packets could get dropped
-            // 640x480x3 images correspond to about 15 datagrams
-            // so there's not much time possible between them
-            // looked at iperf, it just does a busy-waiting delay
-            // there's an implementation below, but commented out -
-            // better solution was to increase recv buffer size
-
-            double first = yarp::os::SystemClock::nowSystem();
-            double now;
-            int ct = 0;
-            do {
-                //printf("Busy wait... %d\n", ct);
-                yarp::os::SystemClock::delaySystem(0);
-                now = yarp::os::SystemClock::nowSystem();
-                ct++;
-            } while (now-first<0.001);
+        int sent = 0;
+        while (sent<writeSlot) {
+            int n = sendmmsg(dgram_sockfd, msgs+sent, writeSlot-sent, 0);
+            if (n<0) {
+                YARP_DEBUG(Logger::get(), "DGRAM failed to send message with error: " + ConstString(strerror(errno)));
+                ok = false;
+                break;
+            }
+            for (int i=sent; i<sent+n; i++) {
+                if ((YARP_SSIZE_T)msgs[i].msg_len!=writeLengths[i]) {
+                    // well, we have a problem
+                    // checksums will cause dumping
+                    YARP_DEBUG(Logger::get(), "dgram/mcast send behaving badly");
+                }
+                if (msgs[i].msg_len>writeSlotSize*0.75) {
+                    longDatagrams++;
+                }
+            }
+            sent += n;
         }
-
-        if (len < 0) {
-            happy = false;
-            YARP_DEBUG(Logger::get(), "DGRAM failed to send message with error: " + ConstString(strerror(errno)));
-            return;
+        YARP_DEBUG(Logger::get(),
+                   ConstString("DGRAM - wrote ") +
+                   NetType::toString(sent) + " datagrams to " +
+                   remoteAddress.toString()
+                   );
+    } else
+#endif
+    {
+        for (int i=0; i<writeSlot && ok; i++) {
+            YARP_SSIZE_T len = sendDatagram(writeBuffer.get()+i*writeSlotSize,
+                                            writeLengths[i]);
+            if (len < 0) {
+                YARP_DEBUG(Logger::get(), "DGRAM failed to send message with error: " + ConstString(strerror(errno)));
+                ok = false;
+            } else if (len!=writeLengths[i]) {
+                // well, we have a problem
+                // checksums will cause dumping
+                YARP_DEBUG(Logger::get(), "dgram/mcast send behaving badly");
+            }
+            //if (len>WRITE_SIZE*0.75) {
+            if (len>writeSlotSize*0.75) {
+                longDatagrams++;
+            }
         }
-        writeAvail -= len;
+    }
+    writeSlot = 0;
 
-        if (writeAvail!=0) {
-            // well, we have a problem
-            // checksums will cause dumping
-            YARP_DEBUG(Logger::get(), "dgram/mcast send behaving badly");
-        }
+    if (!ok) {
+        happy = false;
+        return;
     }
-    // finally: writeAvail should be 0
 
-    // make space for CRC
-    writeAvail = CRC_SIZE;
+    if (longDatagrams>0) {
+        YARP_DEBUG(Logger::get(),
+                   "long dgrams might need a little time");
+
+        // Under heavy loads, packets could get dropped
+        // 640x480x3 images correspond to about 15 datagrams
+        // so there's not much time possible between them
+        // looked at iperf, it just does a busy-waiting delay
+        // there's an implementation below, but commented out -
+        // better solution was to increase recv buffer size
+        // A batch waits for all its long datagrams, and is small enough
+        // to fit the receive buffer of the socket.
+
+        double first = yarp::os::SystemClock::nowSystem();
+        double now;
+        int ct = 0;
+        do {
+            //printf("Busy wait... %d\n", ct);
+            yarp::os::SystemClock::delaySystem(0);
+            now = yarp::os::SystemClock::nowSystem();
+            ct++;
+        } while (now-first<0.001*longDatagrams);
+    }
+}
+
+
+YARP_SSIZE_T DgramTwoWayStream::sendDatagram(char *buf, YARP_SSIZE_T length) {
+    //yAssert(dgram != nullptr);
+    YARP_SSIZE_T len = 0;
+
+#if defined(YARP_HAS_ACE)
+    if (mgram != nullptr) {
+        len = mgram->send(buf, length);
+        YARP_DEBUG(Logger::get(),
+                   ConstString("MCAST - wrote ") +
+                   NetType::toString((int)len) + " bytes"
+                   );
+    } else
+#endif
+        if (dgram != nullptr) {
+#if defined(YARP_HAS_ACE)
+        len = dgram->send(buf, length, remoteHandle);
+#else
+        len = send(dgram_sockfd, buf, length, 0);
+#endif
+        YARP_DEBUG(Logger::get(),
+                   ConstString("DGRAM - wrote ") +
+                   NetType::toString((int)len) + " bytes to " +
+                   remoteAddress.toString()
+                   );
+    } else {
+        Bytes b(buf, length);
+        monitor = ManagedBytes(b, false);
+        monitor.copy();
+        //printf("Monitored output of %d bytes\n", monitor.length());
+        len = monitor.length();
+        onMonitorOutput();
+    }
+    return len;
 }
 
 
@@ -994,14 +1612,25 @@ bool DgramTwoWayStream::isOk() {
 void DgramTwoWayStream::reset() {
     readAt = 0;
     readAvail = 0;
-    writeAvail = CRC_SIZE;
+    writeAvail = writeHeader;
+    writeSlot = 0;
     pct = 0;
+    if (fec != nullptr && fec->sendIndex>0) {
+        // the message being sent is abandoned
+        fec->sendId++;
+        fec->sendIndex = 0;
+        fec->sendLength = 0;
+    }
 }
 
 
 void DgramTwoWayStream::beginPacket() {
     //YARP_ERROR(Logger::get(), ConstString("Packet begins: ")+(reader?"reader":"writer"));
     pct = 0;
+    if (reader && fec != nullptr) {
+        // the rest of a message not read completely is not the next one
+        fec->outputAt = fec->output.size();
+    }
 }
 
 void DgramTwoWayStream::endPacket() {
@@ -0,0 +1,218 @@
+/*
+ * Copyright (C) 2018 Istituto Italiano di Tecnologia (IIT)
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ */
+
+#include <yarp/os/impl/DirectoryCache.h>
+
+#include <yarp/os/LockGuard.h>
+#include <yarp/os/Os.h>
+#include <yarp/os/SystemClock.h>
+#include <yarp/os/impl/PlatformDirent.h>
+#include <yarp/os/impl/PlatformSysStat.h>
+
+#include <cctype>
+#include <string>
+#include <unordered_set>
+
+using namespace yarp::os;
+using namespace yarp::os::impl;
+
+namespace {
+
+std::string toLower(const std::string& txt)
+{
+    std::string result = txt;
+    for (size_t i=0; i<result.length(); i++) {
+        result[i] = (char)tolower((unsigned char)result[i]);
+    }
+    return result;
+}
+
+} // namespace
+
+class DirectoryCache::Listing
+{
+public:
+    Listing() : present(false), unreadable(false), mtime(0), racy(false) {}
+
+    bool present;
+    // the directory exists but cannot be listed, each path is checked
+    bool unreadable;
+    long long mtime;
+    // the mtime has a resolution of a second, a change in the same second
+    // of the listing may not be seen, so such a listing is read again
+    bool racy;
+    std::unordered_set<std::string> names;
+    // lower case names, the file system may not care about the case
+    std::unordered_set<std::string> folded;
+    // symbolic links, which are found by stat only if their target is,
+    // and entries whose type is not known, which may be links
+    std::unordered_set<std::string> links;
+};
+
+
+DirectoryCache& DirectoryCache::getInstance()
+{
+    static DirectoryCache instance;
+    return instance;
+}
+
+DirectoryCache::DirectoryCache() :
+        enabled(true),
+        stats(0),
+        lists(0)
+{
+}
+
+ConstString DirectoryCache::getDirectory(const ConstString& path)
+{
+    size_t n = path.find_last_of("/\\");
+    if (n == ConstString::npos) {
+        return "";
+    }
+    ConstString name = path.substr(n + 1);
+    if (name == "" || name == "." || name == "..") {
+        return "";
+    }
+    // keep the separator of the root directory, e.g. "/" or "C:\"
+    if (n == 0 || (n == 2 && path[1] == ':')) {
+        return path.substr(0, n + 1);
+    }
+    return path.substr(0, n);
+}
+
+bool DirectoryCache::exists(const ConstString& path, bool validate)
+{
+    ConstString dir = getDirectory(path);
+    if (dir == "" || !isEnabled()) {
+        return stat(path);
+    }
+    std::shared_ptr<const Listing> listing = getListing(dir, validate);
+    if (!listing->present) {
+        return false;
+    }
+    if (listing->unreadable) {
+        return stat(path);
+    }
+    std::string name = path.substr(path.find_last_of("/\\") + 1);
+    if (listing->names.count(name) != 0) {
+        if (listing->links.count(name) == 0) {
+            return true;
+        }
+        return stat(path);
+    }
+    if (listing->folded.count(toLower(name)) != 0) {
+        return stat(path);
+    }
+    return false;
+}
+
+std::shared_ptr<const DirectoryCache::Listing> DirectoryCache::getListing(const ConstString& dir, bool validate)
+{
+    {
+        LockGuard guard(mutex);
+        auto it = listings.find(dir);
+        if (it != listings.end() && !validate) {
+            return it->second;
+        }
+    }
+
+    std::shared_ptr<Listing> listing = std::make_shared<Listing>();
+    YARP_stat st;
+    {
+        LockGuard guard(mutex);
+        stats++;
+    }
+    if (yarp::os::impl::stat(dir.c_str(), &st) == 0) {
+        listing->present = true;
+        listing->mtime = (long long)st.st_mtime;
+    }
+
+    {
+        LockGuard guard(mutex);
+        auto it = listings.find(dir);
+        if (it != listings.end() &&
+                !it->second->racy &&
+                it->second->present == listing->present &&
+                it->second->mtime == listing->mtime) {
+            return it->second;
+        }
+    }
+
+    if (listing->present) {
+        listing->racy = listing->mtime >= (long long)SystemClock::nowSystem() - 1;
+        DIR* handle = yarp::os::impl::opendir(dir.c_str());
+        if (handle != nullptr) {
+            dirent* entry;
+            while ((entry = yarp::os::impl::readdir(handle)) != nullptr) {
+                std::string name = entry->d_name;
+                listing->names.insert(name);
+                listing->folded.insert(toLower(name));
+#if defined(_DIRENT_HAVE_D_TYPE)
+                if (entry->d_type == DT_LNK || entry->d_type == DT_UNKNOWN) {
+                    listing->links.insert(name);
+                }
+#endif
+            }
+            yarp::os::impl::closedir(handle);
+        } else {
+            // not a directory, or not readable: e.g. a directory that can
+            // be searched but not listed, its paths can still be found
+            listing->unreadable = true;
+        }
+    }
+
+    LockGuard guard(mutex);
+    if (listing->present && !listing->unreadable) {
+        lists++;
+    }
+    listings[dir] = listing;
+    return listing;
+}
+
+bool DirectoryCache::stat(const ConstString& path)
+{
+    {
+        LockGuard guard(mutex);
+        stats++;
+    }
+    return yarp::os::stat(path.c_str()) == 0;
+}
+
+void DirectoryCache::clear()
+{
+    LockGuard guard(mutex);
+    listings.clear();
+}
+
+void DirectoryCache::setEnabled(bool enabled)
+{
+    LockGuard guard(mutex);
+    this->enabled = enabled;
+}
+
+bool DirectoryCache::isEnabled() const
+{
+    LockGuard guard(mutex);
+    return enabled;
+}
+
+int DirectoryCache::getStatCount() const
+{
+    LockGuard guard(mutex);
+    return stats;
+}
+
+int DirectoryCache::getListCount() const
+{
+    LockGuard guard(mutex);
+    return lists;
+}
+
+void DirectoryCache::resetCounters()
+{
+    LockGuard guard(mutex);
+    stats = 0;
+    lists = 0;
+}
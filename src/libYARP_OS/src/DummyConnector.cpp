@@ -8,7 +8,9 @@
 #include <yarp/os/DummyConnector.h>
 #include <yarp/os/impl/BufferedConnectionWriter.h>
 #include <yarp/os/impl/StreamConnectionReader.h>
-#include <yarp/os/StringInputStream.h>
+#include <yarp/os/InputStream.h>
+
+#include <cstring>
 
 
 using namespace yarp::os::impl;
@@ -25,11 +27,72 @@ public:
     }
 };
 
+/**
+ * An InputStream that reads straight out of the blocks of a
+ * BufferedConnectionWriter, so that whatever was written (including
+ * external blocks such as image payloads) is not flattened into an
+ * intermediate string before being read back.
+ */
+class DummyConnectorInputStream : public InputStream {
+public:
+    using InputStream::read;
+
+    DummyConnectorInputStream() :
+            src(nullptr),
+            index(0),
+            offset(0)
+    {
+    }
+
+    void reset(SizedWriter *src) {
+        this->src = src;
+        index = 0;
+        offset = 0;
+    }
+
+    virtual YARP_SSIZE_T read(const Bytes& b) override {
+        char *base = b.get();
+        size_t space = b.length();
+        YARP_SSIZE_T ct = 0;
+        if (src == nullptr) {
+            return 0;
+        }
+        size_t blocks = src->length();
+        while (space>0 && index<blocks) {
+            size_t avail = src->length(index) - offset;
+            if (avail == 0) {
+                index++;
+                offset = 0;
+                continue;
+            }
+            size_t len = (avail<space) ? avail : space;
+            memcpy(base, src->data(index) + offset, len);
+            base += len;
+            space -= len;
+            offset += len;
+            ct += len;
+        }
+        return ct;
+    }
+
+    virtual void close() override {
+    }
+
+    virtual bool isOk() override {
+        return true;
+    }
+
+private:
+    SizedWriter *src;
+    size_t index;
+    size_t offset;
+};
+
 class DummyConnectorHelper {
 private:
     BufferedConnectionWriter writer;
     DummyConnectorReader reader;
-    StringInputStream sis;
+    DummyConnectorInputStream dis;
     bool textMode;
 public:
 
@@ -60,11 +123,9 @@ public:
     ConnectionReader& getReader()
     {
         writer.stopWrite();
-        ConstString s = writer.toString();
-        sis.reset();
-        sis.add(s);
+        dis.reset(&writer);
         Route r;
-        reader.reset(sis, nullptr, r, s.length(), textMode);
+        reader.reset(dis, nullptr, r, writer.dataSize(), textMode);
         return reader;
     }
 
@@ -69,6 +69,12 @@ int yarp::os::impl::McastCarrier::getSpecifierCode() {
     return 1;
 }
 
+void yarp::os::impl::McastCarrier::getHeader(const Bytes& header) {
+    // the receivers of a group share the datagrams, they keep the old
+    // checksum that all of them accept
+    createStandardHeader(getSpecifierCode(), header);
+}
+
 
 bool yarp::os::impl::McastCarrier::sendHeader(ConnectionState& proto) {
     // need to do more than the default
@@ -200,6 +206,11 @@ bool yarp::os::impl::McastCarrier::becomeMcast(ConnectionState& proto, bool send
         delete stream;
         return false;
     }
+    if (sender) {
+        // the receivers cannot be asked, all of them must accept the
+        // fragments
+        stream->setFec(fecGroup);
+    }
     proto.takeStreams(stream);
     return true;
 }
@@ -10,55 +10,253 @@
 #include <yarp/os/NestedContact.h>
 #include <yarp/os/Os.h>
 #include <yarp/os/impl/Logger.h>
+#include <yarp/os/impl/SharedMemoryClock.h>
 #include <yarp/os/Network.h>
 #include <yarp/conf/system.h>
-#include <list>
-#include <utility>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
 #include <string.h>
 
 
 using namespace yarp::os;
 using namespace yarp::os::impl;
 
-typedef std::list<std::pair<double, Semaphore*> > Waiters;
+namespace {
 
-NetworkClock::NetworkClock()
-    : clockName(""), pwaiters(nullptr), sec(0), nsec(0), _time(0), closing(false), initted(false)
+// A thread sleeping in delay(). Waiters are recycled, so that sleeping
+// does not allocate once the clock reached its steady state.
+struct Waiter
+{
+    double deadline;
+    Semaphore sem;
+
+    Waiter() : deadline(0), sem(0) {}
+};
+
+// Order the heap so that the earliest deadline is on top
+struct LaterDeadline
+{
+    bool operator()(const Waiter* a, const Waiter* b) const
+    {
+        return a->deadline > b->deadline;
+    }
+};
+
+// Number of ticks between two attempts to open the shared memory clock
+const int SHMEM_RETRY_TICKS = 100;
+
+// Seconds without updates after which the time in shared memory is
+// considered stale, and the time received from the port is used instead
+const double SHMEM_STALE_TIME = 1.0;
+
+} // namespace
+
+
+class NetworkClock::Private
 {
-    pwaiters = new Waiters();
-    if(pwaiters==nullptr)
+public:
+    Private() :
+            seq(0),
+            sec(0),
+            nsec(0),
+            closing(false),
+            initted(false),
+            inFlight(0),
+            useShmem(false),
+            shmemRetry(0),
+            shmem(nullptr)
+    {
+    }
+
+    ~Private()
+    {
+        for (size_t i = 0; i < pool.size(); i++) {
+            delete pool[i];
+        }
+        for (size_t i = 0; i < retired.size(); i++) {
+            delete retired[i];
+        }
+        delete shmem.load();
+    }
+
+    // Read the time from the shared memory, if it is still updated
+    bool getShmemTime(double& time) const
+    {
+        const SharedMemoryClock* clock = shmem.load(std::memory_order_acquire);
+        int s, ns;
+        if (clock == nullptr || !clock->read(s, ns, SHMEM_STALE_TIME)) {
+            return false;
+        }
+        time = s + (ns * 1e-9);
+        return true;
+    }
+
+    // Called with listMutex locked, by the thread reading the port only.
+    // The segment is replaced when missing or stale, e.g. because the
+    // source of the time was restarted, and the old one is kept until
+    // the clock is destroyed, since now() may still be reading it.
+    void refreshShmem(const ConstString& clockName)
+    {
+        double time;
+        if (getShmemTime(time)) {
+            shmemRetry = 0;
+            return;
+        }
+        if (++shmemRetry < SHMEM_RETRY_TICKS) {
+            return;
+        }
+        shmemRetry = 0;
+        SharedMemoryClock* clock = new SharedMemoryClock;
+        int s, ns;
+        if (!clock->open(clockName) || !clock->read(s, ns, SHMEM_STALE_TIME)) {
+            delete clock;
+            return;
+        }
+        SharedMemoryClock* old = shmem.exchange(clock, std::memory_order_acq_rel);
+        if (old != nullptr) {
+            retired.push_back(old);
+        }
+    }
+
+    // Called with listMutex locked, by the thread reading the port only
+    void setTime(YARP_INT32 s, YARP_INT32 ns)
+    {
+        unsigned int v = seq.load(std::memory_order_relaxed);
+        seq.store(v + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        sec.store(s, std::memory_order_relaxed);
+        nsec.store(ns, std::memory_order_relaxed);
+        seq.store(v + 2, std::memory_order_release);
+    }
+
+    double getTime() const
+    {
+        unsigned int v1, v2;
+        YARP_INT32 s, ns;
+        do {
+            v1 = seq.load(std::memory_order_acquire);
+            s = sec.load(std::memory_order_relaxed);
+            ns = nsec.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            v2 = seq.load(std::memory_order_relaxed);
+        } while ((v1 & 1) != 0 || v1 != v2);
+        return s + (ns * 1e-9);
+    }
+
+    // Read the tick without building a Bottle. The message is expected to
+    // be a list with at least two integers, seconds and nanoseconds.
+    static bool readTick(ConnectionReader& reader, YARP_INT32& s, YARP_INT32& ns)
     {
-        YARP_FAIL(Logger::get(), "NetworkClock: new Waiters() failed");
+        if (reader.isTextMode()) {
+            Bottle bot;
+            if (!bot.read(reader) || bot.size() < 2) {
+                return false;
+            }
+            s = bot.get(0).asInt();
+            ns = bot.get(1).asInt();
+            return true;
+        }
+
+        int code = reader.expectInt();
+        int len = reader.expectInt();
+        if (reader.isError() || (code & BOTTLE_TAG_LIST) == 0 || len < 2) {
+            return false;
+        }
+        code &= ~BOTTLE_TAG_LIST;
+
+        YARP_INT32 values[2] = { 0, 0 };
+        for (int i = 0; i < len; i++) {
+            int tag = code;
+            if (tag == 0) {
+                tag = reader.expectInt();
+            }
+            YARP_INT32 v;
+            switch (tag) {
+            case BOTTLE_TAG_INT:
+            case BOTTLE_TAG_VOCAB:
+                v = reader.expectInt();
+                break;
+            case BOTTLE_TAG_INT64:
+                v = (YARP_INT32)reader.expectInt64();
+                break;
+            case BOTTLE_TAG_DOUBLE:
+                v = (YARP_INT32)reader.expectDouble();
+                break;
+            default:
+                // Anything else cannot be a time, and cannot be skipped
+                // without parsing it
+                if (i < 2) {
+                    return false;
+                }
+                return !reader.isError();
+            }
+            if (i < 2) {
+                values[i] = v;
+            }
+        }
+        if (reader.isError()) {
+            return false;
+        }
+        s = values[0];
+        ns = values[1];
+        return true;
     }
+
+    std::mutex listMutex;
+    std::condition_variable idle;
+    std::vector<Waiter*> waiters;   // heap, earliest deadline first
+    std::vector<Waiter*> pool;
+
+    // seqlock protecting the time, written under listMutex
+    std::atomic<unsigned int> seq;
+    std::atomic<YARP_INT32> sec;
+    std::atomic<YARP_INT32> nsec;
+
+    std::atomic<bool> closing;
+    std::atomic<bool> initted;
+    int inFlight;
+
+    bool useShmem;
+    int shmemRetry;
+    std::atomic<SharedMemoryClock*> shmem;
+    std::vector<SharedMemoryClock*> retired;
+};
+
+
+NetworkClock::NetworkClock()
+    : clockName(""), mPriv(new Private)
+{
 }
 
 NetworkClock::~NetworkClock() {
     YARP_WARN(Logger::get(), "Destroying network clock");
 
-    listMutex.lock();
-    closing = true;
-    port.interrupt();
-
-    Waiters* waiters = static_cast<Waiters*>(pwaiters);
-    if (waiters) {
-        Waiters::iterator waiter_i;
-        waiter_i = waiters->begin();
-        while (waiter_i != waiters->end())
-        {
-            Semaphore *waiterSemaphore = waiter_i->second;
-            waiter_i = waiters->erase(waiter_i);
-            if (waiterSemaphore)
-                waiterSemaphore->post();
+    {
+        std::lock_guard<std::mutex> lock(mPriv->listMutex);
+        mPriv->closing = true;
+        for (size_t i = 0; i < mPriv->waiters.size(); i++) {
+            mPriv->waiters[i]->sem.post();
         }
+        mPriv->waiters.clear();
+    }
+    port.interrupt();
 
-        delete waiters;
-        pwaiters = nullptr;
+    // Wait for the woken up threads to give back their waiters
+    {
+        std::unique_lock<std::mutex> lock(mPriv->listMutex);
+        mPriv->idle.wait(lock, [this]() { return mPriv->inFlight == 0; });
     }
 
-    listMutex.unlock();
     yarp::os::ContactStyle style;
     style.persistent = true;
     NetworkBase::disconnect(clockName, port.getName(), style);
+    port.close();
+
+    delete mPriv;
+    mPriv = nullptr;
 }
 
 
@@ -88,6 +286,19 @@ bool NetworkClock::open(const ConstString& clockSourcePortName, ConstString loca
         localPortName += ConstString(hostName) + "/" + ConstString(progName) + "/" + ConstString(std::to_string(pid)) + "/clock:i";
     }
 
+    // The source of the time may publish it in shared memory as well.
+    // It may not be running yet, in this case retry later in read().
+    ConstString shmem = NetworkBase::getEnvironment("YARP_CLOCK_SHMEM");
+    mPriv->useShmem = (shmem != "" && shmem != "0");
+    if (mPriv->useShmem) {
+        SharedMemoryClock* clock = new SharedMemoryClock;
+        if (clock->open(clockSourcePortName)) {
+            mPriv->shmem.store(clock, std::memory_order_release);
+        } else {
+            delete clock;
+        }
+    }
+
     // if receiving port cannot be opened, return false.
     bool ret = port.open(localPortName);
     if (!ret)
@@ -108,10 +319,11 @@ bool NetworkClock::open(const ConstString& clockSourcePortName, ConstString loca
 }
 
 double NetworkClock::now() {
-    timeMutex.lock();
-    double result = _time;
-    timeMutex.unlock();
-    return result;
+    double time;
+    if (mPriv->getShmemTime(time)) {
+        return time;
+    }
+    return mPriv->getTime();
 }
 
 void NetworkClock::delay(double seconds) {
@@ -119,70 +331,80 @@ void NetworkClock::delay(double seconds) {
         return;
     }
 
-    listMutex.lock();
-    if (closing) {
-        // We are shutting down.  The time signal is no longer available.
-        // Make a short delay and return.
-        listMutex.unlock();
+    Waiter* waiter;
+    {
+        std::lock_guard<std::mutex> lock(mPriv->listMutex);
+        if (mPriv->closing) {
+            // We are shutting down.  The time signal is no longer available.
+            // Make a short delay and return.
+            waiter = nullptr;
+        } else {
+            if (mPriv->pool.empty()) {
+                waiter = new Waiter;
+            } else {
+                waiter = mPriv->pool.back();
+                mPriv->pool.pop_back();
+            }
+            // The deadline is in the time of the port, which wakes up
+            // the waiters, not in the one of the shared memory
+            waiter->deadline = mPriv->getTime() + seconds;
+            mPriv->waiters.push_back(waiter);
+            std::push_heap(mPriv->waiters.begin(), mPriv->waiters.end(), LaterDeadline());
+            mPriv->inFlight++;
+        }
+    }
+
+    if (!waiter) {
         SystemClock::delaySystem(seconds);
         return;
     }
 
-    Waiters* waiters = static_cast<Waiters*>(pwaiters);
-
-    std::pair<double, Semaphore*> waiter(now() + seconds, new Semaphore(0));
-    waiters->insert(waiters->end(), waiter);
-    listMutex.unlock();
+    waiter->sem.wait();
 
-    waiter.second->wait();
-    delete waiter.second;
-    waiter.second = nullptr;
+    std::lock_guard<std::mutex> lock(mPriv->listMutex);
+    mPriv->pool.push_back(waiter);
+    mPriv->inFlight--;
+    if (mPriv->closing && mPriv->inFlight == 0) {
+        mPriv->idle.notify_all();
+    }
 }
 
 bool NetworkClock::isValid() const {
-    return initted;
+    double time;
+    return mPriv->initted || mPriv->getShmemTime(time);
 }
 
 bool NetworkClock::read(ConnectionReader& reader) {
-    Bottle bot;
-    bool ok = bot.read(reader);
+    YARP_INT32 s = 0;
+    YARP_INT32 ns = 0;
+    bool ok = Private::readTick(reader, s, ns);
 
-    if(closing)
+    if (mPriv->closing)
     {
-        _time = -1;
         return false;
     }
 
-    if (!ok && !closing)
+    if (!ok)
     {
         YARP_ERROR(Logger::get(), "Error reading clock port");
         return false;
     }
 
-    timeMutex.lock();
-    sec = bot.get(0).asInt();
-    nsec = bot.get(1).asInt();
-    _time = sec + (nsec*1e-9);
-    initted = true;
-    timeMutex.unlock();
+    std::lock_guard<std::mutex> lock(mPriv->listMutex);
+    mPriv->setTime(s, ns);
+    mPriv->initted = true;
 
-    listMutex.lock();
-    Waiters* waiters = static_cast<Waiters*>(pwaiters);
-    Waiters::iterator waiter_i;
+    if (mPriv->useShmem) {
+        mPriv->refreshShmem(clockName);
+    }
 
-    waiter_i = waiters->begin();
-    while (waiter_i != waiters->end())
-    {
-        if (waiter_i->first - _time < 1E-12 )
-        {
-            Semaphore *waiterSemaphore = waiter_i->second;
-            waiter_i = waiters->erase(waiter_i);
-            if (waiterSemaphore)
-                waiterSemaphore->post();
-        }
-        else
-            ++waiter_i;
+    // Only the expired waiters are touched
+    double time = s + (ns * 1e-9);
+    std::vector<Waiter*>& waiters = mPriv->waiters;
+    while (!waiters.empty() && waiters.front()->deadline - time < 1E-12) {
+        std::pop_heap(waiters.begin(), waiters.end(), LaterDeadline());
+        waiters.back()->sem.post();
+        waiters.pop_back();
     }
-    listMutex.unlock();
     return true;
 }
@@ -0,0 +1,475 @@
+/*
+ * Copyright (C) 2018 Istituto Italiano di Tecnologia (IIT)
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ */
+
+#include <yarp/os/PeriodicExecutor.h>
+#include <yarp/os/Semaphore.h>
+#include <yarp/os/Thread.h>
+#include <yarp/os/Time.h>
+
+#include <yarp/os/impl/PeriodicTask.h>
+#include <yarp/os/impl/Logger.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#if defined(__linux__)
+#  include <pthread.h>
+#  include <sched.h>
+#  include <unistd.h>
+#endif
+
+using namespace yarp::os::impl;
+using namespace yarp::os;
+
+namespace {
+
+// Same clocks used by RateThread: deadlines on the system clock are computed
+// on a monotonic clock, otherwise on the clock returned by Time::now().
+double monotonicNow()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+double clockNow()
+{
+    return Time::isSystemClock() ? monotonicNow() : Time::now();
+}
+
+struct Entry
+{
+    PeriodicTask* task;
+    double deadline;
+    bool initialized;
+    bool initOk;
+    bool stopping;
+    bool inHeap;
+    bool finished;
+    int waiting;    // threads waiting for the release, the last one erases
+    Semaphore initDone;
+
+    Entry(PeriodicTask* task) :
+            task(task),
+            deadline(0),
+            initialized(false),
+            initOk(false),
+            stopping(false),
+            inHeap(false),
+            finished(false),
+            waiting(0),
+            initDone(0)
+    {
+    }
+};
+
+// min-heap on the deadline
+struct LaterDeadline
+{
+    bool operator()(const Entry* a, const Entry* b) const
+    {
+        return a->deadline > b->deadline;
+    }
+};
+
+} // namespace
+
+
+class yarp::os::PeriodicExecutor::Private
+{
+    // the executor whose worker is the current thread, if any
+    static thread_local const Private* current;
+
+public:
+    class Worker : public Thread
+    {
+    public:
+        Private& owner;
+
+        Worker(Private& owner) : owner(owner) {}
+
+        bool threadInit() override
+        {
+            current = &owner;
+            return owner.applyAffinity();
+        }
+
+        void run() override
+        {
+            owner.work();
+        }
+    };
+
+    int workerCount;
+    std::vector<Worker*> workers;
+    std::vector<Entry*> entries;
+    std::vector<Entry*> heap;
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::condition_variable released;
+    bool closing;
+
+    int priority;
+    int policy;
+    bool prioritySet;
+    std::vector<int> cpus;
+
+    Private(int workers) :
+            workerCount(workers > 0 ? workers : 1),
+            closing(false),
+            priority(0),
+            policy(-1),
+            prioritySet(false)
+    {
+    }
+
+    ~Private()
+    {
+        for (size_t i = 0; i < entries.size(); i++) {
+            delete entries[i];
+        }
+    }
+
+    bool isWorker() const
+    {
+        return current == this;
+    }
+
+    bool applyAffinity()
+    {
+#if defined(__linux__)
+        // without a binding the workers inherit the affinity of the process
+        if (cpus.empty()) {
+            return true;
+        }
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (size_t i = 0; i < cpus.size(); i++) {
+            CPU_SET(cpus[i], &set);
+        }
+        int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (err != 0) {
+            YARP_ERROR(Logger::get(), ConstString("PeriodicExecutor: cannot bind the worker to the CPUs: ") + strerror(err));
+            return false;
+        }
+#endif
+        return true;
+    }
+
+    Entry* find(PeriodicTask* task)
+    {
+        for (size_t i = 0; i < entries.size(); i++) {
+            if (entries[i]->task == task) {
+                return entries[i];
+            }
+        }
+        return nullptr;
+    }
+
+    void erase(Entry* e)
+    {
+        entries.erase(std::find(entries.begin(), entries.end(), e));
+        delete e;
+    }
+
+    // called with the mutex locked
+    void finish(Entry* e)
+    {
+        e->finished = true;
+        released.notify_all();
+    }
+
+    // called with the mutex locked, wait for the release of the task and
+    // erase its entry
+    bool waitReleased(std::unique_lock<std::mutex>& lock, Entry* e, double seconds)
+    {
+        e->waiting++;
+        bool ok = true;
+        if (seconds > 0) {
+            ok = released.wait_for(lock, std::chrono::duration<double>(seconds),
+                                   [e]() { return e->finished; });
+        } else {
+            released.wait(lock, [e]() { return e->finished; });
+        }
+        e->waiting--;
+        if (ok && e->waiting == 0) {
+            erase(e);
+        }
+        return ok;
+    }
+
+    void push(Entry* e)
+    {
+        e->inHeap = true;
+        heap.push_back(e);
+        std::push_heap(heap.begin(), heap.end(), LaterDeadline());
+        cond.notify_one();
+    }
+
+    // called with the mutex locked, after a step
+    void reschedule(Entry* e, double now)
+    {
+        if (e->stopping) {
+            e->deadline = now;
+        } else {
+            double period = e->task->taskPeriod();
+            e->deadline += period;
+            // do not try to catch up when late by a whole period or more
+            if (period <= 0 || now - e->deadline >= period) {
+                e->deadline = now;
+            }
+        }
+        push(e);
+    }
+
+    void work()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!closing) {
+            if (heap.empty()) {
+                cond.wait(lock);
+                continue;
+            }
+
+            Entry* e = heap.front();
+            double now = clockNow();
+            if (e->deadline > now) {
+                if (Time::isSystemClock()) {
+                    cond.wait_until(lock, std::chrono::steady_clock::time_point(
+                        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                            std::chrono::duration<double>(e->deadline))));
+                } else {
+                    // network or custom clock: poll it
+                    double wait = std::min(e->deadline - now, 0.001);
+                    cond.wait_for(lock, std::chrono::duration<double>(wait));
+                }
+                continue;
+            }
+
+            std::pop_heap(heap.begin(), heap.end(), LaterDeadline());
+            heap.pop_back();
+            e->inHeap = false;
+
+            if (!e->initialized) {
+                lock.unlock();
+                bool ok = e->task->taskInit();
+                lock.lock();
+                e->initialized = true;
+                e->initOk = ok;
+                if (ok) {
+                    e->deadline = clockNow();
+                    push(e);
+                } else {
+                    finish(e);
+                }
+                e->initDone.post();
+            } else if (e->stopping) {
+                lock.unlock();
+                e->task->taskRelease();
+                lock.lock();
+                finish(e);
+            } else {
+                lock.unlock();
+                e->task->taskStep();
+                lock.lock();
+                reschedule(e, clockNow());
+            }
+        }
+    }
+};
+
+thread_local const PeriodicExecutor::Private* PeriodicExecutor::Private::current = nullptr;
+
+
+PeriodicExecutor::PeriodicExecutor(int workers) :
+        mPriv(new Private(workers))
+{
+}
+
+PeriodicExecutor::~PeriodicExecutor()
+{
+    stop();
+    delete mPriv;
+}
+
+bool PeriodicExecutor::start()
+{
+    if (isRunning()) {
+        return false;
+    }
+    mPriv->closing = false;
+    for (int i = 0; i < mPriv->workerCount; i++) {
+        Private::Worker* w = new Private::Worker(*mPriv);
+        if (!w->start()) {
+            YARP_ERROR(Logger::get(), "PeriodicExecutor: cannot start the worker threads");
+            delete w;
+            stop();
+            return false;
+        }
+        if (mPriv->prioritySet) {
+            w->setPriority(mPriv->priority, mPriv->policy);
+        }
+        mPriv->workers.push_back(w);
+    }
+    return true;
+}
+
+void PeriodicExecutor::stop()
+{
+    if (mPriv->workers.empty()) {
+        return;
+    }
+
+    std::vector<PeriodicTask*> tasks;
+    {
+        std::lock_guard<std::mutex> lock(mPriv->mutex);
+        for (size_t i = 0; i < mPriv->entries.size(); i++) {
+            tasks.push_back(mPriv->entries[i]->task);
+        }
+    }
+    for (size_t i = 0; i < tasks.size(); i++) {
+        remove(tasks[i], true);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mPriv->mutex);
+        mPriv->closing = true;
+        mPriv->cond.notify_all();
+    }
+    for (size_t i = 0; i < mPriv->workers.size(); i++) {
+        mPriv->workers[i]->stop();
+        delete mPriv->workers[i];
+    }
+    mPriv->workers.clear();
+}
+
+bool PeriodicExecutor::isRunning()
+{
+    return !mPriv->workers.empty();
+}
+
+int PeriodicExecutor::getWorkers()
+{
+    return mPriv->workerCount;
+}
+
+int PeriodicExecutor::getTasks()
+{
+    std::lock_guard<std::mutex> lock(mPriv->mutex);
+    int count = 0;
+    for (size_t i = 0; i < mPriv->entries.size(); i++) {
+        if (!mPriv->entries[i]->finished) {
+            count++;
+        }
+    }
+    return count;
+}
+
+int PeriodicExecutor::setPriority(int priority, int policy)
+{
+    mPriv->priority = priority;
+    mPriv->policy = policy;
+    mPriv->prioritySet = true;
+    int ret = 0;
+    for (size_t i = 0; i < mPriv->workers.size(); i++) {
+        if (mPriv->workers[i]->setPriority(priority, policy) == -1) {
+            ret = -1;
+        }
+    }
+    return ret;
+}
+
+bool PeriodicExecutor::setAffinity(const int* cpus, int count)
+{
+#if defined(__linux__)
+    if (count < 0 || (count > 0 && cpus == nullptr)) {
+        YARP_ERROR(Logger::get(), "PeriodicExecutor: invalid CPU list");
+        return false;
+    }
+    for (int i = 0; i < count; i++) {
+        if (cpus[i] < 0 || cpus[i] >= CPU_SETSIZE) {
+            YARP_ERROR(Logger::get(), ConstString("PeriodicExecutor: invalid CPU index ") + std::to_string(cpus[i]));
+            return false;
+        }
+    }
+    // each worker applies the affinity to itself when it starts
+    mPriv->cpus.assign(cpus, cpus + count);
+    if (!mPriv->workers.empty()) {
+        YARP_WARN(Logger::get(), "PeriodicExecutor: the affinity will be applied when the executor is restarted");
+    }
+    return true;
+#else
+    YARP_UNUSED(cpus);
+    YARP_UNUSED(count);
+    return false;
+#endif
+}
+
+bool PeriodicExecutor::add(PeriodicTask* task)
+{
+    if (!isRunning()) {
+        YARP_ERROR(Logger::get(), "PeriodicExecutor: cannot add a task, the executor is not running");
+        return false;
+    }
+
+    Entry* e;
+    {
+        std::lock_guard<std::mutex> lock(mPriv->mutex);
+        Entry* old = mPriv->find(task);
+        if (old != nullptr) {
+            if (!old->finished || old->waiting > 0) {
+                return false;
+            }
+            mPriv->erase(old);
+        }
+        e = new Entry(task);
+        mPriv->entries.push_back(e);
+        e->deadline = clockNow();
+        mPriv->push(e);
+    }
+
+    e->initDone.wait();
+    return e->initOk;
+}
+
+bool PeriodicExecutor::remove(PeriodicTask* task, bool wait, double seconds)
+{
+    std::unique_lock<std::mutex> lock(mPriv->mutex);
+    Entry* e = mPriv->find(task);
+    if (e == nullptr) {
+        return true;
+    }
+    if (!e->stopping && !e->finished) {
+        e->stopping = true;
+        if (e->inHeap) {
+            // run the release as soon as possible
+            e->deadline = 0;
+            std::make_heap(mPriv->heap.begin(), mPriv->heap.end(), LaterDeadline());
+            mPriv->cond.notify_one();
+        }
+    }
+    // The release is run by a worker: a worker cannot wait for it, e.g.
+    // when a task is stopped from its own run(), the task is only asked
+    // to stop.
+    if (!wait || mPriv->isWorker()) {
+        if (!e->finished) {
+            return false;
+        }
+        if (e->waiting == 0) {
+            mPriv->erase(e);
+        }
+        return true;
+    }
+    return mPriv->waitReleased(lock, e, seconds);
+}
+
+bool PeriodicExecutor::isScheduled(PeriodicTask* task)
+{
+    std::lock_guard<std::mutex> lock(mPriv->mutex);
+    Entry* e = mPriv->find(task);
+    return e != nullptr && !e->finished && e->initOk;
+}
@@ -5,23 +5,59 @@
 */
 
 #include <yarp/os/RateThread.h>
+#include <yarp/os/PeriodicExecutor.h>
 #include <yarp/os/Semaphore.h>
 #include <yarp/os/Time.h>
 #include <yarp/os/SystemClock.h>
 
 #include <yarp/os/impl/ThreadImpl.h>
+#include <yarp/os/impl/PeriodicTask.h>
 #include <yarp/os/impl/Logger.h>
 #include <yarp/os/impl/PlatformTime.h>
 
 #include <cmath>
+#include <chrono>
+#include <thread>
+
+#if defined(__linux__)
+#  include <cerrno>
+#  include <ctime>
+#endif
 
 using namespace yarp::os::impl;
 using namespace yarp::os;
 
-class yarp::os::RateThread::Private : public ThreadImpl
+namespace {
+
+// Deadlines on the system clock are computed on a monotonic clock, so that
+// changes of the wall clock do not affect the period.
+double monotonicNow()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void sleepUntilMonotonic(double deadline)
+{
+#if defined(__linux__)
+    // steady_clock is CLOCK_MONOTONIC on linux
+    struct timespec ts;
+    ts.tv_sec = static_cast<time_t>(deadline);
+    ts.tv_nsec = static_cast<long>((deadline - ts.tv_sec) * 1e9);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+#else
+    std::this_thread::sleep_until(std::chrono::steady_clock::time_point(
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(deadline))));
+#endif
+}
+
+} // namespace
+
+class yarp::os::RateThread::Private : public ThreadImpl,
+                                      public PeriodicTask
 {
 private:
-    float period_ms;
+    double period_ms;
     double adaptedPeriod;
     RateThread& owner;
     Semaphore mutex;
@@ -42,6 +78,18 @@ private:
     double currentRun;     //time when this iteration started
     bool scheduleReset;
 
+    bool absoluteDeadlines;     // schedule iterations at start + n * period
+    double deadline;            // next wake up time, 0 if not initialized yet
+    unsigned int misses;        // iterations that ended after their deadline
+    unsigned int overruns[RateThread::OverrunHistogramSize];
+    unsigned int wakeups;       // number of sleeps until a deadline
+    double totalLatency;        // accumulated wake up latency
+    double maxLatency;          // worst wake up latency
+
+public:
+    PeriodicExecutor* executor; // if not null, the thread is run by the executor
+private:
+
     void _resetStat()
     {
         totalUsed=0;
@@ -51,12 +99,33 @@ private:
         sumUsedSq=0;
         sumTSq=0;
         elapsed=0;
+        misses=0;
+        for (int i=0; i<RateThread::OverrunHistogramSize; i++)
+            overruns[i]=0;
+        wakeups=0;
+        totalLatency=0;
+        maxLatency=0;
         scheduleReset=false;
     }
 
+    double clockNow()
+    {
+        if (useSystemClock || Time::isSystemClock())
+            return monotonicNow();
+        return Time::now();
+    }
+
+    void sleepUntil(double t)
+    {
+        if (useSystemClock || Time::isSystemClock())
+            sleepUntilMonotonic(t);
+        else
+            Time::delay(t - Time::now());
+    }
+
 public:
 
-    Private(RateThread& owner, int p) :
+    Private(RateThread& owner, double p) :
             period_ms(p),
             adaptedPeriod(period_ms/1000.0),
             owner(owner),
@@ -72,8 +141,17 @@ public:
             sumUsedSq(0),
             previousRun(0),
             currentRun(0),
-            scheduleReset(false)
+            scheduleReset(false),
+            absoluteDeadlines(false),
+            deadline(0),
+            misses(0),
+            wakeups(0),
+            totalLatency(0),
+            maxLatency(0),
+            executor(nullptr)
     {
+        for (int i=0; i<RateThread::OverrunHistogramSize; i++)
+            overruns[i]=0;
     }
 
     void initWithSystemClock()
@@ -155,6 +233,112 @@ public:
     }
 
 
+    unsigned int getDeadlineMisses()
+    {
+        lock();
+        unsigned int ret=misses;
+        unlock();
+        return ret;
+    }
+
+    void getOverrunHistogram(unsigned int* bins, int size)
+    {
+        lock();
+        for (int i=0; i<size; i++)
+            bins[i] = (i < RateThread::OverrunHistogramSize) ? overruns[i] : 0;
+        unlock();
+    }
+
+    void getWakeupLatency(double &av, double &max)
+    {
+        lock();
+        av = (wakeups>0) ? totalLatency/wakeups*1000 : 0;
+        max = maxLatency*1000;
+        unlock();
+    }
+
+    void setAbsoluteDeadlines(bool enable)
+    {
+        lock();
+        absoluteDeadlines=enable;
+        deadline=0;
+        unlock();
+    }
+
+    bool hasAbsoluteDeadlines()
+    {
+        return absoluteDeadlines;
+    }
+
+    void singleStepDeadline()
+    {
+        lock();
+        currentRun = useSystemClock ? SystemClock::nowSystem() : Time::now();
+        double runStart = clockNow();
+
+        if (scheduleReset)
+            _resetStat();
+
+        if (count>0) {
+            double dT=(currentRun-previousRun);
+            sumTSq+=dT*dT;
+            totalT+=dT;
+            estPIt++;
+        }
+
+        previousRun=currentRun;
+        if (deadline == 0)
+            deadline = runStart;
+        unlock();
+
+        if (!suspended) {
+            owner.run();
+        }
+
+        double now = clockNow();
+        double period = period_ms/1000.0;
+
+        lock();
+        count++;
+        double elapsed = now - runStart;
+        totalUsed+=elapsed;
+        sumUsedSq+=elapsed*elapsed;
+
+        deadline += period;
+        bool late = (period > 0 && now > deadline);
+        if (late) {
+            double lateness = (now - deadline) / period;
+            misses++;
+            int bin = (lateness < 0.25) ? 0 :
+                      (lateness < 0.5)  ? 1 :
+                      (lateness < 1.0)  ? 2 :
+                      (lateness < 2.0)  ? 3 : 4;
+            overruns[bin]++;
+            // run the next iteration immediately, but do not try to catch
+            // up with a whole period or more: start again from now.
+            if (now - deadline >= period)
+                deadline = now;
+        }
+        if (period <= 0)
+            deadline = 0;
+        unlock();
+
+        if (period <= 0 || late) {
+            yield();
+            return;
+        }
+
+        sleepUntil(deadline);
+
+        double latency = clockNow() - deadline;
+        lock();
+        wakeups++;
+        totalLatency+=latency;
+        if (latency > maxLatency)
+            maxLatency=latency;
+        unlock();
+    }
+
     void singleStep()
     {
         lock();
@@ -205,9 +389,12 @@ public:
     void run() override
     {
         adaptedPeriod = period_ms/1000.0;   //  divide by 1000 because user's period is [ms] while all the rest is [secs]
+        deadline = 0;
         while(!isClosing())
         {
-            if(useSystemClock)
+            if(absoluteDeadlines)
+                singleStepDeadline();
+            else if(useSystemClock)
                 singleStepSystem();
             else
                 singleStep();
@@ -269,12 +456,60 @@ public:
         return owner.threadInit();
     }
 
+    // PeriodicTask, used when run by a PeriodicExecutor: the executor
+    // takes care of the scheduling, here only the statistics are updated.
+    bool taskInit() override
+    {
+        deadline = 0;
+        return owner.threadInit();
+    }
+
+    void taskRelease() override
+    {
+        owner.threadRelease();
+    }
+
+    double taskPeriod() override
+    {
+        return period_ms/1000.0;
+    }
+
+    void taskStep() override
+    {
+        lock();
+        currentRun = useSystemClock ? SystemClock::nowSystem() : Time::now();
+
+        if (scheduleReset)
+            _resetStat();
+
+        if (count>0) {
+            double dT=(currentRun-previousRun);
+            sumTSq+=dT*dT;
+            totalT+=dT;
+            estPIt++;
+        }
+
+        previousRun=currentRun;
+        unlock();
+
+        if (!suspended) {
+            owner.run();
+        }
+
+        lock();
+        count++;
+        double elapsed = (useSystemClock ? SystemClock::nowSystem() : Time::now()) - currentRun;
+        totalUsed+=elapsed;
+        sumUsedSq+=elapsed*elapsed;
+        unlock();
+    }
+
     void threadRelease() override
     {
         owner.threadRelease();
     }
 
-    bool setRate(int p)
+    bool setRate(double p)
     {
         period_ms=p;
         adaptedPeriod = period_ms/1000.0;   //  divide by 1000 because user's period is [ms] while all the rest is [secs]
@@ -324,20 +559,33 @@ public:
 
 
 
-RateThread::RateThread(int period) : mPriv(new Private(*this, period))
+RateThread::RateThread(double period) : mPriv(new Private(*this, period))
 {
 }
 
 RateThread::~RateThread()
 {
+    if (mPriv->executor) {
+        mPriv->executor->remove(mPriv, true);
+    }
     delete mPriv;
 }
 
-bool RateThread::setRate(int period)
+bool RateThread::setRate(double period)
 {
     return mPriv->setRate(period);
 }
 
+void RateThread::setAbsoluteDeadlines(bool enable)
+{
+    mPriv->setAbsoluteDeadlines(enable);
+}
+
+bool RateThread::hasAbsoluteDeadlines()
+{
+    return mPriv->hasAbsoluteDeadlines();
+}
+
 double RateThread::getRate()
 {
     return mPriv->getRate();
@@ -350,16 +598,27 @@ bool RateThread::isSuspended()
 
 bool RateThread::join(double seconds)
 {
+    if (mPriv->executor) {
+        return mPriv->executor->remove(mPriv, true, seconds);
+    }
     return ((ThreadImpl*)mPriv)->join(seconds);
 }
 
 void RateThread::stop()
 {
+    if (mPriv->executor) {
+        mPriv->executor->remove(mPriv, true);
+        return;
+    }
     ((ThreadImpl*)mPriv)->close();
 }
 
 void RateThread::askToStop()
 {
+    if (mPriv->executor) {
+        mPriv->executor->remove(mPriv, false);
+        return;
+    }
     ((ThreadImpl*)mPriv)->askToClose();
 }
 
@@ -371,14 +630,37 @@ bool RateThread::step()
 
 bool RateThread::start()
 {
+    if (mPriv->executor) {
+        beforeStart();
+        bool ok = mPriv->executor->add(mPriv);
+        afterStart(ok);
+        return ok;
+    }
     return ((ThreadImpl*)mPriv)->start();
 }
 
 bool RateThread::isRunning()
 {
+    if (mPriv->executor) {
+        return mPriv->executor->isScheduled(mPriv);
+    }
     return ((ThreadImpl*)mPriv)->isRunning();
 }
 
+bool RateThread::setExecutor(PeriodicExecutor* executor)
+{
+    if (isRunning()) {
+        return false;
+    }
+    mPriv->executor = executor;
+    return true;
+}
+
+PeriodicExecutor* RateThread::getExecutor()
+{
+    return mPriv->executor;
+}
+
 void RateThread::suspend()
 {
     mPriv->suspend();
@@ -414,6 +696,21 @@ void RateThread::getEstUsed(double &av, double &std)
     mPriv->getEstUsed(av, std);
 }
 
+unsigned int RateThread::getDeadlineMisses()
+{
+    return mPriv->getDeadlineMisses();
+}
+
+void RateThread::getOverrunHistogram(unsigned int* bins, int size)
+{
+    mPriv->getOverrunHistogram(bins, size);
+}
+
+void RateThread::getWakeupLatency(double &av, double &max)
+{
+    mPriv->getWakeupLatency(av, max);
+}
+
 void RateThread::resetStat()
 {
     mPriv->resetStat();
@@ -437,16 +734,25 @@ void RateThread::afterStart(bool success)
 
 int RateThread::setPriority(int priority, int policy)
 {
+    if (mPriv->executor) {
+        return -1;
+    }
     return ((ThreadImpl*)mPriv)->setPriority(priority, policy);
 }
 
 int RateThread::getPriority()
 {
+    if (mPriv->executor) {
+        return -1;
+    }
     return ((ThreadImpl*)mPriv)->getPriority();
 }
 
 int RateThread::getPolicy()
 {
+    if (mPriv->executor) {
+        return -1;
+    }
     return ((ThreadImpl*)mPriv)->getPolicy();
 }
 
@@ -454,7 +760,7 @@ int RateThread::getPolicy()
 //  System Rate Thread
 //
 
-SystemRateThread::SystemRateThread(int period) : RateThread(period)
+SystemRateThread::SystemRateThread(double period) : RateThread(period)
 {
     mPriv->initWithSystemClock();
 }
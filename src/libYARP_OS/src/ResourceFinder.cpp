@@ -15,6 +15,7 @@
 #include <yarp/os/SystemClock.h>
 #include <yarp/os/Time.h>
 
+#include <yarp/os/impl/DirectoryCache.h>
 #include <yarp/os/impl/Logger.h>
 #include <yarp/os/impl/NameClient.h>
 #include <yarp/os/impl/NameConfig.h>
@@ -24,6 +25,10 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cerrno>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 using namespace yarp::os;
 using namespace yarp::os::impl;
@@ -115,9 +120,43 @@ static void appendResourceType(Bottle& paths,
 
 class ResourceFinderHelper {
 private:
+    // A directory of the search path
+    class SearchDir {
+    public:
+        enum Kind {
+            Fixed,      // prefix is the directory
+            Pwd,        // the current directory, prefix is the resource type
+            NearMain,   // the directory of the main config file, prefix is
+                        // the resource type
+            Context     // prefix is the directory of a context
+        };
+
+        SearchDir(Kind kind, const ConstString& prefix, const char *doc) :
+                kind(kind),
+                prefix(prefix),
+                doc(doc) {
+        }
+
+        Kind kind;
+        ConstString prefix;
+        const char *doc;
+    };
+
+    // The search path of a set of options, which depends on the contexts
+    // and on the environment as well. The nested searches of the robot and
+    // of the context directories, and the path.d files, are looked up
+    // again after RESOURCE_FINDER_CACHE_TIME.
+    class SearchList {
+    public:
+        double time;
+        std::vector<SearchDir> dirs;
+    };
+
     yarp::os::Bottle apps;
     yarp::os::ConstString configFilePath;
-    yarp::os::Property cache;
+    std::map<std::string, SearchList> searches;
+    // the last time the listing of each directory was checked for changes
+    std::unordered_map<std::string, double> checked;
     bool verbose;
     bool quiet;
     bool mainActive;
@@ -288,35 +327,13 @@ public:
                                 const ConstString& base3,
                                 const ConstString& name,
                                 bool isDir,
-                                const Bottle& doc,
-                                const char *doc2) {
+                                const char *doc) {
         ConstString s = getPath(base1, base2, base3, name);
 
-        // check cache first
-        Bottle *prev = cache.find(s).asList();
-        if (prev!=nullptr) {
-            double t = prev->get(0).asDouble();
-            int flag = prev->get(1).asInt();
-            if (SystemClock::nowSystem()-t<RESOURCE_FINDER_CACHE_TIME) {
-                if (flag) return s;
-                return "";
-            }
-        }
-
         if (verbose) {
-            ConstString base = doc.toString();
-            fprintf(RTARGET, "||| checking [%s] (%s%s%s)\n", s.c_str(),
-                    base.c_str(),
-                    (base.length()==0) ? "" : " ",
-                    doc2);
+            fprintf(RTARGET, "||| checking [%s] (%s)\n", s.c_str(), doc);
         }
-        bool ok = exists(s.c_str(), isDir);
-        Value status;
-        yAssert(status.asList());
-        status.asList()->addDouble(SystemClock::nowSystem());
-        status.asList()->addInt(ok?1:0);
-        cache.put(s, status);
-        if (ok) {
+        if (exists(s.c_str(), isDir)) {
             if (verbose) {
                 fprintf(RTARGET, "||| found %s\n", s.c_str());
             }
@@ -325,6 +342,34 @@ public:
         return "";
     }
 
+    yarp::os::ConstString check(const SearchDir& dir,
+                                const ConstString& pwd,
+                                const ConstString& name,
+                                bool isDir) {
+        switch (dir.kind) {
+        case SearchDir::Pwd: {
+            ConstString str = check(pwd, dir.prefix, "", name, isDir, dir.doc);
+            if (str!="" && mainActive) {
+                useNearMain = true;
+            }
+            return str;
+        }
+        case SearchDir::NearMain:
+            if (!useNearMain || configFilePath=="") {
+                return "";
+            }
+            return check(configFilePath, dir.prefix, "", name, isDir, dir.doc);
+        case SearchDir::Context:
+            if (useNearMain) {
+                return "";
+            }
+            break;
+        case SearchDir::Fixed:
+            break;
+        }
+        return check(dir.prefix, "", "", name, isDir, dir.doc);
+    }
+
     yarp::os::ConstString findPath(Property& config, const ConstString& name,
                                    const ResourceFinderOptions *externalOptions) {
         ConstString fname = config.check(name, Value(name)).asString();
@@ -394,9 +439,8 @@ public:
     void findFileBase(Property& config, const ConstString& name,
                       bool isDir,
                       Bottle& output, const ResourceFinderOptions& opts) {
-        Bottle doc;
         int prelen = output.size();
-        findFileBaseInner(config, name, isDir, true, output, opts, doc, nullptr);
+        findFileBaseInner(config, name, isDir, true, output, opts);
         if (output.size()!=prelen) return;
         bool justTop = (opts.duplicateFilesPolicy==ResourceFinderOptions::First);
         if (justTop) {
@@ -413,74 +457,128 @@ public:
         output.addString(txt);
     }
 
+    yarp::os::Bottle findFilesByName(Property& config, const Bottle& names,
+                                     const ResourceFinderOptions *externalOptions) {
+        ResourceFinderOptions opts;
+        if (externalOptions) {
+            opts = *externalOptions;
+        }
+        const std::vector<SearchDir>& dirs = getSearchDirs(config, true, opts);
+
+        // each directory is checked for all the files still missing, so
+        // that its listing is looked up only once
+        std::vector<ConstString> paths(names.size());
+        int missing = names.size();
+        ConstString pwd;
+        for (size_t i=0; i<dirs.size() && missing>0; i++) {
+            if (dirs[i].kind==SearchDir::Pwd) {
+                pwd = getPwd();
+            }
+            for (int j=0; j<names.size(); j++) {
+                if (paths[j]!="") continue;
+                paths[j] = check(dirs[i], pwd, names.get(j).asString(), false);
+                if (paths[j]!="") missing--;
+            }
+        }
+
+        Bottle result;
+        for (int j=0; j<names.size(); j++) {
+            if (paths[j]=="" && canShowErrors(opts)) {
+                fprintf(RTARGET, "||| did not find %s\n",
+                        names.get(j).asString().c_str());
+            }
+            result.addString(paths[j]);
+        }
+        return result;
+    }
+
     void findFileBaseInner(Property& config, const ConstString& name,
                            bool isDir, bool allowPathd,
-                           Bottle& output, const ResourceFinderOptions& opts,
-                           const Bottle& predoc, const char *reason) {
-        Bottle doc;
-        if (verbose) {
-            doc = predoc;
-            if (reason) {
-                doc.addString(reason);
+                           Bottle& output, const ResourceFinderOptions& opts) {
+        const std::vector<SearchDir>& dirs = getSearchDirs(config, allowPathd, opts);
+        bool justTop = (opts.duplicateFilesPolicy==ResourceFinderOptions::First);
+
+        ConstString pwd;
+        for (size_t i=0; i<dirs.size(); i++) {
+            if (dirs[i].kind==SearchDir::Pwd) {
+                pwd = getPwd();
+                if (name==""&&isDir) {
+                    addString(output, pwd);
+                    if (justTop) return;
+                }
+            }
+            ConstString str = check(dirs[i], pwd, name, isDir);
+            if (str!="") {
+                addString(output, str);
+                if (justTop) return;
             }
         }
+    }
+
+    const std::vector<SearchDir>& getSearchDirs(Property& config,
+                                                bool allowPathd,
+                                                const ResourceFinderOptions& opts) {
         ResourceFinderOptions::SearchLocations locs = opts.searchLocations;
         ResourceFinderOptions::SearchFlavor flavor = opts.searchFlavor;
         ConstString resourceType = opts.resourceType;
 
-        bool justTop = (opts.duplicateFilesPolicy==ResourceFinderOptions::First);
+        bool found = false;
+        ConstString robot = NetworkBase::getEnvironment("YARP_ROBOT_NAME",
+                                                        &found);
+        if (!found) robot = "default";
+        ConstString configHome = ResourceFinder::getConfigHomeNoCreate();
+        ConstString dataHome = ResourceFinder::getDataHomeNoCreate();
+        Bottle configDirs = ResourceFinder::getConfigDirs();
+        Bottle dataDirs = ResourceFinder::getDataDirs();
+
+        Bottle key;
+        key.addInt(locs);
+        key.addInt(flavor);
+        key.addString(resourceType);
+        key.addInt(allowPathd?1:0);
+        key.addList() = apps;
+        key.addString(robot);
+        key.addString(configHome);
+        key.addString(dataHome);
+        key.addList() = configDirs;
+        key.addList() = dataDirs;
+        std::string txt = key.toString();
+
+        double now = SystemClock::nowSystem();
+        std::map<std::string, SearchList>::iterator it = searches.find(txt);
+        if (it!=searches.end() &&
+                now-it->second.time<RESOURCE_FINDER_CACHE_TIME) {
+            return it->second.dirs;
+        }
+
+        std::vector<SearchDir> dirs;
 
         // check current directory
         if (locs & ResourceFinderOptions::Directory) {
-            if (name==""&&isDir) {
-                addString(output, getPwd());
-                if (justTop) return;
-            }
-            ConstString str = check(getPwd(), resourceType, "", name, isDir, doc, "pwd");
-            if (str!="") {
-                if (mainActive) useNearMain = true;
-                addString(output, str);
-                if (justTop) return;
-            }
+            dirs.push_back(SearchDir(SearchDir::Pwd, resourceType, "pwd"));
         }
 
-        if ((locs & ResourceFinderOptions::NearMainConfig) && useNearMain) {
-            if (configFilePath!="") {
-                ConstString str = check(configFilePath.c_str(), resourceType, "", name, isDir, doc, "defaultConfigFile path");
-                if (str!="") {
-                    addString(output, str);
-                    if (justTop) return;
-                }
-            }
+        if (locs & ResourceFinderOptions::NearMainConfig) {
+            dirs.push_back(SearchDir(SearchDir::NearMain, resourceType,
+                                     "defaultConfigFile path"));
         }
 
         if (locs & ResourceFinderOptions::Robot) {
-            ConstString slash = NetworkBase::getDirectorySeparator();
-            bool found = false;
-            ConstString robot = NetworkBase::getEnvironment("YARP_ROBOT_NAME",
-                                                            &found);
-            if (!found) robot = "default";
-
             // Nested search to locate robot directory
             Bottle paths;
             ResourceFinderOptions opts2;
             opts2.searchLocations = (ResourceFinderOptions::SearchLocations)(ResourceFinderOptions::User | ResourceFinderOptions::Sysadmin | ResourceFinderOptions::Installed);
             opts2.resourceType = "robots";
             opts2.duplicateFilesPolicy = ResourceFinderOptions::All;
-            findFileBaseInner(config, robot.c_str(), true, allowPathd, paths, opts2, doc, "robot");
+            findFileBaseInner(config, robot.c_str(), true, allowPathd, paths, opts2);
             appendResourceType(paths, resourceType);
             for (int j=0; j<paths.size(); j++) {
-                ConstString str = check(paths.get(j).asString().c_str(),
-                                        "", "",
-                                        name, isDir, doc, "robot");
-                if (str!="") {
-                    addString(output, str);
-                    if (justTop) return;
-                }
+                dirs.push_back(SearchDir(SearchDir::Fixed,
+                                         paths.get(j).asString(), "robot"));
             }
         }
 
-        if ((locs & ResourceFinderOptions::Context) && !useNearMain) {
+        if (locs & ResourceFinderOptions::Context) {
             for (int i=0; i<apps.size(); i++) {
                 ConstString app = apps.get(i).asString();
 
@@ -494,15 +592,11 @@ public:
                 prependResourceType(app, "contexts");
                 opts2.searchLocations = (ResourceFinderOptions::SearchLocations)ResourceFinderOptions::Default;
                 opts2.duplicateFilesPolicy = ResourceFinderOptions::All;
-                findFileBaseInner(config, app.c_str(), true, allowPathd, paths, opts2, doc, "context");
+                findFileBaseInner(config, app.c_str(), true, allowPathd, paths, opts2);
                 appendResourceType(paths, resourceType);
                 for (int j=0; j<paths.size(); j++) {
-                    ConstString str = check(paths.get(j).asString().c_str(), "", "",
-                                            name, isDir, doc, "context");
-                    if (str!="") {
-                        addString(output, str);
-                        if (justTop) return;
-                    }
+                    dirs.push_back(SearchDir(SearchDir::Context,
+                                             paths.get(j).asString(), "context"));
                 }
             }
         }
@@ -510,60 +604,40 @@ public:
         // check YARP_CONFIG_HOME
         if ((locs & ResourceFinderOptions::User) &&
             (flavor & ResourceFinderOptions::ConfigLike)) {
-            ConstString home = ResourceFinder::getConfigHomeNoCreate();
-            if (home!="") {
-                appendResourceType(home, resourceType);
-                ConstString str = check(home.c_str(), "", "", name, isDir,
-                                        doc, "YARP_CONFIG_HOME");
-                if (str!="") {
-                    addString(output, str);
-                    if (justTop) return;
-                }
+            if (configHome!="") {
+                appendResourceType(configHome, resourceType);
+                dirs.push_back(SearchDir(SearchDir::Fixed, configHome,
+                                         "YARP_CONFIG_HOME"));
             }
         }
 
         // check YARP_DATA_HOME
         if ((locs & ResourceFinderOptions::User) &&
             (flavor & ResourceFinderOptions::DataLike)) {
-            ConstString home = ResourceFinder::getDataHomeNoCreate();
-            if (home!="") {
-                appendResourceType(home, resourceType);
-                ConstString str = check(home.c_str(), "", "", name, isDir,
-                                        doc, "YARP_DATA_HOME");
-                if (str!="") {
-                    addString(output, str);
-                    if (justTop) return;
-                }
+            if (dataHome!="") {
+                appendResourceType(dataHome, resourceType);
+                dirs.push_back(SearchDir(SearchDir::Fixed, dataHome,
+                                         "YARP_DATA_HOME"));
             }
         }
 
         // check YARP_CONFIG_DIRS
         if (locs & ResourceFinderOptions::Sysadmin) {
-            Bottle dirs = ResourceFinder::getConfigDirs();
-            appendResourceType(dirs, resourceType);
-            for (int i=0; i<dirs.size(); i++) {
-                ConstString str = check(dirs.get(i).asString().c_str(),
-                                        "", "", name, isDir,
-                                        doc, "YARP_CONFIG_DIRS");
-                if (str!="") {
-                    addString(output, str);
-                    if (justTop) return;
-                }
+            appendResourceType(configDirs, resourceType);
+            for (int i=0; i<configDirs.size(); i++) {
+                dirs.push_back(SearchDir(SearchDir::Fixed,
+                                         configDirs.get(i).asString(),
+                                         "YARP_CONFIG_DIRS"));
             }
         }
 
         // check YARP_DATA_DIRS
         if (locs & ResourceFinderOptions::Installed) {
-            Bottle dirs = ResourceFinder::getDataDirs();
-            appendResourceType(dirs, resourceType);
-            for (int i=0; i<dirs.size(); i++) {
-                ConstString str = check(dirs.get(i).asString().c_str(),
-                                        "", "", name, isDir,
-                                        doc, "YARP_DATA_DIRS");
-                if (str!="") {
-                    addString(output, str);
-                    if (justTop) return;
-                }
+            appendResourceType(dataDirs, resourceType);
+            for (int i=0; i<dataDirs.size(); i++) {
+                dirs.push_back(SearchDir(SearchDir::Fixed,
+                                         dataDirs.get(i).asString(),
+                                         "YARP_DATA_DIRS"));
             }
         }
 
@@ -573,7 +647,7 @@ public:
             ResourceFinderOptions opts2;
             opts2.searchLocations = (ResourceFinderOptions::SearchLocations)(opts.searchLocations & ResourceFinderOptions::Installed);
             opts2.resourceType = "config";
-            findFileBaseInner(config, "path.d", true, false, pathds, opts2, doc, "path.d");
+            findFileBaseInner(config, "path.d", true, false, pathds, opts2);
 
             for (int i=0; i<pathds.size(); i++) {
                 // check /.../path.d/*
@@ -592,16 +666,18 @@ public:
                     Bottle paths = group.findGroup("path").tail();
                     appendResourceType(paths, resourceType);
                     for (int j=0; j<paths.size(); j++) {
-                        ConstString str = check(paths.get(j).asString().c_str(), "", "",
-                                                name, isDir, doc, "yarp.d");
-                        if (str!="") {
-                            addString(output, str);
-                            if (justTop) return;
-                        }
+                        dirs.push_back(SearchDir(SearchDir::Fixed,
+                                                 paths.get(j).asString(),
+                                                 "yarp.d"));
                     }
                 }
             }
         }
+
+        SearchList& list = searches[txt];
+        list.time = now;
+        list.dirs.swap(dirs);
+        return list.dirs;
     }
 
     bool setVerbose(bool verbose) {
@@ -615,31 +691,25 @@ public:
     }
 
     bool exists(const char *fname, bool isDir) {
-        int result = yarp::os::stat(fname);
-        if (result!=0) {
-            return false;
-        }
-        if (!isDir) {
-            // if not required to be a directory, pass anything.
-            return true;
-        }
-
-        // ACE doesn't seem to help us interpret the results of stat
-        // in a portable fashion.
-
-        // ACE on Ubuntu 9.10 has issues.
-        // Suppressing check for file here since it isn't really needed
-        // and causes a lot of problems.
-        /*
-        YARP_DIR *dir = ACE_OS::opendir(fname);
-        if (dir!=nullptr) {
-            ACE_OS::closedir(dir);
-            dir = nullptr;
-            return true;
+        // if not required to be a directory, pass anything.
+        // Directories are not checked either, it isn't really needed
+        // and it caused a lot of problems with ACE.
+        YARP_UNUSED(isDir);
+
+        // the listing of a directory is checked for changes once every
+        // RESOURCE_FINDER_CACHE_TIME, like the results of a search
+        bool validate = true;
+        ConstString dir = DirectoryCache::getDirectory(fname);
+        if (dir!="") {
+            double now = SystemClock::nowSystem();
+            std::unordered_map<std::string, double>::iterator it = checked.find(dir);
+            if (it!=checked.end() && now-it->second<RESOURCE_FINDER_CACHE_TIME) {
+                validate = false;
+            } else {
+                checked[dir] = now;
+            }
         }
-        return false;
-        */
-        return true;
+        return DirectoryCache::getInstance().exists(fname, validate);
     }
 
 
@@ -832,6 +902,23 @@ yarp::os::ConstString ResourceFinder::findFileByName(const ConstString& name,
     return HELPER(implementation).findFileByName(config, name, &options);
 }
 
+yarp::os::Bottle ResourceFinder::findFilesByName(const Bottle& names)
+{
+    if (HELPER(implementation).isVerbose()) {
+        fprintf(RTARGET, "||| finding files %s\n", names.toString().c_str());
+    }
+    return HELPER(implementation).findFilesByName(config, names, nullptr);
+}
+
+yarp::os::Bottle ResourceFinder::findFilesByName(const Bottle& names,
+                                                 const ResourceFinderOptions& options)
+{
+    if (HELPER(implementation).isVerbose()) {
+        fprintf(RTARGET, "||| finding files %s\n", names.toString().c_str());
+    }
+    return HELPER(implementation).findFilesByName(config, names, &options);
+}
+
 
 yarp::os::ConstString ResourceFinder::findPath(const ConstString& name)
 {
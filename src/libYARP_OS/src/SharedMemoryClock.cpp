@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2018 Istituto Italiano di Tecnologia (IIT)
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ */
+
+#include <yarp/os/impl/SharedMemoryClock.h>
+#include <yarp/os/SystemClock.h>
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+
+#if !defined(_WIN32)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+using namespace yarp::os;
+using namespace yarp::os::impl;
+
+namespace {
+
+const std::uint32_t SEGMENT_MAGIC = 0x59434c4b; // "YCLK"
+
+// Layout of the shared segment. Atomics on lock-free types do not depend
+// on the address, therefore they can be used across processes.
+struct Segment
+{
+    std::atomic<std::uint32_t> magic;
+    std::atomic<std::uint32_t> seq;     // odd while the time is being written
+    std::atomic<std::int32_t> sec;
+    std::atomic<std::int32_t> nsec;
+    // system time of the last write, in microseconds
+    std::atomic<std::int64_t> heartbeat;
+};
+
+std::int64_t nowMicroseconds()
+{
+    return (std::int64_t)(SystemClock::nowSystem() * 1e6);
+}
+
+} // namespace
+
+
+SharedMemoryClock::SharedMemoryClock() :
+        segment(nullptr),
+        owner(false)
+{
+}
+
+SharedMemoryClock::~SharedMemoryClock()
+{
+    close();
+}
+
+ConstString SharedMemoryClock::getSegmentName(const ConstString& clockPortName)
+{
+    ConstString ret = "/yarp_clock";
+    for (size_t i = 0; i < clockPortName.length(); i++) {
+        char ch = clockPortName[i];
+        ret += (ch == '/' || ch == '@') ? '_' : ch;
+    }
+    return ret;
+}
+
+bool SharedMemoryClock::create(const ConstString& clockPortName)
+{
+#if !defined(_WIN32)
+    close();
+    name = getSegmentName(clockPortName);
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    if (ftruncate(fd, sizeof(Segment)) != 0) {
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void* p = mmap(nullptr, sizeof(Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        return false;
+    }
+    // the atomics of the segment are constructed in place once, by its
+    // creator; the readers only map them
+    Segment* s = new (p) Segment();
+    s->seq.store(0, std::memory_order_relaxed);
+    s->sec.store(0, std::memory_order_relaxed);
+    s->nsec.store(0, std::memory_order_relaxed);
+    s->heartbeat.store(0, std::memory_order_relaxed);
+    s->magic.store(0, std::memory_order_release);
+    segment = p;
+    owner = true;
+    return true;
+#else
+    YARP_UNUSED(clockPortName);
+    return false;
+#endif
+}
+
+bool SharedMemoryClock::open(const ConstString& clockPortName)
+{
+#if !defined(_WIN32)
+    close();
+    name = getSegmentName(clockPortName);
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(Segment)) {
+        ::close(fd);
+        return false;
+    }
+    void* p = mmap(nullptr, sizeof(Segment), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        return false;
+    }
+    segment = p;
+    owner = false;
+    return true;
+#else
+    YARP_UNUSED(clockPortName);
+    return false;
+#endif
+}
+
+void SharedMemoryClock::close()
+{
+#if !defined(_WIN32)
+    if (segment == nullptr) {
+        return;
+    }
+    munmap(segment, sizeof(Segment));
+    if (owner) {
+        shm_unlink(name.c_str());
+    }
+#endif
+    segment = nullptr;
+    owner = false;
+}
+
+bool SharedMemoryClock::isOpen() const
+{
+    return segment != nullptr;
+}
+
+void SharedMemoryClock::write(int sec, int nsec)
+{
+    if (!owner) {
+        return;
+    }
+    Segment* s = static_cast<Segment*>(segment);
+    std::uint32_t seq = s->seq.load(std::memory_order_relaxed);
+    s->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    s->sec.store(sec, std::memory_order_relaxed);
+    s->nsec.store(nsec, std::memory_order_relaxed);
+    s->seq.store(seq + 2, std::memory_order_release);
+    s->heartbeat.store(nowMicroseconds(), std::memory_order_relaxed);
+    s->magic.store(SEGMENT_MAGIC, std::memory_order_release);
+}
+
+bool SharedMemoryClock::read(int& sec, int& nsec, double maxAge) const
+{
+    if (segment == nullptr) {
+        return false;
+    }
+    const Segment* s = static_cast<const Segment*>(segment);
+    if (s->magic.load(std::memory_order_acquire) != SEGMENT_MAGIC) {
+        return false;
+    }
+    if (maxAge >= 0) {
+        std::int64_t age = nowMicroseconds() - s->heartbeat.load(std::memory_order_relaxed);
+        if (age > (std::int64_t)(maxAge * 1e6)) {
+            return false;
+        }
+    }
+    std::uint32_t seq1, seq2;
+    do {
+        seq1 = s->seq.load(std::memory_order_acquire);
+        sec = s->sec.load(std::memory_order_relaxed);
+        nsec = s->nsec.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        seq2 = s->seq.load(std::memory_order_relaxed);
+    } while ((seq1 & 1) != 0 || seq1 != seq2);
+    return true;
+}
@@ -6,11 +6,23 @@
 
 #include <yarp/os/impl/UdpCarrier.h>
 #include <yarp/os/ConstString.h>
+#include <yarp/os/Network.h>
+#include <yarp/os/NetType.h>
 
 using namespace yarp::os;
 using namespace yarp::os::impl;
 
-yarp::os::impl::UdpCarrier::UdpCarrier() {
+// header flag of a sender that can check the datagrams with the CRC-32C
+#define UDP_FAST_CRC_HEADER 64
+// port flag of the reply of a receiver that accepts it
+#define UDP_FAST_CRC_REPLY 65536
+// the same for the forward error correction
+#define UDP_FEC_HEADER 32
+#define UDP_FEC_REPLY 131072
+
+yarp::os::impl::UdpCarrier::UdpCarrier() :
+        fastCrc(NetworkBase::getEnvironment("YARP_UDP_CRC32C")!="0"),
+        fecGroup(NetType::toInt(NetworkBase::getEnvironment("YARP_DGRAM_FEC"))) {
 }
 
 yarp::os::Carrier *yarp::os::impl::UdpCarrier::create() {
@@ -30,11 +42,15 @@ bool yarp::os::impl::UdpCarrier::checkHeader(const Bytes& header) {
 }
 
 void yarp::os::impl::UdpCarrier::getHeader(const Bytes& header) {
-    createStandardHeader(getSpecifierCode(), header);
+    createStandardHeader(getSpecifierCode()+(fastCrc?UDP_FAST_CRC_HEADER:0)+
+                         ((fecGroup>0)?UDP_FEC_HEADER:0), header);
 }
 
 void yarp::os::impl::UdpCarrier::setParameters(const Bytes& header) {
-    YARP_UNUSED(header);
+    int specifier = getSpecifier(header);
+    fastCrc = fastCrc && (specifier&UDP_FAST_CRC_HEADER)!=0;
+    // the receivers accept the fragments of any sender
+    fecGroup = ((specifier&UDP_FEC_HEADER)!=0) ? 1 : 0;
 }
 
 bool yarp::os::impl::UdpCarrier::requireAck() {
@@ -61,7 +77,7 @@ bool yarp::os::impl::UdpCarrier::respondToHeader(ConnectionState& proto) {
     }
 
     int myPort = stream->getLocalAddress().getPort();
-    writeYarpInt(myPort, proto);
+    writeYarpInt(myPort+(fastCrc?UDP_FAST_CRC_REPLY:0)+((fecGroup>0)?UDP_FEC_REPLY:0), proto);
     proto.takeStreams(stream);
 
     return true;
@@ -78,6 +94,9 @@ bool yarp::os::impl::UdpCarrier::expectReplyToHeader(ConnectionState& proto) {
     if (altPort==-1) {
         return false;
     }
+    bool altFastCrc = fastCrc && (altPort&UDP_FAST_CRC_REPLY)!=0;
+    bool altFec = (altPort&UDP_FEC_REPLY)!=0;
+    altPort &= UDP_FAST_CRC_REPLY-1;
 
     DgramTwoWayStream *stream = new DgramTwoWayStream();
     yAssert(stream!=nullptr);
@@ -89,6 +108,10 @@ bool yarp::os::impl::UdpCarrier::expectReplyToHeader(ConnectionState& proto) {
         delete stream;
         return false;
     }
+    stream->setFastCrc(altFastCrc);
+    if (altFec) {
+        stream->setFec(fecGroup);
+    }
     proto.takeStreams(stream);
     return true;
 }
@@ -9,12 +9,17 @@
 #include <yarp/os/impl/Logger.h>
 #include <cstdlib>
 #include <yarp/os/impl/NameClient.h>
+#include <yarp/os/impl/PlatformSysStat.h>
+#include <yarp/os/LockGuard.h>
+#include <yarp/os/Os.h>
 #include <yarp/os/Property.h>
 #include <yarp/os/ResourceFinder.h>
 #include <yarp/os/SystemClock.h>
 #include <yarp/os/Network.h>
 
 #include <cstdio>
+#include <functional>
+#include <string>
 
 using namespace yarp::os;
 using namespace yarp::os::impl;
@@ -153,77 +158,318 @@ void YarpPluginSettings::reportFailure() const {
             fn_name.c_str(), dll_name.c_str());
 }
 
+namespace {
 
-void YarpPluginSelector::scan() {
-    // This method needs to be accessed by one thread only
-    LockGuard guard(mutex);
+// Version of the format of the plugin index files, to be increased when
+// the content changes
+const int PLUGIN_INDEX_VERSION = 1;
 
-    // If it was scanned in the last 5 seconds, there is no need to scan again
-    bool need_scan = true;
-    if (config.check("last_update_time")) {
-        if (SystemClock::nowSystem()-config.find("last_update_time").asDouble() < 5) {
-            need_scan = false;
+/*
+ * The [plugin] and [search] sections of the .ini files of all the plugin
+ * directories, shared by the selectors of the process and kept on disk
+ * between processes. They are parsed again only when a directory or an
+ * .ini file changes, which is checked with a stat of each of them.
+ * The index file is named after the list of the plugin directories, so
+ * that the processes with different data directories do not overwrite
+ * each other. YARP_PLUGIN_INDEX sets the directory of the files, empty
+ * disables them.
+ */
+class PluginIndex
+{
+public:
+    static PluginIndex& getInstance()
+    {
+        static PluginIndex instance;
+        return instance;
+    }
+
+    // the plugin directories are looked for again, and the index is
+    // checked against them, before the plugins go through the selector
+    void select(YarpPluginSelector& selector, Bottle& selected, Property& names, Bottle& search)
+    {
+        LockGuard guard(mutex);
+        update();
+        selected.clear();
+        names.clear();
+        for (int i=0; i<plugins.size(); i++) {
+            Bottle* group = plugins.get(i).asList();
+            if (group != nullptr && selector.select(*group)) {
+                ConstString name = group->get(0).asString();
+                if (!names.check(name)) {
+                    names.put(name, selected.size());
+                }
+                selected.addList() = *group;
+            }
         }
+        search = this->search;
     }
-    if(!need_scan) {
-        return;
+
+private:
+    Mutex mutex;
+    bool loaded;
+    bool racy;
+    Bottle paths;
+    Bottle stamps;
+    Bottle plugins;
+    Bottle search;
+
+    PluginIndex() : loaded(false), racy(false) {}
+
+    static Bottle findPluginPaths()
+    {
+        ResourceFinder& rf = ResourceFinder::getResourceFinderSingleton();
+        if (!rf.isConfigured()) {
+            rf.configure(0, nullptr);
+        }
+        rf.setQuiet(true);
+        Bottle plugin_paths = rf.findPaths("plugins");
+        if (plugin_paths.size()==0) {
+            plugin_paths = rf.findPaths("share/yarp/plugins");
+        }
+        return plugin_paths;
     }
 
-    YARP_SPRINTF0(Logger::get(),
-                  debug,
-                  "Scanning. I'm scanning. I hope you like scanning too.");
+    // modification time and size, enough to tell that a file was written
+    static ConstString getStamp(const ConstString& path, long long* mtime = nullptr)
+    {
+        YARP_stat st;
+        if (yarp::os::impl::stat(path.c_str(), &st) != 0) {
+            return "missing";
+        }
+        if (mtime != nullptr) {
+            *mtime = (long long)st.st_mtime;
+        }
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%lld %lld", (long long)st.st_mtime, (long long)st.st_size);
+        return buf;
+    }
 
-    // Search plugins directories
-    ResourceFinder& rf = ResourceFinder::getResourceFinderSingleton();
-    if (!rf.isConfigured()) {
-        rf.configure(0, nullptr);
+    // the time stamps have a resolution of a second, a change in the same
+    // second of the scan may not be seen, so such an index is not trusted
+    bool isValid() const
+    {
+        if (racy) {
+            return false;
+        }
+        for (int i=0; i<stamps.size(); i++) {
+            Bottle* entry = stamps.get(i).asList();
+            if (entry == nullptr || getStamp(entry->get(0).asString()) != entry->get(1).asString()) {
+                return false;
+            }
+        }
+        return true;
     }
-    rf.setQuiet(true);
-    Bottle plugin_paths = rf.findPaths("plugins");
-    if (plugin_paths.size()==0) {
-        plugin_paths = rf.findPaths("share/yarp/plugins");
+
+    void addStamp(const ConstString& path, long long start)
+    {
+        long long mtime = 0;
+        Bottle& entry = stamps.addList();
+        entry.addString(path);
+        entry.addString(getStamp(path, &mtime));
+        if (mtime >= start) {
+            racy = true;
+        }
     }
 
-    // Search .ini files in plugins directories
-    config.clear();
-    if (plugin_paths.size()>0) {
-        for (int i=0; i<plugin_paths.size(); i++) {
-            ConstString target = plugin_paths.get(i).asString();
-            YARP_SPRINTF1(Logger::get(),
-                          debug,
-                          "Loading configuration files related to plugins from %s.", target.c_str());
-            config.fromConfigDir(target, "inifile", false);
+    static ConstString getFileName(const Bottle& paths)
+    {
+        bool found = false;
+        ConstString dir = NetworkBase::getEnvironment("YARP_PLUGIN_INDEX", &found);
+        if (!found) {
+            dir = ResourceFinder::getDataHomeNoCreate();
+        }
+        if (dir.empty()) {
+            return "";
+        }
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%016llx",
+                 (unsigned long long)std::hash<std::string>()(paths.toString()));
+        return dir + "/plugins_" + buf + ".index";
+    }
+
+    // the whole file is read at once, it is a Bottle in binary form
+    bool load(const Bottle& current)
+    {
+        ConstString fname = getFileName(current);
+        if (fname.empty()) {
+            return false;
+        }
+        FILE* fin = fopen(fname.c_str(), "rb");
+        if (fin == nullptr) {
+            return false;
+        }
+        ConstString txt;
+        if (fseek(fin, 0, SEEK_END) == 0) {
+            long len = ftell(fin);
+            if (len > 0 && fseek(fin, 0, SEEK_SET) == 0) {
+                txt.resize((size_t)len);
+                txt.resize(fread(&txt[0], 1, (size_t)len, fin));
+            }
+        }
+        fclose(fin);
+
+        Bottle b;
+        b.fromBinary(txt.c_str(), (int)txt.length());
+        if (b.size() != 6 ||
+                b.get(0).asString() != "yarp_plugin_index" ||
+                b.get(1).asInt() != PLUGIN_INDEX_VERSION ||
+                !b.get(2).isList() || !b.get(3).isList() ||
+                !b.get(4).isList() || !b.get(5).isList() ||
+                b.get(2).asList()->toString() != current.toString()) {
+            return false;
+        }
+        paths = current;
+        stamps = *b.get(3).asList();
+        plugins = *b.get(4).asList();
+        search = *b.get(5).asList();
+        return true;
+    }
+
+    // written in a temporary file first, the readers never see half a file
+    void save()
+    {
+        ConstString fname = getFileName(paths);
+        if (fname.empty()) {
+            return;
         }
-    } else {
+        bool found = false;
+        NetworkBase::getEnvironment("YARP_PLUGIN_INDEX", &found);
+        if (!found) {
+            // creates the data home, if missing
+            ResourceFinder::getDataHome();
+        }
+
+        Bottle b;
+        b.addString("yarp_plugin_index");
+        b.addInt(PLUGIN_INDEX_VERSION);
+        b.addList() = paths;
+        b.addList() = stamps;
+        b.addList() = plugins;
+        b.addList() = search;
+        size_t len = 0;
+        const char* data = b.toBinary(&len);
+
+        char suffix[32];
+        snprintf(suffix, sizeof(suffix), ".%d", yarp::os::getpid());
+        ConstString tmpname = fname + suffix;
+        FILE* fout = fopen(tmpname.c_str(), "wb");
+        if (fout == nullptr) {
+            YARP_SPRINTF1(Logger::get(), debug, "Cannot write the plugin index %s", fname.c_str());
+            return;
+        }
+        bool ok = (fwrite(data, 1, len, fout) == len);
+        ok = (fclose(fout) == 0) && ok;
+        if (ok && yarp::os::rename(tmpname.c_str(), fname.c_str()) != 0) {
+            // the destination cannot be replaced on some systems
+            remove(fname.c_str());
+            ok = (yarp::os::rename(tmpname.c_str(), fname.c_str()) == 0);
+        }
+        if (!ok) {
+            remove(tmpname.c_str());
+        }
+    }
+
+    void scan(const Bottle& current)
+    {
         YARP_SPRINTF0(Logger::get(),
                       debug,
-                      "Plugin directory not found");
-    }
-
-    // Read the .ini files and populate the lists
-    plugins.clear();
-    search_path.clear();
-    Bottle inilst = config.findGroup("inifile").tail();
-    for (int i=0; i<inilst.size(); i++) {
-        ConstString inifile = inilst.get(i).asString();
-        Bottle inigroup = config.findGroup(inifile);
-        Bottle lst = inigroup.findGroup("plugin").tail();
-        for (int i=0; i<lst.size(); i++) {
-            ConstString plugin_name = lst.get(i).asString();
-            Bottle group = inigroup.findGroup(plugin_name);
-            group.add(Value::makeValue(ConstString("(inifile \"") + inifile + "\")"));
-            if (select(group)) {
+                      "Scanning. I'm scanning. I hope you like scanning too.");
+
+        paths = current;
+        stamps.clear();
+        plugins.clear();
+        search.clear();
+        racy = false;
+        long long start = (long long)SystemClock::nowSystem() - 1;
+
+        // Search .ini files in plugins directories. The stamps are taken
+        // before reading, a change after them is seen at the next check
+        Property config;
+        if (paths.size()>0) {
+            for (int i=0; i<paths.size(); i++) {
+                ConstString target = paths.get(i).asString();
+                YARP_SPRINTF1(Logger::get(),
+                              debug,
+                              "Loading configuration files related to plugins from %s.", target.c_str());
+                addStamp(target, start);
+                config.fromConfigDir(target, "inifile", false);
+            }
+        } else {
+            YARP_SPRINTF0(Logger::get(),
+                          debug,
+                          "Plugin directory not found");
+        }
+
+        // Read the .ini files and populate the lists
+        Bottle inilst = config.findGroup("inifile").tail();
+        for (int i=0; i<inilst.size(); i++) {
+            ConstString inifile = inilst.get(i).asString();
+            addStamp(inifile, start);
+            Bottle inigroup = config.findGroup(inifile);
+            Bottle lst = inigroup.findGroup("plugin").tail();
+            for (int i=0; i<lst.size(); i++) {
+                ConstString plugin_name = lst.get(i).asString();
+                Bottle group = inigroup.findGroup(plugin_name);
+                group.add(Value::makeValue(ConstString("(inifile \"") + inifile + "\")"));
                 plugins.addList() = group;
             }
+            lst = inigroup.findGroup("search").tail();
+            for (int i=0; i<lst.size(); i++) {
+                ConstString search_name = lst.get(i).asString();
+                Bottle group = inigroup.findGroup(search_name);
+                search.addList() = group;
+            }
+        }
+    }
+
+    void update()
+    {
+        Bottle current = findPluginPaths();
+        if (loaded && current.toString() == paths.toString() && isValid()) {
+            return;
+        }
+        loaded = true;
+        racy = false;
+        if (load(current) && isValid()) {
+            YARP_SPRINTF0(Logger::get(), debug, "Plugin index loaded");
+            return;
+        }
+        scan(current);
+        if (!racy) {
+            save();
         }
-        lst = inigroup.findGroup("search").tail();
-        for (int i=0; i<lst.size(); i++) {
-            ConstString search_name = lst.get(i).asString();
-            Bottle group = inigroup.findGroup(search_name);
-            search_path.addList() = group;
+    }
+};
+
+} // namespace
+
+void YarpPluginSelector::scan() {
+    // This method needs to be accessed by one thread only
+    LockGuard guard(mutex);
+
+    // If it was scanned in the last 5 seconds, there is no need to scan again
+    bool need_scan = true;
+    if (config.check("last_update_time")) {
+        if (SystemClock::nowSystem()-config.find("last_update_time").asDouble() < 5) {
+            need_scan = false;
         }
     }
+    if(!need_scan) {
+        return;
+    }
+
+    // Select the plugins of the shared index, and index them by name
+    PluginIndex::getInstance().select(*this, plugins, names, search_path);
 
     // Update last_update_time
     config.put("last_update_time", SystemClock::nowSystem());
 }
+
+Bottle YarpPluginSelector::findPlugin(const ConstString& name) const {
+    LockGuard guard(mutex);
+    Value& index = names.find(name);
+    if (!index.isInt()) {
+        return Bottle();
+    }
+    return *plugins.get(index.asInt()).asList();
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2018 Istituto Italiano di Tecnologia (IIT)
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ */
+
+#ifndef YARP_DEV_ANALOGFRAME_H
+#define YARP_DEV_ANALOGFRAME_H
+
+#include <yarp/dev/api.h>
+#include <yarp/os/Portable.h>
+#include <yarp/os/Stamp.h>
+#include <yarp/os/Vocab.h>
+
+#include <vector>
+
+namespace yarp {
+    namespace dev {
+        class AnalogFrame;
+    }
+}
+
+#define VOCAB_ANALOG_FRAME VOCAB4('a','f','r','m')
+
+/**
+ * @ingroup dev_iface_other
+ *
+ * The readings of several analog sensors, taken in the same cycle and
+ * sent as a single message (see the multipleAnalogServer device).
+ *
+ * The channels of all the sensors are packed in a single array. Each
+ * sensor has an offset in the array, a number of channels, and the status
+ * returned by its IAnalogSensor::read(). A sensor whose read failed keeps
+ * its slot, so the layout only changes when the number of channels of a
+ * sensor does.
+ *
+ * The slices are read in place with getData(), without copying. On the
+ * wire the frame has a fixed binary layout: the number of sensors and of
+ * channels, the time stamp, the number of channels and the status of each
+ * sensor, and the channels. As yarp::sig::Vector, the layout assumes a
+ * little endian host.
+ */
+class YARP_dev_API yarp::dev::AnalogFrame : public yarp::os::Portable
+{
+public:
+    AnalogFrame();
+
+    /**
+     * Remove all the sensors. The memory is kept for the next frame.
+     */
+    void clear();
+
+    /**
+     * Add the reading of a sensor to the frame.
+     * @param data the channels of the sensor
+     * @param channels number of channels
+     * @param status the value returned by IAnalogSensor::read()
+     */
+    void addSensor(const double* data, int channels, int status);
+
+    void setStamp(const yarp::os::Stamp& stamp);
+    yarp::os::Stamp getStamp() const;
+
+    /**
+     * @return the number of sensors
+     */
+    int size() const;
+
+    /**
+     * @return the number of channels of all the sensors
+     */
+    int getTotalChannels() const;
+
+    int getChannels(int i) const;
+    int getOffset(int i) const;
+    int getStatus(int i) const;
+
+    /**
+     * @return true if the last read of the i-th sensor succeeded
+     */
+    bool isValid(int i) const;
+
+    /**
+     * @return the channels of the i-th sensor, valid until the frame is
+     * read or modified again
+     */
+    const double* getData(int i) const;
+
+    /**
+     * @return the channels of all the sensors
+     */
+    const double* getData() const;
+
+    virtual bool read(yarp::os::ConnectionReader& connection) override;
+    virtual bool write(yarp::os::ConnectionWriter& connection) override;
+
+private:
+    int seq;
+    double time;
+    std::vector<int> sensors;       // number of channels and status of each sensor
+    std::vector<double> data;
+    std::vector<int> offsets;       // not sent, index of the first channel of each sensor
+};
+
+#endif // YARP_DEV_ANALOGFRAME_H
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2018 Istituto Italiano di Tecnologia (IIT)
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ */
+
+#ifndef YARP_DEV_CIRCULARAUDIOBUFFER_H
+#define YARP_DEV_CIRCULARAUDIOBUFFER_H
+
+#include <yarp/dev/api.h>
+
+#include <cstddef>
+
+namespace yarp {
+    namespace dev {
+        class CircularAudioBuffer;
+    }
+}
+
+/**
+ * @ingroup dev_iface_media
+ *
+ * A circular buffer of audio frames (a 16 bit sample for each channel,
+ * interleaved), between the thread that captures or plays the audio and
+ * the thread of the device driver.
+ *
+ * There must be a single writer and a single reader: read() and write()
+ * never block nor take locks, so they can be called from the callbacks of
+ * the audio libraries, and copy whole blocks of frames. When the buffer is
+ * full, write() drops the frames that do not fit and counts them as an
+ * overrun; when it is empty, readOrSilence() completes the block with
+ * silence and counts the missing frames as an underrun.
+ *
+ * The other side waits with waitFrames() or waitFreeFrames(), and is woken
+ * up by the write() or the read() that makes the frames available, without
+ * polling.
+ */
+class YARP_dev_API yarp::dev::CircularAudioBuffer
+{
+public:
+    /**
+     * Constructor.
+     * @param frames the capacity of the buffer, in frames
+     * @param channels the number of samples of a frame
+     */
+    CircularAudioBuffer(size_t frames, int channels);
+
+    ~CircularAudioBuffer();
+
+    int getChannels() const;
+
+    /**
+     * @return the capacity of the buffer, in frames
+     */
+    size_t getMaxFrames() const;
+
+    /**
+     * @return the frames that can be read
+     */
+    size_t getFrames() const;
+
+    /**
+     * @return the frames that can be written
+     */
+    size_t getFreeFrames() const;
+
+    /**
+     * Append frames to the buffer (writer side).
+     * @param data the frames, of frames*getChannels() samples; if nullptr,
+     * silence is written
+     * @return the frames written, the others are counted as an overrun
+     */
+    size_t write(const short* data, size_t frames);
+
+    /**
+     * Take frames from the buffer (reader side).
+     * @param data where the frames are copied
+     * @return the frames read, less than the requested ones if the buffer
+     * does not have enough
+     */
+    size_t read(short* data, size_t frames);
+
+    /**
+     * Take frames from the buffer (reader side); the missing frames are
+     * filled with silence and counted as an underrun.
+     * @return the frames read from the buffer
+     */
+    size_t readOrSilence(short* data, size_t frames);
+
+    /**
+     * Wait until the buffer has at least the given frames (reader side).
+     * @param frames the frames needed, no more than getMaxFrames()
+     * @param timeout the maximum wait in seconds, negative to wait forever
+     * @return true if the frames are available, false after the timeout or
+     * interrupt()
+     */
+    bool waitFrames(size_t frames, double timeout = -1);
+
+    /**
+     * Wait until the buffer has room for the given frames (writer side).
+     * @see waitFrames()
+     */
+    bool waitFreeFrames(size_t frames, double timeout = -1);
+
+    /**
+     * Wake up the threads waiting in waitFrames() and waitFreeFrames(),
+     * and make the next waits return false at once, until resume().
+     */
+    void interrupt();
+
+    void resume();
+
+    /**
+     * Discard the frames in the buffer (reader side).
+     */
+    void clear();
+
+    /**
+     * @return the frames dropped because the buffer was full
+     */
+    size_t getOverruns() const;
+
+    /**
+     * @return the frames replaced with silence because the buffer was empty
+     */
+    size_t getUnderruns() const;
+
+    void resetCounters();
+
+private:
+    CircularAudioBuffer(const CircularAudioBuffer&);
+    CircularAudioBuffer& operator=(const CircularAudioBuffer&);
+
+    class Private;
+    Private* mPriv;
+};
+
+#endif // YARP_DEV_CIRCULARAUDIOBUFFER_H
@@ -30,6 +30,8 @@
 #include <yarp/dev/IMotorEncoders.h>
 #include <yarp/dev/IMotor.h>
 #include <yarp/dev/IRemoteVariables.h>
+#include <yarp/dev/IRpcBatch.h>
+#include <yarp/dev/IStreamingFrame.h>
 
 namespace yarp {
     namespace dev {
@@ -110,6 +110,9 @@ public:
 #define VOCAB_IMAP_REMOVE             VOCAB4('r','e','m','v')
 #define VOCAB_IMAP_LOAD_COLLECTION    VOCAB4('l','d','c','l')
 #define VOCAB_IMAP_SAVE_COLLECTION    VOCAB4('s','v','c','l')
+#define VOCAB_IMAP_GET_MAP_DELTA      VOCAB4('g','d','l','t')
+#define VOCAB_IMAP_FULL               VOCAB4('f','u','l','l')
+#define VOCAB_IMAP_TILES              VOCAB4('t','i','l','s')
 #define VOCAB_IMAP_OK                 VOCAB3('o','k','k')
 #define VOCAB_IMAP_ERROR              VOCAB3('e','r','r')
 
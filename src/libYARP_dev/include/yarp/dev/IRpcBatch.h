@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2018 Istituto Italiano di Tecnologia (IIT)
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ */
+
+#ifndef YARP_DEV_IRPCBATCH_H
+#define YARP_DEV_IRPCBATCH_H
+
+#include <yarp/dev/api.h>
+#include <yarp/os/Vocab.h>
+
+namespace yarp {
+    namespace dev {
+        class IRpcBatch;
+    }
+}
+
+#define VOCAB_RPC_BATCH VOCAB4('b','t','c','h')
+
+/**
+ * @ingroup dev_iface_motor
+ *
+ * Interface for grouping the configuration calls of a remote device (pids,
+ * limits, control modes, ...) in a few messages.
+ *
+ * Between beginBatch() and endBatch() the setters are not sent, they are
+ * queued and return true. A getter sends the queued setters together with
+ * its own request, in a single message answered with a single reply, so
+ * its result reflects the setters called before it. endBatch() sends what
+ * is left.
+ *
+ * On the wire a batch is the list [btch] (cmd1) (cmd2) ..., and the reply
+ * is [btch] (reply1) (reply2) ..., one for each command, in the same order.
+ */
+class YARP_dev_API yarp::dev::IRpcBatch
+{
+public:
+    virtual ~IRpcBatch() {}
+
+    /**
+     * Start queueing the setters.
+     * @return false if the remote side does not support batches, in this
+     * case the calls are sent one by one as usual
+     */
+    virtual bool beginBatch() = 0;
+
+    /**
+     * Send the queued setters and stop queueing.
+     * @return false if any of the setters called since beginBatch() failed
+     */
+    virtual bool endBatch() = 0;
+};
+
+#endif // YARP_DEV_IRPCBATCH_H
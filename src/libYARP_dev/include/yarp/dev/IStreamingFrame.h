@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2018 Istituto Italiano di Tecnologia (IIT)
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ */
+
+#ifndef YARP_DEV_ISTREAMINGFRAME_H
+#define YARP_DEV_ISTREAMINGFRAME_H
+
+#include <yarp/dev/api.h>
+#include <yarp/dev/StreamingFrame.h>
+
+namespace yarp {
+    namespace dev {
+        class IStreamingFrame;
+    }
+}
+
+/**
+ * @ingroup dev_iface_motor
+ *
+ * Interface for sending several streaming commands, for different groups
+ * of joints and different control modes, at once.
+ *
+ * The remote control board sends the whole frame to the wrapper in a
+ * single message, instead of one message for each command.
+ */
+class YARP_dev_API yarp::dev::IStreamingFrame
+{
+public:
+    virtual ~IStreamingFrame() {}
+
+    /**
+     * Apply all the commands of the frame, in order.
+     * @param frame the commands
+     * @return true/false on success/failure
+     */
+    virtual bool sendStreamingFrame(const yarp::dev::StreamingFrame& frame) = 0;
+};
+
+#endif // YARP_DEV_ISTREAMINGFRAME_H
@@ -7,11 +7,14 @@
 #ifndef YARP_DEV_MAPGRID2D_H
 #define YARP_DEV_MAPGRID2D_H
 
+#include <yarp/os/Bottle.h>
 #include <yarp/os/Portable.h>
 #include <yarp/sig/Image.h>
 #include <yarp/sig/Vector.h>
 #include <yarp/math/Vec2D.h>
 #include <yarp/dev/api.h>
+#include <string>
+#include <vector>
 
 /**
 * \file MapGrid2D.h contains the definition of a map type
@@ -247,6 +250,38 @@ namespace yarp
                 */
                 bool   enlargeObstacles(double size);
 
+                //-------------------------------tiles-------------------------------
+
+                /**
+                * Retrieves the number of tiles of the map. The cells are grouped in square tiles of 64x64 cells,
+                * numbered by row from the top-left corner, so that the changes of a map can be sent tile by tile.
+                * @return the number of tiles.
+                */
+                size_t getTileCount() const;
+
+                /**
+                * Compares the map with an older version of it, tile by tile.
+                * @param older the older version of the map.
+                * @param tiles the indices of the tiles whose cells (occupancy or flags) changed.
+                * @return false if the maps have a different size, in this case the tiles cannot be compared.
+                */
+                bool   getChangedTiles(const MapGrid2D& older, std::vector<size_t>& tiles) const;
+
+                /**
+                * Stores the cells of some tiles of the map, compressed.
+                * @param tiles the indices of the tiles.
+                * @param data the bottle which receives the tiles, to be passed to setTiles() of a map of the same size.
+                * @return true if all the indices are valid, false otherwise.
+                */
+                bool   getTiles(const std::vector<size_t>& tiles, yarp::os::Bottle& data) const;
+
+                /**
+                * Copies in the map the tiles stored by getTiles().
+                * @param data the bottle filled by getTiles().
+                * @return true if the tiles were copied, false if the bottle is invalid or the map has a different size.
+                */
+                bool   setTiles(const yarp::os::Bottle& data);
+
                 //-------------------------------file access functions-------------------------------
 
                 /**
@@ -264,14 +299,16 @@ namespace yarp
                 bool   saveToFile(std::string map_filename) const;
 
                 /*
-                * Read vector from a connection.
-                * return true iff a vector was read correctly
+                * Read a map from a connection.
+                * The layers of the map are received compressed, maps sent in the old uncompressed format are accepted as well.
+                * return true iff a map was read correctly
                 */
                 virtual bool read(yarp::os::ConnectionReader& connection) override;
 
                 /**
-                * Write vector to a connection.
-                * return true iff a vector was written correctly
+                * Write a map to a connection.
+                * The occupancy and flags layers are compressed with a run-length encoding.
+                * return true iff a map was written correctly
                 */
                 virtual bool write(yarp::os::ConnectionWriter& connection) override;
         };
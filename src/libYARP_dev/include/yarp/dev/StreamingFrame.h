@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2018 Istituto Italiano di Tecnologia (IIT)
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ */
+
+#ifndef YARP_DEV_STREAMINGFRAME_H
+#define YARP_DEV_STREAMINGFRAME_H
+
+#include <yarp/dev/api.h>
+#include <yarp/os/Portable.h>
+#include <yarp/os/Vocab.h>
+
+#include <vector>
+
+namespace yarp {
+    namespace dev {
+        class StreamingFrame;
+    }
+}
+
+#define VOCAB_STREAMING_FRAME VOCAB4('s','f','r','m')
+
+/**
+ * @ingroup dev_iface_motor
+ *
+ * A set of streaming commands, each one for a group of joints, sent to a
+ * control board in a single message (see IStreamingFrame).
+ *
+ * Each command is identified by the vocab of the corresponding group
+ * command:
+ *  - VOCAB_POSITION_MOVE_GROUP: IPositionControl2::positionMove()
+ *  - VOCAB_POSITION_DIRECT_GROUP: IPositionDirect::setPositions()
+ *  - VOCAB_VELOCITY_MOVE_GROUP: IVelocityControl2::velocityMove()
+ *  - VOCAB_TORQUES_DIRECT_GROUP: ITorqueControl::setRefTorques()
+ *  - VOCAB_CURRENT_REF_GROUP: ICurrentControl::setRefCurrents()
+ *  - VOCAB_PWMCONTROL_REF_PWM: IPWMControl::setRefDutyCycle() for each joint
+ *
+ * On the wire the frame has a fixed binary layout: the number of commands
+ * and of joints, then the vocab and number of joints of each command, the
+ * joint indexes and the references, so that it can be read without
+ * allocating once the frame reached its size. As yarp::sig::Vector, the
+ * layout assumes a little endian host.
+ */
+class YARP_dev_API yarp::dev::StreamingFrame : public yarp::os::Portable
+{
+public:
+    StreamingFrame();
+
+    /**
+     * Remove all the commands. The memory is kept for the next frame.
+     */
+    void clear();
+
+    /**
+     * Add a command to the frame.
+     * @param vocab the command, see the list above
+     * @param n_joints number of joints
+     * @param joints indexes of the joints
+     * @param refs references, one for each joint
+     * @return false if the command is not valid
+     */
+    bool addCommand(int vocab, int n_joints, const int* joints, const double* refs);
+
+    /**
+     * @return the number of commands
+     */
+    int size() const;
+
+    /**
+     * @return the number of joints of all the commands
+     */
+    int getTotalJoints() const;
+
+    int getVocab(int i) const;
+    int getJointCount(int i) const;
+    const int* getJoints(int i) const;
+    const double* getRefs(int i) const;
+
+    /**
+     * @return true if the given vocab can be used in a frame
+     */
+    static bool isValidCommand(int vocab);
+
+    virtual bool read(yarp::os::ConnectionReader& connection) override;
+    virtual bool write(yarp::os::ConnectionWriter& connection) override;
+
+    /**
+     * Read the frame, after its VOCAB_STREAMING_FRAME header has already
+     * been read. Used by the readers accepting other messages as well.
+     */
+    bool readContent(yarp::os::ConnectionReader& connection);
+
+private:
+    std::vector<int> commands;      // vocab and number of joints of each command
+    std::vector<int> joints;
+    std::vector<double> refs;
+    std::vector<int> offsets;       // not sent, index of the first joint of each command
+};
+
+#endif // YARP_DEV_STREAMINGFRAME_H
@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2018 Istituto Italiano di Tecnologia (IIT)
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ */
+
+#include <yarp/dev/AnalogFrame.h>
+
+#include <yarp/os/ConnectionReader.h>
+#include <yarp/os/ConnectionWriter.h>
+#include <yarp/dev/IAnalogSensor.h>
+
+using namespace yarp::os;
+using namespace yarp::dev;
+
+namespace {
+// Upper bounds to the size of a received frame, to reject corrupted ones
+const int MAX_FRAME_SENSORS = 4096;
+const int MAX_FRAME_CHANNELS = 1 << 20;
+}
+
+AnalogFrame::AnalogFrame() :
+        seq(0),
+        time(0.0)
+{
+}
+
+void AnalogFrame::clear()
+{
+    sensors.clear();
+    data.clear();
+    offsets.clear();
+}
+
+void AnalogFrame::addSensor(const double* d, int channels, int status)
+{
+    if (channels < 0 || d == nullptr) {
+        channels = 0;
+    }
+    offsets.push_back((int)data.size());
+    sensors.push_back(channels);
+    sensors.push_back(status);
+    data.insert(data.end(), d, d + channels);
+}
+
+void AnalogFrame::setStamp(const Stamp& stamp)
+{
+    Stamp s(stamp);
+    seq = s.getCount();
+    time = s.getTime();
+}
+
+Stamp AnalogFrame::getStamp() const
+{
+    return Stamp(seq, time);
+}
+
+int AnalogFrame::size() const
+{
+    return (int)offsets.size();
+}
+
+int AnalogFrame::getTotalChannels() const
+{
+    return (int)data.size();
+}
+
+int AnalogFrame::getChannels(int i) const
+{
+    return sensors[2*i];
+}
+
+int AnalogFrame::getOffset(int i) const
+{
+    return offsets[i];
+}
+
+int AnalogFrame::getStatus(int i) const
+{
+    return sensors[2*i+1];
+}
+
+bool AnalogFrame::isValid(int i) const
+{
+    return sensors[2*i+1] == IAnalogSensor::AS_OK;
+}
+
+const double* AnalogFrame::getData(int i) const
+{
+    return data.data() + offsets[i];
+}
+
+const double* AnalogFrame::getData() const
+{
+    return data.data();
+}
+
+bool AnalogFrame::read(ConnectionReader& connection)
+{
+    int header = connection.expectInt();
+    int n_sensors = connection.expectInt();
+    int n_channels = connection.expectInt();
+    seq = connection.expectInt();
+    time = connection.expectDouble();
+    if (connection.isError() || header != VOCAB_ANALOG_FRAME ||
+            n_sensors < 0 || n_sensors > MAX_FRAME_SENSORS ||
+            n_channels < 0 || n_channels > MAX_FRAME_CHANNELS) {
+        return false;
+    }
+
+    // resize() does not release the memory, the frames of a port are
+    // recycled so they stop allocating after the first messages
+    sensors.resize(2*n_sensors);
+    data.resize(n_channels);
+    offsets.resize(n_sensors);
+
+    bool ok = true;
+    if (n_sensors > 0) {
+        ok = connection.expectBlock((char*)sensors.data(), sensors.size() * sizeof(int));
+    }
+    if (ok && n_channels > 0) {
+        ok = connection.expectBlock((char*)data.data(), data.size() * sizeof(double));
+    }
+    if (!ok) {
+        return false;
+    }
+
+    int offset = 0;
+    for (int i = 0; i < n_sensors; i++) {
+        int count = sensors[2*i];
+        if (count < 0 || offset + count > n_channels) {
+            return false;
+        }
+        offsets[i] = offset;
+        offset += count;
+    }
+    return offset == n_channels;
+}
+
+bool AnalogFrame::write(ConnectionWriter& connection)
+{
+    connection.appendInt(VOCAB_ANALOG_FRAME);
+    connection.appendInt((int)offsets.size());
+    connection.appendInt((int)data.size());
+    connection.appendInt(seq);
+    connection.appendDouble(time);
+    if (!sensors.empty()) {
+        connection.appendExternalBlock((const char*)sensors.data(), sensors.size() * sizeof(int));
+    }
+    if (!data.empty()) {
+        connection.appendExternalBlock((const char*)data.data(), data.size() * sizeof(double));
+    }
+    return !connection.isError();
+}
@@ -0,0 +1,233 @@
+/*
+ * Copyright (C) 2018 Istituto Italiano di Tecnologia (IIT)
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ */
+
+#include <yarp/dev/CircularAudioBuffer.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+using namespace yarp::dev;
+
+class CircularAudioBuffer::Private
+{
+public:
+    int channels;
+    size_t capacity;
+    std::vector<short> samples;
+
+    // frames written and read since the creation of the buffer, each is
+    // only modified by its side
+    std::atomic<size_t> writeCount;
+    std::atomic<size_t> readCount;
+
+    std::atomic<size_t> overruns;
+    std::atomic<size_t> underruns;
+
+    // The frames a waiting thread needs. The side that makes them available
+    // only takes the mutex if a thread is waiting and its frames are there;
+    // as the counts and the requests are sequentially consistent, either
+    // the waiting thread sees the new count, or the other side sees the
+    // request and wakes it up.
+    std::atomic<size_t> wantFrames;
+    std::atomic<size_t> wantFreeFrames;
+    std::atomic<bool> interrupted;
+    std::mutex mutex;
+    std::condition_variable cond;
+
+    Private(size_t frames, int channels) :
+            channels(channels),
+            capacity(frames),
+            samples(frames * channels, 0),
+            writeCount(0),
+            readCount(0),
+            overruns(0),
+            underruns(0),
+            wantFrames(0),
+            wantFreeFrames(0),
+            interrupted(false)
+    {
+    }
+
+    size_t frames() const
+    {
+        return writeCount.load() - readCount.load();
+    }
+
+    void wakeUp(const std::atomic<size_t>& want, size_t available)
+    {
+        size_t n = want.load();
+        if (n != 0 && available >= n) {
+            std::lock_guard<std::mutex> lock(mutex);
+            cond.notify_all();
+        }
+    }
+
+    template <class Ready>
+    bool wait(std::atomic<size_t>& want, size_t n, double timeout, Ready ready)
+    {
+        if (n > capacity) {
+            return false;
+        }
+        if (n == 0 || ready()) {
+            return true;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        want.store(n);
+        auto done = [&]() { return interrupted.load() || ready(); };
+        if (timeout < 0) {
+            cond.wait(lock, done);
+        } else {
+            cond.wait_for(lock, std::chrono::duration<double>(timeout), done);
+        }
+        want.store(0);
+        return !interrupted.load() && ready();
+    }
+};
+
+
+CircularAudioBuffer::CircularAudioBuffer(size_t frames, int channels) :
+        mPriv(new Private(frames, (channels > 0) ? channels : 1))
+{
+}
+
+CircularAudioBuffer::~CircularAudioBuffer()
+{
+    delete mPriv;
+}
+
+int CircularAudioBuffer::getChannels() const
+{
+    return mPriv->channels;
+}
+
+size_t CircularAudioBuffer::getMaxFrames() const
+{
+    return mPriv->capacity;
+}
+
+size_t CircularAudioBuffer::getFrames() const
+{
+    return mPriv->frames();
+}
+
+size_t CircularAudioBuffer::getFreeFrames() const
+{
+    return mPriv->capacity - mPriv->frames();
+}
+
+size_t CircularAudioBuffer::write(const short* data, size_t frames)
+{
+    Private& p = *mPriv;
+    size_t w = p.writeCount.load();
+    size_t free = p.capacity - (w - p.readCount.load());
+    size_t n = std::min(frames, free);
+    if (n < frames) {
+        p.overruns += frames - n;
+    }
+    if (n == 0) {
+        return 0;
+    }
+
+    size_t pos = w % p.capacity;
+    size_t first = std::min(n, p.capacity - pos);
+    size_t frameSize = p.channels * sizeof(short);
+    short* dest = p.samples.data();
+    if (data != nullptr) {
+        memcpy(dest + pos * p.channels, data, first * frameSize);
+        memcpy(dest, data + first * p.channels, (n - first) * frameSize);
+    } else {
+        memset(dest + pos * p.channels, 0, first * frameSize);
+        memset(dest, 0, (n - first) * frameSize);
+    }
+
+    p.writeCount.store(w + n);
+    p.wakeUp(p.wantFrames, p.frames());
+    return n;
+}
+
+size_t CircularAudioBuffer::read(short* data, size_t frames)
+{
+    Private& p = *mPriv;
+    size_t r = p.readCount.load();
+    size_t n = std::min(frames, p.writeCount.load() - r);
+    if (n == 0) {
+        return 0;
+    }
+
+    size_t pos = r % p.capacity;
+    size_t first = std::min(n, p.capacity - pos);
+    size_t frameSize = p.channels * sizeof(short);
+    const short* src = p.samples.data();
+    memcpy(data, src + pos * p.channels, first * frameSize);
+    memcpy(data + first * p.channels, src, (n - first) * frameSize);
+
+    p.readCount.store(r + n);
+    p.wakeUp(p.wantFreeFrames, p.capacity - p.frames());
+    return n;
+}
+
+size_t CircularAudioBuffer::readOrSilence(short* data, size_t frames)
+{
+    size_t n = read(data, frames);
+    if (n < frames) {
+        mPriv->underruns += frames - n;
+        memset(data + n * mPriv->channels, 0, (frames - n) * mPriv->channels * sizeof(short));
+    }
+    return n;
+}
+
+bool CircularAudioBuffer::waitFrames(size_t frames, double timeout)
+{
+    Private& p = *mPriv;
+    return p.wait(p.wantFrames, frames, timeout,
+                  [&]() { return p.frames() >= frames; });
+}
+
+bool CircularAudioBuffer::waitFreeFrames(size_t frames, double timeout)
+{
+    Private& p = *mPriv;
+    return p.wait(p.wantFreeFrames, frames, timeout,
+                  [&]() { return p.capacity - p.frames() >= frames; });
+}
+
+void CircularAudioBuffer::interrupt()
+{
+    std::lock_guard<std::mutex> lock(mPriv->mutex);
+    mPriv->interrupted = true;
+    mPriv->cond.notify_all();
+}
+
+void CircularAudioBuffer::resume()
+{
+    mPriv->interrupted = false;
+}
+
+void CircularAudioBuffer::clear()
+{
+    Private& p = *mPriv;
+    p.readCount.store(p.writeCount.load());
+    p.wakeUp(p.wantFreeFrames, p.capacity);
+}
+
+size_t CircularAudioBuffer::getOverruns() const
+{
+    return mPriv->overruns.load();
+}
+
+size_t CircularAudioBuffer::getUnderruns() const
+{
+    return mPriv->underruns.load();
+}
+
+void CircularAudioBuffer::resetCounters()
+{
+    mPriv->overruns = 0;
+    mPriv->underruns = 0;
+}
@@ -5,7 +5,9 @@
  */
 
 
+#include <yarp/os/LockGuard.h>
 #include <yarp/os/Log.h>
+#include <yarp/os/Mutex.h>
 #include <yarp/os/Os.h>
 #include <yarp/os/Property.h>
 #include <yarp/os/ResourceFinder.h>
@@ -26,6 +28,8 @@
 #include <vector>
 #include <sstream>
 #include <iterator>
+#include <string>
+#include <unordered_map>
 
 using namespace yarp::os;
 using namespace yarp::dev;
@@ -35,7 +39,12 @@ Drivers Drivers::instance;
 
 class DriversHelper : public YarpPluginSelector {
 public:
+    // the devices can be opened by many threads at once (e.g. by
+    // yarprobotinterface), so the factory is serialized
+    Mutex mutex;
     std::vector<DriverCreator *> delegates;
+    // the first creator added for each name
+    std::unordered_map<std::string, DriverCreator *> byName;
 
     ~DriversHelper() {
         for (unsigned int i=0; i<delegates.size(); i++) {
@@ -50,6 +59,7 @@ public:
     }
 
     ConstString toString() {
+        LockGuard guard(mutex);
         ConstString s;
         Property done;
         for (unsigned int i=0; i<delegates.size(); i++) {
@@ -128,25 +138,31 @@ public:
     }
 
     void add(DriverCreator *creator) {
+        LockGuard guard(mutex);
+        addLocked(creator);
+    }
+
+    void addLocked(DriverCreator *creator) {
         if (creator!=nullptr) {
             delegates.push_back(creator);
+            byName.insert(std::make_pair(std::string(creator->toString()), creator));
         }
     }
 
     DriverCreator *load(const char *name);
 
     DriverCreator *find(const char *name) {
-        for (unsigned int i=0; i<delegates.size(); i++) {
-            if (delegates[i]==nullptr) continue;
-            ConstString s = delegates[i]->toString();
-            if (s==name) {
-                return delegates[i];
-            }
+        LockGuard guard(mutex);
+        auto it = byName.find(name);
+        if (it!=byName.end()) {
+            return it->second;
         }
         return load(name);
     }
 
     bool remove(const char *name) {
+        LockGuard guard(mutex);
+        byName.erase(name);
         for (unsigned int i=0; i<delegates.size(); i++) {
             if (delegates[i]==nullptr) continue;
             ConstString s = delegates[i]->toString();
@@ -277,6 +293,7 @@ DeviceDriver *Drivers::open(yarp::os::Searchable& prop) {
     return poly.take();
 }
 
+// called by find(), with the mutex locked
 DriverCreator *DriversHelper::load(const char *name) {
     StubDriver *result = new StubDriver(name,false);
     if (!result->isValid()) {
@@ -289,7 +306,7 @@ DriverCreator *DriversHelper::load(const char *name) {
                                                    result->getClassName().c_str(),
                                                    result->getDllName().c_str(),
                                                    result->getFnName().c_str());
-    add(creator);
+    addLocked(creator);
     delete result;
     return creator;
 }
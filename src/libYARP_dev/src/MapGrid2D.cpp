@@ -6,11 +6,13 @@
 
 #include <yarp/dev/MapGrid2D.h>
 #include <yarp/os/Bottle.h>
+#include <yarp/os/Vocab.h>
 #include <yarp/sig/ImageFile.h>
 #include <yarp/os/LogStream.h>
 #include <algorithm>
 #include <fstream>
 #include <cmath>
+#include <cstring>
 
 using namespace yarp::dev;
 using namespace yarp::sig;
@@ -35,6 +37,105 @@ string extractExtensionFromFile(string full_filename)
     return full_filename.substr(start, 3);
 }
 
+namespace {
+// The layers of the maps are sent compressed, the tiles have 64x64 cells
+const int MAP_ENCODING_RLE = VOCAB3('r','l','e');
+const size_t MAP_TILE_SIZE = 64;
+// Upper bound to the size of a received map, to reject corrupted ones
+const size_t MAP_MAX_CELLS = 1 << 30;
+
+// Run-length encoding of a block of bytes (PackBits): a header byte
+// n < 128 is followed by n+1 bytes copied as they are, a header byte
+// n >= 128 by a single byte repeated n-125 times (3 to 130 times).
+void rleEncode(const unsigned char* data, size_t len, vector<unsigned char>& out)
+{
+    size_t i = 0;
+    while (i < len)
+    {
+        size_t run = 1;
+        while (i + run < len && run < 130 && data[i + run] == data[i]) run++;
+        if (run >= 3)
+        {
+            out.push_back((unsigned char)(run + 125));
+            out.push_back(data[i]);
+            i += run;
+            continue;
+        }
+        // the literal bytes go on until the next run of 3 bytes
+        size_t start = i;
+        while (i < len && i - start < 128)
+        {
+            if (i + 2 < len && data[i] == data[i + 1] && data[i] == data[i + 2]) break;
+            i++;
+        }
+        out.push_back((unsigned char)(i - start - 1));
+        out.insert(out.end(), data + start, data + i);
+    }
+}
+
+bool rleDecode(const unsigned char* data, size_t len, unsigned char* out, size_t outLen)
+{
+    size_t i = 0;
+    size_t o = 0;
+    while (i < len)
+    {
+        size_t header = data[i++];
+        if (header < 128)
+        {
+            size_t n = header + 1;
+            if (i + n > len || o + n > outLen) return false;
+            memcpy(out + o, data + i, n);
+            i += n;
+            o += n;
+        }
+        else
+        {
+            size_t n = header - 125;
+            if (i >= len || o + n > outLen) return false;
+            memset(out + o, data[i++], n);
+            o += n;
+        }
+    }
+    return o == outLen;
+}
+
+// Compresses a layer of the map, without the padding of the rows
+void encodeLayer(const ImageOf<PixelMono>& image, vector<unsigned char>& out)
+{
+    out.clear();
+    size_t w = image.width();
+    size_t h = image.height();
+    if ((size_t)image.getRowSize() == w)
+    {
+        rleEncode(image.getRawImage(), w * h, out);
+        return;
+    }
+    vector<unsigned char> packed(w * h);
+    for (size_t y = 0; y < h; y++)
+    {
+        memcpy(packed.data() + y * w, image.getRow(y), w);
+    }
+    rleEncode(packed.data(), packed.size(), out);
+}
+
+bool decodeLayer(const vector<unsigned char>& in, ImageOf<PixelMono>& image)
+{
+    size_t w = image.width();
+    size_t h = image.height();
+    if ((size_t)image.getRowSize() == w)
+    {
+        return rleDecode(in.data(), in.size(), image.getRawImage(), w * h);
+    }
+    vector<unsigned char> packed(w * h);
+    if (!rleDecode(in.data(), in.size(), packed.data(), packed.size())) return false;
+    for (size_t y = 0; y < h; y++)
+    {
+        memcpy(image.getRow(y), packed.data() + y * w, w);
+    }
+    return true;
+}
+}
+
 
 bool MapGrid2D::isIdenticalTo(const MapGrid2D& other) const
 {
@@ -736,12 +837,15 @@ bool MapGrid2D::read(yarp::os::ConnectionReader& connection)
     connection.convertTextMode();
 
     connection.expectInt();
-    connection.expectInt();
+    int items = connection.expectInt();
+    // 9 items for the maps with the uncompressed layers
+    bool compressed = (items == 10);
+    if (items != 9 && !compressed) return false;
 
     connection.expectInt();
-    m_width = connection.expectInt();
+    int width = connection.expectInt();
     connection.expectInt();
-    m_height = connection.expectInt();
+    int height = connection.expectInt();
     connection.expectInt();
     m_origin.x = connection.expectDouble();
     connection.expectInt();
@@ -752,34 +856,57 @@ bool MapGrid2D::read(yarp::os::ConnectionReader& connection)
     m_resolution = connection.expectDouble();
     connection.expectInt();
     int siz = connection.expectInt();
-    char buff[255]; memset(buff, 0, 255);
-    connection.expectBlock((char*)buff, siz);
-    m_map_name = buff;
+    if (connection.isError() || siz < 0 || siz > 65536) return false;
+    if (width <= 0 || height <= 0 || (size_t)width * (size_t)height > MAP_MAX_CELLS) return false;
+    string name(siz, '\0');
+    if (siz > 0 && !connection.expectBlock(&name[0], siz)) return false;
+    m_map_name = name.c_str();
+    m_width = width;
+    m_height = height;
     m_map_occupancy.resize(m_width, m_height);
     m_map_flags.resize(m_width, m_height);
-    bool ok = true;
-    unsigned char *mem = nullptr;
-    int            memsize = 0;
-    connection.expectInt();
-    memsize = connection.expectInt();
-    if (memsize != m_map_occupancy.getRawImageSize()) { return false; }
-    mem = m_map_occupancy.getRawImage();
-    ok &= connection.expectBlock((char*)mem, memsize);
-    connection.expectInt();
-    memsize = connection.expectInt();
-    if (memsize != m_map_flags.getRawImageSize()) { return false; }
-    mem = m_map_flags.getRawImage();
-    ok &= connection.expectBlock((char*)mem, memsize);
-    if (!ok) return false;
 
+    if (!compressed)
+    {
+        bool ok = true;
+        unsigned char *mem = nullptr;
+        int            memsize = 0;
+        connection.expectInt();
+        memsize = connection.expectInt();
+        if (memsize != m_map_occupancy.getRawImageSize()) { return false; }
+        mem = m_map_occupancy.getRawImage();
+        ok &= connection.expectBlock((char*)mem, memsize);
+        connection.expectInt();
+        memsize = connection.expectInt();
+        if (memsize != m_map_flags.getRawImageSize()) { return false; }
+        mem = m_map_flags.getRawImage();
+        ok &= connection.expectBlock((char*)mem, memsize);
+        if (!ok) return false;
+        return !connection.isError();
+    }
+
+    connection.expectInt();
+    if (connection.expectInt() != MAP_ENCODING_RLE) return false;
+    vector<unsigned char> buffer;
+    ImageOf<CellData>* layers[2] = { &m_map_occupancy, &m_map_flags };
+    for (int i = 0; i < 2; i++)
+    {
+        connection.expectInt();
+        int memsize = connection.expectInt();
+        // the encoding adds at most a byte every 128
+        size_t cells = m_width * m_height;
+        if (connection.isError() || memsize < 0 || (size_t)memsize > cells + cells / 128 + 1) return false;
+        buffer.resize(memsize);
+        if (memsize > 0 && !connection.expectBlock((char*)buffer.data(), memsize)) return false;
+        if (!decodeLayer(buffer, *layers[i])) return false;
+    }
     return !connection.isError();
-        return true;
 }
 
 bool MapGrid2D::write(yarp::os::ConnectionWriter& connection)
 {
     connection.appendInt(BOTTLE_TAG_LIST);
-    connection.appendInt(9);
+    connection.appendInt(10);
     connection.appendInt(BOTTLE_TAG_INT);
     connection.appendInt(m_width);
     connection.appendInt(BOTTLE_TAG_INT);
@@ -794,24 +921,125 @@ bool MapGrid2D::write(yarp::os::ConnectionWriter& connection)
     connection.appendDouble(m_resolution);
     connection.appendInt(BOTTLE_TAG_STRING);
     connection.appendRawString(m_map_name.c_str());
+    connection.appendInt(BOTTLE_TAG_VOCAB);
+    connection.appendInt(MAP_ENCODING_RLE);
 
-    unsigned char *mem = nullptr;
-    int            memsize = 0;
-    mem     = m_map_occupancy.getRawImage();
-    memsize = m_map_occupancy.getRawImageSize();
+    // the compressed layers are copied in the message, they are much
+    // smaller than the maps
+    vector<unsigned char> buffer;
+    encodeLayer(m_map_occupancy, buffer);
     connection.appendInt(BOTTLE_TAG_BLOB);
-    connection.appendInt(memsize);
-    connection.appendExternalBlock((char*)mem, memsize);
-    mem     = m_map_flags.getRawImage();
-    memsize = m_map_flags.getRawImageSize();
+    connection.appendInt((int)buffer.size());
+    connection.appendBlock((const char*)buffer.data(), buffer.size());
+    encodeLayer(m_map_flags, buffer);
     connection.appendInt(BOTTLE_TAG_BLOB);
-    connection.appendInt(memsize);
-    connection.appendExternalBlock((char*)mem, memsize);
+    connection.appendInt((int)buffer.size());
+    connection.appendBlock((const char*)buffer.data(), buffer.size());
 
     connection.convertTextMode();
     return !connection.isError();
 }
 
+size_t MapGrid2D::getTileCount() const
+{
+    size_t tiles_x = (m_width + MAP_TILE_SIZE - 1) / MAP_TILE_SIZE;
+    size_t tiles_y = (m_height + MAP_TILE_SIZE - 1) / MAP_TILE_SIZE;
+    return tiles_x * tiles_y;
+}
+
+bool MapGrid2D::getChangedTiles(const MapGrid2D& older, std::vector<size_t>& tiles) const
+{
+    tiles.clear();
+    if (older.m_width != m_width || older.m_height != m_height) return false;
+
+    size_t tiles_x = (m_width + MAP_TILE_SIZE - 1) / MAP_TILE_SIZE;
+    vector<bool> changed(getTileCount(), false);
+    for (size_t y = 0; y < m_height; y++)
+    {
+        const unsigned char* occ = m_map_occupancy.getRow(y);
+        const unsigned char* occ_old = older.m_map_occupancy.getRow(y);
+        const unsigned char* flg = m_map_flags.getRow(y);
+        const unsigned char* flg_old = older.m_map_flags.getRow(y);
+        size_t row = (y / MAP_TILE_SIZE) * tiles_x;
+        for (size_t x = 0; x < m_width; x += MAP_TILE_SIZE)
+        {
+            size_t n = std::min(MAP_TILE_SIZE, m_width - x);
+            if (memcmp(occ + x, occ_old + x, n) != 0 || memcmp(flg + x, flg_old + x, n) != 0)
+            {
+                changed[row + x / MAP_TILE_SIZE] = true;
+            }
+        }
+    }
+    for (size_t i = 0; i < changed.size(); i++)
+    {
+        if (changed[i]) tiles.push_back(i);
+    }
+    return true;
+}
+
+bool MapGrid2D::getTiles(const std::vector<size_t>& tiles, yarp::os::Bottle& data) const
+{
+    data.clear();
+    data.addInt((int)m_width);
+    data.addInt((int)m_height);
+
+    size_t tiles_x = (m_width + MAP_TILE_SIZE - 1) / MAP_TILE_SIZE;
+    vector<unsigned char> cells;
+    vector<unsigned char> buffer;
+    for (size_t i = 0; i < tiles.size(); i++)
+    {
+        if (tiles[i] >= getTileCount()) return false;
+        size_t x0 = (tiles[i] % tiles_x) * MAP_TILE_SIZE;
+        size_t y0 = (tiles[i] / tiles_x) * MAP_TILE_SIZE;
+        size_t w = std::min(MAP_TILE_SIZE, m_width - x0);
+        size_t h = std::min(MAP_TILE_SIZE, m_height - y0);
+
+        // the occupancy of the cells of the tile, followed by their flags
+        cells.resize(2 * w * h);
+        for (size_t y = 0; y < h; y++)
+        {
+            memcpy(cells.data() + y * w, m_map_occupancy.getRow(y0 + y) + x0, w);
+            memcpy(cells.data() + (h + y) * w, m_map_flags.getRow(y0 + y) + x0, w);
+        }
+        buffer.clear();
+        rleEncode(cells.data(), cells.size(), buffer);
+        data.addInt((int)tiles[i]);
+        data.add(Value::makeBlob(buffer.data(), (int)buffer.size()));
+    }
+    return true;
+}
+
+bool MapGrid2D::setTiles(const yarp::os::Bottle& data)
+{
+    if (data.size() < 2 || data.size() % 2 != 0) return false;
+    if (data.get(0).asInt() != (int)m_width || data.get(1).asInt() != (int)m_height) return false;
+
+    size_t tiles_x = (m_width + MAP_TILE_SIZE - 1) / MAP_TILE_SIZE;
+    vector<unsigned char> cells;
+    for (int i = 2; i < data.size(); i += 2)
+    {
+        int tile = data.get(i).asInt();
+        const Value& blob = data.get(i + 1);
+        if (tile < 0 || (size_t)tile >= getTileCount() || !blob.isBlob()) return false;
+        size_t x0 = (tile % tiles_x) * MAP_TILE_SIZE;
+        size_t y0 = (tile / tiles_x) * MAP_TILE_SIZE;
+        size_t w = std::min(MAP_TILE_SIZE, m_width - x0);
+        size_t h = std::min(MAP_TILE_SIZE, m_height - y0);
+
+        cells.resize(2 * w * h);
+        if (!rleDecode((const unsigned char*)blob.asBlob(), blob.asBlobLength(), cells.data(), cells.size()))
+        {
+            return false;
+        }
+        for (size_t y = 0; y < h; y++)
+        {
+            memcpy(m_map_occupancy.getRow(y0 + y) + x0, cells.data() + y * w, w);
+            memcpy(m_map_flags.getRow(y0 + y) + x0, cells.data() + (h + y) * w, w);
+        }
+    }
+    return true;
+}
+
 MapGrid2D::XYWorld MapGrid2D::cell2World(MapGrid2D::XYCell cell) const
 {
     //convert a cell (from the upper-left corner) to the map reference frame (located in m_origin, measured in meters)
@@ -29,6 +29,7 @@ using namespace yarp::dev;
 extern DriverCreator *createRemoteControlBoard();
 extern DriverCreator *createAnalogSensorClient();
 extern DriverCreator *createAnalogWrapper();
+extern DriverCreator *createMultipleAnalogWrapper();
 extern DriverCreator *createControlBoardWrapper();
 extern DriverCreator *createVirtualAnalogWrapper();
 extern DriverCreator *createServerInertial();
@@ -90,6 +91,7 @@ void Drivers::init() {
     add(createBatteryClient());
     add(createAnalogSensorClient());
     add(createAnalogWrapper());
+    add(createMultipleAnalogWrapper());
     add(createVirtualAnalogWrapper());
     add(createBatteryWrapper());
     add(createRangefinder2DWrapper());
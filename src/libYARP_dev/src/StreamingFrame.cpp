@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2018 Istituto Italiano di Tecnologia (IIT)
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ */
+
+#include <yarp/dev/StreamingFrame.h>
+
+#include <yarp/os/ConnectionReader.h>
+#include <yarp/os/ConnectionWriter.h>
+#include <yarp/dev/ControlBoardInterfaces.h>
+
+using namespace yarp::os;
+using namespace yarp::dev;
+
+namespace {
+// Upper bound to the size of a received frame, to reject corrupted ones
+const int MAX_FRAME_JOINTS = 65536;
+}
+
+StreamingFrame::StreamingFrame()
+{
+}
+
+void StreamingFrame::clear()
+{
+    commands.clear();
+    joints.clear();
+    refs.clear();
+    offsets.clear();
+}
+
+bool StreamingFrame::isValidCommand(int vocab)
+{
+    switch (vocab) {
+    case VOCAB_POSITION_MOVE_GROUP:
+    case VOCAB_POSITION_DIRECT_GROUP:
+    case VOCAB_VELOCITY_MOVE_GROUP:
+    case VOCAB_TORQUES_DIRECT_GROUP:
+    case VOCAB_CURRENT_REF_GROUP:
+    case VOCAB_PWMCONTROL_REF_PWM:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool StreamingFrame::addCommand(int vocab, int n_joints, const int* j, const double* r)
+{
+    if (!isValidCommand(vocab) || n_joints <= 0 || j == nullptr || r == nullptr) {
+        return false;
+    }
+    offsets.push_back((int)joints.size());
+    commands.push_back(vocab);
+    commands.push_back(n_joints);
+    joints.insert(joints.end(), j, j + n_joints);
+    refs.insert(refs.end(), r, r + n_joints);
+    return true;
+}
+
+int StreamingFrame::size() const
+{
+    return (int)offsets.size();
+}
+
+int StreamingFrame::getTotalJoints() const
+{
+    return (int)joints.size();
+}
+
+int StreamingFrame::getVocab(int i) const
+{
+    return commands[2*i];
+}
+
+int StreamingFrame::getJointCount(int i) const
+{
+    return commands[2*i+1];
+}
+
+const int* StreamingFrame::getJoints(int i) const
+{
+    return &joints[offsets[i]];
+}
+
+const double* StreamingFrame::getRefs(int i) const
+{
+    return &refs[offsets[i]];
+}
+
+bool StreamingFrame::read(ConnectionReader& connection)
+{
+    int header = connection.expectInt();
+    if (connection.isError() || header != VOCAB_STREAMING_FRAME) {
+        return false;
+    }
+    return readContent(connection);
+}
+
+bool StreamingFrame::readContent(ConnectionReader& connection)
+{
+    int n_commands = connection.expectInt();
+    int n_joints = connection.expectInt();
+    if (connection.isError() ||
+            n_commands < 0 || n_joints < n_commands || n_joints > MAX_FRAME_JOINTS) {
+        return false;
+    }
+
+    // resize() does not release the memory, the frames of a port are
+    // recycled so they stop allocating after the first messages
+    commands.resize(2*n_commands);
+    joints.resize(n_joints);
+    refs.resize(n_joints);
+    offsets.resize(n_commands);
+
+    if (n_commands == 0) {
+        return true;
+    }
+
+    bool ok = connection.expectBlock((char*)commands.data(), commands.size() * sizeof(int));
+    ok = ok && connection.expectBlock((char*)joints.data(), joints.size() * sizeof(int));
+    ok = ok && connection.expectBlock((char*)refs.data(), refs.size() * sizeof(double));
+    if (!ok) {
+        return false;
+    }
+
+    int offset = 0;
+    for (int i = 0; i < n_commands; i++) {
+        int count = commands[2*i+1];
+        if (count <= 0 || offset + count > n_joints) {
+            return false;
+        }
+        offsets[i] = offset;
+        offset += count;
+    }
+    return offset == n_joints;
+}
+
+bool StreamingFrame::write(ConnectionWriter& connection)
+{
+    connection.appendInt(VOCAB_STREAMING_FRAME);
+    connection.appendInt((int)offsets.size());
+    connection.appendInt((int)joints.size());
+    if (!offsets.empty()) {
+        connection.appendExternalBlock((const char*)commands.data(), commands.size() * sizeof(int));
+        connection.appendExternalBlock((const char*)joints.data(), joints.size() * sizeof(int));
+        connection.appendExternalBlock((const char*)refs.data(), refs.size() * sizeof(double));
+    }
+    return !connection.isError();
+}
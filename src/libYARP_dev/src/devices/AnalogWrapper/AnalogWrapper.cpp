@@ -7,6 +7,7 @@
 #include "AnalogWrapper.h"
 #include <sstream>
 #include <iostream>
+#include <cstring>
 #include <yarp/dev/ControlBoardInterfaces.h>
 #include <yarp/os/Log.h>
 #include <yarp/os/LogStream.h>
@@ -160,6 +161,7 @@ AnalogWrapper::AnalogWrapper(const char* name, int rate): RateThread(rate)
     rosTopicName    = "";
     rosNode         = nullptr;
     rosMsgCounter   = 0;
+    rosMsgKind      = ROS_MSG_NONE;
 
     ownDevices      = false;
     subDeviceOwned  = nullptr;
@@ -193,6 +195,7 @@ AnalogWrapper::AnalogWrapper(const std::vector<AnalogPortEntry>& _analogPorts, i
     rosTopicName(""),
     rosNode(nullptr),
     rosMsgCounter(0),
+    rosMsgKind(ROS_MSG_NONE),
     ownDevices(false),
     subDeviceOwned(nullptr)
 {
@@ -224,6 +227,7 @@ AnalogWrapper::AnalogWrapper() :
     rosTopicName    = "";
     rosNode         = nullptr;
     rosMsgCounter   = 0;
+    rosMsgKind      = ROS_MSG_NONE;
 }
 
 AnalogWrapper::~AnalogWrapper()
@@ -483,6 +487,7 @@ bool AnalogWrapper::checkROSParams(Searchable &config)
         return false;
     }
     rosMsgType = rosGroup.find("ROS_msgType").asString();
+    rosMsgKind = ROS_MSG_NONE;
 
     // check for frame_id parameter
     if (rosMsgType == "geometry_msgs/WrenchStamped")
@@ -496,6 +501,7 @@ bool AnalogWrapper::checkROSParams(Searchable &config)
         }
         frame_id = rosGroup.find("frame_id").asString();
         yInfo() << sensorId << "frame_id is " << frame_id;
+        rosMsgKind = ROS_MSG_WRENCH;
     }
     else if (rosMsgType == "sensor_msgs/JointState")
     {
@@ -544,6 +550,7 @@ bool AnalogWrapper::checkROSParams(Searchable &config)
         {
             ros_joint_names.push_back(jnam.get(i+1).asString());
         }
+        rosMsgKind = ROS_MSG_JOINT_STATE;
     }
     else
     {
@@ -831,14 +838,18 @@ void AnalogWrapper::run()
                                     <<" Vector size expected to be at least "<<last<<" whereas it is "<< lastDataRead.size();
                             continue;
                         }
-                        pv = lastDataRead.subVector(first, last);
+                        // copy in place, the vectors of the port are recycled
+                        // so they are not reallocated as subVector() would do
+                        if ((int)pv.size() != last-first+1)
+                            pv.resize(last-first+1);
+                        memcpy(pv.data(), lastDataRead.data()+first, (last-first+1)*sizeof(double));
 
                         analogPorts[i].port.setEnvelope(lastStateStamp);
                         analogPorts[i].port.write();
                     }
                 }
 
-                if (useROS != ROS_disabled && rosMsgType == "geometry_msgs/WrenchStamped")
+                if (useROS != ROS_disabled && rosMsgKind == ROS_MSG_WRENCH)
                 {
                     geometry_msgs_WrenchStamped rosData;
                     rosData.header.seq = rosMsgCounter++;
@@ -855,7 +866,7 @@ void AnalogWrapper::run()
 
                     rosPublisherWrenchPort.write(rosData);
                 }
-                else if (useROS != ROS_disabled && rosMsgType == "sensor_msgs/JointState")
+                else if (useROS != ROS_disabled && rosMsgKind == ROS_MSG_JOINT_STATE)
                 {
                     sensor_msgs_JointState rosData;
                     size_t data_size = lastDataRead.size();
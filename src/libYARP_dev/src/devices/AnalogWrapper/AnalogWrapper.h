@@ -237,6 +237,7 @@ private:
     std::string                                              rosTopicName;               // name of the rosTopic
     yarp::os::Node                                           *rosNode;                   // add a ROS node
     yarp::os::NetUint32                                      rosMsgCounter;              // incremental counter in the ROS message
+    enum { ROS_MSG_NONE, ROS_MSG_WRENCH, ROS_MSG_JOINT_STATE } rosMsgKind;              // rosMsgType, parsed once at open
 
     // TODO: in the future, in order to support multiple ROS msgs this should be a pointer allocated dynamically depending on the msg maybe (??)
     //  yarp::os::PortWriterBuffer<geometry_msgs_WrenchStamped>  rosOutputWrench_buffer;      // Buffer associated to the ROS topic
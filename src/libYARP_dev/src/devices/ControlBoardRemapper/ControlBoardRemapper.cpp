@@ -491,6 +491,7 @@ void ControlBoardRemapper::configureBuffers()
 {
     allJointsBuffers.configure(remappedControlBoards);
     selectedJointsBuffers.configure(remappedControlBoards);
+    streamingFrames.resize(remappedControlBoards.getNrOfSubControlBoards());
 }
 
 
@@ -4513,4 +4514,158 @@ bool ControlBoardRemapper::getRefCurrents(double* currs)
     return ret;
 }
 
+//
+// IStreamingFrame interface
+//
+
+bool ControlBoardRemapper::sendStreamingFrame(const yarp::dev::StreamingFrame& frame)
+{
+    bool ret=true;
+    LockGuard guard(selectedJointsBuffers.mutex);
+
+    for(size_t ctrlBrd=0; ctrlBrd < streamingFrames.size(); ctrlBrd++)
+    {
+        streamingFrames[ctrlBrd].clear();
+    }
+
+    // Split each command among the subcontrolboards, keeping their order
+    for(int i=0; i < frame.size(); i++)
+    {
+        int n_joints = frame.getJointCount(i);
+        const int *joints = frame.getJoints(i);
+
+        for(int j=0; j < n_joints; j++)
+        {
+            if (joints[j] < 0 || joints[j] >= controlledJoints)
+            {
+                yError() << "ControlBoardRemapper: streaming frame with joint" << joints[j] << "out of range";
+                return false;
+            }
+        }
+
+        selectedJointsBuffers.fillSubControlBoardBuffersFromArbitraryJointVector(frame.getRefs(i),n_joints,joints,remappedControlBoards);
+
+        for(size_t ctrlBrd=0; ctrlBrd < remappedControlBoards.getNrOfSubControlBoards(); ctrlBrd++)
+        {
+            if (selectedJointsBuffers.m_nJointsInSubControlBoard[ctrlBrd] > 0)
+            {
+                streamingFrames[ctrlBrd].addCommand(frame.getVocab(i),
+                                                    selectedJointsBuffers.m_nJointsInSubControlBoard[ctrlBrd],
+                                                    selectedJointsBuffers.m_jointsInSubControlBoard[ctrlBrd].data(),
+                                                    selectedJointsBuffers.m_bufferForSubControlBoard[ctrlBrd].data());
+            }
+        }
+    }
+
+    // Send one frame to each subcontrolboard
+    for(size_t ctrlBrd=0; ctrlBrd < remappedControlBoards.getNrOfSubControlBoards(); ctrlBrd++)
+    {
+        const yarp::dev::StreamingFrame& subFrame = streamingFrames[ctrlBrd];
+        if (subFrame.size() == 0)
+        {
+            continue;
+        }
+
+        yarp::dev::RemappedSubControlBoard *p=remappedControlBoards.getSubControlBoard(ctrlBrd);
+
+        bool ok;
+        if (p->iStream)
+        {
+            ok = p->iStream->sendStreamingFrame(subFrame);
+        }
+        else
+        {
+            ok = applyStreamingFrame(p, subFrame);
+        }
+        ret = ret && ok;
+    }
+
+    return ret;
+}
+
+bool ControlBoardRemapper::applyStreamingFrame(yarp::dev::RemappedSubControlBoard *p, const yarp::dev::StreamingFrame& frame)
+{
+    bool ret=true;
+
+    for(int i=0; i < frame.size(); i++)
+    {
+        int n_joints = frame.getJointCount(i);
+        const int *joints = frame.getJoints(i);
+        const double *refs = frame.getRefs(i);
 
+        bool ok=false;
+        switch (frame.getVocab(i))
+        {
+        case VOCAB_POSITION_MOVE_GROUP:
+            ok = p->pos2 && p->pos2->positionMove(n_joints, joints, refs);
+            break;
+        case VOCAB_POSITION_DIRECT_GROUP:
+            ok = p->posDir && p->posDir->setPositions(n_joints, joints, const_cast<double*>(refs));
+            break;
+        case VOCAB_VELOCITY_MOVE_GROUP:
+            ok = p->vel2 && p->vel2->velocityMove(n_joints, joints, refs);
+            break;
+        case VOCAB_TORQUES_DIRECT_GROUP:
+            ok = p->iTorque && p->iTorque->setRefTorques(n_joints, joints, refs);
+            break;
+        case VOCAB_CURRENT_REF_GROUP:
+            ok = p->iCurr && p->iCurr->setRefCurrents(n_joints, joints, refs);
+            break;
+        case VOCAB_PWMCONTROL_REF_PWM:
+            ok = (p->iPwm != nullptr);
+            for(int j=0; ok && j < n_joints; j++)
+            {
+                ok = p->iPwm->setRefDutyCycle(joints[j], refs[j]);
+            }
+            break;
+        }
+        ret = ret && ok;
+    }
+
+    return ret;
+}
+
+//
+// IRpcBatch interface
+//
+
+bool ControlBoardRemapper::beginBatch()
+{
+    bool ret=true;
+
+    for(size_t ctrlBrd=0; ctrlBrd < remappedControlBoards.getNrOfSubControlBoards(); ctrlBrd++)
+    {
+        yarp::dev::RemappedSubControlBoard *p=remappedControlBoards.getSubControlBoard(ctrlBrd);
+
+        bool ok = p->iBatch ? p->iBatch->beginBatch() : false;
+        ret = ret && ok;
+    }
+
+    // A batch is possible only if all the subcontrolboards support it:
+    // otherwise the caller does not call endBatch(), so the batches
+    // already begun are ended here, and every call is sent as usual
+    if (!ret)
+    {
+        endBatch();
+    }
+
+    return ret;
+}
+
+bool ControlBoardRemapper::endBatch()
+{
+    bool ret=true;
+
+    for(size_t ctrlBrd=0; ctrlBrd < remappedControlBoards.getNrOfSubControlBoards(); ctrlBrd++)
+    {
+        yarp::dev::RemappedSubControlBoard *p=remappedControlBoards.getSubControlBoard(ctrlBrd);
+
+        if (p->iBatch)
+        {
+            bool ok = p->iBatch->endBatch();
+            ret = ret && ok;
+        }
+    }
+
+    return ret;
+}
@@ -91,7 +91,9 @@ class ControlBoardRemapper : public yarp::dev::DeviceDriver,
                              public yarp::dev::IAxisInfo,
                              public yarp::dev::IPreciselyTimed,
                              public yarp::dev::IInteractionMode,
-                             public yarp::dev::IRemoteVariables {
+                             public yarp::dev::IRemoteVariables,
+                             public yarp::dev::IStreamingFrame,
+                             public yarp::dev::IRpcBatch {
 private:
     std::vector<std::string> axesNames;
     yarp::dev::RemappedControlBoards remappedControlBoards;
@@ -114,6 +116,15 @@ private:
     // Buffer data for multiple arbitary joint methods
     ControlBoardArbitraryAxesDecomposition selectedJointsBuffers;
 
+    // Streaming frames split among the subcontrolboards, protected by selectedJointsBuffers.mutex
+    std::vector<yarp::dev::StreamingFrame> streamingFrames;
+
+    /**
+     * Apply the commands of a frame to a subcontrolboard not implementing
+     * IStreamingFrame, using its control interfaces.
+     */
+    bool applyStreamingFrame(yarp::dev::RemappedSubControlBoard *p, const yarp::dev::StreamingFrame& frame);
+
     /**
      * Set the number of controlled axes, resizing appropriatly
      * all the necessary buffers.
@@ -592,6 +603,14 @@ public:
     virtual bool getRefCurrents(double *currs) override;
 
     virtual bool getRefCurrent(int m, double *curr) override;
+
+    // IStreamingFrame
+    virtual bool sendStreamingFrame(const yarp::dev::StreamingFrame& frame) override;
+
+    // IRpcBatch
+    virtual bool beginBatch() override;
+
+    virtual bool endBatch() override;
 };
 
 }
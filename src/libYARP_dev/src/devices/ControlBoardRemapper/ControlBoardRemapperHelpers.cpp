@@ -42,6 +42,8 @@ RemappedSubControlBoard::RemappedSubControlBoard()
     iVar = nullptr;
     iPwm = nullptr;
     iCurr = nullptr;
+    iStream = nullptr;
+    iBatch = nullptr;
 
     subdevice=nullptr;
 
@@ -75,6 +77,8 @@ void RemappedSubControlBoard::detach()
     iVar = nullptr;
     iPwm = nullptr;
     iCurr = nullptr;
+    iStream = nullptr;
+    iBatch = nullptr;
 
     attachedF=false;
 }
@@ -118,6 +122,8 @@ bool RemappedSubControlBoard::attach(yarp::dev::PolyDriver *d, const std::string
         subdevice->view(iVar);
         subdevice->view(iPwm);
         subdevice->view(iCurr);
+        subdevice->view(iStream);
+        subdevice->view(iBatch);
     }
     else
     {
@@ -72,6 +72,8 @@ public:
     yarp::dev::IRemoteVariables      *iVar;
     yarp::dev::IPWMControl           *iPwm;
     yarp::dev::ICurrentControl       *iCurr;
+    yarp::dev::IStreamingFrame       *iStream;
+    yarp::dev::IRpcBatch             *iBatch;
 
     RemappedSubControlBoard();
 
@@ -46,6 +46,14 @@ ControlBoardWrapper::ControlBoardWrapper() :yarp::os::RateThread(20),
     rosMsgCounter = 0;
     useROS = ROS_disabled;
     jointNames.clear();
+
+    timing = false;
+    timing_cycles = 0;
+    timing_readSum = 0.0;
+    timing_readMax = 0.0;
+    timing_publishSum = 0.0;
+    timing_publishMax = 0.0;
+    timing_lastReport = 0.0;
 }
 
 void ControlBoardWrapper::cleanup_yarpPorts()
@@ -430,6 +438,8 @@ bool ControlBoardWrapper::open(Searchable& config)
         period = 20;
     }
 
+    timing = prop.check("timing", Value(false), "print statistics about the time spent in each cycle").asBool();
+
     // check if we need to create subdevice or if they are
     // passed later on thorugh attachAll()
     if(prop.check("subdevice"))
@@ -840,14 +850,72 @@ bool ControlBoardWrapper::detachAll()
         return true;
 }
 
-void ControlBoardWrapper::run()
+bool ControlBoardWrapper::threadInit()
 {
-    // check we are not overflowing with input messages
-    if(inputStreamingPort.getPendingReads() >= 20)
+    // Group the subdevices by the device they map: different devices can be
+    // read in parallel, while the joints of the same device are read in sequence.
+    localSubdevices.clear();
+    std::vector<yarp::dev::PolyDriver*> drivers;
+    for (unsigned int k = 0; k < device.subdevices.size(); k++)
     {
-        yWarning() << "number of streaming intput messages to be read is " << inputStreamingPort.getPendingReads() << " and can overflow";
+        SubDevice* sub = &device.subdevices[k];
+        size_t group = 0;
+        while (group < drivers.size() && drivers[group] != sub->subdevice)
+            group++;
+        if (group == drivers.size())
+        {
+            drivers.push_back(sub->subdevice);
+            if (group > 0)
+                stateReaders.push_back(new StateReaderThread());
+        }
+        if (group == 0)
+            localSubdevices.push_back(sub);
+        else
+            stateReaders[group-1]->subdevices.push_back(sub);
+    }
+
+    for (size_t i = 0; i < stateReaders.size(); i++)
+    {
+        if (!stateReaders[i]->start())
+        {
+            yError() << partName << "unable to start the state reader threads";
+            threadRelease();
+            return false;
+        }
+    }
+
+    timing_cycles = 0;
+    timing_readSum = timing_readMax = 0.0;
+    timing_publishSum = timing_publishMax = 0.0;
+    timing_lastReport = yarp::os::Time::now();
+    return true;
+}
+
+void ControlBoardWrapper::threadRelease()
+{
+    for (size_t i = 0; i < stateReaders.size(); i++)
+    {
+        stateReaders[i]->stop();
+        delete stateReaders[i];
     }
+    stateReaders.clear();
+    localSubdevices.clear();
+}
+
+void ControlBoardWrapper::refreshState()
+{
+    for (size_t i = 0; i < stateReaders.size(); i++)
+        stateReaders[i]->trigger();
+
+    for (size_t k = 0; k < localSubdevices.size(); k++)
+        localSubdevices[k]->refreshState();
+
+    for (size_t i = 0; i < stateReaders.size(); i++)
+        stateReaders[i]->wait();
+}
 
+void ControlBoardWrapper::publishState()
+{
     // Update the time by averaging all timestamps
     double joint_timeStamp = 0.0;
 
@@ -855,9 +923,6 @@ void ControlBoardWrapper::run()
     {
         int axes = device.subdevices[k].axes;
 
-        device.subdevices[k].refreshJointEncoders();
-        device.subdevices[k].refreshMotorEncoders();
-
         for (int l = 0; l < axes; l++)
         {
             joint_timeStamp+=device.subdevices[k].jointEncodersTimes[l];
@@ -873,22 +938,6 @@ void ControlBoardWrapper::run()
         yarp::sig::Vector& v = outputPositionStatePort.prepare();
         v.resize(controlledJoints);
 
-        double *joint_encoders=v.data();
-
-        for (unsigned int k = 0; k < device.subdevices.size(); k++)
-        {
-            int axes=device.subdevices[k].axes;
-
-            for(int l = 0; l < axes; l++)
-            {
-                joint_encoders[l]=device.subdevices[k].subDev_joint_encoders[l];
-            }
-            joint_encoders+=device.subdevices[k].axes; //jump to next group
-        }
-
-        outputPositionStatePort.setEnvelope(time);
-        outputPositionStatePort.write();
-
         jointData &yarp_struct = extendedOutputState_buffer.get();
 
         yarp_struct.jointPosition.resize(controlledJoints);
@@ -903,17 +952,54 @@ void ControlBoardWrapper::run()
         yarp_struct.controlMode.resize(controlledJoints);
         yarp_struct.interactionMode.resize(controlledJoints);
 
-        yarp_struct.jointPosition_isValid       = getEncoders(yarp_struct.jointPosition.getFirst());
-        yarp_struct.jointVelocity_isValid       = getEncoderSpeeds(yarp_struct.jointVelocity.getFirst());
-        yarp_struct.jointAcceleration_isValid   = getEncoderAccelerations(yarp_struct.jointAcceleration.getFirst());
-        yarp_struct.motorPosition_isValid       = getMotorEncoders(yarp_struct.motorPosition.getFirst());
-        yarp_struct.motorVelocity_isValid       = getMotorEncoderSpeeds(yarp_struct.motorVelocity.getFirst());
-        yarp_struct.motorAcceleration_isValid   = getMotorEncoderAccelerations(yarp_struct.motorAcceleration.getFirst());
-        yarp_struct.torque_isValid              = getTorques(yarp_struct.torque.getFirst());
-        yarp_struct.pwmDutycycle_isValid        = getDutyCycles(yarp_struct.pwmDutycycle.getFirst());
-        yarp_struct.current_isValid             = getCurrents(yarp_struct.current.getFirst());
-        yarp_struct.controlMode_isValid         = getControlModes(yarp_struct.controlMode.getFirst());
-        yarp_struct.interactionMode_isValid     = getInteractionModes((yarp::dev::InteractionModeEnum* ) yarp_struct.interactionMode.getFirst());
+        yarp_struct.jointPosition_isValid       = true;
+        yarp_struct.jointVelocity_isValid       = true;
+        yarp_struct.jointAcceleration_isValid   = true;
+        yarp_struct.motorPosition_isValid       = true;
+        yarp_struct.motorVelocity_isValid       = true;
+        yarp_struct.motorAcceleration_isValid   = true;
+        yarp_struct.torque_isValid              = true;
+        yarp_struct.pwmDutycycle_isValid        = true;
+        yarp_struct.current_isValid             = true;
+        yarp_struct.controlMode_isValid         = true;
+        yarp_struct.interactionMode_isValid     = true;
+
+        int offset = 0;
+        for (unsigned int k = 0; k < device.subdevices.size(); k++)
+        {
+            const SubDevice& sub = device.subdevices[k];
+            size_t bytes = sub.axes * sizeof(double);
+
+            memcpy(v.data() + offset,                                 sub.subDev_joint_encoders.data(),      bytes);
+            memcpy(yarp_struct.jointPosition.getFirst() + offset,     sub.subDev_joint_encoders.data(),      bytes);
+            memcpy(yarp_struct.jointVelocity.getFirst() + offset,     sub.subDev_joint_speeds.data(),        bytes);
+            memcpy(yarp_struct.jointAcceleration.getFirst() + offset, sub.subDev_joint_accelerations.data(), bytes);
+            memcpy(yarp_struct.motorPosition.getFirst() + offset,     sub.subDev_motor_encoders.data(),      bytes);
+            memcpy(yarp_struct.motorVelocity.getFirst() + offset,     sub.subDev_motor_speeds.data(),        bytes);
+            memcpy(yarp_struct.motorAcceleration.getFirst() + offset, sub.subDev_motor_accelerations.data(), bytes);
+            memcpy(yarp_struct.torque.getFirst() + offset,            sub.subDev_torques.data(),             bytes);
+            memcpy(yarp_struct.pwmDutycycle.getFirst() + offset,      sub.subDev_dutyCycles.data(),          bytes);
+            memcpy(yarp_struct.current.getFirst() + offset,           sub.subDev_currents.data(),            bytes);
+            memcpy(yarp_struct.controlMode.getFirst() + offset,       sub.subDev_controlModes.getFirst(),     sub.axes * sizeof(int));
+            memcpy(yarp_struct.interactionMode.getFirst() + offset,   sub.subDev_interactionModes.getFirst(), sub.axes * sizeof(int));
+
+            yarp_struct.jointPosition_isValid       = yarp_struct.jointPosition_isValid && sub.jointEncoders_isValid;
+            yarp_struct.jointVelocity_isValid       = yarp_struct.jointVelocity_isValid && sub.jointSpeeds_isValid;
+            yarp_struct.jointAcceleration_isValid   = yarp_struct.jointAcceleration_isValid && sub.jointAccelerations_isValid;
+            yarp_struct.motorPosition_isValid       = yarp_struct.motorPosition_isValid && sub.motorEncoders_isValid;
+            yarp_struct.motorVelocity_isValid       = yarp_struct.motorVelocity_isValid && sub.motorSpeeds_isValid;
+            yarp_struct.motorAcceleration_isValid   = yarp_struct.motorAcceleration_isValid && sub.motorAccelerations_isValid;
+            yarp_struct.torque_isValid              = yarp_struct.torque_isValid && sub.torques_isValid;
+            yarp_struct.pwmDutycycle_isValid        = yarp_struct.pwmDutycycle_isValid && sub.dutyCycles_isValid;
+            yarp_struct.current_isValid             = yarp_struct.current_isValid && sub.currents_isValid;
+            yarp_struct.controlMode_isValid         = yarp_struct.controlMode_isValid && sub.controlModes_isValid;
+            yarp_struct.interactionMode_isValid     = yarp_struct.interactionMode_isValid && sub.interactionModes_isValid;
+
+            offset += sub.axes;
+        }
+
+        outputPositionStatePort.setEnvelope(time);
+        outputPositionStatePort.write();
 
         extendedOutputStatePort.setEnvelope(time);
         extendedOutputState_buffer.write();
@@ -921,30 +1007,32 @@ void ControlBoardWrapper::run()
 
     if(useROS != ROS_disabled)
     {
-        sensor_msgs_JointState ros_struct;
-
-        ros_struct.name.resize(controlledJoints);
         ros_struct.position.resize(controlledJoints);
         ros_struct.velocity.resize(controlledJoints);
         ros_struct.effort.resize(controlledJoints);
+        if (ros_struct.name.size() != jointNames.size())
+            ros_struct.name = jointNames;
 
-        getEncoders(ros_struct.position.data());
-        getEncoderSpeeds(ros_struct.velocity.data());
-        getTorques(ros_struct.effort.data());
-
-        JointTypeEnum jType;
-        for(int i=0; i< controlledJoints; i++)
+        int i = 0;
+        for (unsigned int k = 0; k < device.subdevices.size(); k++)
         {
-            getJointType(i, jType);
-            if(jType == VOCAB_JOINTTYPE_REVOLUTE)
+            const SubDevice& sub = device.subdevices[k];
+            for (int l = 0; l < sub.axes; l++, i++)
             {
-                ros_struct.position[i] = convertDegreesToRadians(ros_struct.position[i]);
-                ros_struct.velocity[i] = convertDegreesToRadians(ros_struct.velocity[i]);
+                if (sub.jointIsRevolute[l])
+                {
+                    ros_struct.position[i] = convertDegreesToRadians(sub.subDev_joint_encoders[l]);
+                    ros_struct.velocity[i] = convertDegreesToRadians(sub.subDev_joint_speeds[l]);
+                }
+                else
+                {
+                    ros_struct.position[i] = sub.subDev_joint_encoders[l];
+                    ros_struct.velocity[i] = sub.subDev_joint_speeds[l];
+                }
+                ros_struct.effort[i] = sub.subDev_torques[l];
             }
         }
 
-        ros_struct.name=jointNames;
-
         ros_struct.header.seq = rosMsgCounter++;
         ros_struct.header.stamp = normalizeSecNSec(time.getTime());
 
@@ -952,6 +1040,52 @@ void ControlBoardWrapper::run()
     }
 }
 
+void ControlBoardWrapper::updateTiming(double readTime, double publishTime)
+{
+    timing_cycles++;
+    timing_readSum += readTime;
+    timing_publishSum += publishTime;
+    if (readTime > timing_readMax)
+        timing_readMax = readTime;
+    if (publishTime > timing_publishMax)
+        timing_publishMax = publishTime;
+
+    double now = yarp::os::Time::now();
+    if (now - timing_lastReport < 5.0)
+        return;
+
+    yInfo("ControlBoardWrapper %s: %d cycles, state read avg %.3f max %.3f [ms], publish avg %.3f max %.3f [ms], period %d [ms]",
+          partName.c_str(), timing_cycles,
+          1000.0 * timing_readSum / timing_cycles, 1000.0 * timing_readMax,
+          1000.0 * timing_publishSum / timing_cycles, 1000.0 * timing_publishMax,
+          period);
+
+    timing_cycles = 0;
+    timing_readSum = timing_readMax = 0.0;
+    timing_publishSum = timing_publishMax = 0.0;
+    timing_lastReport = now;
+}
+
+void ControlBoardWrapper::run()
+{
+    // check we are not overflowing with input messages
+    if(inputStreamingPort.getPendingReads() >= 20)
+    {
+        yWarning() << "number of streaming intput messages to be read is " << inputStreamingPort.getPendingReads() << " and can overflow";
+    }
+
+    // Read the whole state once, then build all the outputs from the snapshot
+    double start = timing ? yarp::os::Time::now() : 0.0;
+    refreshState();
+    double read = timing ? yarp::os::Time::now() : 0.0;
+    publishState();
+
+    if (timing)
+    {
+        updateTiming(read - start, yarp::os::Time::now() - read);
+    }
+}
+
 //
 //  IPid Interface
 //
@@ -52,7 +52,7 @@
 #endif
 
 #define PROTOCOL_VERSION_MAJOR 1
-#define PROTOCOL_VERSION_MINOR 9
+#define PROTOCOL_VERSION_MINOR 10
 #define PROTOCOL_VERSION_TWEAK 0
 
 /*
@@ -168,6 +168,7 @@ public:
  * |:--------------:|:--------------:|:-------:|:--------------:|:-------------:|:--------------------------: |:-----------------------------------------------------------------:|:-----:|
  * | name           |      -         | string  | -              |   -           | Yes                         | full name of the port opened by the device, like /robotName/part/ | MUST start with a '/' character |
  * | period         |      -         | int     | ms             |   20          | No                          | refresh period of the broadcasted values in ms                    | optional, default 20ms |
+ * | timing         |      -         | bool    | -              |   false       | No                          | periodically print the time spent reading the state and publishing it | useful to check the cost of a cycle at high rates |
  * | subdevice      |      -         | string  | -              |   -           | alternative to netwok group | name of the subdevice to instantiate                              | when used, parameters for the subdevice must be provided as well |
  * | networks       |      -         | group   | -              |   -           | alternative to subdevice    | this is expected to be a group parameter in xml format, a list in .ini file format. SubParameter are mandatory if this is used| - |
  * | -              | networkName_1  | 4 * int | joint number   |   -           |   if networks is used       | describe how to match subdevice_1 joints with the wrapper joints. First 2 numbers indicate first/last wrapper joint, last 2 numbers are subdevice first/last joint | The joints are intended to be consequent |
@@ -287,7 +288,7 @@ private:
 
 
     yarp::os::BufferedPort<yarp::sig::Vector>  outputPositionStatePort;   // Port /state:o streaming out the encoder positions
-    yarp::os::BufferedPort<CommandMessage>     inputStreamingPort;        // Input streaming port for high frequency commands
+    yarp::os::BufferedPort<yarp::dev::impl::StreamingMessage> inputStreamingPort;       // Input streaming port for high frequency commands
     yarp::os::Port inputRPCPort;                // Input RPC port for set/get remote calls
     yarp::os::Stamp time;                       // envelope to attach to the state port
     yarp::os::Semaphore timeMutex;
@@ -305,6 +306,7 @@ private:
     yarp::os::Node                                      *rosNode;                   // add a ROS node
     yarp::os::NetUint32                                 rosMsgCounter;              // incremental counter in the ROS message
     yarp::os::PortWriterBuffer<sensor_msgs_JointState>  rosOutputState_buffer;      // Buffer associated to the ROS topic
+    sensor_msgs_JointState                              ros_struct;                 // reused every cycle to avoid allocations
     yarp::os::Publisher<sensor_msgs_JointState>         rosPublisherPort;           // Dedicated ROS topic publisher
 
     yarp::os::PortReaderBuffer<yarp::os::Bottle>    inputRPC_buffer;                // Buffer associated to the inputRPCPort port
@@ -341,6 +343,23 @@ private:
     bool openAndAttachSubDevice(yarp::os::Property& prop);
 
     bool ownDevices;
+
+    // Subdevices are grouped by the device they map; the first group is read
+    // by the wrapper thread itself, each other group by its own helper thread.
+    std::vector<yarp::dev::impl::SubDevice*>         localSubdevices;
+    std::vector<yarp::dev::impl::StateReaderThread*> stateReaders;
+    void refreshState();
+    void publishState();
+
+    // Cycle timing statistics, printed every few seconds when 'timing' is set
+    bool   timing;
+    int    timing_cycles;
+    double timing_readSum;
+    double timing_readMax;
+    double timing_publishSum;
+    double timing_publishMax;
+    double timing_lastReport;
+    void updateTiming(double readTime, double publishTime);
 #endif  //DOXYGEN_SHOULD_SKIP_THIS
 
 public:
@@ -389,6 +408,10 @@ public:
 
     virtual bool attachAll(const yarp::dev::PolyDriverList &l) override;
 
+    virtual bool threadInit() override;
+
+    virtual void threadRelease() override;
+
     /**
     * The thread main loop deals with writing on ports here.
     */
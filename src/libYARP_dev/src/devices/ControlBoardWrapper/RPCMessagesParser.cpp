@@ -1671,6 +1671,25 @@ bool RPCMessagesParser::respond(const yarp::os::Bottle& cmd, yarp::os::Bottle& r
 
     int code = cmd.get(0).asVocab();
 
+    // A batch of commands, answered with one reply for each of them
+    if (code == VOCAB_RPC_BATCH)
+    {
+        response.clear();
+        response.addVocab(VOCAB_RPC_BATCH);
+        for (int i = 1; i < cmd.size(); i++)
+        {
+            Bottle *sub = cmd.get(i).asList();
+            Bottle& subResponse = response.addList();
+            if (sub == nullptr || sub->get(0).asVocab() == VOCAB_RPC_BATCH)
+            {
+                subResponse.addVocab(VOCAB_FAILED);
+                continue;
+            }
+            respond(*sub, subResponse);
+        }
+        return true;
+    }
+
     if(cmd.size() < 2)
     {
         ok = false;
@@ -52,7 +52,102 @@ bool StreamingMessagesParser::initialize()
     return true;
 }
 
+bool StreamingMessage::read(ConnectionReader& connection)
+{
+    // if someone connects in text mode, use standard
+    // text-to-binary mapping
+    connection.convertTextMode();
+
+    int header = connection.expectInt();
+    if (header == VOCAB_STREAMING_FRAME) {
+        isFrame = true;
+        return frame.readContent(connection);
+    }
+
+    // Same as PortablePair::read(), the header is already consumed
+    isFrame = false;
+    if (header != BOTTLE_TAG_LIST) {
+        return false;
+    }
+    if (connection.expectInt() != 2) {
+        return false;
+    }
+    return command.head.read(connection) && command.body.read(connection);
+}
+
+bool StreamingMessage::write(ConnectionWriter& connection)
+{
+    if (isFrame) {
+        return frame.write(connection);
+    }
+    return command.write(connection);
+}
+
 // streaming port callback
+void StreamingMessagesParser::onRead(StreamingMessage& v)
+{
+    if (v.isFrame) {
+        onRead(v.frame);
+    } else {
+        onRead(v.command);
+    }
+}
+
+void StreamingMessagesParser::onRead(const StreamingFrame& frame)
+{
+    for (int i = 0; i < frame.size(); i++)
+    {
+        int vocab = frame.getVocab(i);
+        int n_joints = frame.getJointCount(i);
+        const int* joints = frame.getJoints(i);
+        const double* refs = frame.getRefs(i);
+
+        bool valid = true;
+        for (int j = 0; j < n_joints; j++)
+        {
+            if (joints[j] < 0 || joints[j] >= stream_nJoints)
+                valid = false;
+        }
+        if (!valid)
+        {
+            yarp::os::ConstString str = yarp::os::Vocab::decode(vocab);
+            yError("Received streaming frame with a joint out of range (cmd: %s controlled jnts: %d)\n", str.c_str(), stream_nJoints);
+            continue;
+        }
+
+        bool ok = false;
+        switch (vocab)
+        {
+            case VOCAB_POSITION_MOVE_GROUP:
+                ok = stream_IPosCtrl2 && stream_IPosCtrl2->positionMove(n_joints, joints, refs);
+            break;
+            case VOCAB_POSITION_DIRECT_GROUP:
+                ok = stream_IPosDirect && stream_IPosDirect->setPositions(n_joints, joints, const_cast<double*>(refs));
+            break;
+            case VOCAB_VELOCITY_MOVE_GROUP:
+                ok = stream_IVel2 && stream_IVel2->velocityMove(n_joints, joints, refs);
+            break;
+            case VOCAB_TORQUES_DIRECT_GROUP:
+                ok = stream_ITorque && stream_ITorque->setRefTorques(n_joints, joints, refs);
+            break;
+            case VOCAB_CURRENT_REF_GROUP:
+                ok = stream_ICurrent && stream_ICurrent->setRefCurrents(n_joints, joints, refs);
+            break;
+            case VOCAB_PWMCONTROL_REF_PWM:
+                ok = stream_IPWM != nullptr;
+                for (int j = 0; ok && j < n_joints; j++)
+                    ok = stream_IPWM->setRefDutyCycle(joints[j], refs[j]);
+            break;
+        }
+
+        if (!ok)
+        {
+            yarp::os::ConstString str = yarp::os::Vocab::decode(vocab);
+            yError("Error while trying to command a streaming frame (cmd: %s)\n", str.c_str());
+        }
+    }
+}
+
 void StreamingMessagesParser::onRead(CommandMessage& v)
 {
     Bottle& b = v.head;
@@ -141,11 +236,12 @@ void StreamingMessagesParser::onRead(CommandMessage& v)
                 {
                     if (stream_ICurrent)
                     {
-                        int n_joints = b.get(1).asInt();
-                        Bottle *jlut = b.get(2).asList();
-                        if (((int)jlut->size() != n_joints) && ((int)cmdVector.size() != n_joints))
+                        int n_joints = b.get(2).asInt();
+                        Bottle *jlut = b.get(3).asList();
+                        if (jlut == nullptr || ((int)jlut->size() != n_joints) || ((int)cmdVector.size() != n_joints))
                         {
                             yError("Received VOCAB_CURRENT_REF_GROUP size of joints vector or currents vector does not match the selected joint number\n");
+                            break;
                         }
 
                         int *joint_list = new int[n_joints];
@@ -25,6 +25,7 @@
 #include <yarp/sig/Vector.h>
 #include <yarp/os/Semaphore.h>
 #include <yarp/dev/Wrapper.h>
+#include <yarp/dev/StreamingFrame.h>
 
 #include <string>
 #include <vector>
@@ -47,6 +48,7 @@ namespace yarp {
     namespace dev {
         class ControlBoardWrapper;
         namespace impl {
+            class StreamingMessage;
             class StreamingMessagesParser;
             class SubDevice;
             class WrappedDevice;
@@ -66,11 +68,28 @@ namespace yarp {
 typedef yarp::os::PortablePair<yarp::os::Bottle, yarp::sig::Vector> CommandMessage;
 
 
+/**
+* A message received on the streaming port: either a single command, or a
+* frame with several commands (see yarp::dev::StreamingFrame).
+*/
+class yarp::dev::impl::StreamingMessage : public yarp::os::Portable {
+public:
+    StreamingMessage() : isFrame(false) {}
+
+    CommandMessage command;
+    yarp::dev::StreamingFrame frame;
+    bool isFrame;
+
+    virtual bool read(yarp::os::ConnectionReader& connection) override;
+    virtual bool write(yarp::os::ConnectionWriter& connection) override;
+};
+
+
 
 /**
 * Callback implementation after buffered input.
 */
-class  yarp::dev::impl::StreamingMessagesParser : public yarp::os::TypedReaderCallback<CommandMessage> {
+class  yarp::dev::impl::StreamingMessagesParser : public yarp::os::TypedReaderCallback<yarp::dev::impl::StreamingMessage> {
 protected:
     yarp::dev::IPositionControl     *stream_IPosCtrl;
     yarp::dev::IPositionControl2    *stream_IPosCtrl2;
@@ -94,12 +113,24 @@ public:
     */
     void init(yarp::dev::ControlBoardWrapper *x);
 
-    using yarp::os::TypedReaderCallback<CommandMessage>::onRead;
+    using yarp::os::TypedReaderCallback<yarp::dev::impl::StreamingMessage>::onRead;
     /**
     * Callback function.
-    * @param v is the Vector being received.
+    * @param v is the message being received.
+    */
+    virtual void onRead(yarp::dev::impl::StreamingMessage& v) override;
+
+    /**
+    * Execute a single command.
+    * @param v is the command being received.
+    */
+    void onRead(CommandMessage& v);
+
+    /**
+    * Execute all the commands of a frame.
+    * @param frame is the frame being received.
     */
-    virtual void onRead(CommandMessage& v) override;
+    void onRead(const yarp::dev::StreamingFrame& frame);
 
     bool initialize();
 };
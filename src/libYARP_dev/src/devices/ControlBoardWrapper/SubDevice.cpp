@@ -49,6 +49,17 @@ SubDevice::SubDevice() :
     iVar(nullptr),
     iPWM(nullptr),
     iCurr(nullptr),
+    jointEncoders_isValid(false),
+    jointSpeeds_isValid(false),
+    jointAccelerations_isValid(false),
+    motorEncoders_isValid(false),
+    motorSpeeds_isValid(false),
+    motorAccelerations_isValid(false),
+    torques_isValid(false),
+    dutyCycles_isValid(false),
+    currents_isValid(false),
+    controlModes_isValid(false),
+    interactionModes_isValid(false),
     _subDevVerbose(false),
     attachedF(false)
 {}
@@ -85,6 +96,16 @@ bool SubDevice::configure(int b, int t, int n, const std::string &key, yarp::dev
     jointEncodersTimes.resize(axes);
     subDev_motor_encoders.resize(axes);
     motorEncodersTimes.resize(axes);
+    subDev_joint_speeds.resize(axes);
+    subDev_joint_accelerations.resize(axes);
+    subDev_motor_speeds.resize(axes);
+    subDev_motor_accelerations.resize(axes);
+    subDev_torques.resize(axes);
+    subDev_dutyCycles.resize(axes);
+    subDev_currents.resize(axes);
+    subDev_controlModes.resize(axes);
+    subDev_interactionModes.resize(axes);
+    jointIsRevolute.assign(axes, false);
 
     configuredF=true;
     return true;
@@ -280,6 +301,53 @@ bool SubDevice::attach(yarp::dev::PolyDriver *d, const std::string &k)
                  return false;
     }
 
+    for(int j=0; j<axes; j++)
+    {
+        yarp::dev::JointTypeEnum jType;
+        jointIsRevolute[j] = info && info->getJointType(base+j, jType) && jType == VOCAB_JOINTTYPE_REVOLUTE;
+    }
+
     attachedF=true;
     return true;
 }
+
+void SubDevice::refreshState()
+{
+    jointEncoders_isValid      = (iJntEnc != nullptr);
+    jointSpeeds_isValid        = (iJntEnc != nullptr);
+    jointAccelerations_isValid = (iJntEnc != nullptr);
+    motorEncoders_isValid      = (iMotEnc != nullptr);
+    motorSpeeds_isValid        = (iMotEnc != nullptr);
+    motorAccelerations_isValid = (iMotEnc != nullptr);
+    torques_isValid            = (iTorque != nullptr);
+    dutyCycles_isValid         = (iPWM != nullptr);
+    currents_isValid           = (amp != nullptr);
+    controlModes_isValid       = (iMode != nullptr);
+    interactionModes_isValid   = (iInteract != nullptr);
+
+    for(int j=base, idx=0; j<(base+axes); j++, idx++)
+    {
+        if(iJntEnc)
+        {
+            jointEncoders_isValid      &= iJntEnc->getEncoderTimed(j, &subDev_joint_encoders[idx], &jointEncodersTimes[idx]);
+            jointSpeeds_isValid        &= iJntEnc->getEncoderSpeed(j, &subDev_joint_speeds[idx]);
+            jointAccelerations_isValid &= iJntEnc->getEncoderAcceleration(j, &subDev_joint_accelerations[idx]);
+        }
+        if(iMotEnc)
+        {
+            motorEncoders_isValid      &= iMotEnc->getMotorEncoderTimed(j, &subDev_motor_encoders[idx], &motorEncodersTimes[idx]);
+            motorSpeeds_isValid        &= iMotEnc->getMotorEncoderSpeed(j, &subDev_motor_speeds[idx]);
+            motorAccelerations_isValid &= iMotEnc->getMotorEncoderAcceleration(j, &subDev_motor_accelerations[idx]);
+        }
+        if(iTorque)
+            torques_isValid &= iTorque->getTorque(j, &subDev_torques[idx]);
+        if(iPWM)
+            dutyCycles_isValid &= iPWM->getDutyCycle(j, &subDev_dutyCycles[idx]);
+        if(amp)
+            currents_isValid &= amp->getCurrent(j, &subDev_currents[idx]);
+        if(iMode)
+            controlModes_isValid &= iMode->getControlMode(j, &subDev_controlModes[idx]);
+        if(iInteract)
+            interactionModes_isValid &= iInteract->getInteractionMode(j, (yarp::dev::InteractionModeEnum*) &subDev_interactionModes[idx]);
+    }
+}
@@ -26,6 +26,7 @@
 #include <yarp/dev/PreciselyTimed.h>
 #include <yarp/sig/Vector.h>
 #include <yarp/os/Semaphore.h>
+#include <yarp/os/Thread.h>
 #include <yarp/dev/Wrapper.h>
 
 #include <string>
@@ -54,6 +55,7 @@ namespace yarp {
         namespace impl {
             class SubDevice;
             class WrappedDevice;
+            class StateReaderThread;
         }
     }
 }
@@ -103,10 +105,35 @@ public:
     yarp::dev::IPWMControl           *iPWM;
     yarp::dev::ICurrentControl       *iCurr;
 
+    // Snapshot of the state of the mapped joints, refreshed once per cycle
+    // by refreshState() and used to build all the output messages.
+    // Vectors are allocated in configure(), nothing is allocated while running.
     yarp::sig::Vector subDev_joint_encoders;
     yarp::sig::Vector jointEncodersTimes;
     yarp::sig::Vector subDev_motor_encoders;
     yarp::sig::Vector motorEncodersTimes;
+    yarp::sig::Vector subDev_joint_speeds;
+    yarp::sig::Vector subDev_joint_accelerations;
+    yarp::sig::Vector subDev_motor_speeds;
+    yarp::sig::Vector subDev_motor_accelerations;
+    yarp::sig::Vector subDev_torques;
+    yarp::sig::Vector subDev_dutyCycles;
+    yarp::sig::Vector subDev_currents;
+    yarp::sig::VectorOf<int> subDev_controlModes;
+    yarp::sig::VectorOf<int> subDev_interactionModes;
+    std::vector<bool> jointIsRevolute;                 // cached at attach, used for ROS unit conversion
+
+    bool jointEncoders_isValid;
+    bool jointSpeeds_isValid;
+    bool jointAccelerations_isValid;
+    bool motorEncoders_isValid;
+    bool motorSpeeds_isValid;
+    bool motorAccelerations_isValid;
+    bool torques_isValid;
+    bool dutyCycles_isValid;
+    bool currents_isValid;
+    bool controlModes_isValid;
+    bool interactionModes_isValid;
 
     SubDevice();
 
@@ -116,25 +143,12 @@ public:
 
     bool configure(int base, int top, int axes, const std::string &id, yarp::dev::ControlBoardWrapper *_parent);
 
-    inline void refreshJointEncoders()
-    {
-        for(int j=base, idx=0; j<(base+axes); j++, idx++)
-        {
-            if(iJntEnc)
-                iJntEnc->getEncoderTimed(j, &subDev_joint_encoders[idx], &jointEncodersTimes[idx]);
-        }
-    }
-
-    inline void refreshMotorEncoders()
-    {
-        for(int j=base, idx=0; j<(base+axes); j++, idx++)
-        {
-            if(iMotEnc)
-                iMotEnc->getMotorEncoderTimed(j, &subDev_motor_encoders[idx], &motorEncodersTimes[idx]);
-        }
-    }
-
-
+    /**
+     * Read the whole state of the mapped joints in a single pass.
+     * It is called by the wrapper thread, or by a StateReaderThread when the
+     * wrapper reads more than one device in parallel.
+     */
+    void refreshState();
 
     bool isAttached()
     { return attachedF; }
@@ -146,6 +160,45 @@ private:
 
 typedef std::vector<yarp::dev::impl::SubDevice> SubDeviceVector;
 
+/*
+* Helper thread used by the controlBoardWrapper to refresh the state of a
+* group of subdevices (the ones sharing the same device) in parallel with
+* the other groups. The wrapper thread calls trigger() at the beginning of
+* the cycle and wait() before using the data.
+*/
+class yarp::dev::impl::StateReaderThread : public yarp::os::Thread
+{
+public:
+    std::vector<yarp::dev::impl::SubDevice*> subdevices;
+
+    StateReaderThread() : triggerSem(0), doneSem(0) {}
+
+    inline void trigger() { triggerSem.post(); }
+    inline void wait() { doneSem.wait(); }
+
+    void run() override
+    {
+        while (true)
+        {
+            triggerSem.wait();
+            if (isStopping())
+                break;
+            for (size_t k = 0; k < subdevices.size(); k++)
+                subdevices[k]->refreshState();
+            doneSem.post();
+        }
+    }
+
+    void onStop() override
+    {
+        triggerSem.post();
+    }
+
+private:
+    yarp::os::Semaphore triggerSem;
+    yarp::os::Semaphore doneSem;
+};
+
 struct DevicesLutEntry
 {
     int offset; //an offset, the device is mapped starting from this joint
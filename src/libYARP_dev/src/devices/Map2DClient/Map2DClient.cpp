@@ -92,8 +92,53 @@ bool yarp::dev::Map2DClient::store_map(const MapGrid2D& map)
     return true;
 }
 
+bool yarp::dev::Map2DClient::get_map_delta(std::string map_name, MapGrid2D& map)
+{
+    LockGuard lock(m_maps_cache_mutex);
+    auto cached = m_maps_cache.find(map_name);
+
+    yarp::os::Bottle b;
+    yarp::os::Bottle resp;
+    b.addVocab(VOCAB_IMAP);
+    b.addVocab(VOCAB_IMAP_GET_MAP_DELTA);
+    b.addString(map_name);
+    b.addInt(cached != m_maps_cache.end() ? cached->second.session : 0);
+    b.addInt(cached != m_maps_cache.end() ? cached->second.version : 0);
+
+    bool ok = m_rpcPort_to_Map2DServer.write(b, resp) && resp.get(0).asVocab() == VOCAB_IMAP_OK;
+    if (ok)
+    {
+        CachedMap& copy = m_maps_cache[map_name];
+        int reply = resp.get(3).asVocab();
+        if (reply == VOCAB_IMAP_FULL)
+        {
+            ok = Property::copyPortable(resp.get(4), copy.map);
+        }
+        else
+        {
+            ok = (reply == VOCAB_IMAP_TILES) && cached != m_maps_cache.end() &&
+                 resp.get(4).isList() && copy.map.setTiles(*resp.get(4).asList());
+        }
+        copy.session = resp.get(1).asInt();
+        copy.version = resp.get(2).asInt();
+    }
+    if (!ok)
+    {
+        m_maps_cache.erase(map_name);
+        return false;
+    }
+    map = m_maps_cache[map_name].map;
+    return true;
+}
+
 bool yarp::dev::Map2DClient::get_map(std::string map_name, MapGrid2D& map)
 {
+    if (get_map_delta(map_name, map))
+    {
+        return true;
+    }
+
+    // the servers which do not know the versions of the maps send them whole
     yarp::os::Bottle b;
     yarp::os::Bottle resp;
 
@@ -133,6 +178,10 @@ bool yarp::dev::Map2DClient::get_map(std::string map_name, MapGrid2D& map)
 
 bool yarp::dev::Map2DClient::clear()
 {
+    m_maps_cache_mutex.lock();
+    m_maps_cache.clear();
+    m_maps_cache_mutex.unlock();
+
     yarp::os::Bottle b;
     yarp::os::Bottle resp;
 
@@ -191,6 +240,10 @@ bool yarp::dev::Map2DClient::get_map_names(std::vector<std::string>& map_names)
 
 bool yarp::dev::Map2DClient::remove_map(std::string map_name)
 {
+    m_maps_cache_mutex.lock();
+    m_maps_cache.erase(map_name);
+    m_maps_cache_mutex.unlock();
+
     yarp::os::Bottle b;
     yarp::os::Bottle resp;
 
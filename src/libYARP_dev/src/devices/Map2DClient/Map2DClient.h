@@ -15,9 +15,11 @@
 #include <yarp/sig/Vector.h>
 #include <yarp/dev/MapGrid2D.h>
 #include <yarp/dev/Map2DLocation.h>
+#include <yarp/os/Mutex.h>
 #include <yarp/os/Semaphore.h>
 #include <yarp/os/Time.h>
 #include <yarp/dev/PolyDriver.h>
+#include <map>
 #include <yarp/os/RecursiveMutex.h>
 
 namespace yarp {
@@ -37,6 +39,8 @@ namespace yarp {
  * |:--------------:|:--------------:|:-------:|:--------------:|:-------------:|:-----------: |:-----------------------------------------------------------------:|:-----:|
  * | local          |      -         | string  | -   |   -           | Yes          | Full port name opened by the Map2DClient device.                             |       |
  * | remote         |     -          | string  | -   |   -           | Yes          | Full port name of the port remotely opened by the Map2DServer, to which the Map2DClient connects to.           |  |
+ *
+ * The client keeps a copy of the maps it gets, and receives from the server only the tiles changed since the last get_map().
  */
 
 class yarp::dev::Map2DClient : public DeviceDriver,
@@ -49,6 +53,19 @@ protected:
     yarp::os::ConstString         m_local_name;
     yarp::os::ConstString         m_map_server;
 
+    // the copies of the maps received from the server, updated with the
+    // tiles changed since their version
+    struct CachedMap
+    {
+        yarp::dev::MapGrid2D      map;
+        int                       session;
+        int                       version;
+    };
+    std::map<std::string, CachedMap> m_maps_cache;
+    yarp::os::Mutex               m_maps_cache_mutex;
+
+    bool get_map_delta(std::string map_name, yarp::dev::MapGrid2D& map);
+
 #endif /*DOXYGEN_SHOULD_SKIP_THIS*/
 
 public:
@@ -18,6 +18,7 @@
 #include <yarp/os/Publisher.h>
 #include <yarp/os/Subscriber.h>
 #include <yarp/os/Node.h>
+#include <yarp/os/Time.h>
 
 using namespace yarp::sig;
 using namespace yarp::dev;
@@ -40,6 +41,41 @@ Map2DServer::Map2DServer()
     m_enable_publish_ros_map = false;
     m_enable_subscribe_ros_map = false;
     m_rosNode = nullptr;
+    // the versions of the copies of the clients are valid only for this
+    // instance of the server
+    m_maps_session = (int)((YARP_INT64)(SystemClock::nowSystem() * 1000) % 1000000000) + 1;
+    m_maps_last_version = 0;
+}
+
+void Map2DServer::updateMapVersion(const MapGrid2D& map, const MapGrid2D* previous)
+{
+    MapVersion& v = m_maps_versions[map.getMapName()];
+    v.version = ++m_maps_last_version;
+
+    std::vector<size_t> changed;
+    bool same_layout = previous != nullptr && !v.tiles.empty() &&
+                       map.getChangedTiles(*previous, changed);
+    if (same_layout)
+    {
+        double x1, y1, t1, x2, y2, t2, r1, r2;
+        map.getOrigin(x1, y1, t1);
+        previous->getOrigin(x2, y2, t2);
+        map.getResolution(r1);
+        previous->getResolution(r2);
+        same_layout = (x1 == x2 && y1 == y2 && t1 == t2 && r1 == r2);
+    }
+
+    if (!same_layout)
+    {
+        // the clients receive the whole map again
+        v.layout = v.version;
+        v.tiles.assign(map.getTileCount(), v.version);
+        return;
+    }
+    for (size_t i = 0; i < changed.size(); i++)
+    {
+        v.tiles[changed[i]] = v.version;
+    }
 }
 
 Map2DServer::~Map2DServer()
@@ -65,6 +101,7 @@ void Map2DServer::parse_vocab_command(yarp::os::Bottle& in, yarp::os::Bottle& ou
                 if (it == m_maps_storage.end())
                 {
                     //add a new map
+                    updateMapVersion(the_map, nullptr);
                     m_maps_storage[map_name] = the_map;
                     out.clear();
                     out.addVocab(VOCAB_IMAP_OK);
@@ -72,6 +109,7 @@ void Map2DServer::parse_vocab_command(yarp::os::Bottle& in, yarp::os::Bottle& ou
                 else
                 {
                     //the map alreay exists
+                    updateMapVersion(the_map, &it->second);
                     m_maps_storage[map_name] = the_map;
                     out.clear();
                     out.addVocab(VOCAB_IMAP_OK);
@@ -102,6 +140,44 @@ void Map2DServer::parse_vocab_command(yarp::os::Bottle& in, yarp::os::Bottle& ou
                 yError() << "Map" << name << "not found";
             }
         }
+        else if (cmd == VOCAB_IMAP_GET_MAP_DELTA)
+        {
+            string name = in.get(2).asString();
+            int session = in.get(3).asInt();
+            int since = in.get(4).asInt();
+            auto it = m_maps_storage.find(name);
+            auto v = m_maps_versions.find(name);
+            if (it != m_maps_storage.end() && v != m_maps_versions.end())
+            {
+                out.clear();
+                out.addVocab(VOCAB_IMAP_OK);
+                out.addInt(m_maps_session);
+                out.addInt(v->second.version);
+                if (session != m_maps_session || since < v->second.layout || since > v->second.version)
+                {
+                    // the copy of the client is unknown, or too old
+                    out.addVocab(VOCAB_IMAP_FULL);
+                    yarp::os::Bottle& mapbot = out.addList();
+                    Property::copyPortable(it->second, mapbot);
+                }
+                else
+                {
+                    std::vector<size_t> tiles;
+                    for (size_t i = 0; i < v->second.tiles.size(); i++)
+                    {
+                        if (v->second.tiles[i] > since) tiles.push_back(i);
+                    }
+                    out.addVocab(VOCAB_IMAP_TILES);
+                    it->second.getTiles(tiles, out.addList());
+                }
+            }
+            else
+            {
+                out.clear();
+                out.addVocab(VOCAB_IMAP_ERROR);
+                yError() << "Map" << name << "not found";
+            }
+        }
         else if (cmd == VOCAB_IMAP_GET_NAMES)
         {
             out.clear();
@@ -116,6 +192,7 @@ void Map2DServer::parse_vocab_command(yarp::os::Bottle& in, yarp::os::Bottle& ou
         {
             string name = in.get(2).asString();
             size_t rem = m_maps_storage.erase(name);
+            m_maps_versions.erase(name);
             if (rem == 0)
             {
                 yError() << "Map not found";
@@ -131,6 +208,7 @@ void Map2DServer::parse_vocab_command(yarp::os::Bottle& in, yarp::os::Bottle& ou
         else if (cmd == VOCAB_IMAP_CLEAR)
         {
             m_maps_storage.clear();
+            m_maps_versions.clear();
             out.clear();
             out.addVocab(VOCAB_IMAP_OK);
         }
@@ -354,6 +432,7 @@ void Map2DServer::parse_string_command(yarp::os::Bottle& in, yarp::os::Bottle& o
             auto p = m_maps_storage.find(map_name);
             if (p == m_maps_storage.end())
             {
+                updateMapVersion(map, nullptr);
                 m_maps_storage[map_name] = map;
                 out.addString(in.get(1).asString() + " successfully loaded.");
             }
@@ -383,6 +462,7 @@ void Map2DServer::parse_string_command(yarp::os::Bottle& in, yarp::os::Bottle& o
     else if(in.get(0).asString() == "clear_all_maps")
     {
         m_maps_storage.clear();
+        m_maps_versions.clear();
         out.addString("all maps cleared");
     }
     else if(in.get(0).asString() == "help")
@@ -500,6 +580,7 @@ bool Map2DServer::loadMaps(std::string mapsfile)
                 {
                     if (option == "crop")
                         map.crop(-1,-1,-1,-1);
+                    updateMapVersion(map, nullptr);
                     m_maps_storage[map_name] = map;
                 }
                 else
@@ -692,6 +773,7 @@ bool Map2DServer::open(yarp::os::Searchable &config)
         if (p == m_maps_storage.end())
         {
             yInfo() << "Added map "<< map_name <<" to mapServer";
+            updateMapVersion(map, nullptr);
             m_maps_storage[map_name] = map;
         }
     }
@@ -61,6 +61,9 @@ namespace yarp
  * |:--------------:|:--------------:|:-------:|:--------------:|:----------------:|:-----------: |:-----------------------------------------------------------------:|:-----:|
  * | name           |      -         | string  | -              | /mapServer/rpc   | No           | Full name of the rpc port opened by the Map2DServer device.       |       |
  * | mapCollection  |      -         | string  | -              |   -              | No           | The name of .ini file containing a map collection.                |       |
+ *
+ * The maps are sent compressed. The server keeps a version of each map, and of each of its tiles of 64x64 cells,
+ * so that a client which keeps a copy of a map asks for the tiles changed since the version of its copy.
 
  * \section Notes:
  * Integration with ROS map server is currently under development.
@@ -72,6 +75,18 @@ private:
     std::map<std::string, yarp::dev::MapGrid2D>     m_maps_storage;
     std::map<std::string, yarp::dev::Map2DLocation> m_locations_storage;
 
+    // The versions of the stored maps, so that the clients which keep a
+    // copy of a map receive only the tiles changed since their version.
+    struct MapVersion
+    {
+        int              version;   // last change of the map
+        int              layout;    // last change of anything but the cells
+        std::vector<int> tiles;     // last change of each tile
+    };
+    std::map<std::string, MapVersion>               m_maps_versions;
+    int                                             m_maps_session;
+    int                                             m_maps_last_version;
+
 public:
     Map2DServer();
     ~Map2DServer();
@@ -110,6 +125,7 @@ private:
     void parse_string_command(yarp::os::Bottle& in, yarp::os::Bottle& out);
     void parse_vocab_command(yarp::os::Bottle& in, yarp::os::Bottle& out);
     bool updateVizMarkers();
+    void updateMapVersion(const yarp::dev::MapGrid2D& map, const yarp::dev::MapGrid2D* previous);
 
 #endif //DOXYGEN_SHOULD_SKIP_THIS
 };
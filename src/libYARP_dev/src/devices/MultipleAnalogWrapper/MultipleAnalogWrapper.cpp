@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) 2018 Istituto Italiano di Tecnologia (IIT)
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ */
+
+#include "MultipleAnalogWrapper.h"
+
+#include <yarp/os/Bottle.h>
+#include <yarp/os/ConnectionReader.h>
+#include <yarp/os/ConnectionWriter.h>
+#include <yarp/os/LockGuard.h>
+#include <yarp/os/Log.h>
+#include <yarp/os/LogStream.h>
+#include <yarp/dev/ControlBoardInterfaces.h>
+
+using namespace yarp::sig;
+using namespace yarp::dev;
+using namespace yarp::os;
+using namespace yarp::dev::impl;
+
+// needed for the driver factory.
+yarp::dev::DriverCreator *createMultipleAnalogWrapper() {
+    return new DriverCreatorOf<yarp::dev::MultipleAnalogWrapper>("multipleAnalogServer",
+        "multipleAnalogServer",
+        "yarp::dev::MultipleAnalogWrapper");
+}
+
+
+MultipleAnalogEntry::MultipleAnalogEntry() :
+        sensor(nullptr),
+        port(nullptr),
+        handler(nullptr)
+{
+}
+
+MultipleAnalogEntry::~MultipleAnalogEntry()
+{
+    if (port != nullptr) {
+        port->interrupt();
+        port->close();
+        delete port;
+        port = nullptr;
+    }
+    if (handler != nullptr) {
+        delete handler;
+        handler = nullptr;
+    }
+}
+
+
+MultipleAnalogWrapper::MultipleAnalogWrapper() :
+        RateThread(DEFAULT_THREAD_PERIOD),
+        _rate(DEFAULT_THREAD_PERIOD),
+        legacyPorts(false)
+{
+}
+
+MultipleAnalogWrapper::~MultipleAnalogWrapper()
+{
+    close();
+}
+
+bool MultipleAnalogWrapper::open(yarp::os::Searchable &config)
+{
+    if (!config.check("name"))
+    {
+        yError() << "MultipleAnalogWrapper: missing 'name' parameter. Check you configuration file; it must be like:\n"
+                    "   name:         full name of the port, like /robotName/part/analog:o";
+        return false;
+    }
+    streamingPortName = config.find("name").asString();
+    _rate = config.check("period", Value(DEFAULT_THREAD_PERIOD)).asInt();
+    legacyPorts = config.check("legacyPorts", Value(false)).asBool();
+
+    if (!framePort.open(streamingPortName))
+    {
+        yError("MultipleAnalogWrapper: failed to open port %s", streamingPortName.c_str());
+        return false;
+    }
+    if (!rpcPort.open(streamingPortName + "/rpc:i"))
+    {
+        yError("MultipleAnalogWrapper: failed to open port %s/rpc:i", streamingPortName.c_str());
+        framePort.close();
+        return false;
+    }
+    rpcPort.setReader(*this);
+    return true;
+}
+
+bool MultipleAnalogWrapper::close()
+{
+    if (RateThread::isRunning())
+    {
+        RateThread::stop();
+    }
+    removeSensors();
+
+    rpcPort.interrupt();
+    rpcPort.close();
+    framePort.interrupt();
+    framePort.close();
+    return true;
+}
+
+void MultipleAnalogWrapper::removeSensors()
+{
+    LockGuard guard(sensorsMutex);
+    for (size_t i = 0; i < sensors.size(); i++)
+    {
+        delete sensors[i];
+    }
+    sensors.clear();
+}
+
+bool MultipleAnalogWrapper::attachAll(const PolyDriverList &analog2attach)
+{
+    if (RateThread::isRunning())
+    {
+        yError("MultipleAnalogWrapper: already attached, call detachAll() first");
+        return false;
+    }
+
+    if (analog2attach.size() == 0)
+    {
+        yError("MultipleAnalogWrapper: no device to attach");
+        return false;
+    }
+
+    bool ok = true;
+    std::vector<MultipleAnalogEntry*> attached;
+    for (int p = 0; p < analog2attach.size(); p++)
+    {
+        MultipleAnalogEntry* entry = new MultipleAnalogEntry;
+        attached.push_back(entry);
+        entry->key = analog2attach[p]->key.c_str();
+
+        yarp::dev::PolyDriver *poly = analog2attach[p]->poly;
+        if (poly != nullptr && poly->isValid())
+        {
+            poly->view(entry->sensor);
+        }
+        if (entry->sensor == nullptr)
+        {
+            yError("MultipleAnalogWrapper: subdevice %s passed to attach method is invalid", entry->key.c_str());
+            ok = false;
+            break;
+        }
+
+        // the readings go directly in this vector, it is not reallocated
+        // as long as the number of channels does not change
+        entry->data.resize((size_t)entry->sensor->getChannels(), 0.0);
+
+        if (legacyPorts)
+        {
+            std::string name = streamingPortName + "/" + entry->key;
+            entry->port = new BufferedPort<Vector>;
+            if (!entry->port->open(name))
+            {
+                yError("MultipleAnalogWrapper: failed to open port %s", name.c_str());
+                ok = false;
+                break;
+            }
+            entry->handler = new AnalogServerHandler((name + "/rpc:i").c_str());
+            entry->handler->setInterface(entry->sensor);
+        }
+    }
+
+    if (!ok)
+    {
+        for (size_t i = 0; i < attached.size(); i++)
+        {
+            delete attached[i];
+        }
+        return false;
+    }
+
+    sensorsMutex.lock();
+    sensors.swap(attached);
+    sensorsMutex.unlock();
+
+    RateThread::setRate(_rate);
+    return RateThread::start();
+}
+
+bool MultipleAnalogWrapper::detachAll()
+{
+    if (RateThread::isRunning())
+    {
+        RateThread::stop();
+    }
+    removeSensors();
+    return true;
+}
+
+bool MultipleAnalogWrapper::threadInit()
+{
+    return true;
+}
+
+void MultipleAnalogWrapper::threadRelease()
+{
+}
+
+void MultipleAnalogWrapper::run()
+{
+    lastStateStamp.update();
+
+    AnalogFrame &frame = framePort.prepare();
+    frame.clear();
+    for (size_t i = 0; i < sensors.size(); i++)
+    {
+        MultipleAnalogEntry &s = *sensors[i];
+        // on failure the vector keeps the previous reading, the slot of
+        // the sensor is sent all the same, so that the layout is stable
+        int ret = s.sensor->read(s.data);
+        frame.addSensor(s.data.data(), (int)s.data.size(), ret);
+
+        if (s.port != nullptr && ret == IAnalogSensor::AS_OK && s.data.size() > 0)
+        {
+            // the vectors of the port are recycled, the assignment copies
+            // in place when the size did not change
+            s.port->prepare() = s.data;
+            s.port->setEnvelope(lastStateStamp);
+            s.port->write();
+        }
+    }
+    frame.setStamp(lastStateStamp);
+    framePort.setEnvelope(lastStateStamp);
+    framePort.write();
+}
+
+bool MultipleAnalogWrapper::read(yarp::os::ConnectionReader& connection)
+{
+    Bottle in;
+    Bottle out;
+    if (!in.read(connection))
+    {
+        return false;
+    }
+
+    if (in.get(0).asVocab() == VOCAB_ANALOG_FRAME)
+    {
+        out.addVocab(VOCAB_ANALOG_FRAME);
+        Bottle &names = out.addList();
+        Bottle &channels = out.addList();
+        LockGuard guard(sensorsMutex);
+        for (size_t i = 0; i < sensors.size(); i++)
+        {
+            names.addString(sensors[i]->key);
+            channels.addInt((int)sensors[i]->data.size());
+        }
+    }
+    else
+    {
+        out.addVocab(VOCAB_FAILED);
+    }
+
+    ConnectionWriter *returnToSender = connection.getWriter();
+    if (returnToSender != nullptr)
+    {
+        out.write(*returnToSender);
+    }
+    return true;
+}
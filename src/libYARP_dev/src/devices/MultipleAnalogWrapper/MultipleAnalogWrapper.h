@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2018 Istituto Italiano di Tecnologia (IIT)
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ */
+
+#ifndef YARP_DEV_MULTIPLEANALOGWRAPPER_MULTIPLEANALOGWRAPPER_H
+#define YARP_DEV_MULTIPLEANALOGWRAPPER_MULTIPLEANALOGWRAPPER_H
+
+#include <vector>
+#include <string>
+
+#include <yarp/os/BufferedPort.h>
+#include <yarp/os/Mutex.h>
+#include <yarp/os/Port.h>
+#include <yarp/os/PortReader.h>
+#include <yarp/os/RateThread.h>
+#include <yarp/os/Stamp.h>
+
+#include <yarp/sig/Vector.h>
+
+#include <yarp/dev/AnalogFrame.h>
+#include <yarp/dev/DeviceDriver.h>
+#include <yarp/dev/IAnalogSensor.h>
+#include <yarp/dev/PolyDriver.h>
+#include <yarp/dev/Wrapper.h>
+
+#include <AnalogWrapper.h>
+
+namespace yarp{
+    namespace dev{
+        class MultipleAnalogWrapper;
+        namespace impl{
+            class MultipleAnalogEntry;
+        }
+    }
+}
+
+/**
+ *  @ingroup dev_impl_wrapper
+ *
+ * \brief Device that exposes several AnalogSensors (using the IAnalogSensor interface) on a single YARP port.
+ *
+ * \section multipleAnalogWrapper_parameter Description of input parameters
+ *
+ * All the attached sensors are read in the same cycle, and their readings
+ * are sent on the port <name> as a single yarp::dev::AnalogFrame, in the
+ * order of the attach list. The frame carries the time stamp of the cycle,
+ * and the offset, the number of channels and the status of each sensor.
+ *
+ * The rpc port <name>/rpc:i answers to [afrm] with the list of the names of
+ * the sensors, in the same order, followed by the list of their number of
+ * channels.
+ *
+ * When legacyPorts is set, each sensor is sent on its own port as well,
+ * as the analogServer device does, so that an analogsensorclient can read
+ * it and calibrate it.
+ *
+ * Parameters required by this device are:
+ * | Parameter name | Type    | Units | Default Value | Required | Description                                                        | Notes |
+ * |:--------------:|:-------:|:-----:|:-------------:|:--------:|:------------------------------------------------------------------:|:-----:|
+ * | name           | string  | -     |   -           | Yes      | full name of the port of the frames, like /robotName/part/analog:o | MUST start with a '/' character |
+ * | period         | int     | ms    |   20          | No       | refresh period of the broadcasted values in ms                     | - |
+ * | legacyPorts    | bool    | -     |   false       | No       | open also the ports <name>/<sensor> and <name>/<sensor>/rpc:i      | <sensor> is the name of the device in the attach list |
+ *
+ * Configuration file using .xml format.
+ *
+ * \code{.xml}
+ *  <device name="/icub/ft" type="multipleAnalogServer">
+ *      <param name="period">       10      </param>
+ *      <param name="legacyPorts">  true    </param>
+ *
+ *      <action phase="startup" level="5" type="attach">
+ *          <paramlist name="networks">
+ *              <elem name="left_arm">   left_arm_ft  </elem>
+ *              <elem name="right_arm">  right_arm_ft </elem>
+ *              <elem name="left_leg">   left_leg_ft  </elem>
+ *          </paramlist>
+ *      </action>
+ *
+ *      <action phase="shutdown" level="5" type="detach" />
+ *  </device>
+ * \endcode
+ *
+ * A client reads the frames with a yarp::os::BufferedPort<yarp::dev::AnalogFrame>
+ * and uses AnalogFrame::getData(i) to access the channels of the i-th sensor
+ * in place.
+ */
+class yarp::dev::MultipleAnalogWrapper: public yarp::os::RateThread,
+                                        public yarp::dev::DeviceDriver,
+                                        public yarp::dev::IMultipleWrapper,
+                                        public yarp::os::PortReader
+{
+public:
+    MultipleAnalogWrapper();
+    ~MultipleAnalogWrapper();
+
+    bool open(yarp::os::Searchable &params) override;
+    bool close() override;
+
+    bool attachAll(const PolyDriverList &p) override;
+    bool detachAll() override;
+
+    bool threadInit() override;
+    void threadRelease() override;
+    void run() override;
+
+    bool read(yarp::os::ConnectionReader& connection) override;
+
+private:
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+    std::string streamingPortName;
+    int _rate;
+    bool legacyPorts;
+
+    yarp::os::BufferedPort<yarp::dev::AnalogFrame> framePort;
+    yarp::os::Port rpcPort;
+    yarp::os::Stamp lastStateStamp;
+
+    yarp::os::Mutex sensorsMutex;       // protects the list against the rpc port
+    std::vector<yarp::dev::impl::MultipleAnalogEntry*> sensors;
+
+    void removeSensors();
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+};
+
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+/**
+  * An analog sensor attached to the MultipleAnalogWrapper, with the vector
+  * its channels are read into and its legacy ports, if any.
+  */
+class yarp::dev::impl::MultipleAnalogEntry
+{
+public:
+    std::string key;
+    yarp::dev::IAnalogSensor* sensor;
+    yarp::sig::Vector data;
+    yarp::os::BufferedPort<yarp::sig::Vector>* port;
+    yarp::dev::impl::AnalogServerHandler* handler;
+
+    MultipleAnalogEntry();
+    ~MultipleAnalogEntry();
+};
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+
+#endif // YARP_DEV_MULTIPLEANALOGWRAPPER_MULTIPLEANALOGWRAPPER_H
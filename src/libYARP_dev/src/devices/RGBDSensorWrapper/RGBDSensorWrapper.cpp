@@ -180,6 +180,7 @@ RGBDSensorWrapper::RGBDSensorWrapper() :
     use_YARP(true),
     use_ROS(false),
     forceInfoSync(true),
+    notReadyCount(0),
     isSubdeviceOwned(false),
     subDeviceOwned(nullptr)
 {}
@@ -673,21 +674,6 @@ string RGBDSensorWrapper::yarp2RosPixelCode(int code)
     }
 }
 
-void RGBDSensorWrapper::shallowCopyImages(const yarp::sig::FlexImage& src, yarp::sig::FlexImage& dest)
-{
-    dest.setPixelCode(src.getPixelCode());
-    dest.setQuantum(src.getQuantum());
-    dest.setExternal(src.getRawImage(), src.width(), src.height());
-}
-
-void RGBDSensorWrapper::shallowCopyImages(const ImageOf<PixelFloat>& src, ImageOf<PixelFloat>& dest)
-{
-    dest.setQuantum(src.getQuantum());
-    dest.setExternal(src.getRawImage(), src.width(), src.height());
-}
-
-
-
 void RGBDSensorWrapper::deepCopyImages(const yarp::sig::FlexImage& src,
                                        sensor_msgs_Image&          dest,
                                        const string&               frame_id,
@@ -828,49 +814,42 @@ bool RGBDSensorWrapper::setCamInfo(sensor_msgs_CameraInfo& cameraInfo, const str
 
 bool RGBDSensorWrapper::writeData()
 {
-
-    //colorImage.setPixelCode(VOCAB_PIXEL_RGB);
-    //             depthImage.setPixelCode(VOCAB_PIXEL_MONO_FLOAT);
-
-    //             colorImage.resize(hDim, vDim);  // Has this to be done each time? If size is the same what it does?
-    //             depthImage.resize(hDim, vDim);
-    if (!sensor_p->getImages(colorImage, depthImage, &colorStamp, &depthStamp))
+    // When the yarp ports are in use, the sensor fills directly the buffers
+    // owned by the ports: BufferedPort keeps a pool of them, so the frame
+    // being acquired is never one that is still being sent, and no copy of
+    // the pixels is needed. The ROS messages are filled from the same buffer.
+    FlexImage*  pColorImage = &colorImage;
+    DepthImage* pDepthImage = &depthImage;
+    if (use_YARP)
     {
-        return false;
+        pColorImage = &colorFrame_StreamingPort.prepare();
+        pDepthImage = &depthFrame_StreamingPort.prepare();
     }
 
-    static Stamp oldColorStamp = Stamp(0, 0);
-    static Stamp oldDepthStamp = Stamp(0, 0);
-
-    if (((colorStamp.getTime() - oldColorStamp.getTime()) > 0) == false)
+    if (!sensor_p->getImages(*pColorImage, *pDepthImage, &colorStamp, &depthStamp))
     {
-        return true;
+        if (use_YARP)
+        {
+            colorFrame_StreamingPort.unprepare();
+            depthFrame_StreamingPort.unprepare();
+        }
+        return false;
     }
 
-    if (((depthStamp.getTime() - oldDepthStamp.getTime()) > 0) == false)
+    if (((colorStamp.getTime() - lastColorStamp.getTime()) > 0) == false ||
+        ((depthStamp.getTime() - lastDepthStamp.getTime()) > 0) == false)
     {
+        if (use_YARP)
+        {
+            colorFrame_StreamingPort.unprepare();
+            depthFrame_StreamingPort.unprepare();
+        }
         return true;
     }
 
-    oldDepthStamp = depthStamp;
-    oldColorStamp = colorStamp;
+    lastDepthStamp = depthStamp;
+    lastColorStamp = colorStamp;
 
-    if (use_YARP)
-    {
-        FlexImage& yColorImage           = colorFrame_StreamingPort.prepare();
-        ImageOf<PixelFloat>& yDepthImage = depthFrame_StreamingPort.prepare();
-
-        shallowCopyImages(colorImage, yColorImage);
-        shallowCopyImages(depthImage, yDepthImage);
-        // TBD: We should check here somehow if the timestamp was correctly updated and, if not, update it ourselves.
-
-        colorFrame_StreamingPort.setEnvelope(colorStamp);
-        colorFrame_StreamingPort.write();
-
-        depthFrame_StreamingPort.setEnvelope(depthStamp);
-        depthFrame_StreamingPort.write();
-
-    }
     if (use_ROS)
     {
         sensor_msgs_Image&      rColorImage     = rosPublisherPort_color.prepare();
@@ -882,8 +861,8 @@ bool RGBDSensorWrapper::writeData()
         cRosStamp = normalizeSecNSec(colorStamp.getTime());
         dRosStamp = normalizeSecNSec(depthStamp.getTime());
 
-        deepCopyImages(colorImage, rColorImage, rosFrameId, cRosStamp, nodeSeq);
-        deepCopyImages(depthImage, rDepthImage, rosFrameId, dRosStamp, nodeSeq);
+        deepCopyImages(*pColorImage, rColorImage, rosFrameId, cRosStamp, nodeSeq);
+        deepCopyImages(*pDepthImage, rDepthImage, rosFrameId, dRosStamp, nodeSeq);
         // TBD: We should check here somehow if the timestamp was correctly updated and, if not, update it ourselves.
 
         rosPublisherPort_color.setEnvelope(colorStamp);
@@ -917,6 +896,16 @@ bool RGBDSensorWrapper::writeData()
 
         nodeSeq++;
     }
+
+    if (use_YARP)
+    {
+        // TBD: We should check here somehow if the timestamp was correctly updated and, if not, update it ourselves.
+        colorFrame_StreamingPort.setEnvelope(colorStamp);
+        colorFrame_StreamingPort.write();
+
+        depthFrame_StreamingPort.setEnvelope(depthStamp);
+        depthFrame_StreamingPort.write();
+    }
     return true;
 }
 
@@ -924,7 +913,6 @@ void RGBDSensorWrapper::run()
 {
     if (sensor_p!=nullptr)
     {
-        static int i = 0;
         sensorStatus = sensor_p->getSensorStatus();
         switch (sensorStatus)
         {
@@ -932,21 +920,21 @@ void RGBDSensorWrapper::run()
             {
                 if (!writeData())
                     yError("Image not captured.. check hardware configuration");
-                i = 0;
+                notReadyCount = 0;
             }
             break;
             case(IRGBDSensor::RGBD_SENSOR_NOT_READY):
             {
-                if(i < 1000)
+                if(notReadyCount < 1000)
                 {
-                    if((i % 30) == 0)
+                    if((notReadyCount % 30) == 0)
                         yInfo() << "device not ready, waiting...";
                 }
                 else
                 {
                     yWarning() << "device is taking too long to start..";
                 }
-                i++;
+                notReadyCount++;
             }
             break;
             default:
@@ -186,6 +186,7 @@ private:
     bool                           use_YARP;
     bool                           use_ROS;
     bool                           forceInfoSync;
+    int                            notReadyCount;
     bool                           initialize_YARP(yarp::os::Searchable &config);
     bool                           initialize_ROS(yarp::os::Searchable &config);
     bool                           read(yarp::os::ConnectionReader& connection);
@@ -203,10 +204,10 @@ private:
     // Synch
     yarp::os::Stamp                colorStamp;
     yarp::os::Stamp                depthStamp;
+    yarp::os::Stamp                lastColorStamp;
+    yarp::os::Stamp                lastDepthStamp;
     yarp::os::Property             m_conf;
 
-    void shallowCopyImages(const yarp::sig::FlexImage& src, yarp::sig::FlexImage& dest);
-    void shallowCopyImages(const DepthImage& src, DepthImage& dest);
     bool writeData();
     void deepCopyImages(const yarp::sig::FlexImage& src,
                         sensor_msgs_Image&          dest,
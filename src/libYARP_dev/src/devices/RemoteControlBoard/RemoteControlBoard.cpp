@@ -14,6 +14,8 @@
 #include <yarp/os/Vocab.h>
 #include <yarp/os/Stamp.h>
 #include <yarp/os/Semaphore.h>
+#include <yarp/os/Mutex.h>
+#include <yarp/os/LockGuard.h>
 #include <yarp/os/LogStream.h>
 #include <yarp/os/QosStyle.h>
 
@@ -29,7 +31,7 @@
 #include <stateExtendedReader.hpp>
 
 #define PROTOCOL_VERSION_MAJOR 1
-#define PROTOCOL_VERSION_MINOR 9
+#define PROTOCOL_VERSION_MINOR 10
 #define PROTOCOL_VERSION_TWEAK 0
 
 using namespace yarp::os;
@@ -157,7 +159,9 @@ class yarp::dev::RemoteControlBoard :
     public IRemoteCalibrator,
     public IRemoteVariables,
     public IPWMControl,
-    public ICurrentControl
+    public ICurrentControl,
+    public IStreamingFrame,
+    public IRpcBatch
 {
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
@@ -169,6 +173,7 @@ protected:
 
     PortReaderBuffer<yarp::sig::Vector> state_buffer;
     PortWriterBuffer<CommandMessage> command_buffer;
+    PortWriterBuffer<StreamingFrame> frame_buffer;
     bool writeStrict_singleJoint;
     bool writeStrict_moreJoints;
 
@@ -190,6 +195,129 @@ protected:
 
     ProtocolVersion protocolVersion;
 
+    // Setters queued between beginBatch() and endBatch(), see IRpcBatch.
+    // The getters are const but send the queued setters.
+    mutable Mutex batchMutex;
+    bool batching;
+    mutable Bottle batch;       // [btch] (cmd1) (cmd2) ...
+    mutable bool batchOk;       // false if a setter of the batch failed
+
+    /**
+     * Send a batch and check its reply.
+     * @param msg the batch
+     * @param replies the reply, one element for each command
+     * @param nSetters the number of commands at the beginning of the batch
+     * whose reply is checked, the others are returned to the caller
+     * @return false if the batch could not be sent, or if one of the
+     * checked commands failed
+     */
+    bool sendBatch(Bottle& msg, Bottle& replies, int nSetters) const
+    {
+        bool ok = rpc_p.write(msg, replies);
+        if (!ok || replies.get(0).asVocab() != VOCAB_RPC_BATCH || replies.size() != msg.size())
+        {
+            yError("remote_controlboard: invalid reply to a batch of %d commands", msg.size() - 1);
+            return false;
+        }
+        for (int i = 1; i <= nSetters; i++)
+        {
+            Bottle* reply = replies.get(i).asList();
+            if (reply == nullptr || !CHECK_FAIL(true, *reply))
+            {
+                yError("remote_controlboard: command %s of the batch failed", msg.get(i).toString().c_str());
+                ok = false;
+            }
+        }
+        return ok;
+    }
+
+    /**
+     * Send the setters queued in the open batch, if any, and wait for
+     * their replies.
+     */
+    void flushBatch()
+    {
+        Bottle msg;
+        {
+            LockGuard guard(batchMutex);
+            if (batch.size() <= 1) {
+                return;
+            }
+            msg = batch;
+            batch.clear();
+            batch.addVocab(VOCAB_RPC_BATCH);
+        }
+        Bottle replies;
+        if (!sendBatch(msg, replies, msg.size() - 1)) {
+            LockGuard guard(batchMutex);
+            batchOk = false;
+        }
+    }
+
+    /**
+     * Send the command prepared in command_buffer on the streaming port.
+     * The setters queued in a batch are sent first, the streaming command
+     * must not overtake them (e.g. a setControlMode()).
+     */
+    void writeStreaming(bool strict)
+    {
+        flushBatch();
+        command_buffer.write(strict);
+    }
+
+    /**
+     * Send a command whose reply only tells whether it succeeded (a
+     * setter), and check the reply.
+     * Within a batch the command is queued instead.
+     */
+    bool rpcSet(Bottle& cmd)
+    {
+        {
+            LockGuard guard(batchMutex);
+            if (batching) {
+                batch.addList() = cmd;
+                return true;
+            }
+        }
+        Bottle response;
+        bool ok = rpc_p.write(cmd, response);
+        return CHECK_FAIL(ok, response);
+    }
+
+    /**
+     * Send a command and wait for its reply.
+     * Within a batch, the queued setters are sent in the same message.
+     */
+    bool rpcWrite(Bottle& cmd, Bottle& response) const
+    {
+        Bottle msg;
+        {
+            LockGuard guard(batchMutex);
+            if (batch.size() > 1) {
+                msg = batch;
+                batch.clear();
+                batch.addVocab(VOCAB_RPC_BATCH);
+            }
+        }
+        if (msg.size() == 0) {
+            return rpc_p.write(cmd, response);
+        }
+        msg.addList() = cmd;
+        int nSetters = msg.size() - 2;
+
+        Bottle replies;
+        bool ok = sendBatch(msg, replies, nSetters);
+        if (!ok) {
+            LockGuard guard(batchMutex);
+            batchOk = false;
+        }
+        Bottle* reply = replies.get(nSetters + 1).asList();
+        if (reply == nullptr) {
+            return false;
+        }
+        response = *reply;
+        return true;
+    }
     // Check for number of joints, if needed.
     // This is to allow for delayed connection to the remote control board.
     bool isLive() {
@@ -204,64 +332,44 @@ protected:
 
     bool send1V(int v)
     {
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(v);
-        bool ok=rpc_p.write(cmd, response);
-        if (CHECK_FAIL(ok, response)) {
-            return true;
-        }
-        return false;
+        return rpcSet(cmd);
     }
 
     bool send2V(int v1, int v2)
     {
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(v1);
         cmd.addVocab(v2);
-        bool ok=rpc_p.write(cmd, response);
-        if (CHECK_FAIL(ok, response)) {
-            return true;
-        }
-        return false;
+        return rpcSet(cmd);
     }
 
     bool send2V1I(int v1, int v2, int axis)
     {
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(v1);
         cmd.addVocab(v2);
         cmd.addInt(axis);
-        bool ok=rpc_p.write(cmd, response);
-        if (CHECK_FAIL(ok, response)) {
-            return true;
-        }
-        return false;
+        return rpcSet(cmd);
     }
 
     bool send1V1I(int v, int axis)
     {
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(v);
         cmd.addInt(axis);
-        bool ok=rpc_p.write(cmd, response);
-        if (CHECK_FAIL(ok, response)) {
-            return true;
-        }
-        return false;
+        return rpcSet(cmd);
     }
 
     bool send3V1I(int v1, int v2, int v3, int j)
     {
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(v1);
         cmd.addVocab(v2);
         cmd.addVocab(v3);
         cmd.addInt(j);
-        bool ok=rpc_p.write(cmd, response);
-        if (CHECK_FAIL(ok, response)) {
-            return true;
-        }
-        return false;
+        return rpcSet(cmd);
     }
     /**
      * Send a SET command without parameters and wait for a reply.
@@ -269,12 +377,11 @@ protected:
      * @return true/false on success/failure.
      */
     bool set1V(int code) {
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(VOCAB_SET);
         cmd.addVocab(code);
 
-        bool ok = rpc_p.write(cmd, response);
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
     /**
@@ -286,14 +393,12 @@ protected:
      */
     bool set1V2D(int code, double v)
     {
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(VOCAB_SET);
         cmd.addVocab(code);
         cmd.addDouble(v);
 
-        bool ok = rpc_p.write(cmd, response);
-
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
     /**
@@ -304,14 +409,12 @@ protected:
      * @return true/false on success/failure.
      */
     bool set1V1I(int code, int v) {
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(VOCAB_SET);
         cmd.addVocab(code);
         cmd.addInt(v);
 
-        bool ok = rpc_p.write(cmd, response);
-
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
     /**
@@ -326,7 +429,7 @@ protected:
         cmd.addVocab(VOCAB_GET);
         cmd.addVocab(code);
 
-        bool ok = rpc_p.write(cmd, response);
+        bool ok = rpcWrite(cmd, response);
 
         if (CHECK_FAIL(ok, response)) {
             // response should be [cmd] [name] value
@@ -351,7 +454,7 @@ protected:
         cmd.addVocab(VOCAB_GET);
         cmd.addVocab(code);
 
-        bool ok = rpc_p.write(cmd, response);
+        bool ok = rpcWrite(cmd, response);
 
         if (CHECK_FAIL(ok, response)) {
             // response should be [cmd] [name] value
@@ -372,26 +475,24 @@ protected:
      * @return true/false on success/failure
      */
     bool set1V1I1D(int code, int j, double val) {
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(VOCAB_SET);
         cmd.addVocab(code);
         cmd.addInt(j);
         cmd.addDouble(val);
-        bool ok = rpc_p.write(cmd, response);
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
     bool set1V1I2D(int code, int j, double val1, double val2)
     {
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(VOCAB_SET);
         cmd.addVocab(code);
         cmd.addInt(j);
         cmd.addDouble(val1);
         cmd.addDouble(val2);
 
-        bool ok = rpc_p.write(cmd, response);
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
     /**
@@ -402,20 +503,19 @@ protected:
      */
     bool set1VDA(int v, const double *val) {
         if (!isLive()) return false;
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(VOCAB_SET);
         cmd.addVocab(v);
         Bottle& l = cmd.addList();
         int i;
         for (i = 0; i < nj; i++)
             l.addDouble(val[i]);
-        bool ok = rpc_p.write(cmd, response);
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
     bool set2V1DA(int v1, int v2, const double *val) {
         if (!isLive()) return false;
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(VOCAB_SET);
         cmd.addVocab(v1);
         cmd.addVocab(v2);
@@ -423,13 +523,12 @@ protected:
         int i;
         for (i = 0; i < nj; i++)
             l.addDouble(val[i]);
-        bool ok = rpc_p.write(cmd, response);
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
     bool set2V2DA(int v1, int v2, const double *val1, const double *val2) {
         if (!isLive()) return false;
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(VOCAB_SET);
         cmd.addVocab(v1);
         cmd.addVocab(v2);
@@ -440,13 +539,12 @@ protected:
         Bottle& l2 = cmd.addList();
         for (i = 0; i < nj; i++)
             l2.addDouble(val2[i]);
-        bool ok = rpc_p.write(cmd, response);
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
     bool set1V1I1IA1DA(int v, const int len, const int *val1, const double *val2) {
         if (!isLive()) return false;
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(VOCAB_SET);
         cmd.addVocab(v);
         cmd.addInt(len);
@@ -457,39 +555,36 @@ protected:
         Bottle& l2 = cmd.addList();
         for (i = 0; i < len; i++)
             l2.addDouble(val2[i]);
-        bool ok = rpc_p.write(cmd, response);
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
     bool set2V1I1D(int v1, int v2, int axis, double val) {
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(VOCAB_SET);
         cmd.addVocab(v1);
         cmd.addVocab(v2);
         cmd.addInt(axis);
         cmd.addDouble(val);
-        bool ok = rpc_p.write(cmd, response);
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
      bool setValWithPidType(int voc, PidControlTypeEnum type, int axis, double val)
      {
         if (!isLive()) return false;
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(VOCAB_SET);
         cmd.addVocab(VOCAB_PID);
         cmd.addVocab(voc);
         cmd.addVocab(type);
         cmd.addInt(axis);
         cmd.addDouble(val);
-        bool ok = rpc_p.write(cmd, response);
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
     bool setValWithPidType(int voc, PidControlTypeEnum type, const double* val_arr)
     {
         if (!isLive()) return false;
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(VOCAB_SET);
         cmd.addVocab(VOCAB_PID);
         cmd.addVocab(voc);
@@ -498,8 +593,7 @@ protected:
         int i;
         for (i = 0; i < nj; i++)
             l.addDouble(val_arr[i]);
-        bool ok = rpc_p.write(cmd, response);
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
     bool getValWithPidType(int voc, PidControlTypeEnum type, int j, double *val)
@@ -510,7 +604,7 @@ protected:
         cmd.addVocab(voc);
         cmd.addVocab(type);
         cmd.addInt(j);
-        bool ok = rpc_p.write(cmd, response);
+        bool ok = rpcWrite(cmd, response);
 
         if (CHECK_FAIL(ok, response))
         {
@@ -529,7 +623,7 @@ protected:
         cmd.addVocab(VOCAB_PID);
         cmd.addVocab(voc);
         cmd.addVocab(type);
-        bool ok = rpc_p.write(cmd, response);
+        bool ok = rpcWrite(cmd, response);
         if (CHECK_FAIL(ok, response))
         {
             int i;
@@ -548,13 +642,12 @@ protected:
     }
 
     bool set2V1I(int v1, int v2, int axis) {
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(VOCAB_SET);
         cmd.addVocab(v1);
         cmd.addVocab(v2);
         cmd.addInt(axis);
-        bool ok = rpc_p.write(cmd, response);
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
     /**
@@ -569,7 +662,7 @@ protected:
         cmd.addVocab(VOCAB_GET);
         cmd.addVocab(v);
         cmd.addInt(j);
-        bool ok = rpc_p.write(cmd, response);
+        bool ok = rpcWrite(cmd, response);
 
         if (CHECK_FAIL(ok, response)) {
             // ok
@@ -594,7 +687,7 @@ protected:
         cmd.addVocab(VOCAB_GET);
         cmd.addVocab(v);
         cmd.addInt(j);
-        bool ok = rpc_p.write(cmd, response);
+        bool ok = rpcWrite(cmd, response);
         if (CHECK_FAIL(ok, response)) {
             // ok
             *val = response.get(2).asInt();
@@ -611,7 +704,7 @@ protected:
         cmd.addVocab(v1);
         cmd.addVocab(v2);
         cmd.addInt(j);
-        bool ok = rpc_p.write(cmd, response);
+        bool ok = rpcWrite(cmd, response);
 
         if (CHECK_FAIL(ok, response)) {
             // ok
@@ -629,7 +722,7 @@ protected:
         cmd.addVocab(v1);
         cmd.addVocab(v2);
         cmd.addInt(j);
-        bool ok = rpc_p.write(cmd, response);
+        bool ok = rpcWrite(cmd, response);
         if (CHECK_FAIL(ok, response)) {
             // ok
             *val1 = response.get(2).asDouble();
@@ -648,7 +741,7 @@ protected:
         cmd.addVocab(code);
         cmd.addInt(axis);
 
-        bool ok = rpc_p.write(cmd, response);
+        bool ok = rpcWrite(cmd, response);
 
         if (CHECK_FAIL(ok, response)) {
             *v1 = response.get(2).asDouble();
@@ -670,7 +763,7 @@ protected:
         cmd.addVocab(VOCAB_GET);
         cmd.addVocab(v);
         cmd.addInt(j);
-        bool ok = rpc_p.write(cmd, response);
+        bool ok = rpcWrite(cmd, response);
         if (CHECK_FAIL(ok, response)) {
             val = (response.get(2).asInt()!=0);
             getTimeStamp(response, lastStamp);
@@ -688,7 +781,7 @@ protected:
         for (int i = 0; i < len; i++)
             l1.addInt(val1[i]);
 
-        bool ok = rpc_p.write(cmd, response);
+        bool ok = rpcWrite(cmd, response);
 
         if (CHECK_FAIL(ok, response)) {
             retVal = (response.get(2).asInt()!=0);
@@ -712,7 +805,7 @@ protected:
         for (int i = 0; i < n_joints; i++)
             l1.addInt(joints[i]);
 
-        bool ok = rpc_p.write(cmd, response);
+        bool ok = rpcWrite(cmd, response);
 
         if (CHECK_FAIL(ok, response))
         {
@@ -741,7 +834,7 @@ protected:
         Bottle cmd, response;
         cmd.addVocab(VOCAB_GET);
         cmd.addVocab(v);
-        bool ok = rpc_p.write(cmd, response);
+        bool ok = rpcWrite(cmd, response);
         if (CHECK_FAIL(ok, response)) {
             val = (response.get(2).asInt()!=0);
             getTimeStamp(response, lastStamp);
@@ -761,7 +854,7 @@ protected:
         Bottle cmd, response;
         cmd.addVocab(VOCAB_GET);
         cmd.addVocab(v);
-        bool ok = rpc_p.write(cmd, response);
+        bool ok = rpcWrite(cmd, response);
         if (CHECK_FAIL(ok, response)) {
             int i;
             Bottle* lp = response.get(2).asList();
@@ -792,7 +885,7 @@ protected:
         Bottle cmd, response;
         cmd.addVocab(VOCAB_GET);
         cmd.addVocab(v);
-        bool ok = rpc_p.write(cmd, response);
+        bool ok = rpcWrite(cmd, response);
         if (CHECK_FAIL(ok, response)) {
             int i;
             Bottle* lp = response.get(2).asList();
@@ -823,7 +916,7 @@ protected:
         Bottle cmd, response;
         cmd.addVocab(VOCAB_GET);
         cmd.addVocab(v1);
-        bool ok = rpc_p.write(cmd, response);
+        bool ok = rpcWrite(cmd, response);
 
         if (CHECK_FAIL(ok, response)) {
             int i;
@@ -856,7 +949,7 @@ protected:
         cmd.addVocab(VOCAB_GET);
         cmd.addVocab(v1);
         cmd.addVocab(v2);
-        bool ok = rpc_p.write(cmd, response);
+        bool ok = rpcWrite(cmd, response);
 
         if (CHECK_FAIL(ok, response)) {
             int i;
@@ -882,7 +975,7 @@ protected:
         cmd.addVocab(VOCAB_GET);
         cmd.addVocab(v1);
         cmd.addVocab(v2);
-        bool ok = rpc_p.write(cmd, response);
+        bool ok = rpcWrite(cmd, response);
         if (CHECK_FAIL(ok, response)) {
             int i;
             Bottle* lp1 = response.get(2).asList();
@@ -916,7 +1009,7 @@ protected:
         cmd.addVocab(VOCAB_GET);
         cmd.addVocab(code);
         cmd.addInt(j);
-        bool ok = rpc_p.write(cmd, response);
+        bool ok = rpcWrite(cmd, response);
 
         if (CHECK_FAIL(ok, response)) {
             name = response.get(2).asString();
@@ -938,7 +1031,7 @@ protected:
         for(int i = 0; i < len; i++)
             l1.addInt(val1[i]);
 
-        bool ok = rpc_p.write(cmd, response);
+        bool ok = rpcWrite(cmd, response);
 
         if (CHECK_FAIL(ok, response)) {
             int i;
@@ -974,7 +1067,9 @@ public:
         writeStrict_moreJoints (false),
         nj(0),
         njIsKnown(false),
-        protocolVersion(ProtocolVersion{0,0,0})
+        protocolVersion(ProtocolVersion{0,0,0}),
+        batching(false),
+        batchOk(true)
     {}
 
     /**
@@ -1132,11 +1227,13 @@ public:
 
         state_buffer.setStrict(false);
         command_buffer.attach(command_p);
+        frame_buffer.attach(command_p);
 
         if (!checkProtocolVersion(config.check("ignoreProtocolCheck")))
         {
             yError() << "checkProtocolVersion failed";
             command_buffer.detach();
+            frame_buffer.detach();
             rpc_p.close();
             command_p.close();
             extendedIntputStatePort.close();
@@ -1147,6 +1244,7 @@ public:
             if (remote!="") {
                 yError("Problems with obtaining the number of controlled axes\n");
                 command_buffer.detach();
+                frame_buffer.detach();
                 rpc_p.close();
                 command_p.close();
                 extendedIntputStatePort.close();
@@ -1204,6 +1302,8 @@ public:
             delete diagnosticThread;
         }
 
+        endBatch();
+
         rpc_p.close();
         command_p.close();
         extendedIntputStatePort.close();
@@ -1211,7 +1311,7 @@ public:
     }
 
     virtual bool setPid(const PidControlTypeEnum& pidtype, int j, const Pid &pid) override {
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(VOCAB_SET);
         cmd.addVocab(VOCAB_PID);
         cmd.addVocab(VOCAB_PID);
@@ -1228,13 +1328,12 @@ public:
         l.addDouble(pid.stiction_up_val);
         l.addDouble(pid.stiction_down_val);
         l.addDouble(pid.kff);
-        bool ok = rpc_p.write(cmd, response);
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
     virtual bool setPids(const PidControlTypeEnum& pidtype, const Pid *pids) override {
         if (!isLive()) return false;
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(VOCAB_SET);
         cmd.addVocab(VOCAB_PID);
         cmd.addVocab(VOCAB_PIDS);
@@ -1255,8 +1354,7 @@ public:
             m.addDouble(pids[i].kff);
         }
 
-        bool ok = rpc_p.write(cmd, response);
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
     virtual bool setPidReference(const PidControlTypeEnum& pidtype, int j, double ref) override
@@ -1291,7 +1389,7 @@ public:
         cmd.addVocab(VOCAB_PID);
         cmd.addVocab(pidtype);
         cmd.addInt(j);
-        bool ok = rpc_p.write(cmd, response);
+        bool ok = rpcWrite(cmd, response);
         if (CHECK_FAIL(ok, response)) {
             Bottle* lp = response.get(2).asList();
             if (lp == nullptr)
@@ -1319,7 +1417,7 @@ public:
         cmd.addVocab(VOCAB_PID);
         cmd.addVocab(VOCAB_PIDS);
         cmd.addVocab(pidtype);
-        bool ok = rpc_p.write(cmd, response);
+        bool ok = rpcWrite(cmd, response);
         if (CHECK_FAIL(ok, response))
         {
             int i;
@@ -1367,38 +1465,35 @@ public:
 
     virtual bool resetPid(const PidControlTypeEnum& pidtype, int j) override {
         if (!isLive()) return false;
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(VOCAB_SET);
         cmd.addVocab(VOCAB_PID);
         cmd.addVocab(VOCAB_RESET);
         cmd.addVocab(pidtype);
         cmd.addInt(j);
-        bool ok = rpc_p.write(cmd, response);
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
     virtual bool disablePid(const PidControlTypeEnum& pidtype, int j) override {
         if (!isLive()) return false;
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(VOCAB_SET);
         cmd.addVocab(VOCAB_PID);
         cmd.addVocab(VOCAB_DISABLE);
         cmd.addVocab(pidtype);
         cmd.addInt(j);
-        bool ok = rpc_p.write(cmd, response);
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
     virtual bool enablePid(const PidControlTypeEnum& pidtype, int j) override {
         if (!isLive()) return false;
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(VOCAB_SET);
         cmd.addVocab(VOCAB_PID);
         cmd.addVocab(VOCAB_ENABLE);
         cmd.addVocab(pidtype);
         cmd.addInt(j);
-        bool ok = rpc_p.write(cmd, response);
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
     virtual bool isPidEnabled(const PidControlTypeEnum& pidtype, int j, bool* enabled) override
@@ -1409,7 +1504,7 @@ public:
         cmd.addVocab(VOCAB_ENABLE);
         cmd.addVocab(pidtype);
         cmd.addInt(j);
-        bool ok = rpc_p.write(cmd, response);
+        bool ok = rpcWrite(cmd, response);
         if (CHECK_FAIL(ok, response))
         {
             *enabled = response.get(2).asBool();
@@ -1618,7 +1713,7 @@ public:
         cmd.addVocab(VOCAB_REMOTE_VARIABILE_INTERFACE);
         cmd.addVocab(VOCAB_VARIABLE);
         cmd.addString(key);
-        bool ok = rpc_p.write(cmd, response);
+        bool ok = rpcWrite(cmd, response);
         if (CHECK_FAIL(ok, response))
         {
             val = *(response.get(2).asList());
@@ -1628,16 +1723,14 @@ public:
     }
 
     virtual bool setRemoteVariable(yarp::os::ConstString key, const yarp::os::Bottle& val) override {
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(VOCAB_SET);
         cmd.addVocab(VOCAB_REMOTE_VARIABILE_INTERFACE);
         cmd.addVocab(VOCAB_VARIABLE);
         cmd.addString(key);
         cmd.append(val);
         //std::string s = cmd.toString();
-        bool ok = rpc_p.write(cmd, response);
-
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
 
@@ -1646,7 +1739,7 @@ public:
         cmd.addVocab(VOCAB_GET);
         cmd.addVocab(VOCAB_REMOTE_VARIABILE_INTERFACE);
         cmd.addVocab(VOCAB_LIST_VARIABLES);
-        bool ok = rpc_p.write(cmd, response);
+        bool ok = rpcWrite(cmd, response);
         //std::string s = response.toString();
         if (CHECK_FAIL(ok, response))
         {
@@ -2186,7 +2279,7 @@ public:
     virtual bool stop(const int len, const int *val1) override
     {
         if (!isLive()) return false;
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(VOCAB_SET);
         cmd.addVocab(VOCAB_STOP_GROUP);
         cmd.addInt(len);
@@ -2195,8 +2288,7 @@ public:
         for (i = 0; i < len; i++)
             l1.addInt(val1[i]);
 
-        bool ok = rpc_p.write(cmd, response);
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
     /**
@@ -2223,7 +2315,7 @@ public:
         c.head.addInt(j);
         c.body.resize(1);
         memcpy(&(c.body[0]), &v, sizeof(double));
-        command_buffer.write(writeStrict_singleJoint);
+        writeStreaming(writeStrict_singleJoint);
         return true;
     }
 
@@ -2239,7 +2331,7 @@ public:
         c.head.addVocab(VOCAB_VELOCITY_MOVES);
         c.body.resize(nj);
         memcpy(&(c.body[0]), v, sizeof(double)*nj);
-        command_buffer.write(writeStrict_moreJoints);
+        writeStreaming(writeStrict_moreJoints);
         return true;
     }
 
@@ -2476,7 +2568,7 @@ public:
 
     bool virtual calibrate2(int j, unsigned int ui, double v1, double v2, double v3) override
     {
-        Bottle cmd, response;
+        Bottle cmd;
 
         cmd.addVocab(VOCAB_CALIBRATE_JOINT);
         cmd.addInt(j);
@@ -2485,17 +2577,12 @@ public:
         cmd.addDouble(v2);
         cmd.addDouble(v3);
 
-        bool ok = rpc_p.write(cmd, response);
-
-        if (CHECK_FAIL(ok, response)) {
-            return true;
-        }
-        return false;
+        return rpcSet(cmd);
     }
 
     bool virtual setCalibrationParameters(int j, const CalibrationParameters& params) override
     {
-        Bottle cmd, response;
+        Bottle cmd;
 
         cmd.addVocab(VOCAB_CALIBRATE_JOINT_PARAMS);
         cmd.addInt(j);
@@ -2505,12 +2592,7 @@ public:
         cmd.addDouble(params.param3);
         cmd.addDouble(params.param4);
 
-        bool ok = rpc_p.write(cmd, response);
-
-        if (CHECK_FAIL(ok, response)) {
-            return true;
-        }
-        return false;
+        return rpcSet(cmd);
     }
 
     bool virtual done(int j) override
@@ -2535,7 +2617,7 @@ public:
 
         memcpy(c.body.data(), t, sizeof(double) * nj);
 
-        command_buffer.write(writeStrict_moreJoints);
+        writeStreaming(writeStrict_moreJoints);
         return true;
     }
 
@@ -2553,7 +2635,7 @@ public:
         c.body.clear();
         c.body.resize(1);
         c.body[0] = v;
-        command_buffer.write(writeStrict_singleJoint);
+        writeStreaming(writeStrict_singleJoint);
         return true;
     }
 
@@ -2572,7 +2654,7 @@ public:
             jointList.addInt(joints[i]);
         c.body.resize(n_joint);
         memcpy(&(c.body[0]), t, sizeof(double)*n_joint);
-        command_buffer.write(writeStrict_moreJoints);
+        writeStreaming(writeStrict_moreJoints);
         return true;
     }
 
@@ -2584,7 +2666,7 @@ public:
 
     bool setMotorTorqueParams(int j, const MotorTorqueParameters params) override
     {
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(VOCAB_SET);
         cmd.addVocab(VOCAB_TORQUE);
         cmd.addVocab(VOCAB_MOTOR_PARAMS);
@@ -2594,8 +2676,7 @@ public:
         b.addDouble(params.bemf_scale);
         b.addDouble(params.ktau);
         b.addDouble(params.ktau_scale);
-        bool ok = rpc_p.write(cmd, response);
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
     bool getMotorTorqueParams(int j, MotorTorqueParameters *params) override
@@ -2605,7 +2686,7 @@ public:
         cmd.addVocab(VOCAB_TORQUE);
         cmd.addVocab(VOCAB_MOTOR_PARAMS);
         cmd.addInt(j);
-        bool ok = rpc_p.write(cmd, response);
+        bool ok = rpcWrite(cmd, response);
         if (CHECK_FAIL(ok, response)) {
             Bottle* lp = response.get(2).asList();
             if (lp == nullptr)
@@ -2656,7 +2737,7 @@ public:
         cmd.addVocab(VOCAB_IMPEDANCE);
         cmd.addVocab(VOCAB_IMP_PARAM);
         cmd.addInt(j);
-        bool ok = rpc_p.write(cmd, response);
+        bool ok = rpcWrite(cmd, response);
         if (CHECK_FAIL(ok, response)) {
             Bottle* lp = response.get(2).asList();
             if (lp == nullptr)
@@ -2676,7 +2757,7 @@ public:
         cmd.addVocab(VOCAB_IMPEDANCE);
         cmd.addVocab(VOCAB_IMP_OFFSET);
         cmd.addInt(j);
-        bool ok = rpc_p.write(cmd, response);
+        bool ok = rpcWrite(cmd, response);
         if (CHECK_FAIL(ok, response)) {
             Bottle* lp = response.get(2).asList();
             if (lp == nullptr)
@@ -2690,7 +2771,7 @@ public:
 
     bool setImpedance(int j, double stiffness, double damping) override
     {
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(VOCAB_SET);
         cmd.addVocab(VOCAB_IMPEDANCE);
         cmd.addVocab(VOCAB_IMP_PARAM);
@@ -2700,13 +2781,12 @@ public:
         b.addDouble(stiffness);
         b.addDouble(damping);
 
-        bool ok = rpc_p.write(cmd, response);
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
     bool setImpedanceOffset(int j, double offset) override
     {
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(VOCAB_SET);
         cmd.addVocab(VOCAB_IMPEDANCE);
         cmd.addVocab(VOCAB_IMP_OFFSET);
@@ -2715,8 +2795,7 @@ public:
         Bottle& b = cmd.addList();
         b.addDouble(offset);
 
-        bool ok = rpc_p.write(cmd, response);
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
     bool getCurrentImpedanceLimit(int j, double *min_stiff, double *max_stiff, double *min_damp, double *max_damp) override
@@ -2726,7 +2805,7 @@ public:
         cmd.addVocab(VOCAB_IMPEDANCE);
         cmd.addVocab(VOCAB_LIMITS);
         cmd.addInt(j);
-        bool ok = rpc_p.write(cmd, response);
+        bool ok = rpcWrite(cmd, response);
         if (CHECK_FAIL(ok, response)) {
             Bottle* lp = response.get(2).asList();
             if (lp == nullptr)
@@ -2784,21 +2863,20 @@ public:
     bool setControlMode(const int j, const int mode) override
     {
         if (!isLive()) return false;
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(VOCAB_SET);
         cmd.addVocab(VOCAB_ICONTROLMODE);
         cmd.addVocab(VOCAB_CM_CONTROL_MODE);
         cmd.addInt(j);
         cmd.addVocab(mode);
 
-        bool ok = rpc_p.write(cmd, response);
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
     bool setControlModes(const int n_joint, const int *joints, int *modes) override
     {
         if (!isLive()) return false;
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(VOCAB_SET);
         cmd.addVocab(VOCAB_ICONTROLMODE);
         cmd.addVocab(VOCAB_CM_CONTROL_MODE_GROUP);
@@ -2812,14 +2890,13 @@ public:
         for (i = 0; i < n_joint; i++)
             l2.addVocab(modes[i]);
 
-        bool ok = rpc_p.write(cmd, response);
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
     bool setControlModes(int *modes) override
     {
         if (!isLive()) return false;
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(VOCAB_SET);
         cmd.addVocab(VOCAB_ICONTROLMODE);
         cmd.addVocab(VOCAB_CM_CONTROL_MODES);
@@ -2829,8 +2906,7 @@ public:
         for (i = 0; i < nj; i++)
             l2.addVocab(modes[i]);
 
-        bool ok = rpc_p.write(cmd, response);
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
     //
@@ -2845,7 +2921,7 @@ public:
         c.head.addInt(j);
         c.body.resize(1);
         memcpy(&(c.body[0]), &ref, sizeof(double));
-        command_buffer.write(writeStrict_singleJoint);
+        writeStreaming(writeStrict_singleJoint);
         return true;
     }
 
@@ -2861,7 +2937,7 @@ public:
             jointList.addInt(joints[i]);
         c.body.resize(n_joint);
         memcpy(&(c.body[0]), refs, sizeof(double)*n_joint);
-        command_buffer.write(writeStrict_moreJoints);
+        writeStreaming(writeStrict_moreJoints);
         return true;
     }
 
@@ -2873,7 +2949,7 @@ public:
         c.head.addVocab(VOCAB_POSITION_DIRECTS);
         c.body.resize(nj);
         memcpy(&(c.body[0]), refs, sizeof(double)*nj);
-        command_buffer.write(writeStrict_moreJoints);
+        writeStreaming(writeStrict_moreJoints);
         return true;
     }
 
@@ -2909,7 +2985,7 @@ public:
             jointList.addInt(joints[i]);
         c.body.resize(n_joint);
         memcpy(&(c.body[0]), spds, sizeof(double)*n_joint);
-        command_buffer.write(writeStrict_moreJoints);
+        writeStreaming(writeStrict_moreJoints);
         return true;
     }
 
@@ -2967,7 +3043,7 @@ public:
 
     bool setInteractionMode(int axis, yarp::dev::InteractionModeEnum mode) override
     {
-        Bottle cmd, response;
+        Bottle cmd;
         if (!isLive()) return false;
 
         cmd.addVocab(VOCAB_SET);
@@ -2976,13 +3052,12 @@ public:
         cmd.addInt(axis);
         cmd.addVocab(mode);
 
-        bool ok = rpc_p.write(cmd, response);
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
     bool setInteractionModes(int n_joints, int *joints, yarp::dev::InteractionModeEnum* modes) override
     {
-        Bottle cmd, response;
+        Bottle cmd;
         if (!isLive()) return false;
 
         cmd.addVocab(VOCAB_SET);
@@ -2999,13 +3074,12 @@ public:
         {
             l2.addVocab(modes[i]);
         }
-        bool ok = rpc_p.write(cmd, response);
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
     bool setInteractionModes(yarp::dev::InteractionModeEnum* modes) override
     {
-        Bottle cmd, response;
+        Bottle cmd;
         if (!isLive()) return false;
 
         cmd.addVocab(VOCAB_SET);
@@ -3016,8 +3090,7 @@ public:
         for (int i = 0; i < nj; i++)
             l1.addVocab(modes[i]);
 
-        bool ok = rpc_p.write(cmd, response);
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
     bool checkProtocolVersion(bool ignore)
@@ -3085,7 +3158,7 @@ public:
         cmd.addVocab(VOCAB_GET);
         cmd.addVocab(VOCAB_REMOTE_CALIBRATOR_INTERFACE);
         cmd.addVocab(VOCAB_IS_CALIBRATOR_PRESENT);
-        bool ok = rpc_p.write(cmd, response);
+        bool ok = rpcWrite(cmd, response);
         if(ok)
         {
             *isCalib = response.get(2).asInt()!=0;
@@ -3113,12 +3186,11 @@ public:
      */
     bool calibrateWholePart() override
     {
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(VOCAB_SET);
         cmd.addVocab(VOCAB_REMOTE_CALIBRATOR_INTERFACE);
         cmd.addVocab(VOCAB_CALIBRATE_WHOLE_PART);
-        bool ok = rpc_p.write(cmd, response);
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
     /**
@@ -3141,7 +3213,7 @@ public:
         cmd.addVocab(VOCAB_SET);
         cmd.addVocab(VOCAB_REMOTE_CALIBRATOR_INTERFACE);
         cmd.addVocab(VOCAB_HOMING_WHOLE_PART);
-        bool ok = rpc_p.write(cmd, response);
+        bool ok = rpcWrite(cmd, response);
         yDebug() << "Sent homing whole part message";
         return CHECK_FAIL(ok, response);
     }
@@ -3161,12 +3233,11 @@ public:
      */
     bool parkWholePart() override
     {
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(VOCAB_SET);
         cmd.addVocab(VOCAB_REMOTE_CALIBRATOR_INTERFACE);
         cmd.addVocab(VOCAB_PARK_WHOLE_PART);
-        bool ok = rpc_p.write(cmd, response);
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
     /**
@@ -3175,12 +3246,11 @@ public:
      */
     bool quitCalibrate() override
     {
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(VOCAB_SET);
         cmd.addVocab(VOCAB_REMOTE_CALIBRATOR_INTERFACE);
         cmd.addVocab(VOCAB_QUIT_CALIBRATE);
-        bool ok = rpc_p.write(cmd, response);
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
     /**
@@ -3189,12 +3259,11 @@ public:
      */
     bool quitPark() override
     {
-        Bottle cmd, response;
+        Bottle cmd;
         cmd.addVocab(VOCAB_SET);
         cmd.addVocab(VOCAB_REMOTE_CALIBRATOR_INTERFACE);
         cmd.addVocab(VOCAB_QUIT_PARK);
-        bool ok = rpc_p.write(cmd, response);
-        return CHECK_FAIL(ok, response);
+        return rpcSet(cmd);
     }
 
 //    virtual bool getAxes(int *ax)
@@ -3220,7 +3289,7 @@ public:
         c.head.addVocab(VOCAB_CURRENT_REFS);
         c.body.resize(nj);
         memcpy(&(c.body[0]), refs, sizeof(double)*nj);
-        command_buffer.write(writeStrict_moreJoints);
+        writeStreaming(writeStrict_moreJoints);
         return true;
     }
 
@@ -3234,7 +3303,7 @@ public:
         c.head.addInt(j);
         c.body.resize(1);
         memcpy(&(c.body[0]), &ref, sizeof(double));
-        command_buffer.write(writeStrict_singleJoint);
+        writeStreaming(writeStrict_singleJoint);
         return true;
     }
 
@@ -3251,7 +3320,7 @@ public:
             jointList.addInt(joints[i]);
         c.body.resize(n_joint);
         memcpy(&(c.body[0]), refs, sizeof(double)*n_joint);
-        command_buffer.write(writeStrict_moreJoints);
+        writeStreaming(writeStrict_moreJoints);
         return true;
     }
 
@@ -3288,7 +3357,7 @@ public:
         c.body.clear();
         c.body.resize(1);
         c.body[0] = v;
-        command_buffer.write(writeStrict_singleJoint);
+        writeStreaming(writeStrict_singleJoint);
         return true;
     }
 
@@ -3305,7 +3374,7 @@ public:
 
         memcpy(&(c.body[0]), v, sizeof(double)*nj);
 
-        command_buffer.write(writeStrict_moreJoints);
+        writeStreaming(writeStrict_moreJoints);
 
         return true;
     }
@@ -3319,7 +3388,7 @@ public:
         cmd.addInt(j);
         response.clear();
 
-        bool ok = rpc_p.write(cmd, response);
+        bool ok = rpcWrite(cmd, response);
 
         if (CHECK_FAIL(ok, response))
         {
@@ -3356,6 +3425,101 @@ public:
         return ret;
     }
 
+    /* IStreamingFrame */
+
+    virtual bool sendStreamingFrame(const StreamingFrame& frame) override
+    {
+        if (!isLive()) return false;
+        if (frame.size() == 0) return true;
+
+        // wrappers older than protocol 1.10 do not understand frames
+        // (possible only with ignoreProtocolCheck)
+        if (protocolVersion.major == 1 && protocolVersion.minor < 10)
+        {
+            bool ret = true;
+            for (int i = 0; i < frame.size(); i++)
+            {
+                int n = frame.getJointCount(i);
+                const int* joints = frame.getJoints(i);
+                const double* refs = frame.getRefs(i);
+                bool ok = false;
+                switch (frame.getVocab(i))
+                {
+                case VOCAB_POSITION_MOVE_GROUP:
+                    ok = positionMove(n, joints, refs);
+                    break;
+                case VOCAB_POSITION_DIRECT_GROUP:
+                    ok = setPositions(n, joints, const_cast<double*>(refs));
+                    break;
+                case VOCAB_VELOCITY_MOVE_GROUP:
+                    ok = velocityMove(n, joints, refs);
+                    break;
+                case VOCAB_TORQUES_DIRECT_GROUP:
+                    ok = setRefTorques(n, joints, refs);
+                    break;
+                case VOCAB_CURRENT_REF_GROUP:
+                    ok = setRefCurrents(n, joints, refs);
+                    break;
+                case VOCAB_PWMCONTROL_REF_PWM:
+                    ok = true;
+                    for (int j = 0; ok && j < n; j++)
+                        ok = setRefDutyCycle(joints[j], refs[j]);
+                    break;
+                }
+                ret = ret && ok;
+            }
+            return ret;
+        }
+
+        StreamingFrame& f = frame_buffer.get();
+        f = frame;
+        flushBatch();
+        frame_buffer.write(writeStrict_moreJoints);
+        return true;
+    }
+
+    /* IRpcBatch */
+
+    virtual bool beginBatch() override
+    {
+        // wrappers older than protocol 1.10 do not understand batches
+        // (possible only with ignoreProtocolCheck)
+        if (protocolVersion.major == 1 && protocolVersion.minor < 10)
+            return false;
+
+        LockGuard guard(batchMutex);
+        if (!batching)
+        {
+            batching = true;
+            batchOk = true;
+            batch.clear();
+            batch.addVocab(VOCAB_RPC_BATCH);
+        }
+        return true;
+    }
+
+    virtual bool endBatch() override
+    {
+        Bottle msg;
+        bool ok;
+        {
+            LockGuard guard(batchMutex);
+            if (!batching)
+                return true;
+            batching = false;
+            msg = batch;
+            batch.clear();
+            ok = batchOk;
+        }
+
+        if (msg.size() > 1)
+        {
+            Bottle replies;
+            ok = sendBatch(msg, replies, msg.size() - 1) && ok;
+        }
+        return ok;
+    }
+
 #ifndef YARP_NO_DEPRECATED // since YARP 2.3.70
 #if !defined(_MSC_VER)
 YARP_WARNING_PUSH
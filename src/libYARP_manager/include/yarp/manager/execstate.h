@@ -101,7 +101,7 @@ private:
     bool bAborted;
     bool checkPriorityPorts(void);
     bool checkResources(bool silent=true);
-    bool timeout(double base, double timeout);
+    bool timeout(double base, double timeout, double& delay);
 };
 
 
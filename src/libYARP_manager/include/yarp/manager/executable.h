@@ -10,6 +10,7 @@
 #ifndef YARP_MANAGER_Executable
 #define YARP_MANAGER_Executable
 
+#include <atomic>
 #include <string>
 #include <vector>
 
@@ -129,6 +130,20 @@ public:
     bool startWatchDog();
     void stopWatchDog();
 
+    /**
+     * Sets the semaphore posted when the launch of the module is over,
+     * that is when the module is started and the output ports it declares
+     * are registered, or when it failed to start. The ports are waited
+     * for at most readyTimeout seconds.
+     */
+    void setLaunchSignal(yarp::os::Semaphore* sem, double readyTimeout);
+    bool launched(void) { return launchState != LAUNCH_PENDING; }
+    bool launchFailed(void) { return launchState == LAUNCH_FAILED; }
+    /* seconds from start() to the start of the module, and to the
+       registration of its ports */
+    double getLaunchTime(void) { return launchTime; }
+    double getReadyTime(void) { return readyTime; }
+
 public: // from BrokerEventSink
     void onBrokerStdout(const char* msg) override;
 
@@ -160,7 +175,15 @@ private:
     ConcurentRateWrapper* watchdogWrapper;
     yarp::os::Semaphore semInitialize;
 
+    enum { LAUNCH_PENDING, LAUNCH_OK, LAUNCH_FAILED };
+    yarp::os::Semaphore* semLaunch;
+    double readyTimeout;
+    double launchTime;
+    double readyTime;
+    std::atomic<int> launchState;
+
     void startImplement(void);
+    bool waitReady(void);
     void stopImplement(void);
     void killImplement(void);
     void watchdogImplement(void);
@@ -135,13 +135,15 @@ private:
     CnnContainer connections;
     ModulePContainer modules;
     ResourcePContainer resources;
+    yarp::os::Semaphore semLaunch;
 
     bool createKnowledgeBase(AppLoader &appLoader);
     void clearExecutables(void);
     bool isServer(Module* module);
     bool connectExtraPorts(void);
-    bool checkPortsAvailable(Broker* broker);
+    bool connectAll(double retryTime);
     bool allRunning(void);
+    void getLaunchDependencies(std::vector<std::vector<size_t> >& deps);
     bool oneRunning(void);
     bool allStopped(void);
     bool prepare(bool silent=true);
@@ -50,6 +50,12 @@ public:
      bool kill() override;
      bool connect(const char* from, const char* to,
                         const char* carrier, bool persist=false) override;
+     /**
+      * Same as connect(), for ports already known to be registered (e.g.
+      * from the list of getAllPorts()): it does not check that they exist.
+      */
+     bool connectResolved(const char* from, const char* to,
+                        const char* carrier, bool persist=false);
      bool disconnect(const char* from, const char* to, const char* carrier) override;
      bool rmconnect(const char* from, const char* to);
      int running(void) override;
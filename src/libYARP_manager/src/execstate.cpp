@@ -18,6 +18,20 @@ using namespace FSM;
 using namespace yarp::manager;
 
 
+/**
+ * The ports and the resources are checked again after a short delay at
+ * first, and then less and less often, up to once a second.
+ */
+#define POLL_DELAY_MIN      0.05
+#define POLL_DELAY_MAX      1.0
+
+static void pollDelay(double& delay)
+{
+    yarp::os::SystemClock::delaySystem(delay);
+    delay = (delay*2 < POLL_DELAY_MAX) ? delay*2 : POLL_DELAY_MAX;
+}
+
+
 /**
  * Initializing event factory
  */
@@ -166,9 +180,9 @@ bool Ready::checkResources(bool silent)
     return allOK;
 }
 
-bool Ready::timeout(double base, double timeout)
+bool Ready::timeout(double base, double timeout, double& delay)
 {
-    yarp::os::SystemClock::delaySystem(1.0);
+    pollDelay(delay);
     if((yarp::os::SystemClock::nowSystem()-base) > timeout)
         return true;
     return false;
@@ -183,9 +197,10 @@ void Ready::startModule()
     if(executable->autoConnect())
     {
         bAborted = false;
+        double delay = POLL_DELAY_MIN;
         while(!checkPriorityPorts())
         {
-            yarp::os::SystemClock::delaySystem(1.0);
+            pollDelay(delay);
             if(bAborted) return;
         }
     }
@@ -202,10 +217,11 @@ void Ready::startModule()
 
     // waiting for resources
     double base = yarp::os::SystemClock::nowSystem();
+    double delay = POLL_DELAY_MIN;
     while(!checkResources()) {
         if(bAborted) return;
 
-        if(timeout(base, maxTimeout)) {
+        if(timeout(base, maxTimeout, delay)) {
             // give it the last try and collect the error messages
             if(!checkResources(false)) {
                 OSTRINGSTREAM msg;
@@ -289,9 +305,10 @@ void Connecting::connectAllPorts()
          *  wait for required ports if auto connecte is enabled
          */
         bAborted = false;
+        double delay = POLL_DELAY_MIN;
         while(!checkNormalPorts())
         {
-            yarp::os::SystemClock::delaySystem(1.0);
+            pollDelay(delay);
             if(bAborted) return;
         }
 
@@ -9,6 +9,7 @@
 
 #include <yarp/manager/executable.h>
 #include <yarp/manager/yarpbroker.h>
+#include <yarp/os/Time.h>
 
 using namespace yarp::manager;
 
@@ -31,6 +32,11 @@ Executable::Executable(Broker* _broker, MEvent* _event, Module *module,
     stopWrapper = new ConcurentWrapper(this, &Executable::stopImplement);
     killWrapper = new ConcurentWrapper(this, &Executable::killImplement);
     theID = -1;
+    semLaunch = nullptr;
+    readyTimeout = 0.0;
+    launchTime = 0.0;
+    readyTime = 0.0;
+    launchState = LAUNCH_PENDING;
 
     if(bWatchDog)
         watchdogWrapper = new ConcurentRateWrapper(this, &Executable::watchdogImplement);
@@ -79,8 +85,12 @@ bool Executable::initialize()
 
 bool Executable::start()
 {
+    launchState = LAUNCH_PENDING;
     if(!initialize()) {
       event->onExecutableDied(this);
+      launchState = LAUNCH_FAILED;
+      if(semLaunch)
+          semLaunch->post();
       return false;
     }
 
@@ -88,18 +98,68 @@ bool Executable::start()
         startWrapper->start();
         return true;
     }
+    launchState = LAUNCH_FAILED;
+    if(semLaunch)
+        semLaunch->post();
     return false;
 }
 
 
 void Executable::startImplement()
 {
+    double base = yarp::os::SystemClock::nowSystem();
     execMachine->start();
     execMachine->startModule();
+    launchTime = yarp::os::SystemClock::nowSystem() - base;
+    // startModule() moves to CONNECTING only if the module was started
+    bool ok = compareString(execMachine->currentState()->getName(), "CONNECTING");
+    if(ok && semLaunch)
+        waitReady();
+    readyTime = yarp::os::SystemClock::nowSystem() - base;
+    launchState = ok ? LAUNCH_OK : LAUNCH_FAILED;
+    if(semLaunch)
+        semLaunch->post();
     execMachine->connectAllPorts();
 }
 
 
+void Executable::setLaunchSignal(yarp::os::Semaphore* sem, double timeout)
+{
+    semLaunch = sem;
+    readyTimeout = timeout;
+}
+
+
+bool Executable::waitReady()
+{
+    if(!module)
+        return true;
+
+    // the name server does not notify the registrations, the ports are
+    // checked again after 50ms and then less and less often
+    double base = yarp::os::SystemClock::nowSystem();
+    double delay = 0.05;
+    for(int i=0; i<module->outputCount(); i++)
+    {
+        std::string port = std::string(module->getPrefix()) +
+                           module->getOutputAt(i).getPort();
+        while(!broker->exists(port.c_str()))
+        {
+            if(yarp::os::SystemClock::nowSystem() - base > readyTimeout)
+            {
+                OSTRINGSTREAM msg;
+                msg<<port<<" of "<<strCommand<<" is not registered yet.";
+                logger->addWarning(msg);
+                return false;
+            }
+            yarp::os::SystemClock::delaySystem(delay);
+            delay = (delay < 0.5) ? delay*2 : 1.0;
+        }
+    }
+    return true;
+}
+
+
 void Executable::stop()
 {
     if(!broker->initialized())
@@ -19,12 +19,20 @@
 #include <yarp/manager/singleapploader.h>
 #include <yarp/os/LogStream.h>
 
+#include <atomic>
+#include <map>
+#include <set>
+
 #include <yarp/os/impl/NameClient.h>
 
 
 #define RUN_TIMEOUT             10      // Run timeout in seconds
 #define STOP_TIMEOUT            30      // Stop timeout in seconds
 #define KILL_TIMEOUT            10      // kill timeout in seconds
+#define CONNECT_WORKERS         16      // connections established at the same time
+#define CONNECT_RETRY_TIME      5       // failed connections are retried for 5 seconds
+#define CONNECT_DELAY_MIN       0.1     // first delay between two attempts, in seconds
+#define CONNECT_DELAY_MAX       1.0     // the delay doubles up to once a second
 
 #define BROKER_LOCAL            "local"
 #define BROKER_YARPRUN          "yarprun"
@@ -35,11 +43,91 @@ using namespace yarp::manager;
 using namespace std;
 
 
+/**
+ * Class ConnectWorker: establishes the connections of a list, which is
+ * shared with the other workers.
+ */
+class ConnectWorker : public yarp::os::Thread
+{
+public:
+    ConnectWorker(CnnContainer& cnns, const std::set<std::string>& ports,
+                  bool resolved, std::atomic<size_t>& next,
+                  std::vector<std::string>& errors, double retryTime)
+        : cnns(cnns), ports(ports), resolved(resolved), next(next),
+          errors(errors), retryTime(retryTime) { }
+
+    void run() override {
+        size_t i;
+        while((i = next++) < cnns.size())
+            if(!establish(cnns[i], errors[i]) && errors[i].empty())
+                errors[i] = "unknown error";
+    }
+
+private:
+    CnnContainer& cnns;
+    const std::set<std::string>& ports;
+    bool resolved;
+    std::atomic<size_t>& next;
+    std::vector<std::string>& errors;
+    double retryTime;
+    YarpBroker broker;
+
+    bool establish(Connection& cnn, std::string& error) {
+        double base = yarp::os::SystemClock::nowSystem();
+        double delay = CONNECT_DELAY_MIN;
+        bool first = true;
+        while(true)
+        {
+            // the first attempt relies on the list of the name server, the
+            // next ones check again that the ports exist
+            bool ok;
+            if(first && resolved && !cnn.isPersistent() && !ports.count(cnn.from()))
+            {
+                error = string(cnn.from()) + " does not exist.";
+                ok = false;
+            }
+            else if(first && resolved && !cnn.isPersistent() && !ports.count(cnn.to()))
+            {
+                error = string(cnn.to()) + " does not exist.";
+                ok = false;
+            }
+            else
+            {
+                if(first && resolved)
+                    ok = broker.connectResolved(cnn.from(), cnn.to(),
+                                                cnn.carrier(), cnn.isPersistent());
+                else
+                    ok = broker.connect(cnn.from(), cnn.to(),
+                                        cnn.carrier(), cnn.isPersistent());
+                error = ok ? "" : broker.error();
+
+                // setting the connection Qos if specified
+                if(ok && !broker.setQos(cnn.from(), cnn.to(), cnn.qosFrom(), cnn.qosTo()))
+                {
+                    error = strlen(broker.error()) ? broker.error() : "cannot set the Qos.";
+                    ok = false;
+                }
+            }
+
+            if(ok)
+                return true;
+            // the last attempt is made when the retry time is over
+            double left = retryTime - (yarp::os::SystemClock::nowSystem() - base);
+            if(left <= 0)
+                return false;
+            yarp::os::SystemClock::delaySystem((delay < left) ? delay : left);
+            delay = (delay*2 < CONNECT_DELAY_MAX) ? delay*2 : CONNECT_DELAY_MAX;
+            first = false;
+        }
+    }
+};
+
+
 /**
  * Class Manager
  */
 
-Manager::Manager(bool withWatchDog) : MEvent()
+Manager::Manager(bool withWatchDog) : MEvent(), semLaunch(0)
 {
     logger  = ErrorLogger::Instance();
     bWithWatchDog = withWatchDog;
@@ -52,7 +140,8 @@ Manager::Manager(bool withWatchDog) : MEvent()
 }
 
 Manager::Manager(const char* szModPath, const char* szAppPath,
-                 const char* szResPath, bool withWatchDog)
+                 const char* szResPath, bool withWatchDog) :
+        semLaunch(0)
 {
     logger  = ErrorLogger::Instance();
     bWithWatchDog = withWatchDog;
@@ -782,6 +871,48 @@ bool Manager::run(unsigned int id, bool async)
     return waitingModuleRun(id);
 }
 
+void Manager::getLaunchDependencies(std::vector<std::vector<size_t> >& deps)
+{
+    // the modules which own each port
+    std::map<std::string, size_t> owners;
+    for(size_t i=0; i<runnables.size(); i++)
+    {
+        Module* module = runnables[i]->getModule();
+        for(int j=0; j<module->outputCount(); j++)
+            owners[string(module->getPrefix()) + module->getOutputAt(j).getPort()] = i;
+        for(int j=0; j<module->inputCount(); j++)
+            owners[string(module->getPrefix()) + module->getInputAt(j).getPort()] = i;
+    }
+
+    /**
+     * A module depends on the modules which own its port resources, and
+     * on the modules whose ports are connected with priority to its own.
+     */
+    deps.assign(runnables.size(), std::vector<size_t>());
+    for(size_t i=0; i<runnables.size(); i++)
+    {
+        ResourceIterator res;
+        for(res=runnables[i]->getResources().begin();
+            res!=runnables[i]->getResources().end(); res++)
+        {
+            std::map<std::string, size_t>::iterator owner = owners.find((*res).getPort());
+            if(owner != owners.end() && owner->second != i)
+                deps[i].push_back(owner->second);
+        }
+    }
+
+    CnnIterator cnn;
+    for(cnn=connections.begin(); cnn!=connections.end(); cnn++)
+    {
+        if(!(*cnn).withPriority())
+            continue;
+        std::map<std::string, size_t>::iterator from = owners.find((*cnn).from());
+        std::map<std::string, size_t>::iterator to = owners.find((*cnn).to());
+        if(from != owners.end() && to != owners.end() && from->second != to->second)
+            deps[to->second].push_back(from->second);
+    }
+}
+
 bool Manager::run()
 {
     if(runnables.empty())
@@ -809,15 +940,88 @@ bool Manager::run()
             (*itr)->enableAutoConnect();
         else
             (*itr)->disableAutoConnect();
-        (*itr)->start();
-        yarp::os::SystemClock::delaySystem(0.2);
+        (*itr)->setLaunchSignal(&semLaunch, RUN_TIMEOUT);
         wait = (wait > (*itr)->getPostExecWait()) ? wait : (*itr)->getPostExecWait();
     }
 
-    // waiting for running
+    // forget the signals of the previous launches
+    while(semLaunch.check()) { }
+
+    /**
+     * The modules are started together, except the ones which need the
+     * ports of other modules: they are started as soon as those modules
+     * are launched and their ports are registered.
+     */
+    std::vector<std::vector<size_t> > deps;
+    getLaunchDependencies(deps);
+
+    size_t count = runnables.size();
+    std::vector<bool> started(count, false);
+    std::vector<bool> done(count, false);
+    size_t nStarted = 0;
+    size_t nDone = 0;
     double base = yarp::os::SystemClock::nowSystem();
-    while(!timeout(base, wait + RUN_TIMEOUT))
-        if(allRunning()) break;
+    std::vector<double> startTime(count, 0.0);
+    double deadline = base + wait + 2*RUN_TIMEOUT;
+    while(nDone < count)
+    {
+        for(size_t i=0; i<count; i++)
+        {
+            if(started[i])
+                continue;
+            bool ready = true;
+            for(size_t j=0; j<deps[i].size(); j++)
+                ready = ready && done[deps[i][j]];
+            if(!ready)
+                continue;
+            started[i] = true;
+            nStarted++;
+            startTime[i] = yarp::os::SystemClock::nowSystem() - base;
+            runnables[i]->start();
+        }
+
+        if(nStarted == nDone)
+        {
+            // circular dependencies: the rest is started all the same
+            logger->addWarning("Circular dependencies between the modules, they are started together.");
+            for(size_t i=0; i<count; i++)
+                deps[i].clear();
+            continue;
+        }
+
+        double timeLeft = deadline - yarp::os::SystemClock::nowSystem();
+        if(timeLeft <= 0 || !semLaunch.waitWithTimeout(timeLeft))
+        {
+            if(nStarted == count)
+                break;
+            // the modules which are late do not hold up the others
+            logger->addWarning("Some of the modules are late, the modules which depend on them are started all the same.");
+            for(size_t i=0; i<count; i++)
+                deps[i].clear();
+            deadline = yarp::os::SystemClock::nowSystem() + wait + 2*RUN_TIMEOUT;
+            continue;
+        }
+
+        for(size_t i=0; i<count; i++)
+        {
+            if(!started[i] || done[i] || !runnables[i]->launched())
+                continue;
+            done[i] = true;
+            nDone++;
+            deadline = yarp::os::SystemClock::nowSystem() + wait + 2*RUN_TIMEOUT;
+            if(runnables[i]->launchFailed())
+                yInfo("%s on %s: started at %.3fs, failed after %.3fs",
+                      runnables[i]->getCommand(), runnables[i]->getHost(),
+                      startTime[i], runnables[i]->getLaunchTime());
+            else
+                yInfo("%s on %s: started at %.3fs, launched in %.3fs, ready in %.3fs",
+                      runnables[i]->getCommand(), runnables[i]->getHost(),
+                      startTime[i], runnables[i]->getLaunchTime(),
+                      runnables[i]->getReadyTime());
+        }
+    }
+    yInfo("%d of %d modules launched in %.3fs", (int)nDone, (int)count,
+          yarp::os::SystemClock::nowSystem() - base);
 
     // starting the watchdog if needed
     if(bWithWatchDog) {
@@ -1019,25 +1223,60 @@ bool Manager::connect(unsigned int id)
 
 bool Manager::connect()
 {
-    //YarpBroker connector;
-    //connector.init();
-    CnnIterator cnn;
-    for(cnn=connections.begin(); cnn!=connections.end(); cnn++) {
-        if( !connector.connect((*cnn).from(), (*cnn).to(),
-                               (*cnn).carrier(), (*cnn).isPersistent()) )
-            {
-                logger->addError(connector.error());
-                //cout<<connector.error()<<endl;
-                if(bRestricted)
-                    return false;
-            }
+    if(!connectAll(CONNECT_RETRY_TIME))
+        if(bRestricted)
+            return false;
+    return true;
+}
 
-        // setting the connection Qos if specified
-        if(! connector.setQos((*cnn).from(), (*cnn).to(),
-                         (*cnn).qosFrom(), (*cnn).qosTo())) {
-            if(bRestricted)
-                return false;
-        }
+bool Manager::connectAll(double retryTime)
+{
+    if(connections.empty())
+        return true;
+
+    double base = yarp::os::SystemClock::nowSystem();
+
+    // a single query to the name server for all the ports
+    std::vector<std::string> list;
+    bool resolved = connector.getAllPorts(list);
+    std::set<std::string> ports(list.begin(), list.end());
+
+    std::atomic<size_t> next(0);
+    std::vector<std::string> errors(connections.size());
+    std::vector<ConnectWorker*> workers;
+    for(size_t i=0; i<CONNECT_WORKERS && i<connections.size(); i++)
+    {
+        ConnectWorker* worker = new ConnectWorker(connections, ports, resolved,
+                                                  next, errors, retryTime);
+        worker->start();
+        workers.push_back(worker);
+    }
+    for(size_t i=0; i<workers.size(); i++)
+    {
+        workers[i]->join();
+        delete workers[i];
+    }
+
+    int failed = 0;
+    OSTRINGSTREAM msg;
+    for(size_t i=0; i<connections.size(); i++)
+    {
+        if(errors[i].empty())
+            continue;
+        failed++;
+        msg<<endl<<"  "<<connections[i].from()<<" -> "<<connections[i].to();
+        msg<<" : "<<errors[i];
+    }
+    yInfo("%d of %d connections established in %.3fs",
+          (int)connections.size() - failed, (int)connections.size(),
+          yarp::os::SystemClock::nowSystem() - base);
+    if(failed)
+    {
+        OSTRINGSTREAM err;
+        err<<"Failed to establish "<<failed<<" of "<<connections.size();
+        err<<" connections:"<<msg.str();
+        logger->addError(err);
+        return false;
     }
     return true;
 }
@@ -1141,47 +1380,10 @@ bool Manager::connected()
     return bConnected;
 }
 
-bool Manager::checkPortsAvailable(Broker* broker)
-{
-    CnnIterator itr;
-    for(itr=connections.begin(); itr!=connections.end(); itr++)
-    {
-       //if(!(*itr).owner() )
-       // {
-            if(!broker->exists((*itr).to()) ||
-                !broker->exists((*itr).from()))
-                    return false;
-       // }
-    }
-    return true;
-}
-
-
 bool Manager::connectExtraPorts()
 {
-    //YarpBroker connector;
-    //connector.init();
-
-    double base = yarp::os::SystemClock::nowSystem();
-    while(!timeout(base, 10.0))
-        if(checkPortsAvailable(&connector))
-            break;
-
-    CnnIterator cnn;
-    for(cnn=connections.begin(); cnn!=connections.end(); cnn++)
-    {
-        //if(!(*cnn).owner() )
-        //{
-            if( !connector.connect((*cnn).from(), (*cnn).to(),
-                                   (*cnn).carrier()) )
-            {
-                logger->addError(connector.error());
-                //cout<<connector.error()<<endl;
-                return false;
-            }
-       //}
-    }
-    return true;
+    // the ports of the modules which are still starting are waited for
+    return connectAll(10.0);
 }
 
 bool Manager::running(unsigned int id)
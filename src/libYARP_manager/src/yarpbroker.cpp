@@ -396,11 +396,6 @@ bool YarpBroker::connect(const char* from, const char* to,
         return false;
     }
 
-    ContactStyle style;
-    style.quiet = true;
-    style.timeout = CONNECTION_TIMEOUT;
-    style.carrier = carrier;
-
     if(!persist)
     {
         if(!exists(from))
@@ -416,7 +411,27 @@ bool YarpBroker::connect(const char* from, const char* to,
             strError += " does not exist.";
             return false;
         }
+    }
 
+    return connectResolved(from, to, carrier, persist);
+}
+
+bool YarpBroker::connectResolved(const char* from, const char* to,
+            const char* carrier, bool persist)
+{
+    if(!from || !to)
+    {
+        strError = "no source or destination port is introduced.";
+        return false;
+    }
+
+    ContactStyle style;
+    style.quiet = true;
+    style.timeout = CONNECTION_TIMEOUT;
+    style.carrier = carrier;
+
+    if(!persist)
+    {
         /*
          * TODO: this check should be removed and
          *       the necessary modification should be done inside NetworkBase::isConnected!!!
@@ -126,6 +126,15 @@ public:
      */
     bool copy(const Image& alt, int w, int h);
 
+    /**
+     * Exchange the content of two images, without copying the pixels.
+     * Two ImageOf should have the same pixel type.
+     * If either image uses an external buffer (see setExternal()), the
+     * pixels are copied instead, so that the buffer is never handed over.
+     * @param alt the image to exchange the content with
+     */
+    void swap(Image& alt);
+
 
     /**
      * Gets width of image in pixels.
@@ -76,6 +76,8 @@
 #include <cassert>
 #include <cstdlib>
 
+#include <yarp/sig/api.h>
+
 #if defined _MSC_VER || defined __BORLANDC__
 typedef __int64 int64;
 typedef unsigned __int64 uint64;
@@ -226,7 +228,7 @@ int _iplCalcPadding (int lineSize, int align);
 /**
  * Definition for functions implemented within YARP_sig.
  */
-#define IPLAPIIMPL(type,name,arg) extern type name arg
+#define IPLAPIIMPL(type,name,arg) extern YARP_sig_API type name arg
 
 
 IPLAPIIMPL(IplConvKernel*,
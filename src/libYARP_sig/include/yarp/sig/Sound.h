@@ -11,6 +11,8 @@
 
 #include <yarp/sig/api.h>
 
+#include <vector>
+
 namespace yarp {
     namespace sig {
         class Sound;
@@ -21,9 +23,45 @@ namespace yarp {
  * \ingroup sig_class
  *
  * Class for storing sounds
+ *
+ * The samples are stored in a single contiguous buffer, little endian, as
+ * they are sent on the network. By default the buffer is planar (all the
+ * samples of the first channel, then the second channel), as getRawData()
+ * has always returned it; it can be interleaved instead (the channels of
+ * the first sample, then the channels of the second one, as sound cards
+ * and wav files have them), see setInterleaved().
+ *
+ * The samples are 16 bit integers by default, 24 and 32 bit integers and
+ * 32 bit floats are supported as well, see setSampleFormat().
+ * get() and set() access a single sample, the block methods (getBlock(),
+ * getChannel() and so on) copy whole blocks of samples from and to arrays
+ * of 16 bit integers or of floats, converting the format and the layout
+ * when needed.
+ *
+ * On the network a sound is a short header followed by the buffer as it
+ * is, read back directly in the buffer of the receiving sound. Sounds sent
+ * in the format of the older versions (an image and a bottle) are still
+ * read, but sounds are always written in the new format, which the older
+ * versions cannot read: senders and receivers of sounds must be updated
+ * together.
  */
 class YARP_sig_API yarp::sig::Sound : public yarp::os::Portable {
 public:
+    /**
+     * The formats of the samples.
+     */
+    enum SampleFormat {
+        FORMAT_INT16 = 0,   ///< 16 bit signed integers (the default)
+        FORMAT_INT24 = 1,   ///< 24 bit signed integers, packed in 3 bytes
+        FORMAT_INT32 = 2,   ///< 32 bit signed integers
+        FORMAT_FLOAT32 = 3  ///< 32 bit floats, between -1 and 1
+    };
+
+    /**
+     * Constructor.
+     * @param bytesPerSample 2, 3 or 4, for 16, 24 or 32 bit integer
+     * samples; use setSampleFormat() for float samples
+     */
     Sound(int bytesPerSample = 2);
 
     /**
@@ -37,7 +75,7 @@ public:
 
     /**
      * Assignment operator.
-     * Clones the content of another sound.
+     * Clones the content of another sound, with its format and layout.
      * @param alt the image to sound
      */
     const Sound& operator=(const Sound& alt);
@@ -56,9 +94,24 @@ public:
      */
     Sound subSound(int first_sample, int last_sample);
 
+    /**
+     * Set the number of samples and of channels.
+     * The memory is reused when the size of the buffer does not grow, the
+     * content is not preserved.
+     */
     void resize(int samples, int channels = 1);
 
+    /**
+     * Get a sample.
+     * @return the value of the sample, a signed 16, 24 or 32 bit integer;
+     * for float samples, the value scaled to 16 bit integers
+     */
     int get(int sample, int channel = 0) const;
+
+    /**
+     * Set a sample.
+     * @param value the value, see get()
+     */
     void set(int value, int sample, int channel = 0);
 
     int getSafe(int sample, int channel = 0) {
@@ -99,23 +152,118 @@ public:
 
     int getChannels() const { return channels; }
 
+    /**
+     * Change the format of the samples, converting the samples already in
+     * the sound.
+     */
+    void setSampleFormat(SampleFormat format);
+
+    SampleFormat getSampleFormat() const { return format; }
+
+    /**
+     * Choose between the interleaved and the planar layout of the buffer,
+     * rearranging the samples already in the sound.
+     */
+    void setInterleaved(bool interleaved);
+
+    bool isInterleaved() const { return interleaved; }
+
+    /**
+     * Copy a block of samples of all the channels to an interleaved array
+     * of 16 bit integers.
+     * @param dest the array, of count*getChannels() elements
+     * @param first the first sample to copy
+     * @param count the number of samples to copy
+     * @return false if the samples are not in the sound
+     */
+    bool getBlock(short* dest, int first, int count) const;
+
+    /**
+     * Copy a block of samples of all the channels to an interleaved array
+     * of floats, between -1 and 1.
+     * @see getBlock(short*, int, int) const
+     */
+    bool getBlock(float* dest, int first, int count) const;
+
+    /**
+     * Copy an interleaved array of 16 bit integers to a block of samples
+     * of all the channels.
+     * @param src the array, of count*getChannels() elements
+     * @param first the first sample to set
+     * @param count the number of samples to set
+     * @return false if the samples are not in the sound
+     */
+    bool setBlock(const short* src, int first, int count);
+
+    /**
+     * Copy an interleaved array of floats, between -1 and 1, to a block of
+     * samples of all the channels.
+     * @see setBlock(const short*, int, int)
+     */
+    bool setBlock(const float* src, int first, int count);
+
+    /**
+     * Copy a block of samples of a channel to an array of 16 bit integers.
+     * @param channel the channel
+     * @param dest the array, of count elements
+     * @param first the first sample to copy
+     * @param count the number of samples to copy
+     * @return false if the samples are not in the sound
+     */
+    bool getChannel(int channel, short* dest, int first, int count) const;
+
+    /**
+     * Copy a block of samples of a channel to an array of floats.
+     * @see getChannel(int, short*, int, int) const
+     */
+    bool getChannel(int channel, float* dest, int first, int count) const;
+
+    /**
+     * Copy an array of 16 bit integers to a block of samples of a channel.
+     * @see getChannel(int, short*, int, int) const
+     */
+    bool setChannel(int channel, const short* src, int first, int count);
+
+    /**
+     * Copy an array of floats to a block of samples of a channel.
+     * @see getChannel(int, short*, int, int) const
+     */
+    bool setChannel(int channel, const float* src, int first, int count);
+
     virtual bool read(yarp::os::ConnectionReader& connection) override;
 
     virtual bool write(yarp::os::ConnectionWriter& connection) override;
 
+    /**
+     * @return the buffer of the samples, in the layout and in the format
+     * of the sound
+     */
     unsigned char *getRawData() const;
 
     int getRawDataSize() const;
 
 private:
     void init(int bytesPerSample);
-    void synchronize();
+    bool readLegacy(yarp::os::ConnectionReader& connection);
+
+    // offset of a sample in the buffer, in samples
+    size_t offset(int sample, int channel) const {
+        return interleaved ? (size_t)sample*channels + channel
+                           : (size_t)channel*samples + sample;
+    }
+
+    // distance between two samples of a channel, in samples
+    size_t stride() const {
+        return interleaved ? (size_t)channels : 1;
+    }
 
-    void *implementation;
+    std::vector<unsigned char> buffer;
     int samples;
     int channels;
     int bytesPerSample;
     int frequency;
+    SampleFormat format;
+    bool interleaved;
 };
 
 #endif // YARP_SIG_SOUND_H
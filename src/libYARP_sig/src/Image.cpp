@@ -25,6 +25,7 @@
 
 #include <cstdio>
 #include <cstring>
+#include <utility>
 
 using namespace yarp::sig;
 using namespace yarp::os;
@@ -74,7 +75,7 @@ public:
     bool topIsLow;
 
 protected:
-    Image& owner;
+    Image* owner;
 
     int type_id;
 
@@ -110,7 +111,15 @@ protected:
     }
 
 public:
-    ImageStorage(Image& owner) : owner(owner) {
+    void setOwner(Image& owner) {
+        this->owner = &owner;
+    }
+
+    bool isOwner() const {
+        return is_owner!=0;
+    }
+
+    ImageStorage(Image& owner) : owner(&owner) {
         type_id = 0;
         pImage = nullptr;
         Data = nullptr;
@@ -842,6 +851,50 @@ bool Image::copy(const Image& alt) {
 }
 
 
+void Image::swap(Image& alt) {
+    if (&alt==this) {
+        return;
+    }
+    if (!((ImageStorage*)implementation)->isOwner() ||
+        !((ImageStorage*)alt.implementation)->isOwner()) {
+        // an external buffer stays with the image it was given to, so the
+        // pixels are copied in place when the geometry already matches
+        auto copyContent = [](Image& dest, const Image& src) {
+            if (dest.width()!=src.width() || dest.height()!=src.height() ||
+                dest.getPixelCode()!=src.getPixelCode()) {
+                dest.copy(src);
+                return;
+            }
+            int q1 = src.getQuantum();
+            int q2 = dest.getQuantum();
+            if (q1==0) { q1 = YARP_IMAGE_ALIGN; }
+            if (q2==0) { q2 = YARP_IMAGE_ALIGN; }
+            dest.copyPixels(src.getRawImage(),src.getPixelCode(),
+                            dest.getRawImage(),dest.getPixelCode(),
+                            dest.width(),dest.height(),
+                            dest.getRawImageSize(),q1,q2,
+                            src.topIsLowIndex(),dest.topIsLowIndex());
+        };
+        Image tmp;
+        tmp.copy(*this);
+        copyContent(*this, alt);
+        copyContent(alt, tmp);
+        return;
+    }
+    std::swap(imgWidth, alt.imgWidth);
+    std::swap(imgHeight, alt.imgHeight);
+    std::swap(imgPixelSize, alt.imgPixelSize);
+    std::swap(imgRowSize, alt.imgRowSize);
+    std::swap(imgPixelCode, alt.imgPixelCode);
+    std::swap(imgQuantum, alt.imgQuantum);
+    std::swap(topIsLow, alt.topIsLow);
+    std::swap(data, alt.data);
+    std::swap(implementation, alt.implementation);
+    ((ImageStorage*)implementation)->setOwner(*this);
+    ((ImageStorage*)alt.implementation)->setOwner(alt);
+}
+
+
 void Image::setExternal(const void *data, int imgWidth, int imgHeight) {
     if (imgQuantum==0) {
         imgQuantum = 1;
@@ -5,12 +5,22 @@
  */
 
 
+#include <algorithm>
+#include <climits>
 #include <cstdio>
 #include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include <yarp/os/Log.h>
+#include <yarp/os/Network.h>
 #include <yarp/sig/IplImage.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 static int implemented_yet = 1;
 
 // this was from iplUtil.cpp
@@ -53,6 +63,285 @@ void FreeAligned (T* ptr)
     delete[] reinterpret_cast<T*>(((char *)ptr) - addbytes);
 }
 
+///
+/// Row-band multithreading and SIMD row kernels of the convolutions and
+/// of the pixel arithmetic.
+///
+/// Each output pixel is computed with the same operations, in the same
+/// order, as the original per-pixel loops, so the results are identical
+/// (the integer sums do not depend on the order anyway). The rows of an
+/// image are split in bands, one for each thread, when the image is large
+/// enough to pay for the threads. YARP_IPL_THREADS limits the number of
+/// threads (1 processes everything in the calling thread).
+///
+
+// Minimum amount of work (pixels times kernel size) of a band
+const long IPL_MIN_BAND_WORK = 1L << 18;
+
+static int iplBandCount(int units, long unitWork)
+{
+    int threads = (int)std::thread::hardware_concurrency();
+    std::string env = yarp::os::NetworkBase::getEnvironment("YARP_IPL_THREADS");
+    if (!env.empty())
+    {
+        threads = atoi(env.c_str());
+    }
+    const long bands = (long)units * unitWork / IPL_MIN_BAND_WORK;
+    threads = (int)std::min((long)threads, bands);
+    threads = std::min(threads, units);
+    return (threads > 1) ? threads : 1;
+}
+
+// Calls body(b, e) on bands of [begin, end), in parallel, and waits for
+// all of them. unitWork estimates the cost of a row (or of a pixel).
+template <class F>
+static void iplForEachBand(int begin, int end, long unitWork, const F& body)
+{
+    const int units = end - begin;
+    if (units <= 0)
+        return;
+
+    const int bands = iplBandCount(units, unitWork);
+    if (bands == 1)
+    {
+        body(begin, end);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    workers.reserve(bands - 1);
+    for (int t = 1; t < bands; t++)
+    {
+        const int b = begin + (int)((long long)units * t / bands);
+        const int e = begin + (int)((long long)units * (t + 1) / bands);
+        workers.emplace_back([&body, b, e]() { body(b, e); });
+    }
+    body(begin, begin + units / bands);
+    for (auto& worker : workers)
+        worker.join();
+}
+
+// acc[j] += src[j] * v
+static void iplAccumulateRow(int* acc, const char* src, int n, int v)
+{
+    int j = 0;
+#if defined(__SSE2__) && (CHAR_MIN < 0)
+    if (v >= SHRT_MIN && v <= SHRT_MAX)
+    {
+        const __m128i vv = _mm_set1_epi16((short)v);
+        const __m128i zero = _mm_setzero_si128();
+        for (; j + 16 <= n; j += 16)
+        {
+            const __m128i s = _mm_loadu_si128((const __m128i*)(src + j));
+            const __m128i sign = _mm_cmpgt_epi8(zero, s);
+            const __m128i s0 = _mm_unpacklo_epi8(s, sign);
+            const __m128i s1 = _mm_unpackhi_epi8(s, sign);
+            // 32 bits products, from their low and high halves
+            const __m128i lo0 = _mm_mullo_epi16(s0, vv);
+            const __m128i hi0 = _mm_mulhi_epi16(s0, vv);
+            const __m128i lo1 = _mm_mullo_epi16(s1, vv);
+            const __m128i hi1 = _mm_mulhi_epi16(s1, vv);
+            __m128i* a = (__m128i*)(acc + j);
+            _mm_storeu_si128(a, _mm_add_epi32(_mm_loadu_si128(a), _mm_unpacklo_epi16(lo0, hi0)));
+            _mm_storeu_si128(a + 1, _mm_add_epi32(_mm_loadu_si128(a + 1), _mm_unpackhi_epi16(lo0, hi0)));
+            _mm_storeu_si128(a + 2, _mm_add_epi32(_mm_loadu_si128(a + 2), _mm_unpacklo_epi16(lo1, hi1)));
+            _mm_storeu_si128(a + 3, _mm_add_epi32(_mm_loadu_si128(a + 3), _mm_unpackhi_epi16(lo1, hi1)));
+        }
+    }
+#endif
+    for (; j < n; j++)
+        acc[j] += src[j] * v;
+}
+
+// acc[j] += src[j] * v
+static void iplAccumulateRow(float* acc, const float* src, int n, float v)
+{
+    int j = 0;
+#if defined(__SSE2__)
+    const __m128 vv = _mm_set1_ps(v);
+    for (; j + 4 <= n; j += 4)
+    {
+        const __m128 p = _mm_mul_ps(_mm_loadu_ps(src + j), vv);
+        _mm_storeu_ps(acc + j, _mm_add_ps(_mm_loadu_ps(acc + j), p));
+    }
+#endif
+    for (; j < n; j++)
+        acc[j] += src[j] * v;
+}
+
+// dst[j] = acc[j] >> shift, clipped to 8 bits, signed or unsigned
+static void iplStoreRow(char* dst, const int* acc, int n, int shift, bool isSigned)
+{
+    int j = 0;
+#if defined(__SSE2__)
+    const __m128i count = _mm_cvtsi32_si128(shift);
+    for (; j + 16 <= n; j += 16)
+    {
+        const __m128i* a = (const __m128i*)(acc + j);
+        // the saturations of the packs are the clipping
+        const __m128i p0 = _mm_packs_epi32(_mm_sra_epi32(_mm_loadu_si128(a), count),
+                                           _mm_sra_epi32(_mm_loadu_si128(a + 1), count));
+        const __m128i p1 = _mm_packs_epi32(_mm_sra_epi32(_mm_loadu_si128(a + 2), count),
+                                           _mm_sra_epi32(_mm_loadu_si128(a + 3), count));
+        _mm_storeu_si128((__m128i*)(dst + j), isSigned ? _mm_packs_epi16(p0, p1) : _mm_packus_epi16(p0, p1));
+    }
+#endif
+    const int low = isSigned ? -128 : 0;
+    const int high = isSigned ? 127 : 255;
+    for (; j < n; j++)
+    {
+        int tmp = acc[j] >> shift;
+        if (tmp > high)
+            tmp = high;
+        else
+            if (tmp < low)
+                tmp = low;
+        dst[j] = char(tmp);
+    }
+}
+
+// Integer convolution of the rows [begin, end) of a mono image with a
+// kernel of krows x kcols, applied reversed. Only the columns
+// [borderx, w - borderx) are written.
+static void iplConvolveRows(const char* src, char* dst, int w, int borderx, int begin, int end,
+                            const int* values, int krows, int kcols, int shift, bool isSigned)
+{
+    const int bordery = krows / 2;
+    const int ksize = krows * kcols;
+    const int n = w - 2 * borderx;
+    if (n <= 0)
+        return;
+
+    std::vector<int> acc(n);
+    for (int i = begin; i < end; i++)
+    {
+        std::fill(acc.begin(), acc.end(), 0);
+        for (int k = 0; k < krows; k++)
+            for (int l = 0; l < kcols; l++)
+            {
+                const int v = values[ksize - k * kcols - l - 1];
+                // adding 0 does not change the sum
+                if (v != 0)
+                    iplAccumulateRow(acc.data(), src + (i + k - bordery) * w + borderx + l - kcols / 2, n, v);
+            }
+        iplStoreRow(dst + i * w + borderx, acc.data(), n, shift, isSigned);
+    }
+}
+
+// Same as iplConvolveRows, for float images
+static void iplConvolveRows(const float* src, float* dst, int w, int borderx, int begin, int end,
+                            const float* values, int krows, int kcols)
+{
+    const int bordery = krows / 2;
+    const int ksize = krows * kcols;
+    const int n = w - 2 * borderx;
+    if (n <= 0)
+        return;
+
+    for (int i = begin; i < end; i++)
+    {
+        float* out = dst + i * w + borderx;
+        std::fill(out, out + n, 0.0f);
+        for (int k = 0; k < krows; k++)
+            for (int l = 0; l < kcols; l++)
+                iplAccumulateRow(out, src + (i + k - bordery) * w + borderx + l - kcols / 2, n,
+                                 values[ksize - k * kcols - l - 1]);
+    }
+}
+
+// dst = a + b or a - b, clipped to [0, 255]
+template <bool subtract>
+static void iplAddRow(unsigned char* dst, const unsigned char* a, const unsigned char* b, int n)
+{
+    int i = 0;
+#if defined(__SSE2__)
+    for (; i + 16 <= n; i += 16)
+    {
+        const __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        const __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        _mm_storeu_si128((__m128i*)(dst + i), subtract ? _mm_subs_epu8(va, vb) : _mm_adds_epu8(va, vb));
+    }
+#endif
+    for (; i < n; i++)
+    {
+        short tmp = subtract ? a[i] - b[i] : a[i] + b[i];
+        if (tmp < 0)
+            tmp = 0;
+        else
+            if (tmp > 255)
+                tmp = 255;
+        dst[i] = char(tmp);
+    }
+}
+
+// dst = a + b or a - b, clipped to [-128, 127]
+template <bool subtract>
+static void iplAddRow(char* dst, const char* a, const char* b, int n)
+{
+    int i = 0;
+#if defined(__SSE2__) && (CHAR_MIN < 0)
+    for (; i + 16 <= n; i += 16)
+    {
+        const __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        const __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        _mm_storeu_si128((__m128i*)(dst + i), subtract ? _mm_subs_epi8(va, vb) : _mm_adds_epi8(va, vb));
+    }
+#endif
+    for (; i < n; i++)
+    {
+        short tmp = subtract ? a[i] - b[i] : a[i] + b[i];
+        if (tmp < -128)
+            tmp = -128;
+        else
+            if (tmp > 127)
+                tmp = 127;
+        dst[i] = char(tmp);
+    }
+}
+
+// dst = a + b or a - b
+template <bool subtract>
+static void iplAddRow(float* dst, const float* a, const float* b, int n)
+{
+    int i = 0;
+#if defined(__SSE2__)
+    for (; i + 4 <= n; i += 4)
+    {
+        const __m128 va = _mm_loadu_ps(a + i);
+        const __m128 vb = _mm_loadu_ps(b + i);
+        _mm_storeu_ps(dst + i, subtract ? _mm_sub_ps(va, vb) : _mm_add_ps(va, vb));
+    }
+#endif
+    for (; i < n; i++)
+        dst[i] = subtract ? a[i] - b[i] : a[i] + b[i];
+}
+
+// dst = src * value
+static void iplMultiplyRow(float* dst, const float* src, float value, int n)
+{
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128 vv = _mm_set1_ps(value);
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(src + i), vv));
+#endif
+    for (; i < n; i++)
+        dst[i] = src[i] * value;
+}
+
+// dst = table[src], the 8 bits pixels are mapped through a table of 256
+// values, computed once with the operation on each possible pixel value
+static void iplLookup(IplImage* srcImage, IplImage* dstImage, const char* table)
+{
+    const unsigned char* src = (const unsigned char*)srcImage->imageData;
+    char* dst = dstImage->imageData;
+    iplForEachBand(0, srcImage->imageSize, 1, [=](int begin, int end)
+    {
+        for (int i = begin; i < end; i++)
+            dst[i] = table[src[i]];
+    });
+}
+
 ///
 ///
 /// WARNING:
@@ -218,64 +507,19 @@ IPLAPIIMPL(void, iplConvolve2D,(IplImage* srcImage, IplImage* dstImage,
                 }
         }
 
-    switch (srcImage->depth)
-        {
-        case IPL_DEPTH_8U:
-            {
-                int tmp;
-                for (int i = bordery; i <  h - bordery; i++)
-                    {
-                        for (int j = borderx; j < w - borderx; j++)
-                            {
-                                tmp = 0;
-                                for (int k = 0; k < krows; k++)
-                                    for (int l = 0; l < kcols; l++)
-                                        {
-                                            tmp += srcImage->imageData[(i + k - bordery) * w + j + l - borderx]
-                                                * values[ksize - k * kcols - l - 1];
-                                        }
-                                tmp >>= ktmp->nShiftR;
-                                if (tmp > 255)
-                                    tmp = 255;
-                                else
-                                    if (tmp < 0)
-                                        tmp = 0;
-                                __tmp_res[i * w + j] = char(tmp);
-                            }
-                    }
-
-                memcpy (dstImage->imageData, __tmp_res, dstImage->imageSize);
-            }
-            break;
+    if (srcImage->depth != IPL_DEPTH_8U && srcImage->depth != IPL_DEPTH_8S)
+        return;
 
-        case IPL_DEPTH_8S:
-            {
-                int tmp;
-                for (int i = bordery; i <  h - bordery; i++)
-                    {
-                        for (int j = borderx; j < w - borderx; j++)
-                            {
-                                tmp = 0;
-                                for (int k = 0; k < krows; k++)
-                                    for (int l = 0; l < kcols; l++)
-                                        {
-                                            tmp += srcImage->imageData[(i + k - bordery) * w + j + l - borderx]
-                                                * values[ksize - k * kcols - l - 1];
-                                        }
-                                tmp >>= ktmp->nShiftR;
-                                if (tmp > 127)
-                                    tmp = 127;
-                                else
-                                    if (tmp < -128)
-                                        tmp = -128;
-                                __tmp_res[i * w + j] = char(tmp);
-                            }
-                    }
+    // the 8U images are read as char too, as they always were.
+    const bool isSigned = (srcImage->depth == IPL_DEPTH_8S);
+    const char* src = srcImage->imageData;
+    char* res = __tmp_res;
+    iplForEachBand(bordery, h - bordery, (long)w * ksize, [=](int begin, int end)
+    {
+        iplConvolveRows(src, res, w, borderx, begin, end, values, krows, kcols, ktmp->nShiftR, isSigned);
+    });
 
-                memcpy (dstImage->imageData, __tmp_res, dstImage->imageSize);
-            }
-            break;
-        }
+    memcpy (dstImage->imageData, __tmp_res, dstImage->imageSize);
 }
 
 // Implemented for mono images only.
@@ -337,49 +581,16 @@ IPLAPIIMPL(void, iplConvolve2DFP,(IplImage* srcImage, IplImage* dstImage,
                 }
         }
 
-    if (srcImage != dstImage)
-        {
-            float tmp;
-            float *source = reinterpret_cast<float*>(srcImage->imageData);
-            float *dest = reinterpret_cast<float*>(dstImage->imageData);
-            for (int i = bordery; i <  h - bordery; i++)
-                {
-                    for (int j = borderx; j < w - borderx; j++)
-                        {
-                            tmp = 0;
-                            for (int k = 0; k < krows; k++)
-                                for (int l = 0; l < kcols; l++)
-                                    {
-                                        tmp += source[(i + k - bordery) * w + j + l - borderx]
-                                            * values[ksize - k * kcols - l - 1];
-                                    }
-                            dest[i * w + j] = tmp;
-                        }
-                }
-        }
-    else
-        {
-            // inplace.
-            float tmp;
-            float *source = reinterpret_cast<float*>(srcImage->imageData);
-            //float *dest = reinterpret_cast<float*>(dstImage->imageData);
-            for (int i = bordery; i <  h - bordery; i++)
-                {
-                    for (int j = borderx; j < w - borderx; j++)
-                        {
-                            tmp = 0;
-                            for (int k = 0; k < krows; k++)
-                                for (int l = 0; l < kcols; l++)
-                                    {
-                                        tmp += source[(i + k - bordery) * w + j + l - borderx]
-                                            * values[ksize - k * kcols - l - 1];
-                                    }
-                            __tmp_res[i * w + j] = tmp;
-                        }
-                }
+    // inplace, the result goes in the temporary buffer first.
+    const float *source = reinterpret_cast<float*>(srcImage->imageData);
+    float *dest = (srcImage != dstImage) ? reinterpret_cast<float*>(dstImage->imageData) : __tmp_res;
+    iplForEachBand(bordery, h - bordery, (long)w * ksize, [=](int begin, int end)
+    {
+        iplConvolveRows(source, dest, w, borderx, begin, end, values, krows, kcols);
+    });
 
-            memcpy (dstImage->imageData, __tmp_res, dstImage->imageSize);
-        }
+    if (srcImage == dstImage)
+        memcpy (dstImage->imageData, __tmp_res, dstImage->imageSize);
 }
 
 // TODO: inplace operation.
@@ -443,43 +654,23 @@ IPLAPIIMPL(void, iplConvolveSep2DFP,(IplImage* srcImage,
     // inplace.
     float *src = reinterpret_cast<float*>(srcImage->imageData);
     float *dst = reinterpret_cast<float*>(dstImage->imageData);
+    float *res = __tmp_res;
     if (xKernel != nullptr)
         {
             // apply x kernel.
-            float tmp;
-            for (int i = 0; i <  h; i++)
-                {
-                    for (int j = borderx; j < w - borderx; j++)
-                        {
-                            tmp = 0;
-                            for (int k = 0; k < xksize; k++)
-                                {
-                                    tmp += src[i * w + j + k - borderx]
-                                        * xvalues[xksize - k - 1];
-                                }
-                            __tmp_res[i * w + j] = tmp;
-                        }
-                }
+            iplForEachBand(0, h, (long)w * xksize, [=](int begin, int end)
+            {
+                iplConvolveRows(src, res, w, borderx, begin, end, xvalues, 1, xksize);
+            });
         }
 
     if (yKernel != nullptr)
         {
             // apply y kernel.
-            float tmp;
-            for (int i = bordery; i <  h - bordery; i++)
-                {
-                    // can save borderx (if applied)!
-                    for (int j = borderx; j < w - borderx; j++)
-                        {
-                            tmp = 0;
-                            for (int k = 0; k < yksize; k++)
-                                {
-                                    tmp += __tmp_res[(i + k - bordery) * w + j]
-                                        * yvalues[yksize - k - 1];
-                                }
-                            dst[i * w + j] = tmp;
-                        }
-                }
+            iplForEachBand(bordery, h - bordery, (long)w * yksize, [=](int begin, int end)
+            {
+                iplConvolveRows(res, dst, w, borderx, begin, end, yvalues, yksize, 1);
+            });
         }
 }
 
@@ -547,113 +738,33 @@ IPLAPIIMPL(void, iplConvolveSep2D,(IplImage* srcImage, IplImage* dstImage,
                 }
         }
 
-    switch (srcImage->depth)
+    if (srcImage->depth != IPL_DEPTH_8U && srcImage->depth != IPL_DEPTH_8S)
+        return;
+
+    // the 8U images and the temporary rows are read as char, as they
+    // always were.
+    const bool isSigned = (srcImage->depth == IPL_DEPTH_8S);
+    const char *src = srcImage->imageData;
+    char *dst = dstImage->imageData;
+    char *res = __tmp_res;
+    if (xKernel != nullptr)
         {
-        case IPL_DEPTH_8U:
+            // apply x kernel.
+            const int shift = xKernel->nShiftR;
+            iplForEachBand(0, h, (long)w * xksize, [=](int begin, int end)
             {
-                if (xKernel != nullptr)
-                    {
-                        // apply x kernel.
-                        int tmp;
-                        for (int i = 0; i <  h; i++)
-                            {
-                                for (int j = borderx; j < w - borderx; j++)
-                                    {
-                                        tmp = 0;
-                                        for (int k = 0; k < xksize; k++)
-                                            {
-                                                tmp += srcImage->imageData[i * w + j + k - borderx]
-                                                    * xvalues[xksize - k - 1];
-                                            }
-                                        tmp >>= xKernel->nShiftR;
-                                        if (tmp > 255)
-                                            tmp = 255;
-                                        else
-                                            if (tmp < 0)
-                                                tmp = 0;
-                                        __tmp_res[i * w + j] = char(tmp);
-                                    }
-                            }
-                    }
-
-                if (yKernel != nullptr)
-                    {
-                        // apply y kernel.
-                        int tmp;
-                        for (int i = bordery; i <  h - bordery; i++)
-                            {
-                                // can save borderx (if applied)!
-                                for (int j = borderx; j < w - borderx; j++)
-                                    {
-                                        tmp = 0;
-                                        for (int k = 0; k < yksize; k++)
-                                            {
-                                                tmp += __tmp_res[(i + k - bordery) * w + j]
-                                                    * yvalues[yksize - k - 1];
-                                            }
-                                        tmp >>= yKernel->nShiftR;
-                                        if (tmp > 255)
-                                            tmp = 255;
-                                        else
-                                            if (tmp < 0)
-                                                tmp = 0;
-                                        dstImage->imageData[i * w + j] = char(tmp);
-                                    }
-                            }
-                    }
-            }
-            break;
+                iplConvolveRows(src, res, w, borderx, begin, end, xvalues, 1, xksize, shift, isSigned);
+            });
+        }
 
-        case IPL_DEPTH_8S:
+    if (yKernel != nullptr)
+        {
+            // apply y kernel.
+            const int shift = yKernel->nShiftR;
+            iplForEachBand(bordery, h - bordery, (long)w * yksize, [=](int begin, int end)
             {
-                if (xKernel != nullptr)
-                    {
-                        int tmp;
-                        for (int i = 0; i <  h; i++)
-                            {
-                                for (int j = borderx; j < w - borderx; j++)
-                                    {
-                                        tmp = 0;
-                                        for (int k = 0; k < xksize; k++)
-                                            {
-                                                tmp += srcImage->imageData[i * w + j + k - borderx]
-                                                    * xvalues[xksize - k - 1];
-                                            }
-                                        tmp >>= xKernel->nShiftR;
-                                        if (tmp > 127)
-                                            tmp = 127;
-                                        else
-                                            if (tmp < -128)
-                                                tmp = -128;
-                                        __tmp_res[i * w + j] = char(tmp);
-                                    }
-                            }
-                    }
-
-                if (yKernel != nullptr)
-                    {
-                        int tmp;
-                        for (int i = bordery; i <  h - bordery; i++)
-                            {
-                                for (int j = borderx; j < w - borderx; j++)
-                                    {
-                                        tmp = 0;
-                                        for (int k = 0; k < yksize; k++)
-                                            {
-                                                tmp += __tmp_res[(i + k - bordery) * w + j]
-                                                    * yvalues[yksize - k - 1];
-                                            }
-                                        tmp >>= yKernel->nShiftR;
-                                        if (tmp > 127)
-                                            tmp = 127;
-                                        else
-                                            if (tmp < -128)
-                                                tmp = -128;
-                                        dstImage->imageData[i * w + j] = char(tmp);
-                                    }
-                            }
-                    }
-            }
+                iplConvolveRows(res, dst, w, borderx, begin, end, yvalues, yksize, 1, shift, isSigned);
+            });
         }
 }
 
@@ -955,46 +1066,39 @@ IPLAPIIMPL(void, iplAddS,(IplImage* srcImage, IplImage* dstImage, int value))
     yAssert(srcImage->depth == dstImage->depth);
 
     // assume images have the same size and 8 bits/pixel/planes.
+    char table[256];
     switch (srcImage->depth)
         {
         case IPL_DEPTH_8U:
             {
-                const int size = srcImage->imageSize;
-                unsigned char * src = (unsigned char *)srcImage->imageData;
-                unsigned char * dst = (unsigned char *)dstImage->imageData;
-
                 short tmp;
 
-                for (int i = 0; i < size; i++)
+                for (int i = 0; i < 256; i++)
                     {
-                        tmp = *src++ + value;
+                        tmp = (unsigned char)i + value;
                         if (tmp < 0)
                             tmp = 0;
                         else
                             if (tmp > 255)
                                 tmp = 255;
-                        *dst++ = char(tmp);
+                        table[i] = char(tmp);
                     }
             }
             break;
 
         case IPL_DEPTH_8S:
             {
-                const int size = srcImage->imageSize;
-                char * src = srcImage->imageData;
-                char * dst = dstImage->imageData;
-
                 short tmp;
 
-                for (int i = 0; i < size; i++)
+                for (int i = 0; i < 256; i++)
                     {
-                        tmp = *src++ + value;
+                        tmp = char(i) + value;
                         if (tmp < -128)
                             tmp = -128;
                         else
                             if (tmp > 127)
                                 tmp = 127;
-                        *dst++ = char(tmp);
+                        table[i] = char(tmp);
                     }
             }
             break;
@@ -1002,8 +1106,10 @@ IPLAPIIMPL(void, iplAddS,(IplImage* srcImage, IplImage* dstImage, int value))
         default:
             yAssert(1 == 0);
             // NOT IMPLEMENTED.
-            break;
+            return;
         }
+
+    iplLookup (srcImage, dstImage, table);
 }
 
 IPLAPIIMPL(void, iplAdd,(IplImage* srcImageA, IplImage* srcImageB,
@@ -1020,42 +1126,27 @@ IPLAPIIMPL(void, iplAdd,(IplImage* srcImageA, IplImage* srcImageB,
         {
         case IPL_DEPTH_8U:
             {
-                const int size = srcImageA->imageSize;
                 unsigned char * src1 = (unsigned char *)srcImageA->imageData;
                 unsigned char * src2 = (unsigned char *)srcImageB->imageData;
                 unsigned char * dst = (unsigned char *)dstImage->imageData;
 
-                short tmp;
-
-                for (int i = 0; i < size; i++)
-                    {
-                        tmp = *src1++ + *src2++;
-                        if (tmp > 255)
-                            tmp = 255;
-                        *dst++ = char(tmp);
-                    }
+                iplForEachBand(0, srcImageA->imageSize, 1, [=](int begin, int end)
+                {
+                    iplAddRow<false>(dst + begin, src1 + begin, src2 + begin, end - begin);
+                });
             }
             break;
 
         case IPL_DEPTH_8S:
             {
-                const int size = srcImageA->imageSize;
                 char * src1 = srcImageA->imageData;
                 char * src2 = srcImageB->imageData;
                 char * dst = dstImage->imageData;
 
-                short tmp;
-
-                for (int i = 0; i < size; i++)
-                    {
-                        tmp = *src1++ + *src2++;
-                        if (tmp < -128)
-                            tmp = -128;
-                        else
-                            if (tmp > 127)
-                                tmp = 127;
-                        *dst++ = char(tmp);
-                    }
+                iplForEachBand(0, srcImageA->imageSize, 1, [=](int begin, int end)
+                {
+                    iplAddRow<false>(dst + begin, src1 + begin, src2 + begin, end - begin);
+                });
             }
             break;
 
@@ -1066,10 +1157,10 @@ IPLAPIIMPL(void, iplAdd,(IplImage* srcImageA, IplImage* srcImageB,
                 float * src2 = reinterpret_cast<float*>(srcImageB->imageData);
                 float * dst = reinterpret_cast<float*>(dstImage->imageData);
 
-                for (int i = 0; i < size; i++)
-                    {
-                        *dst++ = *src1++ + *src2++;
-                    }
+                iplForEachBand(0, size, 1, [=](int begin, int end)
+                {
+                    iplAddRow<false>(dst + begin, src1 + begin, src2 + begin, end - begin);
+                });
             }
             break;
 
@@ -1091,44 +1182,27 @@ IPLAPIIMPL(void, iplSubtract,(IplImage* srcImageA, IplImage* srcImageB,
         {
         case IPL_DEPTH_8U:
             {
-                const int size = srcImageA->imageSize;
                 unsigned char * src1 = (unsigned char *)srcImageA->imageData;
                 unsigned char * src2 = (unsigned char *)srcImageB->imageData;
                 unsigned char * dst = (unsigned char *)dstImage->imageData;
 
-                short tmp;
-
-                for (int i = 0; i < size; i++)
-                    {
-                        tmp = *src1++ - *src2++;
-                        if (tmp < 0)
-                            tmp = 0;
-                        if (tmp > 255)
-                            tmp = 255;
-                        *dst++ = char(tmp);
-                    }
+                iplForEachBand(0, srcImageA->imageSize, 1, [=](int begin, int end)
+                {
+                    iplAddRow<true>(dst + begin, src1 + begin, src2 + begin, end - begin);
+                });
             }
             break;
 
         case IPL_DEPTH_8S:
             {
-                const int size = srcImageA->imageSize;
                 char * src1 = srcImageA->imageData;
                 char * src2 = srcImageB->imageData;
                 char * dst = dstImage->imageData;
 
-                short tmp;
-
-                for (int i = 0; i < size; i++)
-                    {
-                        tmp = *src1++ - *src2++;
-                        if (tmp < -128)
-                            tmp = -128;
-                        else
-                            if (tmp > 127)
-                                tmp = 127;
-                        *dst++ = char(tmp);
-                    }
+                iplForEachBand(0, srcImageA->imageSize, 1, [=](int begin, int end)
+                {
+                    iplAddRow<true>(dst + begin, src1 + begin, src2 + begin, end - begin);
+                });
             }
             break;
 
@@ -1139,10 +1213,10 @@ IPLAPIIMPL(void, iplSubtract,(IplImage* srcImageA, IplImage* srcImageB,
                 float * src2 = reinterpret_cast<float*>(srcImageB->imageData);
                 float * dst = reinterpret_cast<float*>(dstImage->imageData);
 
-                for (int i = 0; i < size; i++)
-                    {
-                        *dst++ = *src1++ - *src2++;
-                    }
+                iplForEachBand(0, size, 1, [=](int begin, int end)
+                {
+                    iplAddRow<true>(dst + begin, src1 + begin, src2 + begin, end - begin);
+                });
             }
             break;
 
@@ -1157,54 +1231,47 @@ IPLAPIIMPL(void, iplSubtractS,(IplImage* srcImage, IplImage* dstImage, int value
                                bool flip))
 {
     // assume images have the same size and 8 bits/pixel/planes.
+    char table[256];
     switch (srcImage->depth)
         {
         case IPL_DEPTH_8U:
             {
-                const int size = srcImage->imageSize;
-                unsigned char * src = (unsigned char *)srcImage->imageData;
-                unsigned char * dst = (unsigned char *)dstImage->imageData;
-
                 short tmp;
 
-                for (int i = 0; i < size; i++)
+                for (int i = 0; i < 256; i++)
                     {
                         if (flip)
-                            tmp = value - *src++;
+                            tmp = value - (unsigned char)i;
                         else
-                            tmp = *src++ - value;
+                            tmp = (unsigned char)i - value;
 
                         if (tmp < 0)
                             tmp = 0;
                         else
                             if (tmp > 255)
                                 tmp = 255;
-                        *dst++ = char(tmp);
+                        table[i] = char(tmp);
                     }
             }
             break;
 
         case IPL_DEPTH_8S:
             {
-                const int size = srcImage->imageSize;
-                char * src = srcImage->imageData;
-                char * dst = dstImage->imageData;
-
                 short tmp;
 
-                for (int i = 0; i < size; i++)
+                for (int i = 0; i < 256; i++)
                     {
                         if (flip)
-                            tmp = value - *src++;
+                            tmp = value - char(i);
                         else
-                            tmp = *src++ - value;
+                            tmp = char(i) - value;
 
                         if (tmp < -128)
                             tmp = -128;
                         else
                             if (tmp > 127)
                                 tmp = 127;
-                        *dst++ = char(tmp);
+                        table[i] = char(tmp);
                     }
             }
             break;
@@ -1212,8 +1279,10 @@ IPLAPIIMPL(void, iplSubtractS,(IplImage* srcImage, IplImage* dstImage, int value
         default:
             yAssert(1 == 0);
             // NOT IMPLEMENTED.
-            break;
+            return;
         }
+
+    iplLookup (srcImage, dstImage, table);
 }
 
 IPLAPIIMPL(void, iplMultiplySFP,(IplImage* srcImage, IplImage* dstImage,
@@ -1226,10 +1295,10 @@ IPLAPIIMPL(void, iplMultiplySFP,(IplImage* srcImage, IplImage* dstImage,
     float * src1 = reinterpret_cast<float*>(srcImage->imageData);
     float * dst = reinterpret_cast<float*>(dstImage->imageData);
 
-    for (int i = 0; i < size; i++)
-        {
-            *dst++ = *src1++ * value;
-        }
+    iplForEachBand(0, size, 1, [=](int begin, int end)
+    {
+        iplMultiplyRow(dst + begin, src1 + begin, value, end - begin);
+    });
 }
 
 IPLAPIIMPL(void, iplAbs,(IplImage* srcImage, IplImage* dstImage))
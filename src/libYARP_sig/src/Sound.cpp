@@ -8,10 +8,11 @@
 #include <yarp/sig/Sound.h>
 #include <yarp/sig/Image.h>
 #include <yarp/os/Bottle.h>
-#include <yarp/os/PortablePair.h>
+#include <yarp/os/ConnectionReader.h>
+#include <yarp/os/ConnectionWriter.h>
 #include <yarp/os/Log.h>
-#include <yarp/os/Time.h>
-#include <yarp/os/Value.h>
+#include <yarp/os/Vocab.h>
+#include <yarp/conf/numeric.h>
 
 #include <cstring>
 #include <cstdio>
@@ -19,20 +20,214 @@
 using namespace yarp::sig;
 using namespace yarp::os;
 
-#define HELPER(x) (*((FlexImage*)(x)))
+#define VOCAB_SOUND VOCAB4('s','n','d','b')
+
+namespace {
+
+// Upper bounds to the size of a received sound, to reject corrupted ones
+const int MAX_SOUND_CHANNELS = 4096;
+const size_t MAX_SOUND_BYTES = (size_t)1 << 30;
+
+int formatSize(Sound::SampleFormat format)
+{
+    switch (format) {
+    case Sound::FORMAT_INT16: return 2;
+    case Sound::FORMAT_INT24: return 3;
+    default: return 4;
+    }
+}
+
+inline short clampShort(float x)
+{
+    x *= 32768.0f;
+    if (x >= 32767.0f) return 32767;
+    if (x <= -32768.0f) return -32768;
+    return (short)x;
+}
+
+inline int clampInt32(float x)
+{
+    // 2147483647 is not representable as a float, the comparisons are
+    // made against 2^31
+    x *= 2147483648.0f;
+    if (x >= 2147483648.0f) return 2147483647;
+    if (x <= -2147483648.0f) return (-2147483647 - 1);
+    return (int)x;
+}
+
+inline int loadBytes16(const unsigned char* p)
+{
+    return (short)(p[0] | (p[1] << 8));
+}
+
+inline int loadBytes32(const unsigned char* p)
+{
+    return (int)((unsigned int)p[0] | ((unsigned int)p[1] << 8) |
+                 ((unsigned int)p[2] << 16) | ((unsigned int)p[3] << 24));
+}
+
+inline void storeBytes32(unsigned char* p, unsigned int v)
+{
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+}
+
+// Each codec reads and writes a sample of its format, stored little endian,
+// as a 16 bit integer, as a float, and as a 32 bit integer (used to change
+// the format of a sound without losing precision).
+struct Int16Codec
+{
+    static const int size = 2;
+    static void load(const unsigned char* p, short& v) { v = (short)loadBytes16(p); }
+    static void load(const unsigned char* p, float& v) { v = loadBytes16(p) * (1.0f / 32768); }
+    static void load(const unsigned char* p, int& v) { v = (int)((unsigned int)loadBytes16(p) << 16); }
+    static void store(unsigned char* p, short v) { p[0] = (unsigned char)v; p[1] = (unsigned char)(v >> 8); }
+    static void store(unsigned char* p, float v) { store(p, clampShort(v)); }
+    static void store(unsigned char* p, int v) { store(p, (short)(v >> 16)); }
+};
+
+struct Int24Codec
+{
+    static const int size = 3;
+    static int loadInt24(const unsigned char* p)
+    {
+        int v = p[0] | (p[1] << 8) | (p[2] << 16);
+        return (v ^ 0x800000) - 0x800000;
+    }
+    static void storeInt24(unsigned char* p, int v)
+    {
+        p[0] = (unsigned char)v;
+        p[1] = (unsigned char)(v >> 8);
+        p[2] = (unsigned char)(v >> 16);
+    }
+    static void load(const unsigned char* p, short& v) { v = (short)(loadInt24(p) >> 8); }
+    static void load(const unsigned char* p, float& v) { v = loadInt24(p) * (1.0f / 8388608); }
+    static void load(const unsigned char* p, int& v) { v = (int)((unsigned int)loadInt24(p) << 8); }
+    static void store(unsigned char* p, short v) { storeInt24(p, (int)((unsigned int)v << 8)); }
+    static void store(unsigned char* p, float v) { storeInt24(p, clampInt32(v) >> 8); }
+    static void store(unsigned char* p, int v) { storeInt24(p, v >> 8); }
+};
+
+struct Int32Codec
+{
+    static const int size = 4;
+    static void load(const unsigned char* p, short& v) { v = (short)(loadBytes32(p) >> 16); }
+    static void load(const unsigned char* p, float& v) { v = loadBytes32(p) * (1.0f / 2147483648.0f); }
+    static void load(const unsigned char* p, int& v) { v = loadBytes32(p); }
+    static void store(unsigned char* p, short v) { storeBytes32(p, (unsigned int)v << 16); }
+    static void store(unsigned char* p, float v) { storeBytes32(p, (unsigned int)clampInt32(v)); }
+    static void store(unsigned char* p, int v) { storeBytes32(p, (unsigned int)v); }
+};
+
+struct Float32Codec
+{
+    static const int size = 4;
+    static float loadFloat(const unsigned char* p)
+    {
+        unsigned int bits = (unsigned int)loadBytes32(p);
+        float v;
+        memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+    static void storeFloat(unsigned char* p, float v)
+    {
+        unsigned int bits;
+        memcpy(&bits, &v, sizeof(bits));
+        storeBytes32(p, bits);
+    }
+    static void load(const unsigned char* p, short& v) { v = clampShort(loadFloat(p)); }
+    static void load(const unsigned char* p, float& v) { v = loadFloat(p); }
+    static void load(const unsigned char* p, int& v) { v = clampInt32(loadFloat(p)); }
+    static void store(unsigned char* p, short v) { storeFloat(p, v * (1.0f / 32768)); }
+    static void store(unsigned char* p, float v) { storeFloat(p, v); }
+    static void store(unsigned char* p, int v) { storeFloat(p, v * (1.0f / 2147483648.0f)); }
+};
+
+// The format whose samples are stored as the elements of the arrays, on
+// little endian machines
+inline Sound::SampleFormat nativeFormat(const short*) { return Sound::FORMAT_INT16; }
+inline Sound::SampleFormat nativeFormat(const int*) { return Sound::FORMAT_INT32; }
+inline Sound::SampleFormat nativeFormat(const float*) { return Sound::FORMAT_FLOAT32; }
+
+template <class Codec, class T>
+void loadRun(const unsigned char* src, size_t srcStride, T* dest, size_t destStride, size_t n)
+{
+    srcStride *= Codec::size;
+    for (size_t i = 0; i < n; i++) {
+        Codec::load(src, *dest);
+        src += srcStride;
+        dest += destStride;
+    }
+}
+
+template <class Codec, class T>
+void storeRun(unsigned char* dest, size_t destStride, const T* src, size_t srcStride, size_t n)
+{
+    destStride *= Codec::size;
+    for (size_t i = 0; i < n; i++) {
+        Codec::store(dest, *src);
+        dest += destStride;
+        src += srcStride;
+    }
+}
+
+// Converts n samples, the strides are in samples
+template <class T>
+void loadSamples(Sound::SampleFormat format, const unsigned char* src, size_t srcStride,
+                 T* dest, size_t destStride, size_t n)
+{
+#ifdef YARP_LITTLE_ENDIAN
+    if (format == nativeFormat(dest) && srcStride == 1 && destStride == 1) {
+        memcpy(dest, src, n * sizeof(T));
+        return;
+    }
+#endif
+    switch (format) {
+    case Sound::FORMAT_INT16: loadRun<Int16Codec>(src, srcStride, dest, destStride, n); break;
+    case Sound::FORMAT_INT24: loadRun<Int24Codec>(src, srcStride, dest, destStride, n); break;
+    case Sound::FORMAT_INT32: loadRun<Int32Codec>(src, srcStride, dest, destStride, n); break;
+    case Sound::FORMAT_FLOAT32: loadRun<Float32Codec>(src, srcStride, dest, destStride, n); break;
+    }
+}
+
+template <class T>
+void storeSamples(Sound::SampleFormat format, unsigned char* dest, size_t destStride,
+                  const T* src, size_t srcStride, size_t n)
+{
+#ifdef YARP_LITTLE_ENDIAN
+    if (format == nativeFormat(src) && srcStride == 1 && destStride == 1) {
+        memcpy(dest, src, n * sizeof(T));
+        return;
+    }
+#endif
+    switch (format) {
+    case Sound::FORMAT_INT16: storeRun<Int16Codec>(dest, destStride, src, srcStride, n); break;
+    case Sound::FORMAT_INT24: storeRun<Int24Codec>(dest, destStride, src, srcStride, n); break;
+    case Sound::FORMAT_INT32: storeRun<Int32Codec>(dest, destStride, src, srcStride, n); break;
+    case Sound::FORMAT_FLOAT32: storeRun<Float32Codec>(dest, destStride, src, srcStride, n); break;
+    }
+}
+
+} // namespace
+
 
 Sound::Sound(int bytesPerSample) {
     init(bytesPerSample);
     frequency = 0;
 }
 
-Sound::Sound(const Sound& alt) : yarp::os::Portable() {
-    init(alt.getBytesPerSample());
-    FlexImage& img1 = HELPER(implementation);
-    FlexImage& img2 = HELPER(alt.implementation);
-    img1.copy(img2);
-    frequency = alt.frequency;
-    synchronize();
+Sound::Sound(const Sound& alt) :
+        yarp::os::Portable(),
+        buffer(alt.buffer),
+        samples(alt.samples),
+        channels(alt.channels),
+        bytesPerSample(alt.bytesPerSample),
+        frequency(alt.frequency),
+        format(alt.format),
+        interleaved(alt.interleaved)
+{
 }
 
 Sound& Sound::operator += (const Sound& alt) {
@@ -47,48 +242,45 @@ Sound& Sound::operator += (const Sound& alt) {
         return *this;
     }
 
-    Sound orig= *this;
-    this->resize(this->samples+alt.samples,channels);
-
-    unsigned char* p1    = orig.getRawData();
-    unsigned char* p2    = alt.getRawData();
-    unsigned char* pout  = this->getRawData();
-
-    for (int ch=0; ch<channels; ch++)
-    {
-        int out1 = ch* this->getBytesPerSample() * this->samples;
-        int out2 = ch* this->getBytesPerSample() * this->samples + this->getBytesPerSample() * orig.samples;
-
-        int ori1 = ch * orig.getBytesPerSample() * orig.samples;
-        int s1   = orig.getBytesPerSample() * orig.samples;
-
-        int alt1 = ch * orig.getBytesPerSample() * alt.samples;
-        unsigned int s2 = alt.getBytesPerSample() * alt.samples;
-
-        memcpy((void *) &pout[out1], (void *) (p1+ori1), s1);
-        memcpy((void *) &pout[out2], (void *) (p2+alt1), s2);
+    const Sound* tail = &alt;
+    Sound converted;
+    if (alt.format != format || alt.interleaved != interleaved) {
+        converted = alt;
+        converted.setSampleFormat(format);
+        converted.setInterleaved(interleaved);
+        tail = &converted;
     }
 
-    this->synchronize();
+    if (interleaved) {
+        buffer.insert(buffer.end(), tail->buffer.begin(), tail->buffer.end());
+    } else {
+        std::vector<unsigned char> joined(buffer.size() + tail->buffer.size());
+        size_t s1 = (size_t)samples * bytesPerSample;
+        size_t s2 = (size_t)tail->samples * bytesPerSample;
+        unsigned char* pout = joined.data();
+        for (int ch=0; ch<channels; ch++)
+        {
+            memcpy(pout, buffer.data() + ch*s1, s1);
+            memcpy(pout + s1, tail->buffer.data() + ch*s2, s2);
+            pout += s1 + s2;
+        }
+        buffer.swap(joined);
+    }
+    samples += tail->samples;
     return *this;
 }
 
 const Sound& Sound::operator = (const Sound& alt) {
-    yAssert(getBytesPerSample()==alt.getBytesPerSample());
-    FlexImage& img1 = HELPER(implementation);
-    FlexImage& img2 = HELPER(alt.implementation);
-    img1.copy(img2);
+    buffer = alt.buffer;
+    samples = alt.samples;
+    channels = alt.channels;
+    bytesPerSample = alt.bytesPerSample;
     frequency = alt.frequency;
-    synchronize();
+    format = alt.format;
+    interleaved = alt.interleaved;
     return *this;
 }
 
-void Sound::synchronize() {
-    FlexImage& img = HELPER(implementation);
-    samples = img.width();
-    channels = img.height();
-}
-
 Sound Sound::subSound(int first_sample, int last_sample)
 {
     if (last_sample  > this->samples)
@@ -103,42 +295,33 @@ Sound Sound::subSound(int first_sample, int last_sample)
         last_sample = first_sample;
 
     Sound s;
-
+    s.format = format;
+    s.bytesPerSample = bytesPerSample;
+    s.interleaved = interleaved;
     s.resize(last_sample-first_sample, this->channels);
     s.setFrequency(this->frequency);
 
-    /*
-    //faster implementation but currently not working
-    unsigned char* p1    = this->getRawData();
-    unsigned char* p2    = s.getRawData();
-    int j=0;
-    for (int i=first_sample; i<last_sample*2; i++)
-    {
-        p2[j++]=p1[i];
-    }
-    */
-
-    //safe implementation
-    int j=0;
-    for (int i=first_sample; i<last_sample; i++)
-    {
-        for (int c=0; c< this->channels; c++)
-            s.set(this->get(i,c),j,c);
-        j++;
+    if (interleaved) {
+        memcpy(s.buffer.data(),
+               buffer.data() + offset(first_sample, 0) * bytesPerSample,
+               s.buffer.size());
+    } else {
+        size_t len = (size_t)s.samples * bytesPerSample;
+        for (int c=0; c<channels; c++) {
+            memcpy(s.buffer.data() + c*len,
+                   buffer.data() + offset(first_sample, c) * bytesPerSample,
+                   len);
+        }
     }
-
-    s.synchronize();
-
     return s;
 }
 
 void Sound::init(int bytesPerSample) {
-    implementation = new FlexImage();
-    yAssert(implementation!=nullptr);
-
-    yAssert(bytesPerSample==2); // that's all thats implemented right now
-    HELPER(implementation).setPixelCode(VOCAB_PIXEL_MONO16);
-    HELPER(implementation).setQuantum(2);
+    // 16, 24 and 32 bit integers
+    yAssert(bytesPerSample>=2 && bytesPerSample<=4);
+    format = (SampleFormat)(FORMAT_INT16 + bytesPerSample - 2);
+    // planar, as the raw data of the older versions
+    interleaved = false;
 
     samples = 0;
     channels = 0;
@@ -146,43 +329,56 @@ void Sound::init(int bytesPerSample) {
 }
 
 Sound::~Sound() {
-    if (implementation!=nullptr) {
-        delete &HELPER(implementation);
-        implementation = nullptr;
-    }
 }
 
 void Sound::resize(int samples, int channels) {
-    FlexImage& img = HELPER(implementation);
-    img.resize(samples,channels);
-    synchronize();
+    if (samples < 0) samples = 0;
+    if (channels < 0) channels = 0;
+    this->samples = samples;
+    this->channels = channels;
+    buffer.resize((size_t)samples * channels * bytesPerSample);
 }
 
 int Sound::get(int location, int channel) const {
-    FlexImage& img = HELPER(implementation);
-    unsigned char *addr = img.getPixelAddress(location,channel);
-    if (bytesPerSample==2) {
-        return *(reinterpret_cast<NetUint16*>(addr));
+    const unsigned char *addr = buffer.data() + offset(location,channel) * bytesPerSample;
+    switch (format) {
+    case FORMAT_INT16:
+        return loadBytes16(addr);
+    case FORMAT_INT24:
+        return Int24Codec::loadInt24(addr);
+    case FORMAT_INT32:
+        return loadBytes32(addr);
+    default: {
+        short v;
+        Float32Codec::load(addr, v);
+        return v;
+    }
     }
-    yInfo("sound only implemented for 16 bit samples");
-    return 0;
 }
 
 void Sound::clear()
 {
-    int size = this->getRawDataSize();
-    unsigned char* p  = this->getRawData();
-    memset(p,0,size);
+    if (!buffer.empty()) {
+        memset(buffer.data(), 0, buffer.size());
+    }
 }
 
 void Sound::set(int value, int location, int channel) {
-    FlexImage& img = HELPER(implementation);
-    unsigned char *addr = img.getPixelAddress(location,channel);
-    if (bytesPerSample==2) {
-        *(reinterpret_cast<NetUint16*>(addr)) = value;
-        return;
+    unsigned char *addr = buffer.data() + offset(location,channel) * bytesPerSample;
+    switch (format) {
+    case FORMAT_INT16:
+        Int16Codec::store(addr, (short)value);
+        break;
+    case FORMAT_INT24:
+        Int24Codec::storeInt24(addr, value);
+        break;
+    case FORMAT_INT32:
+        storeBytes32(addr, (unsigned int)value);
+        break;
+    default:
+        Float32Codec::store(addr, (short)value);
+        break;
     }
-    yInfo("sound only implemented for 16 bit samples");
 }
 
 int Sound::getFrequency() const {
@@ -193,31 +389,229 @@ void Sound::setFrequency(int freq) {
     this->frequency = freq;
 }
 
+void Sound::setSampleFormat(SampleFormat format) {
+    if (format == this->format) {
+        return;
+    }
+    size_t n = (size_t)samples * channels;
+    std::vector<int> tmp(n);
+    loadSamples(this->format, buffer.data(), 1, tmp.data(), 1, n);
+    this->format = format;
+    bytesPerSample = formatSize(format);
+    buffer.resize(n * bytesPerSample);
+    storeSamples(format, buffer.data(), 1, tmp.data(), 1, n);
+}
+
+void Sound::setInterleaved(bool interleaved) {
+    if (interleaved == this->interleaved) {
+        return;
+    }
+    std::vector<unsigned char> tmp(buffer.size());
+    size_t bps = bytesPerSample;
+    // samples in the interleaved buffer are channels apart, in the planar
+    // one they are consecutive
+    size_t srcStride = this->interleaved ? channels * bps : bps;
+    size_t destStride = interleaved ? channels * bps : bps;
+    for (int c=0; c<channels; c++) {
+        const unsigned char* src = buffer.data() + offset(0,c) * bps;
+        unsigned char* dest = tmp.data() +
+            (interleaved ? c : (size_t)c * samples) * bps;
+        for (int i=0; i<samples; i++) {
+            memcpy(dest, src, bps);
+            src += srcStride;
+            dest += destStride;
+        }
+    }
+    buffer.swap(tmp);
+    this->interleaved = interleaved;
+}
+
+bool Sound::getBlock(short* dest, int first, int count) const {
+    if (first < 0 || count < 0 || first + count > samples) {
+        return false;
+    }
+    if (interleaved) {
+        loadSamples(format, buffer.data() + offset(first,0) * bytesPerSample, 1,
+                    dest, 1, (size_t)count * channels);
+    } else {
+        for (int c=0; c<channels; c++) {
+            loadSamples(format, buffer.data() + offset(first,c) * bytesPerSample, 1,
+                        dest + c, channels, count);
+        }
+    }
+    return true;
+}
+
+bool Sound::getBlock(float* dest, int first, int count) const {
+    if (first < 0 || count < 0 || first + count > samples) {
+        return false;
+    }
+    if (interleaved) {
+        loadSamples(format, buffer.data() + offset(first,0) * bytesPerSample, 1,
+                    dest, 1, (size_t)count * channels);
+    } else {
+        for (int c=0; c<channels; c++) {
+            loadSamples(format, buffer.data() + offset(first,c) * bytesPerSample, 1,
+                        dest + c, channels, count);
+        }
+    }
+    return true;
+}
+
+bool Sound::setBlock(const short* src, int first, int count) {
+    if (first < 0 || count < 0 || first + count > samples) {
+        return false;
+    }
+    if (interleaved) {
+        storeSamples(format, buffer.data() + offset(first,0) * bytesPerSample, 1,
+                     src, 1, (size_t)count * channels);
+    } else {
+        for (int c=0; c<channels; c++) {
+            storeSamples(format, buffer.data() + offset(first,c) * bytesPerSample, 1,
+                         src + c, channels, count);
+        }
+    }
+    return true;
+}
+
+bool Sound::setBlock(const float* src, int first, int count) {
+    if (first < 0 || count < 0 || first + count > samples) {
+        return false;
+    }
+    if (interleaved) {
+        storeSamples(format, buffer.data() + offset(first,0) * bytesPerSample, 1,
+                     src, 1, (size_t)count * channels);
+    } else {
+        for (int c=0; c<channels; c++) {
+            storeSamples(format, buffer.data() + offset(first,c) * bytesPerSample, 1,
+                         src + c, channels, count);
+        }
+    }
+    return true;
+}
+
+bool Sound::getChannel(int channel, short* dest, int first, int count) const {
+    if (!isSample(first,channel) || count < 0 || first + count > samples) {
+        return count == 0;
+    }
+    loadSamples(format, buffer.data() + offset(first,channel) * bytesPerSample, stride(),
+                dest, 1, count);
+    return true;
+}
+
+bool Sound::getChannel(int channel, float* dest, int first, int count) const {
+    if (!isSample(first,channel) || count < 0 || first + count > samples) {
+        return count == 0;
+    }
+    loadSamples(format, buffer.data() + offset(first,channel) * bytesPerSample, stride(),
+                dest, 1, count);
+    return true;
+}
+
+bool Sound::setChannel(int channel, const short* src, int first, int count) {
+    if (!isSample(first,channel) || count < 0 || first + count > samples) {
+        return count == 0;
+    }
+    storeSamples(format, buffer.data() + offset(first,channel) * bytesPerSample, stride(),
+                 src, 1, count);
+    return true;
+}
+
+bool Sound::setChannel(int channel, const float* src, int first, int count) {
+    if (!isSample(first,channel) || count < 0 || first + count > samples) {
+        return count == 0;
+    }
+    storeSamples(format, buffer.data() + offset(first,channel) * bytesPerSample, stride(),
+                 src, 1, count);
+    return true;
+}
+
 bool Sound::read(ConnectionReader& connection) {
-    // lousy format - fix soon!
-    FlexImage& img = HELPER(implementation);
+    // if someone connects in text mode, use standard
+    // text-to-binary mapping
+    connection.convertTextMode();
+
+    int header = connection.expectInt();
+    if (header == BOTTLE_TAG_LIST) {
+        return readLegacy(connection);
+    }
+
+    int n_samples = connection.expectInt();
+    int n_channels = connection.expectInt();
+    int n_format = connection.expectInt();
+    int n_interleaved = connection.expectInt();
+    int n_frequency = connection.expectInt();
+    if (connection.isError() || header != VOCAB_SOUND ||
+            n_samples < 0 || n_channels < 0 || n_channels > MAX_SOUND_CHANNELS ||
+            n_format < FORMAT_INT16 || n_format > FORMAT_FLOAT32) {
+        return false;
+    }
+    SampleFormat f = (SampleFormat)n_format;
+    if ((size_t)n_samples * n_channels * formatSize(f) > MAX_SOUND_BYTES) {
+        return false;
+    }
+
+    // the samples are read directly in the buffer, which is not
+    // reallocated when the size of the sounds does not grow
+    format = f;
+    bytesPerSample = formatSize(f);
+    interleaved = (n_interleaved != 0);
+    frequency = n_frequency;
+    resize(n_samples, n_channels);
+    if (!buffer.empty()) {
+        return connection.expectBlock((char*)buffer.data(), buffer.size());
+    }
+    return true;
+}
+
+bool Sound::readLegacy(ConnectionReader& connection) {
+    // the format of the older versions: a pair of a 16 bit image, with a
+    // channel for each row, and of a bottle with the frequency
+    int len = connection.expectInt();
+    if (len != 2) {
+        return false;
+    }
+    FlexImage img;
+    img.setPixelCode(VOCAB_PIXEL_MONO16);
+    img.setQuantum(2);
     Bottle bot;
-    bool ok = PortablePair<FlexImage,Bottle>::readPair(connection,img,bot);
+    if (!img.read(connection) || !bot.read(connection)) {
+        return false;
+    }
+
+    format = FORMAT_INT16;
+    bytesPerSample = 2;
+    interleaved = false;
     frequency = bot.get(0).asInt();
-    synchronize();
-    return ok;
+    resize(img.width(), img.height());
+    size_t row = (size_t)samples * bytesPerSample;
+    for (int c=0; c<channels; c++) {
+        memcpy(buffer.data() + c*row, img.getRow(c), row);
+    }
+    return true;
 }
 
-
 bool Sound::write(ConnectionWriter& connection) {
-    // lousy format - fix soon!
-    FlexImage& img = HELPER(implementation);
-    Bottle bot;
-    bot.addInt(frequency);
-    return PortablePair<FlexImage,Bottle>::writePair(connection,img,bot);
+    connection.appendInt(VOCAB_SOUND);
+    connection.appendInt(samples);
+    connection.appendInt(channels);
+    connection.appendInt((int)format);
+    connection.appendInt(interleaved ? 1 : 0);
+    connection.appendInt(frequency);
+    if (!buffer.empty()) {
+        // the buffer is sent as it is, without copies
+        connection.appendExternalBlock((const char*)buffer.data(), buffer.size());
+    }
+    return !connection.isError();
 }
 
 unsigned char *Sound::getRawData() const {
-    FlexImage& img = HELPER(implementation);
-    return img.getRawImage();
+    if (buffer.empty()) {
+        return nullptr;
+    }
+    return const_cast<unsigned char*>(buffer.data());
 }
 
 int Sound::getRawDataSize() const {
-    FlexImage& img = HELPER(implementation);
-    return img.getRawImageSize();
+    return (int)buffer.size();
 }
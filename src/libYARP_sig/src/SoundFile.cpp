@@ -140,6 +140,15 @@ void PcmWavHeader::setup_to_write(const Sound& src, FILE *fp)
 
 }
 
+// The sound gets the format of the samples of the wav files
+static void prepareInt16(Sound& dest, int samples, int channels)
+{
+    dest.resize(0,0);
+    dest.setSampleFormat(Sound::FORMAT_INT16);
+    dest.setInterleaved(true);
+    dest.resize(samples,channels);
+}
+
 bool yarp::sig::file::read(Sound& dest, const char *src)
 {
     FILE *fp = fopen(src, "rb");
@@ -161,24 +170,16 @@ bool yarp::sig::file::read(Sound& dest, const char *src)
     int channels = header.pcm.pcmChannels;
     int bits = header.pcm.pcmBitsPerSample;
     int samples = header.dataLength/(bits/8)/channels;
-    dest.resize(samples,channels);
+    prepareInt16(dest, samples, channels);
     dest.setFrequency(freq);
-    ManagedBytes bytes(header.dataLength);
     printf("%d channels %d samples %d frequency\n", channels, samples, freq);
 
+    // the samples of the file are read directly in the sound, they are
+    // 16 bit integers, little endian and interleaved in both
     size_t result;
-    result = fread(bytes.get(),bytes.length(),1,fp);
+    result = fread(dest.getRawData(),dest.getRawDataSize(),1,fp);
     YARP_UNUSED(result);
 
-    NetInt16 *data = reinterpret_cast<NetInt16*>(bytes.get());
-    int ct = 0;
-    for (int i=0; i<samples; i++) {
-        for (int j=0; j<channels; j++) {
-            dest.set(data[ct],i,j);
-            ct++;
-        }
-    }
-
     fclose(fp);
     return true;
 }
@@ -195,19 +196,14 @@ bool yarp::sig::file::write(const Sound& src, const char *dest)
     PcmWavHeader header;
     header.setup_to_write(src, fp);
 
-    ManagedBytes bytes(header.dataLength);
-    NetInt16 *data = reinterpret_cast<NetInt16*>(bytes.get());
-    int ct = 0;
-    int samples = src.getSamples();
-    int channels = src.getChannels();
-    for (int i=0; i<samples; i++) {
-        for (int j=0; j<channels; j++) {
-            int v = src.get(i,j);
-            data[ct] = v;
-            ct++;
-        }
+    if (src.getSampleFormat()==Sound::FORMAT_INT16 && src.isInterleaved()) {
+        fwrite(src.getRawData(),header.dataLength,1,fp);
+    } else {
+        Sound tmp(src);
+        tmp.setSampleFormat(Sound::FORMAT_INT16);
+        tmp.setInterleaved(true);
+        fwrite(tmp.getRawData(),header.dataLength,1,fp);
     }
-    fwrite(bytes.get(),bytes.length(),1,fp);
 
     fclose(fp);
     return true;
@@ -263,25 +259,15 @@ size_t yarp::sig::file::soundStreamReader::readBlock(Sound& dest, size_t block_s
     int expected_bytes = block_size*(soundInfo.bits/8)*soundInfo.channels;
 
     //this probably works only if soundInfo.bits=16
-    int expected_words=expected_bytes/(soundInfo.bits/8);
-    NetInt16     *data = new NetInt16 [expected_words];
+    prepareInt16(dest, block_size, soundInfo.channels);
+    dest.setFrequency(soundInfo.freq);
 
-    int bytes_read = fread(data,1,expected_bytes,fp);
+    int bytes_read = fread(dest.getRawData(),1,expected_bytes,fp);
     int samples_read = bytes_read/(soundInfo.bits/8)/soundInfo.channels;
-
     dest.resize(samples_read,soundInfo.channels);
-    dest.setFrequency(soundInfo.freq);
 
-    int ct = 0;
-    for (int i=0; i<samples_read; i++) {
-        for (int j=0; j<soundInfo.channels; j++) {
-            dest.set(data[ct],i,j);
-            ct++;
-        }
-    }
     index+=samples_read;
 
-    delete [] data;
     return samples_read;
 }
 
@@ -46,8 +46,17 @@ FlexImage *WireImage::checkForImage(SizedWriter& writer) {
     int w = hdr.width;
     int h = hdr.height;
     //int row_stride = hdr.imgSize/hdr.height;
-    img.setPixelCode(hdr.id);
-    img.setQuantum(hdr.quantum);
-    img.setExternal((char*)img_buf,w,h);
+    changed = (hdr.id!=last_id || hdr.quantum!=last_quantum ||
+               w!=last_width || h!=last_height);
+    if (changed || img_buf!=last_buf) {
+        img.setPixelCode(hdr.id);
+        img.setQuantum(hdr.quantum);
+        img.setExternal((char*)img_buf,w,h);
+        last_id = hdr.id;
+        last_quantum = hdr.quantum;
+        last_width = w;
+        last_height = h;
+        last_buf = img_buf;
+    }
     return &img;
 }
@@ -170,8 +170,31 @@ public:
 class YARP_wire_rep_utils_API WireImage {
 private:
     yarp::sig::FlexImage img;
+    // format and buffer of the last image, the image header is set up
+    // again only when they change
+    int last_id;
+    int last_quantum;
+    int last_width;
+    int last_height;
+    const char *last_buf;
+    bool changed;
 public:
+    WireImage() :
+        last_id(0),
+        last_quantum(0),
+        last_width(0),
+        last_height(0),
+        last_buf(nullptr),
+        changed(true)
+    {}
+
     yarp::sig::FlexImage *checkForImage(yarp::os::SizedWriter& writer);
+
+    /**
+     * @return true if the format of the image found by the last call to
+     * checkForImage() differs from the one of the image before it
+     */
+    bool formatChanged() const { return changed; }
 };
 
 #endif
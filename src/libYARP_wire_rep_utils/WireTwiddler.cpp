@@ -193,6 +193,13 @@ int WireTwiddler::configure(Bottle& desc, int offset, bool& ignored,
         gap.load_external = loading;
         gap.computing = computing;
         gap.var_name = var;
+        if (loading && var.length()>0 && var[0]=='=') {
+            // constant value, parsed once here rather than for each message
+            Bottle b;
+            b.fromString(var.substr(1,var.length()));
+            gap.load_constant = true;
+            gap.load_value = b.get(0).asInt();
+        }
         Bottle tmp;
         tmp.copy(desc,start,offset-start-1);
         gap.origin = tmp.toString();
@@ -261,10 +268,62 @@ bool WireTwiddler::configure(const char *txt, const char *prompt) {
             gap.byte_length = 0;
         }
     }
+    compile();
     if (dbg_flag) show();
     return at == desc.size();
 }
 
+void WireTwiddler::compile() {
+    ops.clear();
+    for (int i=0; i<(int)gaps.size(); i++) {
+        const WireTwiddlerGap& gap = gaps[i];
+        // gaps without tags have nothing to translate from YARP
+        if (gap.buffer_length==0) continue;
+        WireTwiddlerOp check(WireTwiddlerOp::CHECK,gap.byte_length);
+        check.expected = gap.byte_start;
+        ops.push_back(check);
+        if (gap.unit_length==0) continue;
+        if (gap.length==-1 && gap.unit_length==-1) {
+            ops.push_back(WireTwiddlerOp(WireTwiddlerOp::PASS_STRINGS,-1));
+        } else if (gap.length==1 && gap.unit_length==-1) {
+            ops.push_back(WireTwiddlerOp(WireTwiddlerOp::PASS_STRING,-1));
+        } else if (gap.length==-1) {
+            if (gap.wire_unit_length==gap.unit_length) {
+                WireTwiddlerOp op(WireTwiddlerOp::PASS_VECTOR,-1);
+                op.unit_length = gap.unit_length;
+                ops.push_back(op);
+            } else {
+                WireTwiddlerOp op(WireTwiddlerOp::CONVERT_VECTOR,-1);
+                op.gap = i;
+                ops.push_back(op);
+            }
+        } else if (gap.unit_length!=gap.wire_unit_length && !(gap.length==1 && gap.unit_length==1)) {
+            WireTwiddlerOp op(WireTwiddlerOp::CONVERT,gap.length);
+            op.gap = i;
+            ops.push_back(op);
+        } else {
+            ops.push_back(WireTwiddlerOp(WireTwiddlerOp::PASS,gap.length*gap.unit_length));
+        }
+    }
+
+    // Group the steps of fixed length in runs
+    size_t i = 0;
+    while (i<ops.size()) {
+        size_t end = i;
+        int run_length = 0;
+        while (end<ops.size() && ops[end].isFixed()) {
+            ops[end].run_offset = run_length;
+            run_length += ops[end].length;
+            end++;
+        }
+        if (end>i+1) {
+            ops[i].run_length = run_length;
+            ops[i].run_end = (int)end;
+        }
+        i = (end>i) ? end : i+1;
+    }
+}
+
 std::string nameThatCode(int code) {
     switch (code) {
     case BOTTLE_TAG_INT:
@@ -416,12 +475,17 @@ void WireTwiddlerReader::compute(const WireTwiddlerGap& gap) {
         int w = prop.find("width").asInt();
         int h = prop.find("height").asInt();
         int step = prop.find("step").asInt();
+        ConstString encoding = prop.find("encoding").asString();
+        if (computed && w==computed_width && h==computed_height &&
+            step==computed_step && encoding==computed_encoding) {
+            // same format of the last image, the parameters are in prop
+            return;
+        }
         bool bigendian = prop.find("is_bigendian").asInt()==1;
         if (bigendian) {
             fprintf(stderr,"Sorry, cannot handle bigendian images yet.\n");
             std::exit(1);
         }
-        ConstString encoding = prop.find("encoding").asString();
         int bpp = 1;
         int translated_encoding = 0;
         switch (Vocab::encode(encoding)) {
@@ -489,6 +553,11 @@ void WireTwiddlerReader::compute(const WireTwiddlerGap& gap) {
         prop.put("img_size",img_size);
         prop.put("quantum",quantum);
         prop.put("translated_encoding",translated_encoding);
+        computed = true;
+        computed_width = w;
+        computed_height = h;
+        computed_step = step;
+        computed_encoding = encoding;
     }
 }
 
@@ -712,42 +781,50 @@ bool WireTwiddlerWriter::update() {
     dbg_printf("Parent headers %d blocks %d\n", (int)parent->headerLength(),
                (int)parent->length());
 
-    for (int i=0; i<twiddler->getGapCount(); i++) {
+    const std::vector<WireTwiddlerOp>& ops = twiddler->getOps();
+    size_t i = 0;
+    while (i<ops.size()) {
         if (errorState) return false;
-        ConstString item = "";
-        const WireTwiddlerGap& gap = twiddler->getGap(i);
-        if (gap.buffer_length!=0) {
-            dbg_printf("Skip %d bytes\n", gap.byte_length);
-            skip(gap.byte_start,gap.byte_length);
-            if (gap.unit_length!=0) {
-                dbg_printf("Length %d unit_length %d\n", gap.length,
-                           gap.unit_length);
-                if (gap.length==-1 && gap.unit_length==-1) {
-                    dbg_printf("Pass [4-byte length] [<length> instances of 4-byte-length bytes followed by specified number of bytes]\n");
-                    readLengthAndPass(-1);
-                } else if (gap.length==1&&gap.unit_length==1) {
-                    dbg_printf("Pass [%d bytes]\n", gap.unit_length);
-                    pass(gap.unit_length);
-                } else if (gap.length==1&&gap.unit_length==-1) {
-                    dbg_printf("Pass [4-byte length] [<length> bytes]\n");
-                    readLengthAndPass(1);
-                } else if (gap.length==-1) {
-                    dbg_printf("Pass [4-byte length] [<length>*%d bytes]\n", gap.unit_length);
-                    readLengthAndPass(gap.unit_length,&gap);
-                } else {
-                    dbg_printf("Pass [%d*%d bytes]\n", gap.length, gap.unit_length);
-                    if (gap.unit_length!=gap.wire_unit_length) {
-                        dbg_printf("Need to tweak length (not correct for neg numbers yet)...\n");
-                        for (int i=0; i<gap.length; i++) {
-                            if (errorState) return false;
-                            transform(gap);
-                        }
-                    } else {
-                        pass(gap.length*gap.unit_length);
-                    }
+        const WireTwiddlerOp& op = ops[i];
+        if (op.run_end>0 && applyRun(i)) {
+            continue;
+        }
+        switch (op.kind) {
+        case WireTwiddlerOp::CHECK:
+            dbg_printf("Skip %d bytes\n", op.length);
+            skip(op.expected,op.length);
+            break;
+        case WireTwiddlerOp::PASS:
+            dbg_printf("Pass [%d bytes]\n", op.length);
+            pass(op.length);
+            break;
+        case WireTwiddlerOp::PASS_VECTOR:
+            dbg_printf("Pass [4-byte length] [<length>*%d bytes]\n", op.unit_length);
+            readLengthAndPass(op.unit_length);
+            break;
+        case WireTwiddlerOp::PASS_STRING:
+            dbg_printf("Pass [4-byte length] [<length> bytes]\n");
+            readLengthAndPass(1);
+            break;
+        case WireTwiddlerOp::PASS_STRINGS:
+            dbg_printf("Pass [4-byte length] [<length> instances of 4-byte-length bytes followed by specified number of bytes]\n");
+            readLengthAndPass(-1);
+            break;
+        case WireTwiddlerOp::CONVERT:
+            dbg_printf("Convert [%d units]\n", op.length);
+            if (!convert(twiddler->getGap(op.gap),op.length)) return false;
+            break;
+        case WireTwiddlerOp::CONVERT_VECTOR:
+            {
+                dbg_printf("Convert [4-byte length] [<length> units]\n");
+                int len = readLength();
+                if (len>0 && !convert(twiddler->getGap(op.gap),len)) {
+                    return false;
                 }
             }
+            break;
         }
+        i++;
     }
     emit(nullptr, 0);
     dbg_printf("%d write blocks\n", (int)srcs.size());
@@ -760,6 +837,126 @@ bool WireTwiddlerWriter::update() {
 }
 
 
+bool WireTwiddlerWriter::loadBlock() {
+    // same walk of the blocks as advance()
+    while (true) {
+        if (blockPtr == nullptr) {
+            if (block>lastBlock) {
+                return false;
+            }
+            blockPtr = parent->data(block);
+            blockLen = parent->length(block);
+            offset = 0;
+        }
+        if (blockLen-offset>0) {
+            return true;
+        }
+        block++;
+        blockPtr = nullptr;
+    }
+}
+
+
+bool WireTwiddlerWriter::applyRun(size_t& index) {
+    // The whole run must be in the current block, otherwise its steps
+    // are applied one by one
+    const std::vector<WireTwiddlerOp>& ops = twiddler->getOps();
+    const WireTwiddlerOp& first = ops[index];
+    if (!loadBlock() || blockLen-offset<first.run_length) {
+        return false;
+    }
+    const char *base = blockPtr+offset;
+    // All the checks are made before anything is emitted, on a mismatch
+    // the steps are applied one by one and the check reports the error
+    for (int k=(int)index; k<first.run_end; k++) {
+        const WireTwiddlerOp& op = ops[k];
+        if (op.kind==WireTwiddlerOp::CHECK && op.length>0 &&
+                memcmp(base+op.run_offset,op.expected,op.length)!=0) {
+            return false;
+        }
+    }
+    for (int k=(int)index; k<first.run_end; k++) {
+        const WireTwiddlerOp& op = ops[k];
+        if (op.kind!=WireTwiddlerOp::CHECK && op.length>0) {
+            emit(base+op.run_offset,op.length);
+        }
+    }
+    offset += first.run_length;
+    index = first.run_end;
+    return true;
+}
+
+
+size_t WireTwiddlerWriter::remaining() {
+    // bytes of the message not read yet
+    size_t total = (blockPtr != nullptr) ? (size_t)(blockLen-offset) : 0;
+    int first = (blockPtr != nullptr) ? block+1 : block;
+    for (int i=first; i<=lastBlock; i++) {
+        total += parent->length(i);
+    }
+    return total;
+}
+
+
+bool WireTwiddlerWriter::gather(char *dest, int len) {
+    while (len>0) {
+        if (!loadBlock()) {
+            // the message is shorter than its format
+            showBrokenExpectation(0,0,0);
+            return false;
+        }
+        int rem = blockLen-offset;
+        if (rem>len) rem = len;
+        memcpy(dest,blockPtr+offset,rem);
+        dest += rem;
+        offset += rem;
+        len -= rem;
+    }
+    return true;
+}
+
+
+bool WireTwiddlerWriter::convert(const WireTwiddlerGap& gap, int count) {
+    // All the units are converted in the scratch buffer at once, the
+    // count comes from the message and must fit in what is left of it
+    if (count<0 || (size_t)count*gap.unit_length>remaining()) {
+        showBrokenExpectation(0,0,0);
+        return false;
+    }
+    size_t outLength = (size_t)count*gap.wire_unit_length;
+    if (scratchOffset+outLength>scratch.length()) {
+        scratch.allocateOnNeed(scratchOffset+outLength,scratchOffset+outLength);
+    }
+    char *out = scratch.get()+scratchOffset;
+    if (gap.wire_unit_length>gap.unit_length) {
+        int padding = gap.wire_unit_length-gap.unit_length;
+        for (int i=0; i<count; i++) {
+            if (!gather(out,gap.unit_length)) return false;
+            memset(out+gap.unit_length,0,padding);
+            out += gap.wire_unit_length;
+        }
+    } else if (gap.wire_unit_length==4 && gap.unit_length==8 &&
+               gap.flavor == BOTTLE_TAG_DOUBLE) {
+        size_t inLength = (size_t)count*gap.unit_length;
+        if (gathered.length()<inLength) {
+            gathered.allocate(inLength);
+        }
+        if (!gather(gathered.get(),inLength)) return false;
+        const NetFloat64 *x = (const NetFloat64 *)gathered.get();
+        NetFloat32 *y = (NetFloat32 *)out;
+        for (int i=0; i<count; i++) {
+            y[i] = (NetFloat32) x[i];
+        }
+    } else {
+        fprintf(stderr,"WireTwidder::transform needs to be extended to deal with this case\n");
+        ::exit(1);
+    }
+    bool ok = emitAt(nullptr,scratchOffset,outLength);
+    scratchOffset += outLength;
+    return ok;
+}
+
+
 bool WireTwiddlerWriter::skip(const char *start, int len) {
     activeCheck = start;
     return advance(len,false,false,true);
@@ -838,6 +1035,11 @@ bool WireTwiddlerWriter::advance(int length, bool shouldEmit,
     if (length<0) return false;
     while (length>0) {
         if (blockPtr == nullptr) {
+            if (block>lastBlock) {
+                // the message is shorter than its format
+                showBrokenExpectation(0,0,0);
+                return false;
+            }
             blockPtr = parent->data(block);
             blockLen = parent->length(block);
             dbg_printf("  block %d is at %ld, length %d\n",block,
@@ -848,9 +1050,6 @@ bool WireTwiddlerWriter::advance(int length, bool shouldEmit,
         if (rem==0) {
             block++;
             blockPtr = nullptr;
-            if (block>lastBlock) {
-                return false;
-            }
             dbg_printf("  moved on to block %d\n",block);
             continue;
         }
@@ -923,6 +1122,10 @@ bool WireTwiddlerWriter::emit(const char *src, int len) {
             activeGap = nullptr;
         }
     }
+    return emitAt(src,noffset,len);
+}
+
+bool WireTwiddlerWriter::emitAt(const char *src, int noffset, int len) {
     dbg_printf("  cache %ld len %d offset %d /// activeEmit %ld %d %d\n", (long int)src, len, noffset, (long int) activeEmit, activeEmitLength, activeEmitOffset);
     if (activeEmit != nullptr || activeEmitOffset >= 0) {
         bool push = false;
@@ -978,10 +1181,8 @@ YARP_SSIZE_T WireTwiddlerReader::readMapped(yarp::os::InputStream& is,
                                             const WireTwiddlerGap& gap) {
     if (gap.load_external) {
         int v = 0;
-        if (gap.var_name[0]=='=') {
-            Bottle b;
-            b.fromString(gap.var_name.substr(1,gap.var_name.length()));
-            v = b.get(0).asInt();
+        if (gap.load_constant) {
+            v = gap.load_value;
         } else {
             v = prop.find(gap.var_name).asInt();
         }
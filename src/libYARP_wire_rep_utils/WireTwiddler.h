@@ -36,6 +36,8 @@ public:
     bool save_external;
     bool load_external;
     bool computing;
+    bool load_constant;
+    int load_value;
     yarp::os::ConstString origin;
     yarp::os::ConstString var_name;
     int flavor;
@@ -51,6 +53,8 @@ public:
         save_external = false;
         load_external = false;
         computing = false;
+        load_constant = false;
+        load_value = 0;
         flavor = 0;
     }
 
@@ -63,6 +67,50 @@ public:
 };
 
 
+/**
+ * A step of the translation of a message from the YARP to the ROS wire
+ * format, compiled from the gaps by WireTwiddler::configure().
+ *
+ * Consecutive steps consuming a fixed number of bytes form a run, whose
+ * offsets are precomputed, so that a run falling in a single block of the
+ * message is applied without tracking the position step by step.
+ */
+class WireTwiddlerOp {
+public:
+    enum Kind {
+        CHECK,          // skip the YARP tags, checking they are as expected
+        PASS,           // pass a fixed number of bytes
+        PASS_VECTOR,    // pass a length, then <length>*unit_length bytes
+        PASS_STRING,    // pass a length, then <length> bytes
+        PASS_STRINGS,   // pass a length, then <length> strings
+        CONVERT,        // convert a fixed number of units
+        CONVERT_VECTOR  // pass a length, then convert <length> units
+    };
+
+    int kind;
+    int length;         // bytes consumed by CHECK and PASS, units by CONVERT
+    int unit_length;    // for PASS_VECTOR
+    const char *expected;   // for CHECK
+    int gap;            // index of the gap, for the conversions
+    int run_offset;     // offset of the step in its run
+    int run_length;     // on the first step of a run, bytes consumed by the run
+    int run_end;        // on the first step of a run, index of the step after it
+
+    WireTwiddlerOp(int kind, int length) {
+        this->kind = kind;
+        this->length = length;
+        unit_length = 0;
+        expected = nullptr;
+        gap = -1;
+        run_offset = 0;
+        run_length = 0;
+        run_end = 0;
+    }
+
+    bool isFixed() const { return kind==CHECK || kind==PASS; }
+};
+
+
 class YARP_wire_rep_utils_API WireTwiddler {
 public:
     WireTwiddler() {
@@ -91,6 +139,7 @@ private:
     int buffer_start;
     std::vector<yarp::os::NetInt32> buffer;
     std::vector<WireTwiddlerGap> gaps;
+    std::vector<WireTwiddlerOp> ops;
     yarp::os::ConnectionWriter *writer;
     yarp::os::ConstString prompt;
 
@@ -107,12 +156,23 @@ public:
         buffer_start = 0;
         buffer.clear();
         gaps.clear();
+        ops.clear();
     }
 
     const WireTwiddlerGap& getGap(int index) {
         return gaps[index];
     }
 
+    /**
+     * Compile the gaps into the steps applied by WireTwiddlerWriter.
+     * Called by configure().
+     */
+    void compile();
+
+    const std::vector<WireTwiddlerOp>& getOps() const {
+        return ops;
+    }
+
     yarp::os::ConstString toString() const;
 
     const yarp::os::ConstString& getPrompt() const {
@@ -149,10 +209,20 @@ private:
     int pending_string_data;
     yarp::os::ManagedBytes dump;
     yarp::os::Property prop;
+    // image parameters computed last time, they change rarely
+    bool computed;
+    int computed_width;
+    int computed_height;
+    int computed_step;
+    yarp::os::ConstString computed_encoding;
 public:
     WireTwiddlerReader(yarp::os::InputStream& is,
                        WireTwiddler& twiddler) : is(is),
-                                                 twiddler(twiddler) {
+                                                 twiddler(twiddler),
+                                                 computed(false),
+                                                 computed_width(0),
+                                                 computed_height(0),
+                                                 computed_step(0) {
         reset();
     }
 
@@ -214,6 +284,7 @@ private:
     yarp::os::Bytes lengthBytes;
     yarp::os::ManagedBytes zeros;
     yarp::os::ManagedBytes scratch;
+    yarp::os::ManagedBytes gathered;
     int accumOffset;
     const char *activeEmit;
     const WireTwiddlerGap *activeGap;
@@ -228,6 +299,13 @@ private:
     void showBrokenExpectation(const yarp::os::NetInt32& expected,
                                const yarp::os::NetInt32& received,
                                int evidence);
+
+    bool loadBlock();
+    size_t remaining();
+    bool gather(char *dest, int len);
+    bool applyRun(size_t& index);
+    bool convert(const WireTwiddlerGap& gap, int count);
+    bool emitAt(const char *src, int noffset, int len);
 public:
     WireTwiddlerWriter(yarp::os::SizedWriter& parent,
                        WireTwiddler& twiddler) :
@@ -243,6 +321,7 @@ public:
         lengthBytes(),
         zeros(0),
         scratch(0),
+        gathered(0),
         accumOffset(0),
         activeEmit(nullptr),
         activeGap(nullptr),
@@ -270,6 +349,7 @@ public:
         lengthBytes(),
         zeros(0),
         scratch(0),
+        gathered(0),
         accumOffset(0),
         activeEmit(nullptr),
         activeGap(nullptr),
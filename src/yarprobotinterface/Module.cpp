@@ -74,6 +74,7 @@ bool RobotInterface::Module::configure(yarp::os::ResourceFinder &rf)
 
     mPriv->robot.setVerbose(rf.check("verbose"));
     mPriv->robot.setAllowDeprecatedDevices(rf.check("allow-deprecated-devices"));
+    mPriv->robot.setParallelism(rf.check("parallel", yarp::os::Value(1)).asInt());
 
     yarp::os::ConstString rpcPortName("/" + getName() + "/yarprobotinterface");
     mPriv->rpcPort.open(rpcPortName);
@@ -11,6 +11,10 @@
 #include "Param.h"
 
 #include <yarp/os/LogStream.h>
+#include <yarp/os/Mutex.h>
+#include <yarp/os/Semaphore.h>
+#include <yarp/os/SystemClock.h>
+#include <yarp/os/Thread.h>
 
 #include <yarp/dev/PolyDriver.h>
 #include <yarp/dev/PolyDriverList.h>
@@ -18,6 +22,162 @@
 #include <string>
 #include <iostream>
 #include <algorithm>
+#include <deque>
+#include <functional>
+#include <set>
+
+
+namespace {
+
+// A job for the worker pool, started when all the tasks it depends on are
+// finished
+struct Task
+{
+    Task(const std::string &n, const std::function<bool()> &f) :
+            name(n),
+            job(f),
+            waiting(0),
+            result(false),
+            time(0.0)
+    {
+    }
+
+    std::string name;
+    std::function<bool()> job;
+    std::vector<size_t> dependents; // tasks waiting for this one
+    int waiting;                    // unfinished tasks this one depends on
+    bool result;
+    double time;                    // seconds spent running the job
+};
+
+class TaskPool
+{
+public:
+    TaskPool(std::vector<Task> &tasks) :
+            tasks(tasks),
+            available(0),
+            finished(0),
+            done(0)
+    {
+    }
+
+    // return false if the dependencies have a cycle
+    bool isAcyclic() const
+    {
+        std::vector<int> waiting(tasks.size());
+        std::vector<size_t> ready;
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            waiting[i] = tasks[i].waiting;
+            if (waiting[i] == 0) {
+                ready.push_back(i);
+            }
+        }
+        size_t count = 0;
+        while (!ready.empty()) {
+            size_t i = ready.back();
+            ready.pop_back();
+            ++count;
+            for (size_t d : tasks[i].dependents) {
+                if (--waiting[d] == 0) {
+                    ready.push_back(d);
+                }
+            }
+        }
+        return count == tasks.size();
+    }
+
+    // run all the tasks on the given number of threads, return false if
+    // any of them failed
+    bool run(int workers)
+    {
+        if (tasks.empty()) {
+            return true;
+        }
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            if (tasks[i].waiting == 0) {
+                ready.push_back(i);
+                available.post();
+            }
+        }
+
+        if (workers > (int)tasks.size()) {
+            workers = (int)tasks.size();
+        }
+        std::vector<Worker*> threads;
+        for (int i = 0; i < workers; ++i) {
+            threads.push_back(new Worker(*this));
+            threads.back()->start();
+        }
+
+        finished.wait();
+
+        // wake up the workers with an empty queue, so that they exit
+        for (size_t i = 0; i < threads.size(); ++i) {
+            available.post();
+        }
+        for (size_t i = 0; i < threads.size(); ++i) {
+            threads[i]->join();
+            delete threads[i];
+        }
+
+        bool ret = true;
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            ret = ret && tasks[i].result;
+        }
+        return ret;
+    }
+
+private:
+    class Worker : public yarp::os::Thread
+    {
+    public:
+        Worker(TaskPool &pool) : pool(pool) {}
+        virtual void run() override { pool.work(); }
+    private:
+        TaskPool &pool;
+    };
+
+    void work()
+    {
+        while (true) {
+            available.wait();
+            mutex.lock();
+            if (ready.empty()) {
+                mutex.unlock();
+                return;
+            }
+            size_t i = ready.front();
+            ready.pop_front();
+            mutex.unlock();
+
+            Task &task = tasks[i];
+            double start = yarp::os::SystemClock::nowSystem();
+            task.result = task.job();
+            task.time = yarp::os::SystemClock::nowSystem() - start;
+
+            mutex.lock();
+            for (size_t d : task.dependents) {
+                if (--tasks[d].waiting == 0) {
+                    ready.push_back(d);
+                    available.post();
+                }
+            }
+            if (++done == tasks.size()) {
+                finished.post();
+            }
+            mutex.unlock();
+        }
+    }
+
+    std::vector<Task> &tasks;
+    std::deque<size_t> ready;
+    yarp::os::Mutex mutex;
+    yarp::os::Semaphore available;
+    yarp::os::Semaphore finished;
+    size_t done;
+};
+
+} // namespace
 
 
 std::ostringstream& operator<<(std::ostringstream &oss, const RobotInterface::Robot &t)
@@ -44,7 +204,8 @@ public:
     Private(Robot * /*parent*/) :
             build(0),
                 currentPhase(ActionPhaseUnknown),
-        currentLevel(0)
+        currentLevel(0),
+        parallelism(1)
     {
     }
 
@@ -60,6 +221,18 @@ public:
     // close all the devices and return true if all the close calls were succesful
     bool closeDevices();
 
+    // return the names of the devices that the actions of a device refer to
+    std::set<std::string> getDependencies(const Device &device) const;
+
+    // build one task per device, each one after the devices it depends on
+    // (or before them, if reverse is true). Return false if the
+    // dependencies have a cycle
+    bool buildDeviceTasks(std::vector<Task> &tasks, bool reverse, const std::function<bool(Device&)> &job);
+
+    // run the tasks on the given number of threads, as allowed by their
+    // dependencies, and return true if all of them were succesful
+    bool runTasks(std::vector<Task> &tasks, int threads);
+
     // return a vector of levels that have actions in the requested phase
     std::vector<unsigned int> getLevels(ActionPhase phase) const;
 
@@ -95,6 +268,7 @@ public:
     DeviceList devices;
     RobotInterface::ActionPhase currentPhase;
     unsigned int currentLevel;
+    int parallelism;
 }; // class RobotInterface::Robot::Private
 
 bool RobotInterface::Robot::Private::hasDevice(const std::string &name) const
@@ -118,20 +292,109 @@ RobotInterface::Device* RobotInterface::Robot::Private::findDevice(const std::st
     return nullptr;
 }
 
-bool RobotInterface::Robot::Private::openDevices()
+std::set<std::string> RobotInterface::Robot::Private::getDependencies(const RobotInterface::Device &device) const
 {
-    bool ret = true;
-    for (RobotInterface::DeviceList::iterator it = devices.begin(); it != devices.end(); ++it) {
-        RobotInterface::Device &device = *it;
+    std::set<std::string> deps;
+    for (ActionList::const_iterator ait = device.actions().begin(); ait != device.actions().end(); ++ait) {
+        const ParamList &params = ait->params();
+        if (RobotInterface::hasParam(params, "device")) {
+            deps.insert(RobotInterface::findParam(params, "device"));
+        }
+        if (RobotInterface::hasParam(params, "target")) {
+            deps.insert(RobotInterface::findParam(params, "target"));
+        }
+        if (RobotInterface::hasParam(params, "networks")) {
+            yarp::os::Value v;
+            v.fromString(RobotInterface::findParam(params, "networks").c_str());
+            yarp::os::Bottle *targetNetworks = v.asList();
+            for (int i = 0; targetNetworks && i < targetNetworks->size(); ++i) {
+                std::string targetNetwork = targetNetworks->get(i).toString().c_str();
+                if (RobotInterface::hasParam(params, targetNetwork)) {
+                    deps.insert(RobotInterface::findParam(params, targetNetwork));
+                }
+            }
+        }
+        if (RobotInterface::hasParam(params, "all")) {
+            for (DeviceList::const_iterator dit = devices.begin(); dit != devices.end(); ++dit) {
+                deps.insert(dit->name());
+            }
+        }
+    }
+    deps.erase(device.name());
+    return deps;
+}
 
-        // yDebug() << device;
+bool RobotInterface::Robot::Private::buildDeviceTasks(std::vector<Task> &tasks, bool reverse, const std::function<bool(Device&)> &job)
+{
+    tasks.clear();
+    tasks.reserve(devices.size());
+    for (DeviceList::iterator it = devices.begin(); it != devices.end(); ++it) {
+        Device *device = &(*it);
+        tasks.push_back(Task(device->name(), [device, job]() { return job(*device); }));
+    }
+
+    for (size_t i = 0; i < devices.size(); ++i) {
+        std::set<std::string> deps = getDependencies(devices[i]);
+        for (size_t j = 0; j < devices.size(); ++j) {
+            if (deps.count(devices[j].name()) == 0) {
+                continue;
+            }
+            // device i uses device j: open j before i, close i before j
+            size_t first = reverse ? i : j;
+            size_t second = reverse ? j : i;
+            tasks[first].dependents.push_back(second);
+            ++tasks[second].waiting;
+        }
+    }
+
+    return TaskPool(tasks).isAcyclic();
+}
 
+bool RobotInterface::Robot::Private::runTasks(std::vector<Task> &tasks, int threads)
+{
+    if (threads <= 1 || tasks.size() <= 1) {
+        bool ret = true;
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            double start = yarp::os::SystemClock::nowSystem();
+            tasks[i].result = tasks[i].job();
+            tasks[i].time = yarp::os::SystemClock::nowSystem() - start;
+            ret = ret && tasks[i].result;
+        }
+        return ret;
+    }
+    return TaskPool(tasks).run(threads);
+}
+
+bool RobotInterface::Robot::Private::openDevices()
+{
+    // Devices are opened in parallel, except that a device is opened after
+    // the devices that its actions refer to (attach, calibrate, park).
+    // Without threads, or with a cycle, they are opened in the xml order.
+    std::vector<Task> tasks;
+    auto open = [](RobotInterface::Device &device) {
+        // yDebug() << device;
         if (!device.open()) {
             yWarning() << "Cannot open device" << device.name();
-            ret = false;
+            return false;
         }
+        return true;
+    };
+
+    int threads = parallelism;
+    if (!buildDeviceTasks(tasks, false, open)) {
+        yWarning() << "The devices depend on each other in a cycle, opening them one after the other";
+        threads = 1;
+    }
+
+    double start = yarp::os::SystemClock::nowSystem();
+    bool ret = runTasks(tasks, threads);
+    double total = yarp::os::SystemClock::nowSystem() - start;
 
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        yInfo() << "Device" << tasks[i].name << (tasks[i].result ? "opened in" : "failed opening in") << tasks[i].time << "s";
     }
+    yInfo() << "Opening" << tasks.size() << "devices took" << total << "s";
+
     if (ret) {
         // yDebug() << "All devices opened.";
     } else {
@@ -143,18 +406,38 @@ bool RobotInterface::Robot::Private::openDevices()
 
 bool RobotInterface::Robot::Private::closeDevices()
 {
-    bool ret = true;
-    for (RobotInterface::DeviceList::reverse_iterator it = devices.rbegin(); it != devices.rend(); ++it) {
-        RobotInterface::Device &device = *it;
-
+    // Devices are closed in parallel, a device only after all the devices
+    // using it are closed. With a cycle, they are closed in the reverse
+    // xml order.
+    std::vector<Task> tasks;
+    auto close = [](RobotInterface::Device &device) {
         // yDebug() << device;
-
         if (!device.close()) {
             yWarning() << "Cannot close device" << device.name();
-            ret = false;
+            return false;
         }
+        return true;
+    };
 
+    int threads = parallelism;
+    if (!buildDeviceTasks(tasks, true, close)) {
+        yWarning() << "The devices depend on each other in a cycle, closing them one after the other";
+        threads = 1;
     }
+
+    if (threads <= 1) {
+        // one after the other, the last opened first
+        std::reverse(tasks.begin(), tasks.end());
+    }
+    double start = yarp::os::SystemClock::nowSystem();
+    bool ret = runTasks(tasks, threads);
+    double total = yarp::os::SystemClock::nowSystem() - start;
+
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        yInfo() << "Device" << tasks[i].name << (tasks[i].result ? "closed in" : "failed closing in") << tasks[i].time << "s";
+    }
+    yInfo() << "Closing" << tasks.size() << "devices took" << total << "s";
+
     if (ret) {
         // yDebug() << "All devices closed.";
     } else {
@@ -379,6 +662,7 @@ RobotInterface::Robot::Robot(const RobotInterface::Robot& other) :
     mPriv->portprefix = other.mPriv->portprefix;
     mPriv->currentPhase = other.mPriv->currentPhase;
     mPriv->currentLevel = other.mPriv->currentLevel;
+    mPriv->parallelism = other.mPriv->parallelism;
     mPriv->devices = other.mPriv->devices;
     mPriv->params = other.mPriv->params;
 }
@@ -391,6 +675,7 @@ RobotInterface::Robot& RobotInterface::Robot::operator=(const RobotInterface::Ro
         mPriv->portprefix = other.mPriv->portprefix;
         mPriv->currentPhase = other.mPriv->currentPhase;
         mPriv->currentLevel = other.mPriv->currentLevel;
+        mPriv->parallelism = other.mPriv->parallelism;
 
         mPriv->devices.clear();
         mPriv->devices = other.mPriv->devices;
@@ -434,6 +719,11 @@ void RobotInterface::Robot::setVerbose(bool verbose)
     }
 }
 
+void RobotInterface::Robot::setParallelism(int threads)
+{
+    mPriv->parallelism = threads;
+}
+
 void RobotInterface::Robot::setAllowDeprecatedDevices(bool allowDeprecatedDevices)
 {
     for (DeviceList::iterator dit = devices().begin(); dit != devices().end(); ++dit) {
@@ -561,6 +851,19 @@ bool RobotInterface::Robot::enterPhase(RobotInterface::ActionPhase phase)
 
         std::vector<std::pair<Device, Action> > actions = mPriv->getActions(phase, level);
 
+        // Consecutive attach and detach actions, each on its own wrapper,
+        // are run in parallel. The other actions are run in order, after
+        // the attach and detach actions before them.
+        std::vector<Task> batch;
+        std::vector<std::set<std::string> > batchDependencies;
+        auto runBatch = [this, &batch, &batchDependencies, &ret]() {
+            if (!mPriv->runTasks(batch, mPriv->parallelism)) {
+                ret = false;
+            }
+            batch.clear();
+            batchDependencies.clear();
+        };
+
         for (std::vector<std::pair<Device, Action> >::iterator ait = actions.begin(); ait != actions.end(); ++ait) {
             // for each action in that level
             Device &device = ait->first;
@@ -573,6 +876,41 @@ bool RobotInterface::Robot::enterPhase(RobotInterface::ActionPhase phase)
                 break;
             }
 
+            if (action.type() == ActionTypeAttach) {
+                batch.push_back(Task(device.name(), [this, &device, &action]() {
+                    if (!mPriv->attach(device, action.params())) {
+                        yError() << "Cannot run attach action on device" << device.name();
+                        return false;
+                    }
+                    return true;
+                }));
+            } else if (action.type() == ActionTypeDetach) {
+                batch.push_back(Task(device.name(), [this, &device, &action]() {
+                    if (!mPriv->detach(device, action.params())) {
+                        yError() << "Cannot run detach action on device" << device.name();
+                        return false;
+                    }
+                    return true;
+                }));
+            }
+            if (action.type() == ActionTypeAttach || action.type() == ActionTypeDetach) {
+                // the actions on the same device, or on devices depending
+                // on each other (e.g. a wrapper attached to a remapper
+                // attached in the same level), stay in the xml order
+                batchDependencies.push_back(mPriv->getDependencies(device));
+                const std::set<std::string> &deps = batchDependencies.back();
+                for (size_t k = 0; k + 1 < batch.size(); ++k) {
+                    if (batch[k].name == device.name() ||
+                            deps.count(batch[k].name) != 0 ||
+                            batchDependencies[k].count(device.name()) != 0) {
+                        batch[k].dependents.push_back(batch.size() - 1);
+                        ++batch.back().waiting;
+                    }
+                }
+                continue;
+            }
+            runBatch();
+
             switch (action.type()) {
             case ActionTypeConfigure:
                 if(!mPriv->configure(device, action.params())) {
@@ -586,24 +924,12 @@ bool RobotInterface::Robot::enterPhase(RobotInterface::ActionPhase phase)
                     ret = false;
                 }
                 break;
-            case ActionTypeAttach:
-                if (!mPriv->attach(device, action.params())) {
-                    yError() << "Cannot run attach action on device" << device.name();
-                    ret = false;
-                }
-                break;
             case ActionTypeAbort:
                 if(!mPriv->abort(device, action.params())) {
                     yError() << "Cannot run abort action on device" << device.name();
                     ret = false;
                 }
                 break;
-            case ActionTypeDetach:
-                if (!mPriv->detach(device, action.params())) {
-                    yError() << "Cannot run detach action on device" << device.name();
-                    ret = false;
-                }
-                break;
             case ActionTypePark:
                 if (!mPriv->park(device, action.params())) {
                     yError() << "Cannot run park action on device" << device.name();
@@ -622,6 +948,7 @@ bool RobotInterface::Robot::enterPhase(RobotInterface::ActionPhase phase)
                 break;
             }
         }
+        runBatch();
 
         yInfo() << "All actions for action level" << level << "of" << ActionPhaseToString(phase) << "phase started. Waiting for unfinished actions.";
 
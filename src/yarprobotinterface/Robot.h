@@ -30,6 +30,10 @@ public:
     void setVerbose(bool verbose);
     void setAllowDeprecatedDevices(bool allowDeprecatedDevices);
 
+    // number of threads opening, closing, attaching and detaching the
+    // devices (1 to do it sequentially in the xml order)
+    void setParallelism(int threads);
+
     ParamList& params();
     DeviceList& devices();
     Device& device(const std::string &name);
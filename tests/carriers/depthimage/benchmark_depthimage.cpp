@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2018 Istituto Italiano di Tecnologia (IIT)
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ *
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include <yarp/os/all.h>
+#include <yarp/sig/all.h>
+
+#include <DepthImage.h>
+
+using namespace yarp::os;
+using namespace yarp::sig;
+
+// The conversion loop used before the row kernel, kept as reference.
+static void legacyConvert(ImageOf<PixelFloat>& img, FlexImage& outImg, double min, double max)
+{
+    outImg.setPixelCode(VOCAB_PIXEL_MONO);
+    outImg.setPixelSize(1);
+    outImg.resize(img.width(), img.height());
+
+    outImg.zero();
+    float *inPixels = (float *)img.getRawImage();
+    unsigned char *pixels = outImg.getRawImage();
+    for(int h=0; h<img.height(); h++)
+    {
+        for(int w=0; w<img.width(); w++)
+        {
+            float inVal = inPixels[w + (h * img.width())];
+            if (inVal != inVal /* NaN */ || inVal < min || inVal > max) {
+                pixels[w + (h * (img.width() ))] = 0;
+            } else {
+                int val = (int) (255.0 - (inVal * 255.0 / (max - min)));
+                if(val >= 255)
+                    val = 255;
+                if(val <= 0)
+                    val = 0;
+                pixels[w + (h * (img.width() ))] = (char) val;
+            }
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    Network yarp;
+
+    Property options;
+    options.fromCommand(argc,argv);
+    int width = options.check("width",Value(1280)).asInt();
+    int height = options.check("height",Value(720)).asInt();
+    int frames = options.check("frames",Value(300)).asInt();
+
+    ImageOf<PixelFloat> depth;
+    depth.resize(width, height);
+    srand(0);
+    for (int r=0; r<height; r++) {
+        for (int c=0; c<width; c++) {
+            int v = rand() % 1100;
+            depth(c, r) = (v > 1050) ? NAN : v / 100.0f;
+        }
+    }
+
+    FlexImage legacy;
+    double start = Time::now();
+    for (int i=0; i<frames; i++) {
+        legacyConvert(depth, legacy, 0.2, 10.0);
+    }
+    double legacyTime = (Time::now() - start) / frames;
+
+    DepthImageConverter converter;
+    Property create;
+    converter.create(create);
+    Things thing;
+    thing.setPortWriter(&depth);
+    if (!converter.accept(thing)) {
+        fprintf(stderr, "Depth image not accepted\n");
+        return 1;
+    }
+    start = Time::now();
+    Things* result = nullptr;
+    for (int i=0; i<frames; i++) {
+        result = &converter.update(thing);
+    }
+    double monoTime = (Time::now() - start) / frames;
+
+    // check against the reference, allowing one level of difference
+    // because of the single precision scale
+    FlexImage* mono = result->cast_as<FlexImage>();
+    int mismatches = 0;
+    for (int r=0; r<height; r++) {
+        for (int c=0; c<width; c++) {
+            int a = legacy.getPixelAddress(c, r)[0];
+            int b = mono->getPixelAddress(c, r)[0];
+            if (std::abs(a-b) > 1) {
+                mismatches++;
+            }
+        }
+    }
+
+    Property params;
+    params.put("colormap", "turbo");
+    converter.setparam(params);
+    start = Time::now();
+    for (int i=0; i<frames; i++) {
+        converter.update(thing);
+    }
+    double colorTime = (Time::now() - start) / frames;
+    converter.destroy();
+
+    printf("%dx%d depth image, %d frames\n", width, height, frames);
+    printf("  legacy loop:        %.3f [ms]\n", legacyTime * 1000);
+    printf("  row kernel (mono):  %.3f [ms]\n", monoTime * 1000);
+    printf("  row kernel (turbo): %.3f [ms]\n", colorTime * 1000);
+    printf("  mismatching pixels: %d\n", mismatches);
+
+    return (mismatches == 0) ? 0 : 1;
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2018 Istituto Italiano di Tecnologia (IIT)
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ *
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <yarp/os/all.h>
+#include <yarp/sig/all.h>
+
+#include <MjpegCompression.h>
+#include <MjpegDecompression.h>
+
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace yarp::mjpeg;
+
+// Benchmark of the compression of the mjpeg carrier: a compressor created
+// for each frame (as done so far), a persistent one, and the parallel
+// compression in bands. The band compressed images are checked to decode
+// as the plain ones.
+//
+// Parameters:
+// --width, --height: size of the rgb image (default 1920x1080)
+// --frames: number of compressed frames (default 100)
+// --quality: jpeg quality (default 75)
+
+static bool decode(const std::vector<unsigned char>& jpeg, ImageOf<PixelRgb>& img)
+{
+    MjpegDecompression decompression;
+    Bytes b((char*)jpeg.data(), jpeg.size());
+    return decompression.decompress(b, img);
+}
+
+int main(int argc, char *argv[])
+{
+    Network yarp;
+
+    Property p;
+    p.fromCommand(argc, argv);
+    int width = p.check("width", Value(1920)).asInt();
+    int height = p.check("height", Value(1080)).asInt();
+    int frames = p.check("frames", Value(100)).asInt();
+    int quality = p.check("quality", Value(75)).asInt();
+
+    // a smooth pattern with some detail, not too easy to compress
+    ImageOf<PixelRgb> img;
+    img.resize(width, height);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            PixelRgb& px = img.pixel(x, y);
+            px.r = (unsigned char)(x + y);
+            px.g = (unsigned char)((x * y) >> 6);
+            px.b = (unsigned char)((x ^ y) & 0xf0);
+        }
+    }
+
+    std::vector<unsigned char> jpeg;
+    double t = SystemClock::nowSystem();
+    for (int i = 0; i < frames; i++) {
+        MjpegCompression compression;
+        compression.setQuality(quality);
+        compression.compress(img, "", jpeg);
+    }
+    t = SystemClock::nowSystem() - t;
+    printf("%-24s %8.2f ms/frame  %8zu bytes\n", "new compressor:", t / frames * 1000, jpeg.size());
+
+    ImageOf<PixelRgb> reference;
+    MjpegCompression compression;
+    compression.setQuality(quality);
+    int bands[] = { 1, 2, 4, 8 };
+    for (size_t k = 0; k < sizeof(bands) / sizeof(bands[0]); k++) {
+        compression.setBands(bands[k]);
+        t = SystemClock::nowSystem();
+        for (int i = 0; i < frames; i++) {
+            if (!compression.compress(img, "", jpeg)) {
+                printf("Compression failed\n");
+                return 1;
+            }
+        }
+        t = SystemClock::nowSystem() - t;
+        ImageOf<PixelRgb> decoded;
+        if (!decode(jpeg, decoded)) {
+            printf("Decompression failed with %d bands\n", bands[k]);
+            return 1;
+        }
+        if (k == 0) {
+            reference.copy(decoded);
+        } else if (decoded.width() != reference.width() || decoded.height() != reference.height() ||
+                memcmp(decoded.getRawImage(), reference.getRawImage(), reference.getRawImageSize()) != 0) {
+            printf("Image compressed in %d bands decodes differently\n", bands[k]);
+            return 1;
+        }
+        char name[64];
+        sprintf(name, "persistent, %d band%s:", bands[k], bands[k] > 1 ? "s" : "");
+        printf("%-24s %8.2f ms/frame  %8zu bytes\n", name, t / frames * 1000, jpeg.size());
+    }
+    return 0;
+}
@@ -0,0 +1,207 @@
+/*
+ * Copyright (C) 2018 Istituto Italiano di Tecnologia (IIT)
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ *
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include <yarp/os/all.h>
+#include <yarp/os/InputStream.h>
+#include <yarp/os/OutputStream.h>
+#include <yarp/os/StringOutputStream.h>
+#include <yarp/sig/all.h>
+
+#include <WireImage.h>
+#include <WireTwiddler.h>
+
+using namespace yarp::os;
+using namespace yarp::sig;
+
+// Benchmark of the translation done by the tcpros carrier between the
+// YARP and the ROS wire formats, for sensor_msgs/JointState (through
+// WireTwiddler in both directions) and sensor_msgs/Image (WireImage and
+// RosWireImage towards ROS, WireTwiddler from ROS).
+//
+// Parameters:
+// --joints: number of joints of the JointState (default 30)
+// --width, --height: size of the rgb image (default 640x480)
+// --iterations: number of translated messages (default 20000)
+
+// Description of sensor_msgs/JointState, as given by yarpidl_rosmsg
+static const char *jointStateKind =
+    "list 5 list 3 uint32 * vector uint32 2 * string * vector string * vector float64 * vector float64 * vector float64 *";
+
+// Description of sensor_msgs/Image, as in TcpRosStream::rosToKind()
+static const char *imageKind =
+    "list 4 skip uint32 * skip uint32 * skip uint32 * skip string *    >height uint32 * >width uint32 * >encoding string * skip int8 * >step int32 *  compute image_params    <=[mat] vocab * <translated_encoding vocab * item_vector int32 5 <depth item * <img_size item * <quantum item * <width item * <height item * blob *";
+
+// Discards the data, as the socket would take it
+class NullOutputStream : public OutputStream
+{
+public:
+    size_t total;
+    NullOutputStream() : total(0) {}
+    using OutputStream::write;
+    virtual void write(const Bytes& b) override { total += b.length(); }
+    virtual void close() override {}
+    virtual bool isOk() override { return true; }
+};
+
+// Reads a message from memory, as the socket would give it
+class MemoryInputStream : public InputStream
+{
+public:
+    MemoryInputStream() : data(nullptr), len(0), at(0) {}
+    void reset(const std::string& str) { data = str.c_str(); len = str.length(); at = 0; }
+    using InputStream::read;
+    virtual YARP_SSIZE_T read(const Bytes& b) override
+    {
+        size_t n = b.length();
+        if (n > len - at) n = len - at;
+        memcpy(b.get(), data + at, n);
+        at += n;
+        return (YARP_SSIZE_T)n;
+    }
+    virtual void close() override {}
+    virtual bool isOk() override { return true; }
+private:
+    const char *data;
+    size_t len;
+    size_t at;
+};
+
+// The translations towards ROS do not copy the payload, so the time per
+// message is reported together with the message size rather than as a rate
+static void report(const char *name, double t, int iterations, size_t bytes)
+{
+    printf("%-24s %8.2f us/msg  (%zu bytes/msg)\n", name, t / iterations * 1e6,
+           bytes / iterations);
+}
+
+int main(int argc, char *argv[])
+{
+    Property p;
+    p.fromCommand(argc, argv);
+    int joints = p.check("joints", Value(30)).asInt();
+    int width = p.check("width", Value(640)).asInt();
+    int height = p.check("height", Value(480)).asInt();
+    int iterations = p.check("iterations", Value(20000)).asInt();
+
+    // JointState, YARP to ROS
+    Bottle js;
+    Bottle& header = js.addList();
+    header.addInt(42);
+    Bottle& stamp = header.addList();
+    stamp.addInt(1000);
+    stamp.addInt(500);
+    header.addString("/base");
+    Bottle& names = js.addList();
+    Bottle& pos = js.addList();
+    Bottle& vel = js.addList();
+    Bottle& eff = js.addList();
+    for (int i = 0; i < joints; i++) {
+        names.addString("joint_" + std::to_string(i));
+        pos.addDouble(i * 0.1);
+        vel.addDouble(i * 0.2);
+        eff.addDouble(i * 0.3);
+    }
+
+    WireTwiddler jsTwiddler;
+    jsTwiddler.configure(jointStateKind, "sensor_msgs/JointState");
+    ConnectionWriter *jsWriter = ConnectionWriter::createBufferedConnectionWriter();
+    js.write(*jsWriter);
+    SizedWriter *jsBuf = jsWriter->getBuffer();
+
+    WireTwiddlerWriter jsOutput;
+    NullOutputStream null;
+    double t = SystemClock::nowSystem();
+    for (int i = 0; i < iterations; i++) {
+        jsOutput.attach(*jsBuf, jsTwiddler);
+        jsOutput.write(null);
+    }
+    t = SystemClock::nowSystem() - t;
+    if (null.total == 0) {
+        printf("JointState translation failed\n");
+        return 1;
+    }
+    report("JointState to ROS:", t, iterations, null.total);
+
+    // JointState, ROS to YARP
+    StringOutputStream rosJs;
+    jsOutput.attach(*jsBuf, jsTwiddler);
+    jsOutput.write(rosJs);
+    std::string rosJsBytes = rosJs.toString();
+
+    MemoryInputStream mis;
+    Bottle jsIn;
+    t = SystemClock::nowSystem();
+    for (int i = 0; i < iterations; i++) {
+        mis.reset(rosJsBytes);
+        WireTwiddlerReader reader(mis, jsTwiddler);
+        ConnectionReader::readFromStream(jsIn, reader);
+    }
+    t = SystemClock::nowSystem() - t;
+    if (jsIn != js) {
+        printf("JointState read back as %s\n", jsIn.toString().c_str());
+        return 1;
+    }
+    report("JointState from ROS:", t, iterations, rosJsBytes.length() * iterations);
+
+    // Image, YARP to ROS
+    ImageOf<PixelRgb> img;
+    img.resize(width, height);
+    for (int i = 0; i < img.getRawImageSize(); i++) {
+        img.getRawImage()[i] = (unsigned char)i;
+    }
+    ConnectionWriter *imgWriter = ConnectionWriter::createBufferedConnectionWriter();
+    img.write(*imgWriter);
+    SizedWriter *imgBuf = imgWriter->getBuffer();
+
+    WireImage wi;
+    RosWireImage ri;
+    FlexImage *flex = wi.checkForImage(*imgBuf);
+    if (flex == nullptr) {
+        printf("Image not recognized\n");
+        return 1;
+    }
+    ri.init(*flex, "/frame");
+    int imgIterations = iterations / 10 + 1;
+    null.total = 0;
+    t = SystemClock::nowSystem();
+    for (int i = 0; i < imgIterations; i++) {
+        flex = wi.checkForImage(*imgBuf);
+        ri.update(flex, i, 0.0);
+        ri.write(null);
+    }
+    t = SystemClock::nowSystem() - t;
+    report("Image to ROS:", t, imgIterations, null.total);
+
+    // Image, ROS to YARP
+    StringOutputStream rosImg;
+    ri.write(rosImg);
+    std::string rosImgBytes = rosImg.toString();
+
+    WireTwiddler imgTwiddler;
+    imgTwiddler.configure(imageKind, "sensor_msgs/Image");
+    FlexImage imgIn;
+    t = SystemClock::nowSystem();
+    for (int i = 0; i < imgIterations; i++) {
+        mis.reset(rosImgBytes);
+        WireTwiddlerReader reader(mis, imgTwiddler);
+        ConnectionReader::readFromStream(imgIn, reader);
+    }
+    t = SystemClock::nowSystem() - t;
+    if (imgIn.width() != width || imgIn.height() != height ||
+            memcmp(imgIn.getRawImage(), img.getRawImage(), img.getRawImageSize()) != 0) {
+        printf("Image read back as %dx%d\n", imgIn.width(), imgIn.height());
+        return 1;
+    }
+    report("Image from ROS:", t, imgIterations, rosImgBytes.length() * imgIterations);
+
+    delete jsWriter;
+    delete imgWriter;
+    return 0;
+}
@@ -11,6 +11,8 @@
 #include <yarp/os/impl/UnitTest.h>
 #include <yarp/os/NetType.h>
 #include <cstdio>
+#include <cstring>
+#include <vector>
 
 using namespace yarp::os::impl;
 using namespace yarp::os;
@@ -98,6 +100,32 @@ public:
         }
     }
 
+    // Change a field of the header of a fragment with forward error
+    // correction, and update its checksum
+    void forgeFec(int index, int field, int value) {
+        char *buf = store[index].get();
+        Bytes b(buf+8+4*field, 4);
+        NetType::netInt(value, b);
+        Bytes crc(buf, 4);
+        Bytes pct(buf+4, 4);
+        size_t len = store[index].length()-8;
+        bool crc32c = (NetType::netInt(pct)&0x40000000)!=0;
+        NetType::netInt(crc32c ? (int)NetType::getCrc32c(buf+8, len) :
+                                 (int)NetType::getCrc(buf+8, len), crc);
+    }
+
+    // @return the first fragment with the given flags (2 for the last
+    // data, 1 for a parity), or -1
+    int findFec(int wanted) {
+        for (int i=0; i<cursor; i++) {
+            Bytes flags(store[i].get()+8+8, 4);
+            if (NetType::netInt(flags)==wanted) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
     void corruptDrop(int index) {
         if (index<MAX_PACKET) {
             for (int i=index; i<cursor-1; i++) {
@@ -112,6 +140,46 @@ public:
 };
 
 
+// Drops, duplicates and reorders the datagrams it sends, as a lossy
+// network would
+class LossyDgramTest : public DgramTest {
+public:
+    int dropEvery;      // drop one datagram every dropEvery, 0 for none
+    int dropOffset;
+    int dropBurst;      // consecutive datagrams dropped
+    bool reverse;       // send the datagrams of a message backwards
+    int dropped;
+    int sent;
+
+    LossyDgramTest() :
+            dropEvery(0),
+            dropOffset(0),
+            dropBurst(1),
+            reverse(false),
+            dropped(0),
+            sent(0) {
+    }
+
+    virtual void onMonitorOutput() override {
+        int index = sent++;
+        if (dropEvery>0 && ((index+dropOffset)%dropEvery)<dropBurst) {
+            dropped++;
+            removeMonitor();
+            return;
+        }
+        DgramTest::onMonitorOutput();
+    }
+
+    void endMessage() {
+        if (reverse) {
+            for (int i=0, j=size()-1; i<j; i++, j--) {
+                corruptSwap(i, j);
+            }
+        }
+    }
+};
+
+
 class DgramTwoWayStreamTest : public UnitTest {
 public:
     virtual ConstString getName() override { return "DgramTwoWayStreamTest"; }
@@ -255,8 +323,256 @@ public:
         }
     }
 
+    void checkFastCrc() {
+        report(0, "checking dgrams with the crc32c checksum");
+
+        DgramTest out;
+        int sz = 100;
+        out.openMonitor(sz,sz);
+        out.setFastCrc(true);
+
+        ManagedBytes msg(200);
+        for (size_t i=0; i<msg.length(); i++) {
+            msg.get()[i] = i%128;
+        }
+        out.beginPacket();
+        out.write(msg.bytes());
+        out.flush();
+        out.endPacket();
+        checkEqual(3,out.size(),"right number of packets");
+        bool flagged = true;
+        for (int i=0; i<out.size(); i++) {
+            Bytes code(out.get(i).get()+4, 4);
+            flagged = flagged && NetType::netInt(code)==(i|0x40000000);
+        }
+        checkTrue(flagged,"packet codes are flagged");
+
+        // the receivers check both kinds of checksum
+        DgramTest in;
+        in.openMonitor(sz,sz);
+        ManagedBytes recv(200);
+        for (int problem=0; problem<2; problem++) {
+            in.clear();
+            in.copyMonitor(out);
+            if (problem==1) {
+                in.corrupt(1,10);
+            }
+            for (size_t i=0; i<recv.length(); i++) {
+                recv.get()[i] = 0;
+            }
+            in.beginPacket();
+            int len = in.readFull(recv.bytes());
+            in.endPacket();
+            if (problem==0) {
+                checkEqual(len,recv.length(),"full length");
+                checkTrue(memcmp(recv.get(),msg.get(),msg.length())==0,
+                          "received what is sent");
+            } else {
+                checkEqual(len,-1,"corrupted message is an error");
+            }
+        }
+    }
+
+    void fill(ManagedBytes& msg, int seed) {
+        for (size_t i=0; i<msg.length(); i++) {
+            msg.get()[i] = (char)(i*7+seed*31);
+        }
+    }
+
+    // Sends messages of 1000 bytes, in fragments of 64 bytes (16 for each
+    // message) with a parity every 4, and reads them back
+    int sendFec(LossyDgramTest& out, DgramTest& in, int messages,
+                std::vector<int>& received) {
+        ManagedBytes msg(1000);
+        for (int k=0; k<messages; k++) {
+            fill(msg, k);
+            out.beginPacket();
+            out.write(msg.bytes());
+            out.flush();
+            out.endPacket();
+        }
+        out.endMessage();
+        in.copyMonitor(out);
+        out.clear();
+
+        // each message read is identified by its content
+        received.clear();
+        ManagedBytes recv(1000);
+        ManagedBytes expected(1000);
+        while (true) {
+            in.beginPacket();
+            int len = in.readFull(recv.bytes());
+            in.endPacket();
+            if (len!=(int)recv.length()) {
+                break;
+            }
+            int id = -1;
+            for (int k=0; k<messages && id<0; k++) {
+                fill(expected, k);
+                if (memcmp(recv.get(), expected.get(), recv.length())==0) {
+                    id = k;
+                }
+            }
+            received.push_back(id);
+        }
+        return (int)received.size();
+    }
+
+    void checkFec() {
+        report(0, "checking dgrams with forward error correction");
+
+        int sz = 100;
+        std::vector<int> received;
+        {
+            LossyDgramTest out;
+            out.openMonitor(sz,sz);
+            out.setFec(4);
+            DgramTest in;
+            in.openMonitor(sz,sz);
+            checkEqual(sendFec(out, in, 3, received),3,"three messages");
+            checkTrue(received[0]==0 && received[1]==1 && received[2]==2,
+                      "messages in order");
+            checkEqual(out.sent,3*(16+4),"data and parity fragments");
+            checkEqual((int)in.getFecStats().messages,3,"messages counted");
+        }
+
+        report(0, "one fragment lost in each group");
+        {
+            LossyDgramTest out;
+            out.openMonitor(sz,sz);
+            out.setFec(4);
+            out.dropEvery = 5;
+            out.dropOffset = 3;
+            DgramTest in;
+            in.openMonitor(sz,sz);
+            checkEqual(sendFec(out, in, 3, received),3,"three messages rebuilt");
+            checkTrue(received[0]==0 && received[1]==1 && received[2]==2,
+                      "messages in order");
+            checkEqual(out.dropped,12,"fragments dropped");
+            checkEqual((int)in.getFecStats().recoveredFragments,12,"fragments recovered");
+            checkEqual((int)in.getFecStats().lostMessages,0,"no message lost");
+        }
+
+        report(0, "last fragment and parity lost");
+        {
+            LossyDgramTest out;
+            out.openMonitor(sz,sz);
+            out.setFec(4);
+            out.dropEvery = 1000;
+            out.dropOffset = 1000-18;
+            out.dropBurst = 2;
+            DgramTest in;
+            in.openMonitor(sz,sz);
+            // the last two datagrams of the first message are lost, it
+            // cannot be completed, but it does not stop the next ones
+            sendFec(out, in, 3, received);
+            checkEqual((int)received.size(),2,"two messages");
+            checkTrue(received.size()==2 && received[0]==1 && received[1]==2,
+                      "later messages received");
+            checkEqual((int)in.getFecStats().lostMessages,1,"message lost");
+        }
+
+        report(0, "two fragments lost in a group");
+        {
+            LossyDgramTest out;
+            out.openMonitor(sz,sz);
+            out.setFec(4);
+            out.dropEvery = 1000;
+            out.dropOffset = 1000-22;
+            out.dropBurst = 2;
+            DgramTest in;
+            in.openMonitor(sz,sz);
+            sendFec(out, in, 3, received);
+            checkTrue(received.size()==2 && received[0]==0 && received[1]==2,
+                      "the broken message is skipped");
+            checkEqual((int)in.getFecStats().lostMessages,1,"message lost");
+        }
+
+        report(0, "fragments out of order");
+        {
+            LossyDgramTest out;
+            out.openMonitor(sz,sz);
+            out.setFec(4);
+            out.reverse = true;
+            out.dropEvery = 7;
+            DgramTest in;
+            in.openMonitor(sz,sz);
+            // the parity and the last fragments arrive first
+            sendFec(out, in, 1, received);
+            checkTrue(received.size()==1 && received[0]==0,
+                      "message rebuilt from reversed fragments");
+        }
+
+        report(0, "inconsistent sizes in the last fragment");
+        for (int problem=0; problem<2; problem++) {
+            LossyDgramTest out;
+            out.openMonitor(sz,sz);
+            out.setFec(4);
+            ManagedBytes msg(1000);
+            fill(msg, 0);
+            out.beginPacket();
+            out.write(msg.bytes());
+            out.flush();
+            out.endPacket();
+            int last = out.findFec(2);
+            checkTrue(last>=0, "last fragment found");
+            if (last<0) {
+                break;
+            }
+            // 16 fragments of 64 bytes: the size must be more than 960,
+            // and the last fragment (40 bytes) must fit in it
+            out.forgeFec(last, 6, (problem==0) ? 960 : 961);
+            DgramTest in;
+            in.openMonitor(sz,sz);
+            in.copyMonitor(out);
+            ManagedBytes recv(1000);
+            in.beginPacket();
+            int len = in.readFull(recv.bytes());
+            in.endPacket();
+            // the rejected fragment is rebuilt from the parity
+            checkEqual(len,(int)recv.length(),"message delivered");
+            checkTrue(memcmp(recv.get(),msg.get(),msg.length())==0,
+                      "received what is sent");
+            checkEqual((int)in.getFecStats().badFragments,1,"fragment rejected");
+            checkEqual((int)in.getFecStats().recoveredFragments,1,"fragment recovered");
+        }
+
+        report(0, "parity index out of range");
+        {
+            LossyDgramTest out;
+            out.openMonitor(sz,sz);
+            out.setFec(4);
+            ManagedBytes msg(1000);
+            fill(msg, 0);
+            out.beginPacket();
+            out.write(msg.bytes());
+            out.flush();
+            out.endPacket();
+            int first = out.findFec(1);
+            checkTrue(first>=0, "parity fragment found");
+            if (first>=0) {
+                // fragments of 64 bytes in groups of 4: a message has at
+                // most 2^20 fragments, so 2^18 parities
+                out.forgeFec(first, 1, 1<<18);
+                DgramTest in;
+                in.openMonitor(sz,sz);
+                in.copyMonitor(out);
+                ManagedBytes recv(1000);
+                in.beginPacket();
+                int len = in.readFull(recv.bytes());
+                in.endPacket();
+                checkEqual(len,(int)recv.length(),"message delivered");
+                checkTrue(memcmp(recv.get(),msg.get(),msg.length())==0,
+                          "received what is sent");
+                checkEqual((int)in.getFecStats().badFragments,1,"parity rejected");
+            }
+        }
+    }
+
     virtual void runTests() override {
         checkNormal();
+        checkFastCrc();
+        checkFec();
     }
 };
 
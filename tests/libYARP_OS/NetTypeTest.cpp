@@ -42,6 +42,39 @@ public:
         checkTrue(ct1==ct2,"two identical sequences again");
     }
 
+    void checkCrcValues() {
+        report(0,"checking cyclic redundancy check values");
+
+        char check[] = "123456789";
+        checkEqual(NetType::getCrc(check,9),0xcbf43926UL,"crc32 check value");
+        checkEqual(NetType::getCrc32c(check,9),0xe3069283UL,"crc32c check value");
+
+        // the slices of 8 bytes against the bytes one at a time, at any
+        // alignment
+        char buf[100];
+        for (int i=0; i<100; i++) {
+            buf[i] = (char)(i*37+11);
+        }
+        bool ok = true;
+        for (int start=0; start<8; start++) {
+            for (int len=0; len<90; len++) {
+                unsigned long crc = 0xffffffffUL;
+                unsigned long crc32c = 0xffffffffUL;
+                for (int i=start; i<start+len; i++) {
+                    crc ^= (unsigned char)buf[i];
+                    crc32c ^= (unsigned char)buf[i];
+                    for (int k=0; k<8; k++) {
+                        crc = (crc&1) ? (0xedb88320UL^(crc>>1)) : (crc>>1);
+                        crc32c = (crc32c&1) ? (0x82f63b78UL^(crc32c>>1)) : (crc32c>>1);
+                    }
+                }
+                ok = ok && NetType::getCrc(buf+start,len)==(crc^0xffffffffUL);
+                ok = ok && NetType::getCrc32c(buf+start,len)==(crc32c^0xffffffffUL);
+            }
+        }
+        checkTrue(ok,"crc of unaligned blocks");
+    }
+
     void checkInt() {
         report(0,"checking integer representation");
         union {
@@ -87,6 +120,7 @@ public:
 
     virtual void runTests() override {
         checkCrc();
+        checkCrcValues();
         checkInt();
         checkInt16();
         checkFloat();
@@ -478,6 +478,53 @@ public:
     }
 
 
+    void testUdpFec() {
+        report(0,"checking udp with forward error correction");
+
+        Bottle bot1;
+        PortReaderBuffer<Bottle> buf;
+
+        bot1.fromString("1 2 3");
+        for (int i=0; i<100000; i++) {
+            bot1.addInt(i);
+        }
+
+        NetworkBase::setEnvironment("YARP_DGRAM_FEC", "4");
+        Port input, output;
+        input.open("/in");
+        output.open("/out");
+
+        buf.setStrict();
+        buf.attach(input);
+
+        output.addOutput(Contact("/in", "udp"));
+        NetworkBase::unsetEnvironment("YARP_DGRAM_FEC");
+
+        for (int j=0; j<3; j++) {
+            output.write(bot1);
+            Time::delay(0.1);
+        }
+
+        report(0,"checking for whatever got through...");
+        int ct = 0;
+        while (buf.check()) {
+            ct++;
+            Bottle *result = buf.read();
+            checkTrue(result!=nullptr,"got something check");
+            if (result!=nullptr) {
+                checkEqual(bot1.size(),result->size(),"size check");
+                checkEqual(result->get(100002).asInt(),99999,"content check");
+            }
+        }
+        if (ct==0) {
+            report(0,"NOTHING got through - possible but sad");
+        }
+
+        output.close();
+        input.close();
+    }
+
+
     void testHeavy() {
         report(0,"checking heavy udp");
 
@@ -1551,6 +1598,7 @@ public:
         testPair();
         testReply();
         testUdp();
+        testUdpFec();
         //testHeavy();
 
         testBackground();
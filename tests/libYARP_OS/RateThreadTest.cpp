@@ -9,6 +9,8 @@
 // thread init success/failure notification -nat
 
 #include <yarp/os/RateThread.h>
+#include <yarp/os/PeriodicExecutor.h>
+#include <yarp/os/Thread.h>
 #include <yarp/os/impl/NameServer.h>
 #include <yarp/os/Network.h>
 #include <yarp/os/Time.h>
@@ -16,6 +18,8 @@
 #include <yarp/os/SystemClock.h>
 
 #include <yarp/os/impl/UnitTest.h>
+
+#include <cmath>
 //#include "TestList.h"
 
 using namespace yarp::os::impl;
@@ -214,6 +218,24 @@ private:
         }
     };
 
+    class DeadlineThread: public RateThread
+    {
+    public:
+        int count;
+        double busy;
+
+        DeadlineThread(double r, double b=0): RateThread(r),count(0),busy(b)
+        {
+            setAbsoluteDeadlines(true);
+        }
+
+        virtual void run() override {
+            count++;
+            if (busy > 0)
+                SystemClock::delaySystem(busy);
+        }
+    };
+
     class AskForStopThread : public RateThread {
     public:
         bool done;
@@ -231,6 +253,30 @@ private:
         }
     };
 
+    class StopFromRunThread : public RateThread {
+    public:
+        bool done;
+
+        StopFromRunThread() : RateThread(5) {
+            done = false;
+        }
+
+        void run() override {
+            if (done) stop();
+        }
+    };
+
+    class Stopper : public Thread {
+    public:
+        RateThread& thread;
+
+        Stopper(RateThread& thread) : thread(thread) {}
+
+        void run() override {
+            thread.stop();
+        }
+    };
+
     class Runnable1:public Runnable
     {
     public:
@@ -444,6 +490,153 @@ public:
         checkTrue(Time::getClockType() == YARP_CLOCK_SYSTEM, "getClockType is YARP_CLOCK_SYSTEM");
     }
 
+    void testAbsoluteDeadlines() {
+        report(0, "testing absolute deadlines and sub-millisecond periods");
+
+        DeadlineThread fast(0.5);
+        checkTrue(fast.hasAbsoluteDeadlines(), "absolute deadlines enabled");
+        checkEqualish(fast.getRate(), 0.5, "fractional period accepted");
+        fast.start();
+        int first = fast.count;
+        double start = SystemClock::nowSystem();
+        SystemClock::delaySystem(1);
+        int last = fast.count;
+        double elapsed = SystemClock::nowSystem() - start;
+        fast.stop();
+        char message[255];
+        // iterations made against the ones expected in the time measured
+        double ratio = (last - first) * 0.0005 / elapsed;
+        sprintf(message, "0.5[ms] thread: %d iterations in %.3lf[s] (%.0lf%% of the expected), estimated period %.3lf[ms]",
+                last - first, elapsed, ratio * 100, fast.getEstPeriod());
+        report(0, message);
+        // be tolerant, tests can run on loaded machines: a period rounded
+        // up to one millisecond would make half of the iterations
+        checkTrue(ratio > 0.5, "sub-millisecond period is honored");
+
+        DeadlineThread late(10, 0.025);
+        late.start();
+        SystemClock::delaySystem(0.5);
+        late.stop();
+        unsigned int bins[RateThread::OverrunHistogramSize];
+        late.getOverrunHistogram(bins, RateThread::OverrunHistogramSize);
+        unsigned int total = 0;
+        for (int i=0; i<RateThread::OverrunHistogramSize; i++)
+            total += bins[i];
+        checkTrue(late.getDeadlineMisses() > 0, "deadline misses are detected");
+        checkEqual(total, late.getDeadlineMisses(), "histogram counts all the misses");
+        checkTrue(bins[3] > 0, "overruns between one and two periods are counted");
+
+        DeadlineThread regular(5);
+        regular.start();
+        SystemClock::delaySystem(0.5);
+        regular.stop();
+        double av, max;
+        regular.getWakeupLatency(av, max);
+        checkTrue(av >= 0 && max >= av, "wake up latency is measured");
+    }
+
+    void testExecutor() {
+        report(0, "testing rate threads on a shared executor");
+
+        PeriodicExecutor executor(2);
+        checkTrue(executor.start(), "executor started");
+
+        const int tasks = 10;
+        RateThread2* threads[tasks];
+        DeadlineThread* counters[tasks];
+        for (int i=0; i<tasks; i++) {
+            threads[i] = new RateThread2(5);
+            counters[i] = new DeadlineThread(5);
+            checkTrue(threads[i]->setExecutor(&executor), "executor set");
+            checkTrue(counters[i]->setExecutor(&executor), "executor set");
+            counters[i]->start();
+        }
+
+        threads[0]->threadWillFail(true);
+        checkFalse(threads[0]->start(), "init failure is notified");
+        checkFalse(threads[0]->isRunning(), "failed thread is not running");
+        for (int i=1; i<tasks; i++) {
+            checkTrue(threads[i]->start(), "thread started on the executor");
+            checkEqual(threads[i]->state, 0, "afterStart() was called");
+        }
+        checkEqual(executor.getTasks(), 2*tasks-1, "all tasks are scheduled");
+
+        SystemClock::delaySystem(0.5);
+
+        for (int i=0; i<tasks; i++) {
+            checkTrue(counters[i]->count > 50, "task is running at its rate");
+            checkTrue(fabs(counters[i]->getEstPeriod() - 5.0) < 1.0, "estimated period is updated");
+            counters[i]->stop();
+            checkFalse(counters[i]->isRunning(), "task stopped");
+        }
+        for (int i=1; i<tasks; i++) {
+            threads[i]->stop();
+            checkEqual(threads[i]->state, 1, "threadRelease() was called");
+        }
+        checkEqual(executor.getTasks(), 0, "no tasks left");
+
+        AskForStopThread stopping;
+        stopping.setExecutor(&executor);
+        stopping.start();
+        stopping.done = true;
+        for (int i=0; i<20 && stopping.isRunning(); i++) {
+            SystemClock::delaySystem(0.1);
+        }
+        checkFalse(stopping.isRunning(), "askToStop() works on the executor");
+        stopping.stop();
+
+        StopFromRunThread self;
+        self.setExecutor(&executor);
+        self.start();
+        self.done = true;
+        for (int i=0; i<20 && self.isRunning(); i++) {
+            SystemClock::delaySystem(0.1);
+        }
+        checkFalse(self.isRunning(), "stop() works from run() on the executor");
+        self.stop();
+
+        DeadlineThread shared(5);
+        shared.setExecutor(&executor);
+        shared.start();
+        Stopper first(shared);
+        Stopper second(shared);
+        first.start();
+        second.start();
+        first.stop();
+        second.stop();
+        checkFalse(shared.isRunning(), "task stopped by two threads");
+        checkEqual(executor.getTasks(), 0, "no tasks left after two stops");
+
+        DeadlineThread* deleted = new DeadlineThread(5);
+        deleted->setExecutor(&executor);
+        deleted->start();
+        deleted->askToStop();
+        delete deleted;
+        checkEqual(executor.getTasks(), 0, "task removed by the destructor");
+
+        executor.stop();
+
+#if defined(__linux__)
+        PeriodicExecutor bound(1);
+        int negative[] = { -1 };
+        int huge[] = { 1 << 20 };
+        int cpu0[] = { 0 };
+        checkFalse(bound.setAffinity(negative, 1), "negative CPU index rejected");
+        checkFalse(bound.setAffinity(huge, 1), "CPU index out of range rejected");
+        checkFalse(bound.setAffinity(nullptr, 1), "missing CPU list rejected");
+        checkFalse(bound.setAffinity(cpu0, -1), "negative count rejected");
+        checkTrue(bound.setAffinity(cpu0, 1), "valid CPU index accepted");
+        checkTrue(bound.start(), "executor bound to a CPU started");
+        bound.stop();
+        checkTrue(bound.setAffinity(nullptr, 0), "binding removed");
+#endif
+
+        for (int i=0; i<tasks; i++) {
+            delete threads[i];
+            delete counters[i];
+        }
+    }
+
     void testStartAskForStopStart() {
         report(0,"testing start() askForStop() start() sequence...");
         AskForStopThread test;
@@ -464,6 +657,8 @@ public:
         testRunnable();
         testRateThread();
         testSimTime();
+        testAbsoluteDeadlines();
+        testExecutor();
         testStartAskForStopStart();
     }
 };
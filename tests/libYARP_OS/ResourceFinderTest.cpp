@@ -10,12 +10,22 @@
 #include <yarp/os/Os.h>
 #include <yarp/os/YarpPlugin.h>
 
+#include <yarp/os/impl/DirectoryCache.h>
 #include <yarp/os/impl/PlatformDirent.h>
 #include <yarp/os/impl/PlatformSysStat.h>
 #include <yarp/os/impl/PlatformUnistd.h>
 #include <yarp/os/impl/UnitTest.h>
 
 #include <cstdlib>
+#include <ctime>
+
+#if defined(_WIN32)
+# include <sys/utime.h>
+# define utime _utime
+# define utimbuf _utimbuf
+#else
+# include <utime.h>
+#endif
 
 using namespace yarp::os;
 using namespace yarp::os::impl;
@@ -771,6 +781,221 @@ public:
         breakDownTestArea();
     }
 
+    // Set the modification time of a file or a directory to some seconds
+    // ago: the plugin index does not trust what changed in the second of
+    // a scan, the test would not see the index at work otherwise
+    void backdate(const ConstString& path, int age) {
+        struct utimbuf times;
+        times.actime = times.modtime = time(nullptr) - age;
+        int result = utime(path.c_str(), &times);
+        yAssert(result == 0);
+        YARP_UNUSED(result);
+    }
+
+    void writePlugin(const ConstString& fname, const char *name, const char *library) {
+        FILE *fout = fopen(fname.c_str(),"w");
+        yAssert(fout!=nullptr);
+        fprintf(fout,"[plugin %s]\n", name);
+        fprintf(fout,"type device\n");
+        fprintf(fout,"name %s\n", name);
+        fprintf(fout,"library %s\n", library);
+        fprintf(fout,"part %s\n", name);
+        fclose(fout);
+    }
+
+    void testPluginIndex() {
+        report(0,"test the plugin index is updated when the plugins change");
+        setUpTestArea(false);
+        ConstString slash = Network::getDirectorySeparator();
+        Bottle plugins;
+        plugins.addString("__test_dir_rf_a2");
+        plugins.addString("usr");
+        plugins.addString("share");
+        plugins.addString("yarp");
+        plugins.addString("plugins");
+        Bottle config_plugins;
+        config_plugins.addString("__test_dir_rf_a2");
+        config_plugins.addString("home");
+        config_plugins.addString("yarper");
+        config_plugins.addString(".config");
+        config_plugins.addString("yarp");
+        config_plugins.addString("plugins");
+        Bottle index;
+        index.addString("__test_dir_rf_a2");
+        index.addString("index");
+        mkdir(index);
+        saveEnvironment("YARP_PLUGIN_INDEX");
+        Network::setEnvironment("YARP_PLUGIN_INDEX",pathify(index));
+        ConstString fakedev1 = pathify(config_plugins)+slash+"fakedev1.ini";
+        ConstString fakedev2 = pathify(plugins)+slash+"fakedev2.ini";
+        ConstString fakedev3 = pathify(plugins)+slash+"fakedev3.ini";
+        backdate(fakedev1,100);
+        backdate(fakedev2,100);
+        backdate(pathify(config_plugins),100);
+        backdate(pathify(plugins),100);
+
+        {
+            YarpPluginSelector selector;
+            selector.scan();
+            checkEqual(selector.findPlugin("fakedev2").find("library").asString(),
+                       "yarp_fakedev2","plugin found by name");
+            checkEqual(selector.findPlugin("fakedev3").size(),0,
+                       "non-existent plugin not found by name");
+        }
+
+        // A file changed without changing its stamp (time and size) is
+        // not parsed again, the plugins are read from the index file
+        writePlugin(fakedev2,"fakedev2","yarp_fakedevZ"); // same size
+        backdate(fakedev2,100);
+        // other plugin directories make the index load its file again,
+        // as a new process would do
+        ConstString configHome = NetworkBase::getEnvironment("YARP_CONFIG_HOME");
+        Network::setEnvironment("YARP_CONFIG_HOME",pathify(index));
+        {
+            YarpPluginSelector selector;
+            selector.scan();
+            checkEqual(selector.findPlugin("fakedev1").size(),0,
+                       "plugins of other directories");
+        }
+        Network::setEnvironment("YARP_CONFIG_HOME",configHome);
+        {
+            YarpPluginSelector selector;
+            selector.scan();
+            checkTrue(selector.getSelectedPlugins().check("fakedev1"),
+                      "index file loaded");
+            checkEqual(selector.findPlugin("fakedev2").find("library").asString(),
+                       "yarp_fakedev2","plugins read from the index file");
+        }
+
+        // A new modification time makes the file parsed again
+        backdate(fakedev2,50);
+        {
+            YarpPluginSelector selector;
+            selector.scan();
+            checkEqual(selector.findPlugin("fakedev2").find("library").asString(),
+                       "yarp_fakedevZ","changed modification time read again");
+        }
+
+        writePlugin(fakedev2,"fakedev2","yarp_fakedev2_changed");
+        writePlugin(fakedev3,"fakedev3","yarp_fakedev3");
+        backdate(fakedev2,40);
+        backdate(fakedev3,40);
+        backdate(pathify(plugins),40);
+
+        {
+            YarpPluginSelector selector;
+            selector.scan();
+            checkEqual(selector.findPlugin("fakedev2").find("library").asString(),
+                       "yarp_fakedev2_changed","changed plugin read again");
+            checkEqual(selector.findPlugin("fakedev3").find("library").asString(),
+                       "yarp_fakedev3","new plugin found");
+            checkTrue(selector.getSelectedPlugins().check("fakedev1"),
+                      "unchanged plugin still present");
+        }
+
+        yarp::os::impl::unlink(fakedev3.c_str());
+        backdate(pathify(plugins),30);
+        {
+            YarpPluginSelector selector;
+            selector.scan();
+            checkEqual(selector.findPlugin("fakedev3").size(),0,
+                       "removed plugin not found");
+        }
+        breakDownTestArea();
+    }
+
+    void testFindFilesByName() {
+        report(0,"test finding many files at once");
+        setUpTestArea(false);
+        ConstString slash = Network::getDirectorySeparator();
+        Bottle context;
+        context.addString("__test_dir_rf_a2");
+        context.addString("usr");
+        context.addString("share");
+        context.addString("yarp");
+        context.addString("contexts");
+        context.addString("bulk_app");
+        mkdir(context);
+
+        // a context with many files, and as many files that are missing
+        Bottle names;
+        for (int i=0; i<100; i++) {
+            char buf[64];
+            sprintf(buf,"bulk%d.ini",i);
+            names.addString(buf);
+            if (i%2==0) {
+                FILE *fout = fopen((pathify(context)+slash+buf).c_str(),"w");
+                yAssert(fout!=nullptr);
+                fprintf(fout,"x %d\n",i);
+                fclose(fout);
+            }
+        }
+        names.addString("data.ini");
+
+        DirectoryCache& cache = DirectoryCache::getInstance();
+        cache.setEnabled(false);
+        cache.resetCounters();
+        Bottle expected;
+        {
+            ResourceFinder rf;
+            rf.setQuiet();
+            rf.setDefaultContext("bulk_app");
+            rf.configure(0,nullptr);
+            for (int i=0; i<names.size(); i++) {
+                expected.addString(rf.findFileByName(names.get(i).asString()));
+            }
+        }
+        int statsBefore = cache.getStatCount();
+
+        cache.setEnabled(true);
+        cache.clear();
+        cache.resetCounters();
+        Bottle found;
+        {
+            ResourceFinder rf;
+            rf.setQuiet();
+            rf.setDefaultContext("bulk_app");
+            rf.configure(0,nullptr);
+            found = rf.findFilesByName(names);
+        }
+        int statsAfter = cache.getStatCount();
+        int listsAfter = cache.getListCount();
+        report(0,ConstString("file system calls without the directory cache: ") +
+                 Value(statsBefore).toString() + " stat");
+        report(0,ConstString("file system calls with the directory cache: ") +
+                 Value(statsAfter).toString() + " stat, " +
+                 Value(listsAfter).toString() + " listings");
+
+        checkEqual(found.size(),names.size(),"a result for each file");
+        int different = 0;
+        for (int i=0; i<found.size(); i++) {
+            if (found.get(i).asString()!=expected.get(i).asString()) {
+                different++;
+            }
+        }
+        checkEqual(different,0,"same files found");
+        checkTrue(found.get(0).asString()!="","file in the context found");
+        checkEqual(found.get(1).asString(),"","missing file not found");
+        checkTrue(found.get(100).asString()!="","file in the data home found");
+        checkTrue(statsAfter+listsAfter<statsBefore/4,"fewer calls to the file system");
+
+        // a new file is seen by a new finder
+        FILE *fout = fopen((pathify(context)+slash+"bulk1.ini").c_str(),"w");
+        yAssert(fout!=nullptr);
+        fprintf(fout,"x 1\n");
+        fclose(fout);
+        {
+            ResourceFinder rf;
+            rf.setQuiet();
+            rf.setDefaultContext("bulk_app");
+            rf.configure(0,nullptr);
+            checkTrue(rf.findFileByName("bulk1.ini")!="","new file found");
+        }
+        yarp::os::impl::unlink((pathify(context)+slash+"bulk1.ini").c_str());
+
+        breakDownTestArea();
+    }
+
     void testFailOnFrom() {
         report(0,"test fail behavior on --from / setDefaultConfigFile");
         setUpTestArea(false);
@@ -829,6 +1054,8 @@ public:
         testCopy();
         testGetHomeDirsForWriting();
         testFindPlugins();
+        testPluginIndex();
+        testFindFilesByName();
         testFailOnFrom();
     }
 };
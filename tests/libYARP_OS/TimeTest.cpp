@@ -8,6 +8,15 @@
 #include <yarp/os/Time.h>
 #include <yarp/os/NetType.h>
 #include <yarp/os/ConstString.h>
+#include <yarp/os/Bottle.h>
+#include <yarp/os/Network.h>
+#include <yarp/os/NetworkClock.h>
+#include <yarp/os/Port.h>
+#include <yarp/os/SystemClock.h>
+#include <yarp/os/Thread.h>
+#include <yarp/os/impl/SharedMemoryClock.h>
+
+#include <atomic>
 
 #include <yarp/os/impl/UnitTest.h>
 //#include "TestList.h"
@@ -15,6 +24,25 @@
 using namespace yarp::os;
 using namespace yarp::os::impl;
 
+class NetworkClockSleeper : public Thread {
+public:
+    NetworkClock& clock;
+    double duration;
+    std::atomic<int>& woken;
+
+    NetworkClockSleeper(NetworkClock& clock, double duration, std::atomic<int>& woken) :
+            clock(clock),
+            duration(duration),
+            woken(woken)
+    {
+    }
+
+    virtual void run() override {
+        clock.delay(duration);
+        woken++;
+    }
+};
+
 class TimeTest : public UnitTest {
 public:
     virtual ConstString getName() override { return "TimeTest"; }
@@ -34,8 +62,105 @@ public:
         checkEqual(true,inLimits,"delay for 3.0 seconds");
     }
 
+    void sendTick(Port& port, int sec, int nsec) {
+        Bottle tick;
+        tick.addInt(sec);
+        tick.addInt(nsec);
+        port.write(tick);
+        SystemClock::delaySystem(0.2);
+    }
+
+    void testNetworkClock() {
+        report(0,"testing network clock...");
+        NetworkBase::setLocalMode(true);
+
+        Port source;
+        source.open("/time/clock");
+        std::atomic<int> woken(0);
+        NetworkClock* pclock = new NetworkClock;
+        NetworkClock& clock = *pclock;
+        NetworkClockSleeper forever(clock, 1000.0, woken);
+        {
+            checkTrue(clock.open("/time/clock", "/time/clock:i"), "clock opened");
+            checkFalse(clock.isValid(), "no time received yet");
+            for (int i = 0; i < 50 && source.getOutputCount() == 0; i++) {
+                SystemClock::delaySystem(0.1);
+            }
+
+            sendTick(source, 10, 500000000);
+            checkTrue(clock.isValid(), "time received");
+            checkEqualish(clock.now(), 10.5, "time read");
+
+            NetworkClockSleeper s3(clock, 3.0, woken);
+            NetworkClockSleeper s1(clock, 1.0, woken);
+            NetworkClockSleeper s2(clock, 2.0, woken);
+            s3.start();
+            s1.start();
+            s2.start();
+            forever.start();
+            SystemClock::delaySystem(0.2);
+            checkEqual(woken.load(), 0, "nobody woken up before the deadlines");
+
+            sendTick(source, 11, 600000000);
+            checkEqual(woken.load(), 1, "first deadline expired");
+            sendTick(source, 12, 600000000);
+            checkEqual(woken.load(), 2, "second deadline expired");
+            sendTick(source, 13, 600000000);
+            checkEqual(woken.load(), 3, "third deadline expired");
+            s1.stop();
+            s2.stop();
+            s3.stop();
+
+            // the waiters are reused
+            NetworkClockSleeper again(clock, 0.5, woken);
+            again.start();
+            SystemClock::delaySystem(0.2);
+            sendTick(source, 14, 200000000);
+            checkEqual(woken.load(), 4, "recycled waiter woken up");
+            again.stop();
+        }
+
+        // closing the clock must release the last sleeper
+        delete pclock;
+        SystemClock::delaySystem(0.2);
+        checkEqual(woken.load(), 5, "sleepers released when the clock is closed");
+        forever.stop();
+        source.close();
+
+        NetworkBase::setLocalMode(false);
+    }
+
+    void testSharedMemoryClock() {
+#if !defined(_WIN32)
+        report(0,"testing shared memory clock...");
+        SharedMemoryClock producer;
+        SharedMemoryClock consumer;
+        int sec = 0;
+        int nsec = 0;
+        checkFalse(consumer.open("/time/shmem"), "no segment before the producer");
+        checkTrue(producer.create("/time/shmem"), "segment created");
+        checkTrue(consumer.open("/time/shmem"), "segment opened");
+        checkFalse(consumer.read(sec, nsec), "nothing published yet");
+        producer.write(42, 123);
+        checkTrue(consumer.read(sec, nsec), "time published");
+        checkEqual(sec, 42, "seconds");
+        checkEqual(nsec, 123, "nanoseconds");
+        checkTrue(consumer.read(sec, nsec, 10.0), "time recently published");
+        SystemClock::delaySystem(0.1);
+        checkFalse(consumer.read(sec, nsec, 0.05), "stale time not read");
+        producer.write(43, 0);
+        checkTrue(consumer.read(sec, nsec, 0.05), "time updated again");
+        checkEqual(sec, 43, "updated seconds");
+        consumer.close();
+        producer.close();
+        checkFalse(consumer.open("/time/shmem"), "segment removed by the producer");
+#endif
+    }
+
     virtual void runTests() override {
         testDelay();
+        testNetworkClock();
+        testSharedMemoryClock();
     }
 };
 
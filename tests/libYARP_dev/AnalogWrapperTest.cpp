@@ -7,7 +7,12 @@
 #include <yarp/os/ConstString.h>
 #include <yarp/os/Network.h>
 #include <yarp/os/LogStream.h>
+#include <yarp/os/BufferedPort.h>
+#include <yarp/dev/AnalogFrame.h>
+#include <yarp/dev/IAnalogSensor.h>
 #include <yarp/dev/PolyDriver.h>
+#include <yarp/dev/PolyDriverList.h>
+#include <yarp/dev/Wrapper.h>
 
 #include "TestList.h"
 
@@ -147,9 +152,96 @@ public:
         }
     }
 
+    void testAnalogFrame() {
+        report(0,"\ntest the AnalogFrame serialization");
+
+        double a[] = { 1.0, 2.0, 3.0 };
+        double b[] = { 4.0, 5.0 };
+        AnalogFrame frame;
+        frame.addSensor(a, 3, IAnalogSensor::AS_OK);
+        frame.addSensor(nullptr, 0, IAnalogSensor::AS_ERROR);
+        frame.addSensor(b, 2, IAnalogSensor::AS_TIMEOUT);
+        frame.setStamp(Stamp(42, 12.5));
+
+        AnalogFrame copy;
+        checkTrue(Portable::copyPortable(frame, copy), "frame copied");
+        checkEqual(copy.size(), 3, "number of sensors");
+        checkEqual(copy.getTotalChannels(), 5, "number of channels");
+        checkEqual(copy.getStamp().getCount(), 42, "stamp count");
+        checkEqualish(copy.getStamp().getTime(), 12.5, "stamp time");
+        checkEqual(copy.getOffset(2), 3, "offset of the last sensor");
+        checkEqual(copy.getChannels(1), 0, "empty sensor");
+        checkTrue(copy.isValid(0) && !copy.isValid(1) && !copy.isValid(2), "validity");
+        checkEqual(copy.getStatus(2), (int)IAnalogSensor::AS_TIMEOUT, "status");
+        checkEqualish(copy.getData(0)[2], 3.0, "data of the first sensor");
+        checkEqualish(copy.getData(2)[1], 5.0, "data of the last sensor");
+        checkTrue(copy.getData(2) == copy.getData() + 3, "slices are not copied");
+    }
+
+    void testMultipleAnalogWrapper() {
+        report(0,"\ntest the MultipleAnalogWrapper");
+
+        const char* names[] = { "left_arm", "right_arm" };
+        PolyDriver sensors[2];
+        PolyDriverList list;
+        for (int i = 0; i < 2; i++)
+        {
+            Property p;
+            p.put("device","fakeAnalogSensor");
+            p.put("period",10);
+            checkTrue(sensors[i].open(p), "fakeAnalogSensor open reported successful");
+            list.push(&sensors[i], names[i]);
+        }
+
+        PolyDriver dd;
+        Property p;
+        p.put("device","multipleAnalogServer");
+        p.put("name","/testMultipleAnalogWrapper");
+        p.put("period",10);
+        p.put("legacyPorts",1);
+        checkTrue(dd.open(p), "multipleAnalogServer open reported successful");
+
+        IMultipleWrapper* iwrap = nullptr;
+        checkTrue(dd.view(iwrap) && iwrap != nullptr, "multipleAnalogServer is a multiple wrapper");
+        checkTrue(iwrap->attachAll(list), "attached to the sensors");
+        checkTrue(Network::exists("/testMultipleAnalogWrapper/left_arm") &&
+                  Network::exists("/testMultipleAnalogWrapper/right_arm/rpc:i"), "legacy ports opened");
+
+        BufferedPort<AnalogFrame> in;
+        in.open("/testMultipleAnalogWrapper/in");
+        checkTrue(Network::connect("/testMultipleAnalogWrapper", "/testMultipleAnalogWrapper/in"), "connected");
+        Network::sync("/testMultipleAnalogWrapper/in");
+        AnalogFrame* frame = in.read();
+        checkTrue(frame != nullptr, "frame received");
+        if (frame != nullptr)
+        {
+            checkEqual(frame->size(), 2, "one slot for each sensor");
+            checkEqual(frame->getChannels(1), 1, "channels of the sensor");
+            checkTrue(frame->isValid(0) && frame->isValid(1), "sensors read");
+            checkTrue(frame->getStamp().isValid(), "frame stamped");
+        }
+
+        Port rpc;
+        rpc.open("/testMultipleAnalogWrapper/rpc:o");
+        Network::connect("/testMultipleAnalogWrapper/rpc:o", "/testMultipleAnalogWrapper/rpc:i");
+        Bottle cmd, reply;
+        cmd.addVocab(VOCAB_ANALOG_FRAME);
+        rpc.write(cmd, reply);
+        checkEqual(reply.get(1).toString().c_str(), "left_arm right_arm", "names of the sensors");
+
+        rpc.close();
+        in.close();
+        checkTrue(iwrap->detachAll(), "detached");
+        checkTrue(dd.close(), "close reported successful");
+        sensors[0].close();
+        sensors[1].close();
+    }
+
     virtual void runTests() override {
         Network::setLocalMode(true);
         testAnalogWrapper();
+        testAnalogFrame();
+        testMultipleAnalogWrapper();
         Network::setLocalMode(false);
     }
 };
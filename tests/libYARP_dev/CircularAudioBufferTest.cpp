@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2018 Istituto Italiano di Tecnologia (IIT)
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ */
+
+#include <yarp/dev/CircularAudioBuffer.h>
+#include <yarp/os/SystemClock.h>
+#include <yarp/os/Thread.h>
+
+#include <vector>
+
+#include "TestList.h"
+
+using namespace yarp::os;
+using namespace yarp::os::impl;
+using namespace yarp::dev;
+
+namespace {
+
+// Writes blocks of frames every millisecond, as the callback of an audio
+// library would; the samples count up, so that the reader can check them
+class AudioProducer : public Thread
+{
+public:
+    CircularAudioBuffer& buffer;
+    int blocks;
+    int blockFrames;
+    double lastWrite;
+
+    AudioProducer(CircularAudioBuffer& buffer, int blocks, int blockFrames) :
+            buffer(buffer),
+            blocks(blocks),
+            blockFrames(blockFrames),
+            lastWrite(0)
+    {
+    }
+
+    virtual void run() override
+    {
+        int channels = buffer.getChannels();
+        std::vector<short> block(blockFrames * channels);
+        short value = 0;
+        for (int b = 0; b < blocks && !isStopping(); b++) {
+            for (size_t i = 0; i < block.size(); i++) {
+                block[i] = value++;
+            }
+            buffer.waitFreeFrames(blockFrames, 1.0);
+            buffer.write(block.data(), blockFrames);
+            lastWrite = SystemClock::nowSystem();
+            SystemClock::delaySystem(0.001);
+        }
+    }
+};
+
+} // namespace
+
+
+class CircularAudioBufferTest : public UnitTest
+{
+public:
+    virtual ConstString getName() override { return "CircularAudioBufferTest"; }
+
+    void checkReadWrite()
+    {
+        report(0, "check read and write across the end of the buffer...");
+        CircularAudioBuffer buffer(10, 2);
+        checkEqual(2, buffer.getChannels(), "channels");
+        checkEqual(10, (int)buffer.getMaxFrames(), "capacity");
+
+        short in[16];
+        for (int i = 0; i < 16; i++) {
+            in[i] = (short)(i + 1);
+        }
+        short out[20];
+
+        bool ok = true;
+        for (int round = 0; round < 5; round++) {
+            checkEqual(7, (int)buffer.write(in, 7), "write");
+            checkEqual(7, (int)buffer.getFrames(), "frames");
+            checkEqual(3, (int)buffer.getFreeFrames(), "free frames");
+            checkEqual(7, (int)buffer.read(out, 7), "read");
+            for (int i = 0; i < 14; i++) {
+                ok = ok && (out[i] == in[i]);
+            }
+        }
+        checkTrue(ok, "frames copied in blocks");
+        checkEqual(0, (int)buffer.getOverruns(), "no overrun");
+        checkEqual(0, (int)buffer.getUnderruns(), "no underrun");
+
+        checkEqual(8, (int)buffer.write(in, 8), "write");
+        checkEqual(2, (int)buffer.write(in, 8), "full");
+        checkEqual(6, (int)buffer.getOverruns(), "overrun");
+        checkEqual(10, (int)buffer.readOrSilence(out, 10), "read");
+        checkEqual(1, (int)out[16], "frames of the second write");
+        checkEqual(0, (int)buffer.readOrSilence(out, 3), "empty");
+        checkEqual(3, (int)buffer.getUnderruns(), "underrun");
+        checkTrue(out[0] == 0 && out[5] == 0, "silence");
+
+        buffer.write(nullptr, 2);
+        checkEqual(2, (int)buffer.read(out, 10), "silence written");
+        buffer.write(in, 4);
+        buffer.clear();
+        checkEqual(0, (int)buffer.getFrames(), "clear");
+        buffer.resetCounters();
+        checkEqual(0, (int)buffer.getOverruns(), "counters reset");
+    }
+
+    void checkWait()
+    {
+        report(0, "check waiting for frames...");
+        CircularAudioBuffer buffer(100, 1);
+        double start = SystemClock::nowSystem();
+        checkFalse(buffer.waitFrames(10, 0.1), "timeout");
+        checkTrue(SystemClock::nowSystem() - start >= 0.09, "waited");
+        checkFalse(buffer.waitFrames(200, 0.1), "more than the capacity");
+        checkTrue(buffer.waitFrames(0, 0.1), "no frames");
+        checkTrue(buffer.waitFreeFrames(100, 0.1), "free frames");
+
+        buffer.interrupt();
+        checkFalse(buffer.waitFrames(10), "interrupted");
+        buffer.resume();
+
+        // 48 kHz, stereo, blocks of 1 ms read in packets of 10 ms
+        int blockFrames = 48;
+        int packet = 480;
+        int blocks = 100;
+        CircularAudioBuffer stream(4 * packet, 2);
+        AudioProducer producer(stream, blocks, blockFrames);
+        producer.start();
+
+        std::vector<short> out(packet * 2);
+        short expected = 0;
+        bool ok = true;
+        double maxDelay = 0;
+        int packets = blocks * blockFrames / packet;
+        for (int p = 0; p < packets; p++) {
+            ok = ok && stream.waitFrames(packet, 2.0);
+            double delay = SystemClock::nowSystem() - producer.lastWrite;
+            if (delay > maxDelay) {
+                maxDelay = delay;
+            }
+            ok = ok && (stream.read(out.data(), packet) == (size_t)packet);
+            for (size_t i = 0; i < out.size(); i++) {
+                ok = ok && (out[i] == expected++);
+            }
+        }
+        producer.stop();
+        checkTrue(ok, "all the frames received in order");
+        checkEqual(0, (int)stream.getOverruns(), "no overrun");
+        char buf[100];
+        sprintf(buf, "woken up %.3f ms at most after the last block", maxDelay * 1000);
+        report(0, buf);
+        checkTrue(maxDelay < 0.1, "woken up by the writer");
+    }
+
+    virtual void runTests() override
+    {
+        checkReadWrite();
+        checkWait();
+    }
+};
+
+static CircularAudioBufferTest theCircularAudioBufferTest;
+
+UnitTest& getCircularAudioBufferTest()
+{
+    return theCircularAudioBufferTest;
+}
@@ -163,6 +163,170 @@ public:
         {
             checkEqual(setPosition[i],readedEncoders[i],"Setted position and readed encoders match");
         }
+
+        // Test a streaming frame with commands for different groups of
+        // joints, spanning different subcontrolboards
+        IStreamingFrame *istream = nullptr;
+        ok = ddRemapper.view(istream);
+        checkTrue(ok, "streaming frame interface correctly opened");
+
+        ICurrentControl *icurr = nullptr;
+        ok = ddRemapper.view(icurr);
+        checkTrue(ok, "current control interface correctly opened");
+
+        const int posJoints[3] = { 5, 0, 3 };
+        const double posRefs[3] = { 11.0 + rand, 12.0 + rand, 13.0 + rand };
+        const int currJoints[3] = { 1, 2, 4 };
+        const double currRefs[3] = { 1.5 + rand, 2.5 + rand, 3.5 + rand };
+
+        StreamingFrame frame;
+        checkTrue(frame.addCommand(VOCAB_POSITION_DIRECT_GROUP, 3, posJoints, posRefs), "position direct command added");
+        checkTrue(frame.addCommand(VOCAB_CURRENT_REF_GROUP, 3, currJoints, currRefs), "current command added");
+        checkFalse(frame.addCommand(VOCAB_POSITION_DIRECTS, 3, posJoints, posRefs), "invalid command rejected");
+        checkEqual(frame.size(), 2, "frame contains two commands");
+
+        ok = istream->sendStreamingFrame(frame);
+        checkTrue(ok, "sendStreamingFrame correctly called");
+
+        yarp::os::Time::delay(0.1);
+
+        for(int i=0; i < 3; i++)
+        {
+            double ref = 0;
+            ok = posdir->getRefPosition(posJoints[i], &ref);
+            checkTrue(ok, "getRefPosition correctly called");
+            checkEqual(ref, posRefs[i], "Position sent in the frame and readed ref position match");
+
+            ok = icurr->getRefCurrent(currJoints[i], &ref);
+            checkTrue(ok, "getRefCurrent correctly called");
+            checkEqual(ref, currRefs[i], "Current sent in the frame and readed ref current match");
+        }
+    }
+
+    void checkBatch(yarp::dev::PolyDriver & ddRemapper, int rand, size_t nrOfRemappedAxes)
+    {
+        IRpcBatch *ibatch = nullptr;
+        bool ok = ddRemapper.view(ibatch);
+        checkTrue(ok, "batch interface correctly opened");
+
+        IPositionControl2 *pos = nullptr;
+        ok = ddRemapper.view(pos);
+        checkTrue(ok, "interface position correctly opened");
+
+        ok = ibatch->beginBatch();
+        checkTrue(ok, "beginBatch correctly called");
+
+        for(size_t i=0; i < nrOfRemappedAxes; i++)
+        {
+            ok = pos->setRefSpeed(i, i*20.0+7 + rand);
+            checkTrue(ok, "setRefSpeed correctly queued");
+        }
+
+        // A getter in the middle of the batch sees the setters queued before it
+        double speed = 0;
+        ok = pos->getRefSpeed(nrOfRemappedAxes-1, &speed);
+        checkTrue(ok, "getRefSpeed correctly called in a batch");
+        checkEqual(speed, (nrOfRemappedAxes-1)*20.0+7 + rand, "Queued speed and readed speed match");
+
+        ok = pos->setRefAcceleration(0, 3.0 + rand);
+        checkTrue(ok, "setRefAcceleration correctly queued");
+
+        ok = ibatch->endBatch();
+        checkTrue(ok, "endBatch correctly called");
+
+        for(size_t i=0; i < nrOfRemappedAxes; i++)
+        {
+            ok = pos->getRefSpeed(i, &speed);
+            checkTrue(ok, "getRefSpeed correctly called");
+            checkEqual(speed, i*20.0+7 + rand, "Speed set in the batch and readed speed match");
+        }
+
+        double acc = 0;
+        ok = pos->getRefAcceleration(0, &acc);
+        checkTrue(ok, "getRefAcceleration correctly called");
+        checkEqual(acc, 3.0 + rand, "Acceleration set in the batch and readed acceleration match");
+    }
+
+    void checkStreamingInBatch(yarp::dev::PolyDriver & ddRemapper, PolyDriver *fmcbA)
+    {
+        IRpcBatch *ibatch = nullptr;
+        IPositionControl *pos = nullptr;
+        IVelocityControl *vel = nullptr;
+        IPositionControl *posA = nullptr;
+        bool ok = ddRemapper.view(ibatch) && ddRemapper.view(pos) &&
+                  ddRemapper.view(vel) && fmcbA->view(posA);
+        checkTrue(ok, "interfaces correctly opened");
+
+        ok = ibatch->beginBatch();
+        checkTrue(ok, "beginBatch correctly called");
+        ok = pos->setRefSpeed(0, 17.0);
+        checkTrue(ok, "setRefSpeed correctly queued");
+
+        // A streaming command sends the queued setters first: they reach
+        // the device before it, without a getter or endBatch()
+        ok = vel->velocityMove(0, 1.0);
+        checkTrue(ok, "velocityMove correctly called in a batch");
+        double speed = 0;
+        ok = posA->getRefSpeed(0, &speed);
+        checkTrue(ok, "getRefSpeed correctly called on the device");
+        checkEqual(speed, 17.0, "queued setter sent before the streaming command");
+
+        ok = ibatch->endBatch();
+        checkTrue(ok, "endBatch correctly called");
+    }
+
+    void checkPartialBatch(PolyDriver *fmcbA, PolyDriver *fmcbB)
+    {
+        // A remapper of a remote controlboard, which supports batches,
+        // and of a local one, which does not
+        PolyDriver ddRemote;
+        Property pRemote;
+        pRemote.put("device","remote_controlboard");
+        pRemote.put("remote","/testRemapperRobot/a");
+        pRemote.put("local","/test/partialBatch/a");
+        bool ok = ddRemote.open(pRemote);
+        checkTrue(ok,"remote_controlboard open reported successful");
+
+        PolyDriverList list;
+        list.push(&ddRemote,"remoteA");
+        list.push(fmcbB,"localB");
+
+        PolyDriver ddRemapper;
+        Property pRemapper;
+        pRemapper.put("device","controlboardremapper");
+        pRemapper.addGroup("axesNames");
+        Bottle & axesList = pRemapper.findGroup("axesNames").addList();
+        axesList.addString("axisA1");
+        axesList.addString("axisB1");
+        ok = ddRemapper.open(pRemapper);
+        checkTrue(ok,"controlboardremapper open reported successful");
+
+        yarp::dev::IMultipleWrapper *imultwrap = nullptr;
+        ok = ddRemapper.view(imultwrap);
+        checkTrue(ok, "interface for multiple wrapper correctly opened");
+        ok = imultwrap->attachAll(list);
+        checkTrue(ok, "attachAll for controlboardremapper successful");
+
+        IRpcBatch *ibatch = nullptr;
+        IPositionControl *pos = nullptr;
+        IPositionControl *posA = nullptr;
+        ok = ddRemapper.view(ibatch) && ddRemapper.view(pos) && fmcbA->view(posA);
+        checkTrue(ok, "interfaces correctly opened");
+
+        ok = ibatch->beginBatch();
+        checkFalse(ok, "beginBatch fails if a subcontrolboard does not support it");
+
+        // the caller does not call endBatch(), the setters are sent anyway
+        ok = pos->setRefSpeed(0, 42.0);
+        checkTrue(ok, "setRefSpeed correctly called");
+        double speed = 0;
+        ok = posA->getRefSpeed(0, &speed);
+        checkTrue(ok, "getRefSpeed correctly called");
+        checkEqual(speed, 42.0, "setter sent without a batch");
+
+        imultwrap->detachAll();
+        ddRemapper.close();
+        ddRemote.close();
     }
 
     void testControlBoardRemapper() {
@@ -335,6 +499,9 @@ public:
 
         // Test the remotecontrolboardremapper
         checkRemapper(ddRemoteRemapper,100,nrOfRemappedAxes);
+        checkBatch(ddRemoteRemapper,100,nrOfRemappedAxes);
+        checkStreamingInBatch(ddRemoteRemapper,fmcbs[0]);
+        checkPartialBatch(fmcbs[0],fmcbs[1]);
 
         // Close devices
         imultwrap->detachAll();
@@ -21,6 +21,7 @@
 #include <yarp/os/Port.h>
 #include <yarp/os/Bottle.h>
 #include <yarp/os/Time.h>
+#include <yarp/os/Property.h>
 
 #include "TestList.h"
 
@@ -173,11 +174,191 @@ public:
         return true;
     }
 
+    // A building of 2000x2000 cells: rooms of 100x100 cells with doors,
+    // surrounded by unknown cells, with some noise in the occupancy
+    void makeLargeMap(MapGrid2D& m)
+    {
+        m.setMapName("large_map");
+        m.setResolution(0.05);
+        m.setSize_in_cells(2000, 2000);
+        ImageOf<PixelMono> occupancy;
+        occupancy.resize(2000, 2000);
+        for (size_t y = 0; y < 2000; y++)
+        {
+            for (size_t x = 0; x < 2000; x++)
+            {
+                MapGrid2D::XYCell cell(x, y);
+                bool outside = x < 100 || y < 100 || x >= 1900 || y >= 1900;
+                bool wall = (x % 100 == 0 || y % 100 == 0) && !(x % 100 > 40 && x % 100 < 60) && !(y % 100 > 40 && y % 100 < 60);
+                if (outside)
+                {
+                    occupancy.pixel(x, y) = 255;
+                    m.setMapFlag(cell, MapGrid2D::MAP_CELL_UNKNOWN);
+                }
+                else if (wall)
+                {
+                    occupancy.pixel(x, y) = 100;
+                    m.setMapFlag(cell, MapGrid2D::MAP_CELL_WALL);
+                }
+                else
+                {
+                    occupancy.pixel(x, y) = (x * 7919 + y * 104729) % 997 == 0 ? 1 : 0;
+                    m.setMapFlag(cell, MapGrid2D::MAP_CELL_FREE);
+                }
+            }
+        }
+        m.setOccupancyGrid(occupancy);
+    }
+
+    void testCompression()
+    {
+        report(0,"checking the compression of the maps...");
+
+        MapGrid2D large;
+        makeLargeMap(large);
+        Bottle b;
+        checkTrue(Property::copyPortable(large, b), "compressed map written");
+        MapGrid2D received;
+        checkTrue(Property::copyPortable(b, received), "compressed map read");
+        checkTrue(large.isIdenticalTo(received), "compressed map received correctly");
+        size_t bytes = 0;
+        b.toBinary(&bytes);
+        checkTrue(bytes < 2000 * 2000 / 10, "map compressed more than 10 times");
+        report(0, ConstString("full map: ") + Value((int)bytes).toString() + " bytes instead of 8000000");
+
+        // the maps of the old uncompressed format are accepted as well
+        MapGrid2D small;
+        small.setMapName("legacy_map");
+        small.setSize_in_cells(3, 2);
+        small.setMapFlag(MapGrid2D::XYCell(1, 1), MapGrid2D::MAP_CELL_WALL);
+        small.setOccupancyData(MapGrid2D::XYCell(2, 0), 50);
+        unsigned char occ[6] = { 0, 0, 50, 0, 0, 0 };
+        unsigned char flags[6] = { 0, 0, 0, 0, MapGrid2D::MAP_CELL_WALL, 0 };
+        Bottle legacy;
+        legacy.addInt(3);
+        legacy.addInt(2);
+        legacy.addDouble(0.0);
+        legacy.addDouble(0.0);
+        legacy.addDouble(0.0);
+        legacy.addDouble(1.0);
+        legacy.addString("legacy_map");
+        legacy.add(Value::makeBlob(occ, 6));
+        legacy.add(Value::makeBlob(flags, 6));
+        MapGrid2D legacy_map;
+        checkTrue(Property::copyPortable(legacy, legacy_map), "uncompressed map read");
+        checkTrue(small.isIdenticalTo(legacy_map), "uncompressed map received correctly");
+
+        // tiles
+        MapGrid2D changed = large;
+        changed.setMapFlag(MapGrid2D::XYCell(10, 10), MapGrid2D::MAP_CELL_TEMPORARY_OBSTACLE);
+        changed.setMapFlag(MapGrid2D::XYCell(1999, 1999), MapGrid2D::MAP_CELL_TEMPORARY_OBSTACLE);
+        std::vector<size_t> tiles;
+        checkTrue(changed.getChangedTiles(large, tiles), "changed tiles found");
+        checkTrue(tiles.size() == 2 && tiles[0] == 0 && tiles[1] == changed.getTileCount() - 1, "changed tiles are correct");
+        Bottle data;
+        checkTrue(changed.getTiles(tiles, data), "tiles written");
+        checkTrue(large.setTiles(data), "tiles read");
+        checkTrue(large.isIdenticalTo(changed), "tiles copied correctly");
+    }
+
+    int getDeltaBytes(Port& port, const std::string& name, int& session, int& version)
+    {
+        Bottle cmd;
+        Bottle reply;
+        cmd.addVocab(VOCAB_IMAP);
+        cmd.addVocab(VOCAB_IMAP_GET_MAP_DELTA);
+        cmd.addString(name);
+        cmd.addInt(session);
+        cmd.addInt(version);
+        if (!port.write(cmd, reply) || reply.get(0).asVocab() != VOCAB_IMAP_OK)
+        {
+            return -1;
+        }
+        session = reply.get(1).asInt();
+        version = reply.get(2).asInt();
+        size_t bytes = 0;
+        reply.toBinary(&bytes);
+        return (int)bytes;
+    }
+
+    void testDelta()
+    {
+        report(0,"checking the updates of the maps...");
+
+        PolyDriver ddmapserver;
+        Property pmapserver_cfg;
+        pmapserver_cfg.put("device", "map2DServer");
+        checkTrue(ddmapserver.open(pmapserver_cfg), "ddmapserver open reported successfull");
+
+        IMap2D* imap = nullptr;
+        PolyDriver ddmapclient;
+        Property pmapclient_cfg;
+        pmapclient_cfg.put("device", "map2DClient");
+        pmapclient_cfg.put("local", "/mapClientTest");
+        pmapclient_cfg.put("remote", "/mapServer");
+        bool ok_client = ddmapclient.open(pmapclient_cfg) && ddmapclient.view(imap);
+        checkTrue(ok_client, "ddmapclient open reported successfull");
+
+        Port port;
+        port.open("/mapClientTest/raw");
+        bool ok_port = Network::connect("/mapClientTest/raw", "/mapServer/rpc");
+        checkTrue(ok_port, "raw port connected to the server");
+        if (!ok_client || !ok_port)
+        {
+            return;
+        }
+
+        MapGrid2D map;
+        makeLargeMap(map);
+        MapGrid2D received;
+        int session = 0;
+        int version = 0;
+        imap->store_map(map);
+        checkTrue(imap->get_map("large_map", received), "large map received");
+        checkTrue(map.isIdenticalTo(received), "large map received correctly");
+        int full = getDeltaBytes(port, "large_map", session, version);
+        checkTrue(full > 0, "full map sent to a new client");
+
+        int unchanged = getDeltaBytes(port, "large_map", session, version);
+        checkTrue(unchanged >= 0 && unchanged < 100, "nothing sent when the map did not change");
+
+        // a temporary obstacle
+        for (int y = 500; y < 520; y++)
+        {
+            for (int x = 700; x < 720; x++)
+            {
+                map.setMapFlag(MapGrid2D::XYCell(x, y), MapGrid2D::MAP_CELL_TEMPORARY_OBSTACLE);
+            }
+        }
+        imap->store_map(map);
+        int update = getDeltaBytes(port, "large_map", session, version);
+        checkTrue(update > 0 && update < full / 20, "only the changed tiles sent");
+        checkTrue(imap->get_map("large_map", received), "updated map received");
+        checkTrue(map.isIdenticalTo(received), "updated map received correctly");
+
+        // a different layout is sent whole
+        map.setOrigin(1.0, 1.0, 0.0);
+        imap->store_map(map);
+        int layout = getDeltaBytes(port, "large_map", session, version);
+        checkTrue(layout > full / 2, "full map sent after a change of the origin");
+        checkTrue(imap->get_map("large_map", received) && map.isIdenticalTo(received), "map with a new origin received correctly");
+
+        report(0, ConstString("bytes per update: full map ") + Value(full).toString() +
+                  ", unchanged " + Value(unchanged).toString() +
+                  ", obstacle " + Value(update).toString());
+
+        port.close();
+        ddmapclient.close();
+        ddmapserver.close();
+    }
+
     virtual void runTests() override
     {
         Network::setLocalMode(true);
         testDataType();
         testClientServer();
+        testCompression();
+        testDelta();
         Network::setLocalMode(false);
     }
 };
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2018 Istituto Italiano di Tecnologia (IIT)
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ */
+
+#include <yarp/os/BufferedPort.h>
+#include <yarp/os/ConstString.h>
+#include <yarp/os/Network.h>
+#include <yarp/os/Port.h>
+#include <yarp/os/SystemClock.h>
+#include <yarp/sig/Image.h>
+
+#include "TestList.h"
+
+using namespace yarp::os;
+using namespace yarp::os::impl;
+using namespace yarp::sig;
+
+
+// Check that each image received is the conversion of a single depth
+// image: the frames are uniform, any other content is a torn payload
+class UniformImageChecker : public TypedReaderCallback<FlexImage>
+{
+public:
+    int received;
+    int torn;
+
+    UniformImageChecker() : received(0), torn(0) {}
+
+    virtual void onRead(FlexImage& img) override
+    {
+        received++;
+        const unsigned char* pixels = img.getRawImage();
+        size_t size = (size_t)img.getRawImageSize();
+        for (size_t i = 1; i < size; i++) {
+            if (pixels[i] != pixels[0]) {
+                torn++;
+                return;
+            }
+        }
+    }
+};
+
+
+class PortMonitorTest : public UnitTest
+{
+public:
+    virtual ConstString getName() override { return "PortMonitorTest"; }
+
+    void testAsyncPayloads()
+    {
+        report(0, "checking the payloads delivered by an asynchronous monitor");
+
+        Port out;
+        BufferedPort<FlexImage> in;
+        UniformImageChecker checker;
+        in.setStrict();
+        in.useCallback(checker);
+        checkTrue(out.open("/test/portmonitor/out"), "output port open");
+        checkTrue(in.open("/test/portmonitor/in"), "input port open");
+        bool ok = NetworkBase::connect("/test/portmonitor/out", "/test/portmonitor/in",
+                                       "tcp+recv.portmonitor+type.dll+file.depthimage+async.1");
+        checkTrue(ok, "asynchronous monitor connected");
+        if (!ok) {
+            in.close();
+            out.close();
+            return;
+        }
+
+        const int frames = 100;
+        ImageOf<PixelFloat> depth;
+        depth.resize(640, 480);
+        for (int k = 0; k < frames; k++) {
+            float value = 0.5f + (k % 19) * 0.5f;
+            float* pixels = (float*)depth.getRawImage();
+            for (int i = 0; i < depth.width() * depth.height(); i++) {
+                pixels[i] = value;
+            }
+            out.write(depth);
+        }
+
+        for (int i = 0; i < 50 && checker.received < frames / 2; i++) {
+            SystemClock::delaySystem(0.1);
+        }
+        NetworkBase::disconnect("/test/portmonitor/out", "/test/portmonitor/in");
+        in.close();
+        out.close();
+
+        checkTrue(checker.received > 0, "converted images received");
+        checkEqual(checker.torn, 0, "no torn payload");
+    }
+
+    virtual void runTests() override
+    {
+        Network::setLocalMode(true);
+        testAsyncPayloads();
+        Network::setLocalMode(false);
+    }
+};
+
+static PortMonitorTest thePortMonitorTest;
+
+UnitTest& getPortMonitorTest()
+{
+    return thePortMonitorTest;
+}
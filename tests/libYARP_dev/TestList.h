@@ -21,6 +21,7 @@ namespace yarp {
 // need to made one function for each new test, and add to collectTests()
 // method
 extern yarp::os::impl::UnitTest& getPolyDriverTest();
+extern yarp::os::impl::UnitTest& getCircularAudioBufferTest();
 extern yarp::os::impl::UnitTest& getRobotDescriptionTest();
 
 #ifdef YARP_CONTROLBOARDREMAPPER_TESTS
@@ -35,6 +36,10 @@ extern yarp::os::impl::UnitTest& getAnalogWrapperTest();
 extern yarp::os::impl::UnitTest& getTestFrameGrabberTest();
 #endif
 
+#ifdef YARP_PORTMONITOR_TESTS
+extern yarp::os::impl::UnitTest& getPortMonitorTest();
+#endif
+
 #ifdef WITH_YARPMATH
 extern yarp::os::impl::UnitTest& getFrameTransformClientTest();
 extern yarp::os::impl::UnitTest& getMapGrid2DTest();
@@ -45,6 +50,7 @@ public:
     static void collectTests() {
         UnitTest& root = UnitTest::getRoot();
         root.add(getPolyDriverTest());
+        root.add(getCircularAudioBufferTest());
         root.add(getRobotDescriptionTest());
 #ifdef YARP_CONTROLBOARDREMAPPER_TESTS
         root.add(getControlBoardRemapperTest());
@@ -55,6 +61,9 @@ public:
 #ifdef YARP_TESTFRAMEGRABBER_TESTS
         root.add(getTestFrameGrabberTest());
 #endif
+#ifdef YARP_PORTMONITOR_TESTS
+        root.add(getPortMonitorTest());
+#endif
 #ifdef WITH_YARPMATH
         root.add(getFrameTransformClientTest());
         root.add(getMapGrid2DTest());
@@ -134,6 +134,46 @@ public:
         }
     }
 
+    void testSwap() {
+        report(0,"testing image swapping...");
+
+        ImageOf<PixelRgb> img1;
+        img1.resize(128,64);
+        img1.pixel(3,4).r = 42;
+        ImageOf<PixelRgb> img2;
+        img2.resize(16,8);
+        img2.pixel(1,2).g = 24;
+        unsigned char *raw1 = img1.getRawImage();
+
+        img1.swap(img2);
+        checkEqual(img1.width(),16,"width of the first image");
+        checkEqual(img1.height(),8,"height of the first image");
+        checkEqual(img2.width(),128,"width of the second image");
+        checkEqual(img2.height(),64,"height of the second image");
+        checkTrue(img2.getRawImage()==raw1,"pixels are not copied");
+        checkEqual(img1.pixel(1,2).g,24,"pixel of the first image");
+        checkEqual(img2.pixel(3,4).r,42,"pixel of the second image");
+
+        // the images are still independent
+        img1.resize(32,32);
+        checkEqual(img2.width(),128,"resize does not affect the other image");
+        checkEqual(img2.pixel(3,4).r,42,"pixels are kept");
+
+        // an external buffer is never handed over to the other image
+        unsigned char buffer[16*8*3];
+        ImageOf<PixelRgb> img3;
+        img3.setExternal(buffer,16,8);
+        img3.zero();
+        ImageOf<PixelRgb> img4;
+        img4.resize(16,8);
+        img4.zero();
+        img4.pixel(5,6).b = 33;
+        img3.swap(img4);
+        checkTrue(img3.getRawImage()==buffer,"external buffer is kept");
+        checkTrue(img4.getRawImage()!=buffer,"external buffer is not handed over");
+        checkEqual(img3.pixel(5,6).b,33,"pixels are copied into the external buffer");
+    }
+
     void testZero() {
         report(0,"testing image zeroing...");
         ImageOf<PixelRgb> img1;
@@ -620,6 +660,7 @@ public:
         testTransmit();
         Network::setLocalMode(netMode);
         testCopy();
+        testSwap();
         testCast();
         testExternal();
         testPadding();
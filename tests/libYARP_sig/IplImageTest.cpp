@@ -0,0 +1,318 @@
+/*
+ * Copyright (C) 2018 Istituto Italiano di Tecnologia (IIT)
+ * CopyPolicy: Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ */
+
+#include <yarp/sig/IplImage.h>
+#include <yarp/os/Network.h>
+
+#include <cstring>
+#include <vector>
+
+#include "TestList.h"
+
+using namespace yarp::os::impl;
+using namespace yarp::os;
+
+// The scalar per-pixel loops the ipl functions were implemented with, the
+// results of the row-band SIMD versions must be identical.
+namespace {
+
+unsigned int seed = 12345;
+
+int nextRandom()
+{
+    seed = seed * 1103515245u + 12345u;
+    return (int)((seed >> 16) & 0x7fff);
+}
+
+IplImage* createImage(int depth, int w, int h)
+{
+    IplImage* img = iplCreateImageHeader(1, 0, depth, const_cast<char*>("GRAY"), const_cast<char*>("GRAY"),
+                                         IPL_DATA_ORDER_PIXEL, IPL_ORIGIN_TL, IPL_ALIGN_QWORD,
+                                         w, h, nullptr, nullptr, nullptr, nullptr);
+    if (depth == IPL_DEPTH_32F) {
+        iplAllocateImageFP(img, 0, 0);
+        float* data = reinterpret_cast<float*>(img->imageData);
+        for (int i = 0; i < w * h; i++) {
+            data[i] = (nextRandom() - 16384) / 1000.0f;
+        }
+    } else {
+        iplAllocateImage(img, 0, 0);
+        for (int i = 0; i < img->imageSize; i++) {
+            img->imageData[i] = (char)nextRandom();
+        }
+    }
+    return img;
+}
+
+void refConvolve(const char* src, char* dst, int w, int h, const int* values,
+                 int krows, int kcols, int borderx, int shift, bool isSigned)
+{
+    const int ksize = krows * kcols;
+    const int bordery = krows / 2;
+    for (int i = bordery; i < h - bordery; i++) {
+        for (int j = borderx; j < w - borderx; j++) {
+            int tmp = 0;
+            for (int k = 0; k < krows; k++) {
+                for (int l = 0; l < kcols; l++) {
+                    tmp += src[(i + k - bordery) * w + j + l - kcols / 2] * values[ksize - k * kcols - l - 1];
+                }
+            }
+            tmp >>= shift;
+            if (isSigned) {
+                tmp = (tmp > 127) ? 127 : ((tmp < -128) ? -128 : tmp);
+            } else {
+                tmp = (tmp > 255) ? 255 : ((tmp < 0) ? 0 : tmp);
+            }
+            dst[i * w + j] = char(tmp);
+        }
+    }
+}
+
+void refConvolve(const float* src, float* dst, int w, int h, const float* values,
+                 int krows, int kcols, int borderx)
+{
+    const int ksize = krows * kcols;
+    const int bordery = krows / 2;
+    for (int i = bordery; i < h - bordery; i++) {
+        for (int j = borderx; j < w - borderx; j++) {
+            float tmp = 0;
+            for (int k = 0; k < krows; k++) {
+                for (int l = 0; l < kcols; l++) {
+                    tmp += src[(i + k - bordery) * w + j + l - kcols / 2] * values[ksize - k * kcols - l - 1];
+                }
+            }
+            dst[i * w + j] = tmp;
+        }
+    }
+}
+
+bool sameInterior(const char* a, const char* b, int size, int w, int borderx, int bordery)
+{
+    const int h = size / w;
+    for (int i = bordery; i < h - bordery; i++) {
+        if (memcmp(a + i * w + borderx, b + i * w + borderx, w - 2 * borderx) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+class IplImageTest : public UnitTest {
+public:
+    virtual ConstString getName() override { return "IplImageTest"; }
+
+    void checkConvolve2D() {
+        report(0,"checking iplConvolve2D against the per-pixel loops...");
+        const int w = 320;
+        const int h = 120;
+        for (int depth : {IPL_DEPTH_8U, IPL_DEPTH_8S}) {
+            IplImage* src = createImage(depth, w, h);
+            IplImage* dst = createImage(depth, w, h);
+            for (int size = 3; size <= 15; size += 4) {
+                std::vector<int> values(size * size);
+                for (auto& v : values) {
+                    v = nextRandom() % 41 - 20;
+                }
+                // too large for 16 bits products
+                values[1] = 40000;
+                const int shift = size / 3;
+                IplConvKernel* kernel = iplCreateConvKernel(size, size, size / 2, size / 2, values.data(), shift);
+                iplConvolve2D(src, dst, &kernel, 1, 0);
+
+                std::vector<char> ref(src->imageSize, 0);
+                refConvolve(src->imageData, ref.data(), w, h, values.data(), size, size, size / 2, shift,
+                            depth == IPL_DEPTH_8S);
+                checkTrue(sameInterior(dst->imageData, ref.data(), src->imageSize, w, size / 2, size / 2),
+                          "same pixels");
+                iplDeleteConvKernel(kernel);
+            }
+            iplDeallocate(src, IPL_IMAGE_ALL);
+            iplDeallocate(dst, IPL_IMAGE_ALL);
+        }
+    }
+
+    void checkConvolveSep2D() {
+        report(0,"checking iplConvolveSep2D against the per-pixel loops...");
+        const int w = 640;
+        const int h = 100;
+        for (int depth : {IPL_DEPTH_8U, IPL_DEPTH_8S}) {
+            IplImage* src = createImage(depth, w, h);
+            IplImage* dst = createImage(depth, w, h);
+            std::vector<char> before(dst->imageData, dst->imageData + dst->imageSize);
+            const int size = 7;
+            std::vector<int> xvalues(size);
+            std::vector<int> yvalues(size);
+            for (int k = 0; k < size; k++) {
+                xvalues[k] = nextRandom() % 17 - 4;
+                yvalues[k] = nextRandom() % 17 - 4;
+            }
+            IplConvKernel* xKernel = iplCreateConvKernel(size, 1, size / 2, 0, xvalues.data(), 3);
+            IplConvKernel* yKernel = iplCreateConvKernel(1, size, 0, size / 2, yvalues.data(), 2);
+            iplConvolveSep2D(src, dst, xKernel, yKernel);
+
+            // the rows of the x kernel are stored as char and read back
+            std::vector<char> tmp(src->imageSize, 0);
+            std::vector<char> ref(before);
+            const bool isSigned = (depth == IPL_DEPTH_8S);
+            refConvolve(src->imageData, tmp.data(), w, h, xvalues.data(), 1, size, size / 2, 3, isSigned);
+            refConvolve(tmp.data(), ref.data(), w, h, yvalues.data(), size, 1, size / 2, 2, isSigned);
+            checkTrue(memcmp(dst->imageData, ref.data(), ref.size()) == 0, "same pixels, borders untouched");
+
+            iplDeleteConvKernel(xKernel);
+            iplDeleteConvKernel(yKernel);
+            iplDeallocate(src, IPL_IMAGE_ALL);
+            iplDeallocate(dst, IPL_IMAGE_ALL);
+        }
+    }
+
+    void checkConvolveFP() {
+        report(0,"checking iplConvolve2DFP and iplConvolveSep2DFP against the per-pixel loops...");
+        const int w = 200;
+        const int h = 150;
+        IplImage* src = createImage(IPL_DEPTH_32F, w, h);
+        IplImage* dst = createImage(IPL_DEPTH_32F, w, h);
+        const int n = w * h;
+        const float* in = reinterpret_cast<float*>(src->imageData);
+        const float* out = reinterpret_cast<float*>(dst->imageData);
+
+        const int size = 9;
+        std::vector<float> values(size * size);
+        for (auto& v : values) {
+            v = (nextRandom() - 16384) / 20000.0f;
+        }
+        IplConvKernelFP* kernel = iplCreateConvKernelFP(size, size, size / 2, size / 2, values.data());
+        std::vector<float> ref(out, out + n);
+        refConvolve(in, ref.data(), w, h, values.data(), size, size, size / 2);
+        iplConvolve2DFP(src, dst, &kernel, 1, 0);
+        checkTrue(memcmp(out, ref.data(), n * sizeof(float)) == 0, "2D, same pixels");
+
+        // inplace, the borders come from the temporary buffer
+        std::vector<float> copy(out, out + n);
+        refConvolve(copy.data(), ref.data(), w, h, values.data(), size, size, size / 2);
+        iplConvolve2DFP(dst, dst, &kernel, 1, 0);
+        checkTrue(sameInterior(dst->imageData, (const char*)ref.data(), n * sizeof(float), w * sizeof(float),
+                               size / 2 * sizeof(float), size / 2),
+                  "2D inplace, same pixels");
+        iplDeleteConvKernelFP(kernel);
+
+        std::vector<float> xvalues(size);
+        std::vector<float> yvalues(size);
+        for (int k = 0; k < size; k++) {
+            xvalues[k] = (nextRandom() - 16384) / 20000.0f;
+            yvalues[k] = (nextRandom() - 16384) / 20000.0f;
+        }
+        IplConvKernelFP* xKernel = iplCreateConvKernelFP(size, 1, size / 2, 0, xvalues.data());
+        IplConvKernelFP* yKernel = iplCreateConvKernelFP(1, size, 0, size / 2, yvalues.data());
+        std::vector<float> tmp(n, 0.0f);
+        ref.assign(out, out + n);
+        refConvolve(in, tmp.data(), w, h, xvalues.data(), 1, size, size / 2);
+        refConvolve(tmp.data(), ref.data(), w, h, yvalues.data(), size, 1, size / 2);
+        iplConvolveSep2DFP(src, dst, xKernel, yKernel);
+        checkTrue(memcmp(out, ref.data(), n * sizeof(float)) == 0, "separable, same pixels");
+        iplDeleteConvKernelFP(xKernel);
+        iplDeleteConvKernelFP(yKernel);
+
+        iplDeallocate(src, IPL_IMAGE_ALL);
+        iplDeallocate(dst, IPL_IMAGE_ALL);
+    }
+
+    void checkArithmetic() {
+        report(0,"checking the pixel arithmetic against the per-pixel loops...");
+        const int w = 1024;
+        const int h = 600;
+        for (int depth : {IPL_DEPTH_8U, IPL_DEPTH_8S}) {
+            const bool isSigned = (depth == IPL_DEPTH_8S);
+            const int low = isSigned ? -128 : 0;
+            const int high = isSigned ? 127 : 255;
+            IplImage* a = createImage(depth, w, h);
+            IplImage* b = createImage(depth, w, h);
+            IplImage* dst = createImage(depth, w, h);
+            const int size = a->imageSize;
+            auto pixel = [isSigned](const IplImage* img, int i) {
+                return isSigned ? (int)img->imageData[i] : (int)(unsigned char)img->imageData[i];
+            };
+            auto clip = [low, high](int v) {
+                return (char)((v < low) ? low : ((v > high) ? high : v));
+            };
+
+            bool ok = true;
+            iplAdd(a, b, dst);
+            for (int i = 0; i < size; i++) {
+                ok = ok && dst->imageData[i] == clip(pixel(a, i) + pixel(b, i));
+            }
+            checkTrue(ok, "iplAdd");
+
+            ok = true;
+            iplSubtract(a, b, dst);
+            for (int i = 0; i < size; i++) {
+                ok = ok && dst->imageData[i] == clip(pixel(a, i) - pixel(b, i));
+            }
+            checkTrue(ok, "iplSubtract");
+
+            for (int value : {-300, -37, 0, 55, 1000}) {
+                ok = true;
+                iplAddS(a, dst, value);
+                for (int i = 0; i < size; i++) {
+                    ok = ok && dst->imageData[i] == clip(pixel(a, i) + value);
+                }
+                checkTrue(ok, "iplAddS");
+
+                ok = true;
+                iplSubtractS(a, dst, value, false);
+                for (int i = 0; i < size; i++) {
+                    ok = ok && dst->imageData[i] == clip(pixel(a, i) - value);
+                }
+                iplSubtractS(a, dst, value, true);
+                for (int i = 0; i < size; i++) {
+                    ok = ok && dst->imageData[i] == clip(value - pixel(a, i));
+                }
+                checkTrue(ok, "iplSubtractS");
+            }
+
+            iplDeallocate(a, IPL_IMAGE_ALL);
+            iplDeallocate(b, IPL_IMAGE_ALL);
+            iplDeallocate(dst, IPL_IMAGE_ALL);
+        }
+
+        IplImage* a = createImage(IPL_DEPTH_32F, w, h);
+        IplImage* b = createImage(IPL_DEPTH_32F, w, h);
+        IplImage* dst = createImage(IPL_DEPTH_32F, w, h);
+        const float* fa = reinterpret_cast<float*>(a->imageData);
+        const float* fb = reinterpret_cast<float*>(b->imageData);
+        const float* fd = reinterpret_cast<float*>(dst->imageData);
+        bool ok = true;
+        iplAdd(a, b, dst);
+        for (int i = 0; i < w * h; i++) {
+            ok = ok && fd[i] == fa[i] + fb[i];
+        }
+        iplSubtract(a, b, dst);
+        for (int i = 0; i < w * h; i++) {
+            ok = ok && fd[i] == fa[i] - fb[i];
+        }
+        iplMultiplySFP(a, dst, 0.37f);
+        for (int i = 0; i < w * h; i++) {
+            ok = ok && fd[i] == fa[i] * 0.37f;
+        }
+        checkTrue(ok, "float arithmetic");
+        iplDeallocate(a, IPL_IMAGE_ALL);
+        iplDeallocate(b, IPL_IMAGE_ALL);
+        iplDeallocate(dst, IPL_IMAGE_ALL);
+    }
+
+    virtual void runTests() override {
+        checkConvolve2D();
+        checkConvolveSep2D();
+        checkConvolveFP();
+        checkArithmetic();
+    }
+};
+
+static IplImageTest theIplImageTest;
+
+UnitTest& getIplImageTest() {
+    return theIplImageTest;
+}
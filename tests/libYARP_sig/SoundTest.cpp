@@ -6,8 +6,15 @@
  */
 
 #include <yarp/sig/Sound.h>
+#include <yarp/sig/Image.h>
+#include <yarp/os/Bottle.h>
+#include <yarp/os/NetInt16.h>
 #include <yarp/os/Network.h>
 #include <yarp/os/BufferedPort.h>
+#include <yarp/os/PortablePair.h>
+
+#include <cstring>
+#include <vector>
 
 #include "TestList.h"
 
@@ -38,6 +45,127 @@ public:
         checkEqual(99,snd2.get(50),"copy works");
     }
 
+    void checkFormats() {
+        report(0,"check sample formats...");
+        Sound snd;
+        snd.resize(4,2);
+        snd.set(-1000,0,0);
+        snd.set(32767,1,1);
+        snd.set(-32768,2,0);
+        checkEqual(-1000,snd.get(0,0),"negative samples");
+        checkEqual(2,snd.getBytesPerSample(),"16 bit");
+
+        snd.setSampleFormat(Sound::FORMAT_INT24);
+        checkEqual(3,snd.getBytesPerSample(),"24 bit");
+        checkEqual(4*2*3,snd.getRawDataSize(),"24 bit size");
+        checkEqual(-1000*256,snd.get(0,0),"16 to 24 bit");
+        snd.set(-8388608,3,1);
+        checkEqual(-8388608,snd.get(3,1),"24 bit set/get");
+
+        snd.setSampleFormat(Sound::FORMAT_INT32);
+        checkEqual(-1000*65536,snd.get(0,0),"24 to 32 bit");
+        checkEqual(32767*65536,snd.get(1,1),"24 to 32 bit");
+
+        snd.setSampleFormat(Sound::FORMAT_FLOAT32);
+        checkEqual(4,snd.getBytesPerSample(),"float");
+        checkEqual(-1000,snd.get(0,0),"32 bit to float");
+        checkEqual(-32768,snd.get(2,0),"32 bit to float");
+        float f[2];
+        snd.getBlock(f,0,1);
+        checkTrue(f[0]==-1000/32768.0f,"float value");
+
+        snd.setSampleFormat(Sound::FORMAT_INT16);
+        checkEqual(-1000,snd.get(0,0),"float to 16 bit");
+        checkEqual(32767,snd.get(1,1),"float to 16 bit");
+        checkEqual(-32768,snd.get(3,1),"float to 16 bit");
+
+        Sound snd24(3);
+        checkTrue(snd24.getSampleFormat()==Sound::FORMAT_INT24,"24 bit constructor");
+    }
+
+    void checkBlocks() {
+        report(0,"check block access...");
+        int samples = 50;
+        int channels = 3;
+        std::vector<short> in(samples*channels);
+        for (size_t i=0; i<in.size(); i++) {
+            in[i] = (short)(i*97-3000);
+        }
+
+        Sound::SampleFormat formats[] = {
+            Sound::FORMAT_INT16, Sound::FORMAT_INT24,
+            Sound::FORMAT_INT32, Sound::FORMAT_FLOAT32
+        };
+        for (int k=0; k<8; k++) {
+            Sound snd;
+            snd.setSampleFormat(formats[k%4]);
+            snd.setInterleaved(k<4);
+            snd.resize(samples,channels);
+            checkTrue(snd.setBlock(in.data(),0,samples),"set block");
+
+            bool ok = true;
+            for (int i=0; i<samples; i++) {
+                for (int c=0; c<channels; c++) {
+                    short v;
+                    snd.getChannel(c,&v,i,1);
+                    ok = ok && (v == in[i*channels+c]);
+                }
+            }
+            checkTrue(ok,"block matches the samples");
+
+            std::vector<short> out(10*channels);
+            checkTrue(snd.getBlock(out.data(),20,10),"get block");
+            ok = true;
+            for (size_t i=0; i<out.size(); i++) {
+                ok = ok && (out[i] == in[20*channels+i]);
+            }
+            checkTrue(ok,"get block");
+            checkFalse(snd.getBlock(out.data(),45,10),"block out of the sound");
+
+            std::vector<float> ch(samples);
+            checkTrue(snd.getChannel(1,ch.data(),0,samples),"get channel");
+            for (int i=0; i<samples; i++) {
+                ch[i] = -ch[i];
+            }
+            checkTrue(snd.setChannel(1,ch.data(),0,samples),"set channel");
+            ok = true;
+            for (int i=0; i<samples; i++) {
+                short v;
+                snd.getChannel(1,&v,i,1);
+                ok = ok && (v == -in[i*channels+1]);
+            }
+            checkTrue(ok,"set channel");
+
+            Sound sub = snd.subSound(10,20);
+            checkEqual(10,sub.getSamples(),"sub sound");
+            short v1, v2;
+            sub.getChannel(2,&v1,5,1);
+            snd.getChannel(2,&v2,15,1);
+            checkEqual(v2,v1,"sub sound samples");
+        }
+
+        Sound a;
+        a.resize(samples,channels);
+        a.setBlock(in.data(),0,samples);
+        checkFalse(a.isInterleaved(),"planar by default");
+        checkEqual((int)in[channels+2],
+                   (int)((short*)a.getRawData())[2*samples+1],
+                   "channels are consecutive in the planar layout");
+        Sound b(a);
+        b.setInterleaved(true);
+        checkTrue(b.isInterleaved(),"interleaved");
+        bool ok = true;
+        for (int i=0; i<samples; i++) {
+            for (int c=0; c<channels; c++) {
+                ok = ok && (a.get(i,c) == b.get(i,c));
+            }
+        }
+        checkTrue(ok,"interleaved layout");
+        checkEqual((int)in[channels+2],
+                   (int)((short*)b.getRawData())[channels+2],
+                   "samples are consecutive in the interleaved layout");
+    }
+
     void checkSum() {
         report(0,"check set/get sample...");
         Sound snd1, snd2, sndSum;
@@ -125,11 +253,72 @@ public:
         input.close();
     }
     
+    void checkTransmitFormats() {
+        report(0,"checking sound transmission in every format...");
+        Sound snd1;
+        snd1.setSampleFormat(Sound::FORMAT_FLOAT32);
+        snd1.setInterleaved(false);
+        snd1.resize(100,4);
+        snd1.setFrequency(48000);
+        for (int i=0; i<snd1.getSamples(); i++) {
+            for (int c=0; c<snd1.getChannels(); c++) {
+                snd1.set(i*100-c*1000,i,c);
+            }
+        }
+        Sound snd2;
+        snd2.resize(10);
+        checkTrue(Portable::copyPortable(snd1,snd2),"copy");
+        checkTrue(snd2.getSampleFormat()==Sound::FORMAT_FLOAT32,"format");
+        checkFalse(snd2.isInterleaved(),"layout");
+        checkEqual(48000,snd2.getFrequency(),"frequency");
+        checkEqual(100,snd2.getSamples(),"samples");
+        checkEqual(4,snd2.getChannels(),"channels");
+        checkTrue(memcmp(snd1.getRawData(),snd2.getRawData(),snd1.getRawDataSize())==0,
+                  "samples");
+
+        Sound empty;
+        checkTrue(Portable::copyPortable(empty,snd2),"copy empty sound");
+        checkEqual(0,snd2.getSamples(),"empty sound");
+    }
+
+    void checkLegacyFormat() {
+        report(0,"checking the format of the older versions...");
+        // the sounds were sent as an image, with a channel for each row,
+        // and a bottle with the frequency
+        PortablePair<FlexImage,Bottle> old;
+        old.head.setPixelCode(VOCAB_PIXEL_MONO16);
+        old.head.setQuantum(2);
+        old.head.resize(30,2);
+        for (int i=0; i<30; i++) {
+            for (int c=0; c<2; c++) {
+                *reinterpret_cast<NetInt16*>(old.head.getPixelAddress(i,c)) = (short)(i*c-20);
+            }
+        }
+        old.body.addInt(22050);
+
+        Sound snd;
+        checkTrue(Portable::copyPortable(old,snd),"read");
+        checkEqual(30,snd.getSamples(),"samples");
+        checkEqual(2,snd.getChannels(),"channels");
+        checkEqual(22050,snd.getFrequency(),"frequency");
+        bool ok = true;
+        for (int i=0; i<30; i++) {
+            for (int c=0; c<2; c++) {
+                ok = ok && (snd.get(i,c) == i*c-20);
+            }
+        }
+        checkTrue(ok,"samples");
+    }
+
     virtual void runTests() override {
         Network::setLocalMode(true);
         checkSetGet();
+        checkFormats();
+        checkBlocks();
         checkSum();
         checkTransmit();
+        checkTransmitFormats();
+        checkLegacyFormat();
         Network::setLocalMode(false);
     }
 };
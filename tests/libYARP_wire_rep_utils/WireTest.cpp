@@ -14,6 +14,7 @@
 #include <yarp/os/Route.h>
 #include <yarp/os/InputStream.h>
 #include <yarp/os/ConnectionReader.h>
+#include <yarp/os/ConnectionWriter.h>
 #include <yarp/os/impl/UnitTest.h>
 
 #if defined(_MSC_VER)
@@ -61,6 +62,17 @@ public:
             char seq[] = {2, 0, 0, 0, 3, 0, 0, 0, 'f', 'o', 'o', 3, 0, 0, 0, 'b', 'a', 'r', 12, 0, 0, 0, 2, 0, 0, 0, 42, 0, 0, 0, 24, 0, 0, 0};
             testSequence(seq, sizeof(seq),"list 3 vector string * int32 * vector int32 *", Bottle("(foo bar) 12 (42 24)"));
         }
+        {
+            report(0, "checking vector float32 *");
+            // 1.5 and -2.0, converted from the doubles of the bottle
+            char seq[] = {2, 0, 0, 0, 0, 0, (char)0xc0, 0x3f, 0, 0, 0, (char)0xc0};
+            testSequence(seq, sizeof(seq),"vector float32 *", Bottle("1.5 -2.0"));
+        }
+        {
+            report(0, "checking list 2 vector float32 2 * vector int32 *");
+            char seq[] = {0, 0, (char)0xc0, 0x3f, 0, 0, 0, (char)0xc0, 2, 0, 0, 0, 42, 0, 0, 0, 24, 0, 0, 0};
+            testSequence(seq, sizeof(seq),"list 2 vector float32 2 * vector int32 *", Bottle("(1.5 -2.0) (42 24)"));
+        }
         {
             report(0, "checking vector int32 2 *");
             char seq[] = {42, 0, 0, 0, 24, 0, 0, 0};
@@ -99,11 +111,58 @@ public:
 
     }
 
+    void checkMismatch()
+    {
+        report(0, "checking a message that does not match the format");
+        WireTwiddler tt;
+        tt.configure("list 2 int32 * int32 *", "list 2 int32 * int32 *");
+        const char *msgs[] = { "12 13", "12 hello", "(12 13)" };
+        for (size_t i = 0; i < sizeof(msgs)/sizeof(msgs[0]); i++) {
+            ConnectionWriter *writer = ConnectionWriter::createBufferedConnectionWriter();
+            Bottle bot(msgs[i]);
+            bot.write(*writer);
+            WireTwiddlerWriter twiddled_output;
+            twiddled_output.attach(*writer->getBuffer(), tt);
+            char err[1024];
+            snprintf(err, 1024, "mismatch of %s reported", msgs[i]);
+            checkFalse(twiddled_output.update(), err);
+            delete writer;
+        }
+    }
+
+    void checkTruncated()
+    {
+        report(0, "checking a truncated message");
+        WireTwiddler tt;
+        tt.configure("vector float32 *", "vector float32 *");
+        // the length of the vector is more than the doubles in the message
+        const int lengths[] = { 2, 3, 0x7fffffff };
+        for (size_t i = 0; i < sizeof(lengths)/sizeof(lengths[0]); i++) {
+            ConnectionWriter *writer = ConnectionWriter::createBufferedConnectionWriter();
+            writer->appendInt(BOTTLE_TAG_LIST|BOTTLE_TAG_DOUBLE);
+            writer->appendInt(lengths[i]);
+            writer->appendDouble(1.5);
+            writer->appendDouble(-2.0);
+            WireTwiddlerWriter twiddled_output;
+            twiddled_output.attach(*writer->getBuffer(), tt);
+            char err[1024];
+            if (lengths[i] == 2) {
+                checkTrue(twiddled_output.update(), "complete message converted");
+            } else {
+                snprintf(err, 1024, "truncation of a vector of %d reported", lengths[i]);
+                checkFalse(twiddled_output.update(), err);
+            }
+            delete writer;
+        }
+    }
+
     virtual void runTests() override
     {
         NetworkBase::setLocalMode(true);
 
         checkWire();
+        checkMismatch();
+        checkTruncated();
 
         NetworkBase::setLocalMode(false);
 